@@ -50,6 +50,10 @@ set(HOST_SOURCES
     host/usbcontrol.cpp host/usbcontrol.h
     host/multimediabackend.cpp host/multimediabackend.h
     host/imagecapturer.cpp host/imagecapturer.h
+    host/timelapsearchive.cpp host/timelapsearchive.h
+    host/framebus.cpp host/framebus.h
+    host/backend/common/jpegutils.cpp host/backend/common/jpegutils.h
+    host/backend/common/latencyhistogram.h
     host/backend/ffmpegbackendhandler.cpp host/backend/ffmpegbackendhandler.h
     host/backend/qtmultimediabackendhandler.cpp host/backend/qtmultimediabackendhandler.h
     host/backend/qtbackendhandler.cpp host/backend/qtbackendhandler.h
@@ -57,7 +61,21 @@ set(HOST_SOURCES
     host/backend/ffmpeg/ffmpeg_hardware_accelerator.cpp host/backend/ffmpeg/ffmpeg_hardware_accelerator.h
     host/backend/ffmpeg/ffmpeg_device_manager.cpp host/backend/ffmpeg/ffmpeg_device_manager.h
     host/backend/ffmpeg/ffmpeg_frame_processor.cpp host/backend/ffmpeg/ffmpeg_frame_processor.h
+    host/backend/ffmpeg/ffmpeg_frame_pool.cpp host/backend/ffmpeg/ffmpeg_frame_pool.h
+    host/backend/ffmpeg/ffmpeg_decode_pipeline.cpp host/backend/ffmpeg/ffmpeg_decode_pipeline.h
+    host/backend/ffmpeg/ffmpeg_packet_ring.h
+    host/backend/ffmpeg/ffmpeg_encoded_frame.h
+    host/backend/ffmpeg/ffmpeg_clock.h
+    host/backend/ffmpeg/ffmpeg_latency_tracer.cpp host/backend/ffmpeg/ffmpeg_latency_tracer.h
+    host/backend/ffmpeg/ffmpeg_frame_pacer.cpp host/backend/ffmpeg/ffmpeg_frame_pacer.h
+    host/backend/ffmpeg/ffmpeg_yuv_convert.cpp host/backend/ffmpeg/ffmpeg_yuv_convert.h
+    host/backend/ffmpeg/ffmpeg_packet_capture_file.cpp host/backend/ffmpeg/ffmpeg_packet_capture_file.h
+    host/backend/ffmpeg/ffmpeg_replay_frame_reader.cpp host/backend/ffmpeg/ffmpeg_replay_frame_reader.h
+    host/backend/ffmpeg/ffmpeg_video_benchmark.cpp host/backend/ffmpeg/ffmpeg_video_benchmark.h
+    host/backend/ffmpeg/ffmpeg_image_saver.cpp host/backend/ffmpeg/ffmpeg_image_saver.h
+    host/backend/ffmpeg/ffmpeg_frame_change_detector.cpp host/backend/ffmpeg/ffmpeg_frame_change_detector.h
     host/backend/ffmpeg/ffmpeg_recorder.cpp host/backend/ffmpeg/ffmpeg_recorder.h
+    host/backend/ffmpeg/ffmpeg_audio_encoder.cpp host/backend/ffmpeg/ffmpeg_audio_encoder.h
     host/backend/ffmpeg/ffmpeg_device_validator.cpp host/backend/ffmpeg/ffmpeg_device_validator.h
     host/backend/ffmpeg/ffmpeg_hotplug_handler.cpp host/backend/ffmpeg/ffmpeg_hotplug_handler.h
     host/backend/ffmpeg/ffmpeg_capture_manager.cpp host/backend/ffmpeg/ffmpeg_capture_manager.h
@@ -82,6 +100,8 @@ if(NOT WIN32)
         host/backend/gstreamer/externalgstrunner.h
         host/backend/gstreamer/recordingmanager.cpp
         host/backend/gstreamer/recordingmanager.h
+        host/backend/gstreamer/pipelineprobes.cpp
+        host/backend/gstreamer/pipelineprobes.h
         host/backend/gstreamerbackendhandler.h
         host/backend/gstreamer/sinkselector.h
         host/backend/gstreamer/queueconfigurator.h
@@ -145,6 +165,8 @@ set(SERIAL_SOURCES
     serial/SerialCommandCoordinator.cpp serial/SerialCommandCoordinator.h
     serial/SerialStateManager.cpp serial/SerialStateManager.h
     serial/SerialStatistics.cpp serial/SerialStatistics.h
+    serial/SerialTraceRecorder.cpp serial/SerialTraceRecorder.h
+    serial/SerialTxScheduler.cpp serial/SerialTxScheduler.h
     serial/FactoryResetManager.cpp serial/FactoryResetManager.h
     serial/serial_hotplug_handler.cpp serial/serial_hotplug_handler.h
     serial/ch9329.h
@@ -153,6 +175,7 @@ set(SERIAL_SOURCES
     serial/chipstrategy/CH32V208Strategy.cpp serial/chipstrategy/CH32V208Strategy.h
     serial/chipstrategy/ChipStrategyFactory.cpp serial/chipstrategy/ChipStrategyFactory.h
     serial/protocol/SerialProtocol.cpp serial/protocol/SerialProtocol.h
+    serial/protocol/SerialPacketFramer.cpp serial/protocol/SerialPacketFramer.h
     serial/watchdog/ConnectionWatchdog.cpp serial/watchdog/ConnectionWatchdog.h
 )
 
@@ -332,6 +332,22 @@ QAudioDevice AudioManager::getCurrentAudioDevice() const
     return m_currentAudioDevice;
 }
 
+QAudioFormat AudioManager::getCurrentAudioFormat() const
+{
+    if (!m_audioThread || !m_audioThread->isRunning()) {
+        return QAudioFormat();
+    }
+    return m_audioThread->format();
+}
+
+void AudioManager::setPcmTap(std::function<void(const char* data, qint64 size, const QAudioFormat& format)> tap)
+{
+    m_pcmTap = std::move(tap);
+    if (m_audioThread) {
+        m_audioThread->setPcmTap(m_pcmTap);
+    }
+}
+
 QList<QAudioDevice> AudioManager::getAvailableAudioDevices() const
 {
     return QMediaDevices::audioInputs();
@@ -711,6 +727,7 @@ void AudioManager::initializeAudioWithDevice(const QAudioDevice& inputDevice)
             qCDebug(log_core_host_audio) << "No better alternative ALSA device found, using original device";
         }
         m_audioThread = new AudioThread(deviceToUse, outputDevice, format, this);
+        m_audioThread->setPcmTap(m_pcmTap);
         connect(m_audioThread, &AudioThread::error, this, &AudioManager::handleAudioError);
         connect(m_audioThread, &AudioThread::cleanupRequested, this, &AudioManager::handleCleanupRequest, Qt::QueuedConnection);
         
@@ -7,6 +7,8 @@
 #include <QLoggingCategory>
 #include <QTimer>
 #include <QRegularExpression>
+#include <QAudioFormat>
+#include <functional>
 
 class AudioThread;
 
@@ -46,6 +48,13 @@ public:
     QString getCurrentAudioPortChain() const;
     QAudioDevice getCurrentAudioDevice() const;
     
+    // PCM format of the running capture (invalid when audio is not running)
+    QAudioFormat getCurrentAudioFormat() const;
+    
+    // Receives a copy of the captured PCM on the audio thread (e.g. for
+    // recording).  Survives device switches; pass an empty function to remove.
+    void setPcmTap(std::function<void(const char* data, qint64 size, const QAudioFormat& format)> tap);
+    
     // Device discovery and management
     QList<QAudioDevice> getAvailableAudioDevices() const;
     QStringList getAvailableAudioDeviceIds() const;
@@ -93,6 +102,7 @@ private:
     void displayAllAudioDeviceIds() const;
 
     AudioThread* m_audioThread;
+    std::function<void(const char*, qint64, const QAudioFormat&)> m_pcmTap;
     QAudioDevice m_currentAudioDevice;
     QString m_currentAudioPortChain;
 };
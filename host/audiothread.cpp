@@ -128,6 +128,12 @@ qreal AudioThread::volume() const
     return vol;
 }
 
+void AudioThread::setPcmTap(PcmTap tap)
+{
+    QMutexLocker locker(&m_pcmTapMutex);
+    m_pcmTap = std::move(tap);
+}
+
 void AudioThread::cleanupMultimediaObjects()
 {
     qCDebug(log_core_audio) << "AudioThread::cleanupMultimediaObjects() - skipping to prevent crashes";
@@ -374,6 +380,14 @@ void AudioThread::run()
                     if (bytesRead > 0) {
                         // qCDebug(log_core_audio) << "Audio data: read" << bytesRead << "bytes from" << bytesAvailable << "available";
                         
+                        // Hand a copy to the recorder (if any) before playback
+                        {
+                            QMutexLocker tapLocker(&m_pcmTapMutex);
+                            if (m_pcmTap) {
+                                m_pcmTap(buffer, bytesRead, m_format);
+                            }
+                        }
+                        
                         // Double-check we haven't started cleanup between reads
                         m_mutex.lock();
                         bool safeToWrite = !m_cleanupStarted && m_sinkIODevice;
@@ -9,6 +9,7 @@
 #include <QMutex>
 #include <QLoggingCategory>
 #include <memory>
+#include <functional>
 
 Q_DECLARE_LOGGING_CATEGORY(log_core_audio)
 
@@ -16,6 +17,9 @@ class AudioThread : public QThread {
     Q_OBJECT
 
 public:
+    // Receives every captured PCM buffer on the audio thread; must not block
+    using PcmTap = std::function<void(const char* data, qint64 size, const QAudioFormat& format)>;
+
     AudioThread(const QAudioDevice& inputDevice, 
                const QAudioDevice& outputDevice,
                const QAudioFormat& format,
@@ -25,6 +29,11 @@ public:
     void stop();
     void setVolume(qreal volume);
     qreal volume() const;
+    QAudioFormat format() const { return m_format; }
+    
+    // Install (or clear, with an empty function) the PCM tap.  Once this
+    // returns, the previous tap is never called again.
+    void setPcmTap(PcmTap tap);
     
     // Method to clean up multimedia objects safely
     void cleanupMultimediaObjects();
@@ -48,6 +57,8 @@ private:
     bool m_cleanupStarted;         // Flag to prevent access during cleanup
     mutable QMutex m_mutex;  // Make the mutex mutable so it can be locked in const functions
     qreal m_volume;
+    PcmTap m_pcmTap;
+    QMutex m_pcmTapMutex;          // Separate from m_mutex so setVolume() never waits on a tap
 };
 
 #endif // AUDIOTHREAD_H
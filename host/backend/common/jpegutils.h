@@ -0,0 +1,48 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#ifndef JPEGUTILS_H
+#define JPEGUTILS_H
+
+#include <QByteArray>
+#include <QSize>
+
+/**
+ * @brief Helpers for the MJPEG frames UVC capture cards deliver
+ *
+ * Shared by the FFmpeg and GStreamer backends so an EncodedFrame is the same
+ * standalone JPEG file whichever backend produced it.
+ */
+class JpegUtils {
+public:
+    // Returns `jpeg` as a standalone JPEG file, inserting the standard Huffman
+    // tables before the first SOS marker when the stream carries none.  Shares
+    // the input buffer when nothing needs inserting; null if `jpeg` is not a
+    // JPEG.
+    static QByteArray makeStandalone(const QByteArray& jpeg);
+
+    // Frame size from the first SOF segment, read from the JPEG headers alone;
+    // invalid if there is none before the scan data.
+    static QSize frameSize(const uchar* data, qsizetype size);
+};
+
+#endif // JPEGUTILS_H
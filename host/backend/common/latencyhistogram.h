@@ -0,0 +1,156 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QtGlobal>
+#include <QtCore/qalgorithms.h>
+#include <array>
+#include <atomic>
+
+/**
+ * @brief Lock-free log-linear latency histogram in microseconds
+ *
+ * 16 linear buckets below 16 us, then 8 sub-buckets per power of two, so
+ * percentiles are accurate to about 6%.  record() is a relaxed atomic
+ * increment plus a max update and may run on any thread.  Shared by the FFmpeg
+ * latency tracer and the GStreamer pipeline probes so both backends report
+ * the same numbers.
+ *
+ * Reading may race with record(); a sample landing in between is attributed
+ * to either window, which is fine for statistics.
+ */
+class LatencyHistogram {
+public:
+    struct Summary {
+        quint64 samples = 0;
+        double p50_ms = 0.0;
+        double p95_ms = 0.0;
+        double p99_ms = 0.0;
+        double max_ms = 0.0;
+    };
+
+    void record(qint64 us)
+    {
+        const quint64 value = us > 0 ? static_cast<quint64>(us) : 0;
+        m_buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        qint64 previous = m_maxUs.load(std::memory_order_relaxed);
+        while (us > previous && !m_maxUs.compare_exchange_weak(previous, us, std::memory_order_relaxed)) {
+        }
+    }
+
+    Summary summary() const
+    {
+        std::array<quint32, kBucketCount> counts;
+        for (int i = 0; i < kBucketCount; ++i) {
+            counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        }
+        return summarize(counts, m_maxUs.load(std::memory_order_relaxed));
+    }
+
+    // Reads and clears the histogram in one pass
+    Summary takeSummary()
+    {
+        std::array<quint32, kBucketCount> counts;
+        for (int i = 0; i < kBucketCount; ++i) {
+            counts[i] = m_buckets[i].exchange(0, std::memory_order_relaxed);
+        }
+        return summarize(counts, m_maxUs.exchange(0, std::memory_order_relaxed));
+    }
+
+    void reset()
+    {
+        for (std::atomic<quint32>& bucket : m_buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        m_maxUs.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr int kLinearBuckets = 16;
+    static constexpr int kSubBuckets = 8;
+    static constexpr int kMaxExponent = 25;  // ~67 s; larger samples are clamped
+    static constexpr int kBucketCount = kLinearBuckets + (kMaxExponent - 3) * kSubBuckets;
+
+    static int bucketIndex(quint64 us)
+    {
+        if (us < kLinearBuckets) {
+            return static_cast<int>(us);
+        }
+        const int exponent = 63 - qCountLeadingZeroBits(us);
+        if (exponent > kMaxExponent) {
+            return kBucketCount - 1;
+        }
+        const int sub = static_cast<int>((us >> (exponent - 3)) & (kSubBuckets - 1));
+        return kLinearBuckets + (exponent - 4) * kSubBuckets + sub;
+    }
+
+    static double bucketValueMs(int index)
+    {
+        if (index < kLinearBuckets) {
+            return index / 1000.0;
+        }
+        const int exponent = (index - kLinearBuckets) / kSubBuckets + 4;
+        const int sub = (index - kLinearBuckets) % kSubBuckets;
+        const quint64 width = 1ULL << (exponent - 3);
+        const quint64 lower = static_cast<quint64>(kSubBuckets + sub) << (exponent - 3);
+        return (lower + width / 2) / 1000.0;  // Bucket midpoint
+    }
+
+    static double percentileMs(const std::array<quint32, kBucketCount>& counts, quint64 total, double fraction)
+    {
+        if (total == 0) {
+            return 0.0;
+        }
+        const quint64 rank = qMax<quint64>(1, static_cast<quint64>(fraction * total + 0.5));
+        quint64 seen = 0;
+        for (int i = 0; i < kBucketCount; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return bucketValueMs(i);
+            }
+        }
+        return bucketValueMs(kBucketCount - 1);
+    }
+
+    static Summary summarize(const std::array<quint32, kBucketCount>& counts, qint64 max_us)
+    {
+        quint64 total = 0;
+        for (quint32 count : counts) {
+            total += count;
+        }
+
+        Summary result;
+        result.samples = total;
+        result.p50_ms = percentileMs(counts, total, 0.50);
+        result.p95_ms = percentileMs(counts, total, 0.95);
+        result.p99_ms = percentileMs(counts, total, 0.99);
+        result.max_ms = max_us / 1000.0;
+        return result;
+    }
+
+    std::array<std::atomic<quint32>, kBucketCount> m_buckets{};
+    std::atomic<qint64> m_maxUs{0};
+};
+
+#endif // LATENCYHISTOGRAM_H
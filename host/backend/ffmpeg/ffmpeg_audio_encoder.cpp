@@ -0,0 +1,406 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#include "ffmpeg_audio_encoder.h"
+
+#include <QDebug>
+#include <QLoggingCategory>
+#include <cstdlib>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/audio_fifo.h>
+#include <libavutil/channel_layout.h>
+#include <libavutil/samplefmt.h>
+#include <libswresample/swresample.h>
+}
+
+Q_DECLARE_LOGGING_CATEGORY(log_ffmpeg_backend)
+
+namespace {
+
+AVSampleFormat ToAVSampleFormat(FFmpegAudioEncoder::SampleFormat format)
+{
+    switch (format) {
+    case FFmpegAudioEncoder::SampleFormat::Int32:
+        return AV_SAMPLE_FMT_S32;
+    case FFmpegAudioEncoder::SampleFormat::Float:
+        return AV_SAMPLE_FMT_FLT;
+    case FFmpegAudioEncoder::SampleFormat::Int16:
+    default:
+        return AV_SAMPLE_FMT_S16;
+    }
+}
+
+AVCodecID CodecIdForName(const QString& name)
+{
+    const QString lower = name.trimmed().toLower();
+    if (lower == "opus") return AV_CODEC_ID_OPUS;
+    if (lower == "mp3") return AV_CODEC_ID_MP3;
+    if (lower == "flac") return AV_CODEC_ID_FLAC;
+    if (lower == "pcm") return AV_CODEC_ID_PCM_S16LE;
+    return AV_CODEC_ID_AAC;
+}
+
+QString ErrorString(int error)
+{
+    char errbuf[AV_ERROR_MAX_STRING_SIZE];
+    av_strerror(error, errbuf, AV_ERROR_MAX_STRING_SIZE);
+    return QString::fromUtf8(errbuf);
+}
+
+} // namespace
+
+FFmpegAudioEncoder::~FFmpegAudioEncoder()
+{
+    Close();
+}
+
+bool FFmpegAudioEncoder::Open(AVFormatContext* format_context, const QString& codec_name, int bitrate,
+                              int sample_rate, const InputFormat& input)
+{
+    Close();
+    if (!format_context || !input.IsValid()) {
+        return false;
+    }
+
+    // Not every container takes every codec (AVI has no Opus mapping)
+    AVCodecID codec_id = CodecIdForName(codec_name);
+    if (avformat_query_codec(format_context->oformat, codec_id, FF_COMPLIANCE_NORMAL) == 0) {
+        qCWarning(log_ffmpeg_backend) << "Audio codec" << codec_name << "not supported by"
+                                      << format_context->oformat->name << "- using AAC";
+        codec_id = AV_CODEC_ID_AAC;
+    }
+
+    const AVCodec* codec = codec_id == AV_CODEC_ID_OPUS ? avcodec_find_encoder_by_name("libopus") : nullptr;
+    if (!codec) {
+        codec = avcodec_find_encoder(codec_id);
+    }
+    if (!codec) {
+        qCWarning(log_ffmpeg_backend) << "No audio encoder available for" << avcodec_get_name(codec_id);
+        return false;
+    }
+
+    codec_context_ = avcodec_alloc_context3(codec);
+    if (!codec_context_) {
+        return false;
+    }
+
+    // Encoder-native sample format and the closest supported rate
+    codec_context_->sample_fmt = codec->sample_fmts ? codec->sample_fmts[0] : AV_SAMPLE_FMT_FLTP;
+    int rate = sample_rate > 0 ? sample_rate : input.sample_rate;
+    if (codec->supported_samplerates) {
+        int best = codec->supported_samplerates[0];
+        for (const int* r = codec->supported_samplerates; *r; ++r) {
+            if (std::abs(*r - rate) < std::abs(best - rate)) {
+                best = *r;
+            }
+        }
+        rate = best;
+    }
+    codec_context_->sample_rate = rate;
+    av_channel_layout_default(&codec_context_->ch_layout, qBound(1, input.channels, 2));
+    codec_context_->bit_rate = bitrate;
+    codec_context_->time_base = AVRational{1, rate};
+    codec_context_->strict_std_compliance = FF_COMPLIANCE_EXPERIMENTAL;  // Native Opus encoder
+    if (format_context->oformat->flags & AVFMT_GLOBALHEADER) {
+        codec_context_->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+
+    int ret = avcodec_open2(codec_context_, codec, nullptr);
+    if (ret < 0) {
+        qCWarning(log_ffmpeg_backend) << "Failed to open audio encoder:" << ErrorString(ret);
+        Close();
+        return false;
+    }
+
+    stream_ = avformat_new_stream(format_context, nullptr);
+    if (!stream_ || avcodec_parameters_from_context(stream_->codecpar, codec_context_) < 0) {
+        qCWarning(log_ffmpeg_backend) << "Failed to create audio stream";
+        Close();
+        return false;
+    }
+    stream_->time_base = codec_context_->time_base;
+
+    AVChannelLayout in_layout;
+    av_channel_layout_default(&in_layout, input.channels);
+    ret = swr_alloc_set_opts2(&swr_context_,
+                              &codec_context_->ch_layout, codec_context_->sample_fmt, codec_context_->sample_rate,
+                              &in_layout, ToAVSampleFormat(input.sample_format), input.sample_rate,
+                              0, nullptr);
+    av_channel_layout_uninit(&in_layout);
+    if (ret < 0 || swr_init(swr_context_) < 0) {
+        qCWarning(log_ffmpeg_backend) << "Failed to initialize audio resampler";
+        Close();
+        return false;
+    }
+
+    const bool variable_frames = codec->capabilities & AV_CODEC_CAP_VARIABLE_FRAME_SIZE;
+    frame_size_ = codec_context_->frame_size > 0 && !variable_frames ? codec_context_->frame_size : 1024;
+    pad_last_frame_ = !variable_frames && !(codec->capabilities & AV_CODEC_CAP_SMALL_LAST_FRAME);
+
+    fifo_ = av_audio_fifo_alloc(codec_context_->sample_fmt, codec_context_->ch_layout.nb_channels, frame_size_ * 4);
+    frame_ = av_frame_alloc();
+    packet_ = av_packet_alloc();
+    if (!fifo_ || !frame_ || !packet_) {
+        Close();
+        return false;
+    }
+    frame_->format = codec_context_->sample_fmt;
+    frame_->sample_rate = codec_context_->sample_rate;
+    frame_->nb_samples = frame_size_;
+    av_channel_layout_copy(&frame_->ch_layout, &codec_context_->ch_layout);
+    if (av_frame_get_buffer(frame_, 0) < 0) {
+        Close();
+        return false;
+    }
+
+    format_context_ = format_context;
+    input_ = input;
+    next_sample_ = -1;
+
+    qCDebug(log_ffmpeg_backend) << "Audio encoder configured:" << codec->name
+                               << "rate:" << codec_context_->sample_rate
+                               << "channels:" << codec_context_->ch_layout.nb_channels
+                               << "bitrate:" << bitrate
+                               << "input:" << input.sample_rate << "Hz" << input.channels << "ch";
+    return true;
+}
+
+void FFmpegAudioEncoder::Close()
+{
+    if (convert_data_) {
+        av_freep(&convert_data_[0]);
+        av_freep(&convert_data_);
+    }
+    convert_capacity_ = 0;
+    if (fifo_) {
+        av_audio_fifo_free(fifo_);
+        fifo_ = nullptr;
+    }
+    av_frame_free(&frame_);
+    av_packet_free(&packet_);
+    swr_free(&swr_context_);
+    avcodec_free_context(&codec_context_);
+    stream_ = nullptr;          // Owned by the format context
+    format_context_ = nullptr;
+    next_sample_ = -1;
+}
+
+bool FFmpegAudioEncoder::EnsureConvertBuffer(int samples)
+{
+    if (samples <= convert_capacity_) {
+        return true;
+    }
+    if (convert_data_) {
+        av_freep(&convert_data_[0]);
+        av_freep(&convert_data_);
+    }
+    convert_capacity_ = 0;
+    if (av_samples_alloc_array_and_samples(&convert_data_, nullptr, codec_context_->ch_layout.nb_channels,
+                                           samples, codec_context_->sample_fmt, 0) < 0) {
+        return false;
+    }
+    convert_capacity_ = samples;
+    return true;
+}
+
+bool FFmpegAudioEncoder::Encode(const QByteArray& pcm, qint64 timestamp_us)
+{
+    if (!IsOpen()) {
+        return false;
+    }
+    const int in_samples = pcm.size() / input_.BytesPerFrame();
+    if (in_samples <= 0) {
+        return true;
+    }
+
+    // Where the chunk's first sample belongs on the recording clock
+    const int out_rate = codec_context_->sample_rate;
+    const qint64 start_us = timestamp_us - static_cast<qint64>(in_samples) * 1000000 / input_.sample_rate;
+    const int64_t clock_position = av_rescale(start_us, out_rate, 1000000);
+    if (next_sample_ < 0) {
+        next_sample_ = qMax<int64_t>(0, clock_position);
+    }
+
+    const int64_t drift = clock_position - next_sample_;
+    const qint64 drift_us = av_rescale(drift, 1000000, out_rate);
+    drift_us_.store(drift_us, std::memory_order_relaxed);
+    qint64 current_max = max_drift_us_.load(std::memory_order_relaxed);
+    while (std::abs(drift_us) > current_max &&
+           !max_drift_us_.compare_exchange_weak(current_max, std::abs(drift_us), std::memory_order_relaxed)) {
+    }
+
+    const int64_t tolerance = static_cast<int64_t>(out_rate) * kMaxDriftMs / 1000;
+    if (drift > tolerance) {
+        // Capture stalled or chunks were dropped: keep the timeline on the clock
+        underruns_.fetch_add(1, std::memory_order_relaxed);
+        const int64_t max_silence = static_cast<int64_t>(out_rate) * kMaxSilenceMs / 1000;
+        if (drift <= max_silence) {
+            if (!WriteSilence(drift)) {
+                return false;
+            }
+        } else {
+            // Too long to pad: flush what is buffered and leave a timestamp gap
+            EncodeAvailable(true);
+            next_sample_ = clock_position;
+        }
+    } else if (drift < -tolerance) {
+        // The audio device delivers faster than the capture clock advances
+        samples_dropped_.fetch_add(static_cast<quint64>(in_samples), std::memory_order_relaxed);
+        return true;
+    }
+
+    const int out_capacity = swr_get_out_samples(swr_context_, in_samples);
+    if (out_capacity <= 0 || !EnsureConvertBuffer(out_capacity)) {
+        return false;
+    }
+    const uint8_t* in_data[1] = { reinterpret_cast<const uint8_t*>(pcm.constData()) };
+    const int converted = swr_convert(swr_context_, convert_data_, out_capacity, in_data, in_samples);
+    if (converted < 0) {
+        qCWarning(log_ffmpeg_backend) << "Audio conversion failed:" << ErrorString(converted);
+        return false;
+    }
+    if (converted > 0) {
+        if (av_audio_fifo_write(fifo_, reinterpret_cast<void**>(convert_data_), converted) < converted) {
+            return false;
+        }
+        next_sample_ += converted;
+    }
+    return EncodeAvailable(false);
+}
+
+bool FFmpegAudioEncoder::WriteSilence(int64_t samples)
+{
+    const int chunk = static_cast<int>(qMin<int64_t>(samples, frame_size_ * 4));
+    if (!EnsureConvertBuffer(chunk)) {
+        return false;
+    }
+    av_samples_set_silence(convert_data_, 0, chunk, codec_context_->ch_layout.nb_channels,
+                           codec_context_->sample_fmt);
+    while (samples > 0) {
+        const int count = static_cast<int>(qMin<int64_t>(samples, chunk));
+        if (av_audio_fifo_write(fifo_, reinterpret_cast<void**>(convert_data_), count) < count) {
+            return false;
+        }
+        next_sample_ += count;
+        samples -= count;
+        if (!EncodeAvailable(false)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FFmpegAudioEncoder::EncodeAvailable(bool flush)
+{
+    int available = av_audio_fifo_size(fifo_);
+    while (available >= frame_size_ || (flush && available > 0)) {
+        const int count = qMin(available, frame_size_);
+        if (av_frame_make_writable(frame_) < 0) {
+            return false;
+        }
+        // PTS of the FIFO's head: the end of the timeline minus what is still buffered
+        frame_->pts = next_sample_ - available;
+        frame_->nb_samples = count;
+        if (av_audio_fifo_read(fifo_, reinterpret_cast<void**>(frame_->data), count) < count) {
+            return false;
+        }
+        if (count < frame_size_ && pad_last_frame_) {
+            av_samples_set_silence(frame_->data, count, frame_size_ - count,
+                                   codec_context_->ch_layout.nb_channels, codec_context_->sample_fmt);
+            frame_->nb_samples = frame_size_;
+        }
+        if (!SendFrame(frame_)) {
+            return false;
+        }
+        frames_encoded_.fetch_add(1, std::memory_order_relaxed);
+        available = av_audio_fifo_size(fifo_);
+    }
+    return true;
+}
+
+bool FFmpegAudioEncoder::SendFrame(AVFrame* frame)
+{
+    int ret = avcodec_send_frame(codec_context_, frame);
+    if (ret < 0 && ret != AVERROR_EOF) {
+        qCWarning(log_ffmpeg_backend) << "Error sending audio frame to encoder:" << ErrorString(ret);
+        return false;
+    }
+
+    while (true) {
+        ret = avcodec_receive_packet(codec_context_, packet_);
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+            return true;
+        }
+        if (ret < 0) {
+            qCWarning(log_ffmpeg_backend) << "Error receiving audio packet:" << ErrorString(ret);
+            return false;
+        }
+        av_packet_rescale_ts(packet_, codec_context_->time_base, stream_->time_base);
+        packet_->stream_index = stream_->index;
+        ret = av_interleaved_write_frame(format_context_, packet_);
+        av_packet_unref(packet_);
+        if (ret < 0) {
+            qCWarning(log_ffmpeg_backend) << "Error writing audio packet:" << ErrorString(ret);
+            return false;
+        }
+    }
+}
+
+bool FFmpegAudioEncoder::Flush()
+{
+    if (!IsOpen()) {
+        return false;
+    }
+
+    // Samples still inside the resampler
+    if (EnsureConvertBuffer(frame_size_)) {
+        const int converted = swr_convert(swr_context_, convert_data_, frame_size_, nullptr, 0);
+        if (converted > 0 && av_audio_fifo_write(fifo_, reinterpret_cast<void**>(convert_data_), converted) == converted) {
+            next_sample_ += converted;
+        }
+    }
+
+    const bool ok = EncodeAvailable(true);
+    return SendFrame(nullptr) && ok;
+}
+
+FFmpegAudioEncoder::Stats FFmpegAudioEncoder::GetStats() const
+{
+    Stats stats;
+    stats.frames_encoded = frames_encoded_.load(std::memory_order_relaxed);
+    stats.underruns = underruns_.load(std::memory_order_relaxed);
+    stats.samples_dropped = samples_dropped_.load(std::memory_order_relaxed);
+    stats.drift_ms = drift_us_.load(std::memory_order_relaxed) / 1000.0;
+    stats.max_drift_ms = max_drift_us_.load(std::memory_order_relaxed) / 1000.0;
+    return stats;
+}
+
+void FFmpegAudioEncoder::ResetStats()
+{
+    frames_encoded_.store(0, std::memory_order_relaxed);
+    underruns_.store(0, std::memory_order_relaxed);
+    samples_dropped_.store(0, std::memory_order_relaxed);
+    max_drift_us_.store(0, std::memory_order_relaxed);
+}
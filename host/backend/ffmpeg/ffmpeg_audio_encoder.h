@@ -0,0 +1,137 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#ifndef FFMPEG_AUDIO_ENCODER_H
+#define FFMPEG_AUDIO_ENCODER_H
+
+#include <QByteArray>
+#include <QString>
+#include <atomic>
+
+extern "C" {
+struct AVFormatContext;
+struct AVCodecContext;
+struct AVStream;
+struct AVFrame;
+struct AVPacket;
+struct AVAudioFifo;
+struct SwrContext;
+}
+
+/**
+ * @brief Audio track of an FFmpeg recording
+ *
+ * Converts captured interleaved PCM to the encoder's format and rate
+ * (libswresample), buffers it in an AVAudioFifo and muxes complete
+ * AAC/Opus frames into the recorder's output file.
+ *
+ * The audio timeline is kept in samples.  Every chunk also carries its
+ * capture time on the recording clock; when the two drift apart by more
+ * than kMaxDriftMs the gap is filled with silence (capture underrun) or the
+ * chunk is dropped (audio clock running fast), so audio stays in sync with
+ * video over long sessions.
+ *
+ * Not thread-safe: used from the recorder's encoder thread only, apart from
+ * GetStats()/ResetStats().
+ */
+class FFmpegAudioEncoder {
+public:
+    enum class SampleFormat { Int16, Int32, Float };
+
+    // Layout of the PCM handed to Encode()
+    struct InputFormat {
+        int sample_rate = 48000;
+        int channels = 2;
+        SampleFormat sample_format = SampleFormat::Int16;
+
+        int BytesPerFrame() const { return channels * (sample_format == SampleFormat::Int16 ? 2 : 4); }
+        bool IsValid() const { return sample_rate > 0 && channels > 0; }
+    };
+
+    struct Stats {
+        quint64 frames_encoded = 0;
+        quint64 underruns = 0;        // Capture gaps filled with silence
+        quint64 samples_dropped = 0;  // Input samples skipped to correct drift
+        double drift_ms = 0.0;        // Capture clock minus sample clock, last chunk
+        double max_drift_ms = 0.0;
+    };
+
+    // Drift tolerated before the timeline is corrected
+    static constexpr int kMaxDriftMs = 60;
+    // Longest gap filled with silence; longer ones become a timestamp gap
+    static constexpr int kMaxSilenceMs = 10000;
+
+    FFmpegAudioEncoder() = default;
+    ~FFmpegAudioEncoder();
+
+    FFmpegAudioEncoder(const FFmpegAudioEncoder&) = delete;
+    FFmpegAudioEncoder& operator=(const FFmpegAudioEncoder&) = delete;
+
+    // Adds the audio stream to `format_context`; call before avformat_write_header().
+    // `codec_name` is "aac", "opus", "mp3", "flac" or "pcm" (case-insensitive).
+    bool Open(AVFormatContext* format_context, const QString& codec_name, int bitrate,
+              int sample_rate, const InputFormat& input);
+    void Close();
+    bool IsOpen() const { return codec_context_ != nullptr; }
+
+    // `timestamp_us` is the capture time of the chunk's last sample,
+    // relative to the start of the recording.
+    bool Encode(const QByteArray& pcm, qint64 timestamp_us);
+
+    // Encodes what is left in the FIFO and drains the encoder; call before
+    // av_write_trailer().
+    bool Flush();
+
+    Stats GetStats() const;
+    void ResetStats();
+
+private:
+    bool EnsureConvertBuffer(int samples);
+    bool WriteSilence(int64_t samples);
+    bool EncodeAvailable(bool flush);
+    bool SendFrame(AVFrame* frame);
+
+    AVFormatContext* format_context_ = nullptr;  // Not owned
+    AVCodecContext* codec_context_ = nullptr;
+    AVStream* stream_ = nullptr;
+    SwrContext* swr_context_ = nullptr;
+    AVAudioFifo* fifo_ = nullptr;
+    AVFrame* frame_ = nullptr;
+    AVPacket* packet_ = nullptr;
+
+    InputFormat input_;
+    int frame_size_ = 1024;
+    bool pad_last_frame_ = true;
+
+    uint8_t** convert_data_ = nullptr;
+    int convert_capacity_ = 0;
+
+    int64_t next_sample_ = -1;       // Timeline position of the FIFO's end, in output samples
+
+    std::atomic<quint64> frames_encoded_{0};
+    std::atomic<quint64> underruns_{0};
+    std::atomic<quint64> samples_dropped_{0};
+    std::atomic<qint64> drift_us_{0};
+    std::atomic<qint64> max_drift_us_{0};
+};
+
+#endif // FFMPEG_AUDIO_ENCODER_H
@@ -170,12 +170,16 @@ bool FFmpegCaptureManager::StartCapture(const QString& devicePath, const QSize&
     return true;
 }
 
-void FFmpegCaptureManager::StopCapture()
+void FFmpegCaptureManager::StopCapture(const std::function<void()>& onThreadStopped)
 {
     {
         QMutexLocker locker(&mutex_);
         
         if (!capture_running_) {
+            locker.unlock();
+            if (onThreadStopped) {
+                onThreadStopped();
+            }
             return;
         }
         
@@ -194,6 +198,11 @@ void FFmpegCaptureManager::StopCapture()
     // The thread must exit before we close FFmpeg resources
     StopCaptureThread();
     
+    // No more packets can be read; let consumers finish with the codec context
+    if (onThreadStopped) {
+        onThreadStopped();
+    }
+    
     // Now safe to close input device after thread has stopped
     {
         QMutexLocker locker(&mutex_);
@@ -259,6 +268,8 @@ bool FFmpegCaptureManager::ReadFrame()
     static constexpr int    kMaxDiscard = 300;
 
     int discarded = 0;
+    QElapsedTimer stageTimer;
+    stageTimer.start();
 
     for (int attempt = 0; attempt <= kMaxDiscard; ++attempt) {
         if (interrupt_requested_ || QThread::currentThread()->isInterruptionRequested()) {
@@ -326,6 +337,11 @@ bool FFmpegCaptureManager::ReadFrame()
         discarded++;
     }
 
+    last_read_duration_us_.store(stageTimer.nsecsElapsed() / 1000, std::memory_order_relaxed);
+    if (discarded > 0) {
+        stale_packets_discarded_.fetch_add(discarded, std::memory_order_relaxed);
+    }
+
     // Log first few successful reads
     static int readCount = 0;
     if (++readCount <= 5) {
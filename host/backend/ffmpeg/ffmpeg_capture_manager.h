@@ -28,6 +28,8 @@
 #include <QSize>
 #include <QMutex>
 #include <QTimer>
+#include <atomic>
+#include <functional>
 #include <memory>
 #include "icapture_frame_reader.h"
 
@@ -70,7 +72,10 @@ public:
 
     // Capture lifecycle
     bool StartCapture(const QString& devicePath, const QSize& resolution, int framerate);
-    void StopCapture();
+    // `onThreadStopped` runs once the capture thread has exited and before the
+    // device (and its codec context) is closed, so consumers of the packets
+    // it submitted can be shut down safely.
+    void StopCapture(const std::function<void()>& onThreadStopped = nullptr);
     bool IsRunning() const { return capture_running_; }
     
     // ICaptureFrameReader interface implementation
@@ -86,6 +91,11 @@ public:
     AVPacket* GetPacket() { return packet_; }
 #endif
     
+    // Reader stage statistics: duration of the last successful ReadFrame()
+    // (including live-edge discards) and total stale packets skipped
+    qint64 GetLastReadDurationUs() const { return last_read_duration_us_.load(std::memory_order_relaxed); }
+    quint64 GetStalePacketsDiscarded() const { return stale_packets_discarded_.load(std::memory_order_relaxed); }
+    
     // Video stream info
     int GetVideoStreamIndex() const { return video_stream_index_; }
     
@@ -144,6 +154,10 @@ private:
     // Performance monitoring (not owned)
     QTimer* performance_timer_;
     
+    // Reader stage statistics (written by the capture thread)
+    std::atomic<qint64> last_read_duration_us_{0};
+    std::atomic<quint64> stale_packets_discarded_{0};
+    
     // Thread safety
     mutable QMutex mutex_;
 };
@@ -0,0 +1,42 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#ifndef FFMPEG_CLOCK_H
+#define FFMPEG_CLOCK_H
+
+#include <QtGlobal>
+#include <chrono>
+
+/**
+ * @brief Monotonic time base shared by the capture, recording and audio paths
+ *
+ * Timestamps taken on different threads are only comparable when they come
+ * from the same clock.  steady_clock never jumps when the wall clock is
+ * adjusted, so it is safe to derive presentation timestamps from it.
+ */
+inline qint64 FFmpegMonotonicTimeUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif // FFMPEG_CLOCK_H
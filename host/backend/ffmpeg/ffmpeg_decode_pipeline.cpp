@@ -0,0 +1,367 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#include "ffmpeg_decode_pipeline.h"
+#include "ffmpeg_frame_processor.h"
+#include "ffmpeg_clock.h"
+
+#include <QDebug>
+#include <QLoggingCategory>
+#include <QThread>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+Q_DECLARE_LOGGING_CATEGORY(log_ffmpeg_backend)
+
+namespace {
+// Workers wake up at least this often to notice Stop()
+constexpr int kWorkerWaitMs = 50;
+}
+
+void FFmpegDecodePipeline::StageTimer::Add(qint64 us)
+{
+    total_us.fetch_add(static_cast<quint64>(qMax<qint64>(0, us)), std::memory_order_relaxed);
+    samples.fetch_add(1, std::memory_order_relaxed);
+    qint64 current = max_us.load(std::memory_order_relaxed);
+    while (us > current && !max_us.compare_exchange_weak(current, us, std::memory_order_relaxed)) {
+    }
+}
+
+void FFmpegDecodePipeline::StageTimer::Reset()
+{
+    total_us.store(0, std::memory_order_relaxed);
+    samples.store(0, std::memory_order_relaxed);
+    max_us.store(0, std::memory_order_relaxed);
+}
+
+double FFmpegDecodePipeline::StageTimer::AverageMs() const
+{
+    const quint64 count = samples.load(std::memory_order_relaxed);
+    return count > 0 ? total_us.load(std::memory_order_relaxed) / 1000.0 / count : 0.0;
+}
+
+FFmpegDecodePipeline::FFmpegDecodePipeline(FFmpegFrameProcessor* processor)
+    : processor_(processor)
+    , ring_(kDefaultRingCapacity)
+    , free_packets_(kDefaultRingCapacity * 2)
+{
+    clock_.start();
+}
+
+FFmpegDecodePipeline::~FFmpegDecodePipeline()
+{
+    Stop();
+
+    AVPacket* shell = nullptr;
+    while (free_packets_.TryPop(shell)) {
+        av_packet_free(&shell);
+    }
+}
+
+int FFmpegDecodePipeline::ResolveWorkerCount(int requested)
+{
+    if (requested > 0) {
+        return qBound(1, requested, kMaxWorkers);
+    }
+    // Auto: leave half the cores for the reader, GUI and encoder threads
+    return qBound(1, QThread::idealThreadCount() / 2, 4);
+}
+
+bool FFmpegDecodePipeline::Start(int worker_count, DeliverCallback callback)
+{
+    if (!processor_) {
+        return false;
+    }
+    if (IsRunning()) {
+        Stop();
+    }
+
+    callback_ = std::move(callback);
+    next_sequence_ = 0;
+    // A packet submitted while the previous session was stopping still
+    // points at that session's codec context
+    DrainQueues();
+    {
+        QMutexLocker locker(&reorder_mutex_);
+        next_delivery_ = 1;
+    }
+    available_.tryAcquire(available_.available());
+    ResetStats();
+
+    const int count = ResolveWorkerCount(worker_count);
+    running_.store(true, std::memory_order_release);
+    for (int i = 0; i < count; ++i) {
+        QThread* worker = QThread::create([this]() { WorkerLoop(); });
+        worker->setObjectName(QStringLiteral("FFmpegDecodeWorker-%1").arg(i));
+        worker->start(QThread::HighPriority);
+        workers_.push_back(worker);
+    }
+    worker_count_.store(count, std::memory_order_relaxed);
+
+    qCDebug(log_ffmpeg_backend) << "Decode pipeline started with" << count << "worker(s), ring capacity"
+                                << ring_.Capacity();
+    return true;
+}
+
+void FFmpegDecodePipeline::Stop()
+{
+    if (!running_.exchange(false, std::memory_order_acq_rel) && workers_.empty()) {
+        return;
+    }
+
+    available_.release(static_cast<int>(workers_.size()));
+    for (QThread* worker : workers_) {
+        worker->wait();
+        delete worker;
+    }
+    workers_.clear();
+
+    worker_count_.store(0, std::memory_order_relaxed);
+    DrainQueues();
+
+    qCDebug(log_ffmpeg_backend) << "Decode pipeline stopped - delivered" << delivered_.load()
+                                << "dropped" << ring_drops_.load();
+}
+
+void FFmpegDecodePipeline::DrainQueues()
+{
+    QueuedPacket item;
+    while (ring_.TryPop(item)) {
+        RecyclePacketShell(item.packet);
+    }
+
+    QMutexLocker locker(&reorder_mutex_);
+    pending_.clear();
+}
+
+AVPacket* FFmpegDecodePipeline::AcquirePacketShell()
+{
+    AVPacket* shell = nullptr;
+    if (free_packets_.TryPop(shell)) {
+        return shell;
+    }
+    return av_packet_alloc();
+}
+
+void FFmpegDecodePipeline::RecyclePacketShell(AVPacket* packet)
+{
+    if (!packet) {
+        return;
+    }
+    av_packet_unref(packet);
+    if (!free_packets_.TryPush(packet)) {
+        av_packet_free(&packet);
+    }
+}
+
+bool FFmpegDecodePipeline::Submit(AVPacket* packet, AVCodecContext* codec_context,
+                                  const QSize& target_size, qint64 read_us, const QRectF& region)
+{
+    if (!IsRunning() || !packet || !codec_context || packet->size <= 0) {
+        return false;
+    }
+
+    AVPacket* shell = AcquirePacketShell();
+    if (!shell) {
+        return false;
+    }
+    av_packet_move_ref(shell, packet);
+
+    parallel_decode_.store(processor_->SupportsParallelDecode(codec_context), std::memory_order_relaxed);
+
+    QueuedPacket item;
+    item.packet = shell;
+    item.codec_context = codec_context;
+    item.target_size = target_size;
+    item.region = region;
+    item.sequence = ++next_sequence_;
+    item.capture_us = FFmpegMonotonicTimeUs();
+    item.read_us = read_us;
+    item.enqueue_ns = clock_.nsecsElapsed();
+
+    read_timer_.Add(read_us);
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+
+    while (!ring_.TryPush(item)) {
+        // Ring full: the decoders are behind.  Drop the oldest packet so the
+        // newest frame is never the one that waits.
+        QueuedPacket oldest;
+        if (ring_.TryPop(oldest)) {
+            available_.tryAcquire();
+            ring_drops_.fetch_add(1, std::memory_order_relaxed);
+            RecyclePacketShell(oldest.packet);
+            FrameTiming skipped;
+            skipped.sequence = oldest.sequence;
+            Complete(oldest.sequence, QImage(), skipped);
+        }
+    }
+    available_.release();
+    return true;
+}
+
+void FFmpegDecodePipeline::WorkerLoop()
+{
+    while (running_.load(std::memory_order_acquire)) {
+        if (!available_.tryAcquire(1, kWorkerWaitMs)) {
+            continue;
+        }
+
+        // Codecs that keep state between packets must see them in order, so
+        // pop and decode under one lock; intra-only MJPEG decodes in parallel.
+        const bool serialize = !parallel_decode_.load(std::memory_order_relaxed);
+        if (serialize) {
+            serial_decode_mutex_.lock();
+        }
+
+        QueuedPacket item;
+        if (ring_.TryPop(item)) {
+            DecodeOne(item);
+        }
+
+        if (serialize) {
+            serial_decode_mutex_.unlock();
+        }
+    }
+}
+
+void FFmpegDecodePipeline::DecodeOne(QueuedPacket& item)
+{
+    const qint64 start_ns = clock_.nsecsElapsed();
+
+    FrameTiming timing;
+    timing.sequence = item.sequence;
+    timing.capture_us = item.capture_us;
+    timing.read_us = item.read_us;
+    timing.queue_us = (start_ns - item.enqueue_ns) / 1000;
+    queue_timer_.Add(timing.queue_us);
+
+    QImage image;
+    if (running_.load(std::memory_order_acquire)) {
+        image = processor_->DecodePacketToImage(item.packet, item.codec_context,
+                                                item.target_size, item.sequence, item.region);
+    }
+    RecyclePacketShell(item.packet);
+    item.packet = nullptr;
+
+    timing.decode_us = (clock_.nsecsElapsed() - start_ns) / 1000;
+    decode_timer_.Add(timing.decode_us);
+
+    if (image.isNull()) {
+        decode_failures_.fetch_add(1, std::memory_order_relaxed);
+    }
+    Complete(item.sequence, image, timing);
+}
+
+void FFmpegDecodePipeline::Complete(quint64 sequence, const QImage& image, const FrameTiming& timing)
+{
+    {
+        QMutexLocker locker(&reorder_mutex_);
+        if (sequence < next_delivery_) {
+            // Arrived after the reorder stage already gave up on it
+            return;
+        }
+        PendingFrame& slot = pending_[sequence];
+        slot.image = image;
+        slot.timing = timing;
+        slot.ready_ns = clock_.nsecsElapsed();
+    }
+
+    // One deliverer at a time keeps frames in order; the callback (display and
+    // recorder hand-off) runs outside reorder_mutex_ so GetStats() never waits on it
+    QMutexLocker deliverLocker(&deliver_mutex_);
+
+    std::vector<PendingFrame> ready;
+    {
+        QMutexLocker locker(&reorder_mutex_);
+        for (;;) {
+            auto it = pending_.find(next_delivery_);
+            if (it == pending_.end()) {
+                if (static_cast<int>(pending_.size()) <= kMaxReorderFrames) {
+                    break;
+                }
+                // A sequence went missing; skip ahead rather than stall the display
+                const quint64 first = pending_.begin()->first;
+                reorder_skips_.fetch_add(first - next_delivery_, std::memory_order_relaxed);
+                next_delivery_ = first;
+                continue;
+            }
+
+            PendingFrame frame = std::move(it->second);
+            pending_.erase(it);
+            ++next_delivery_;
+
+            if (frame.image.isNull() || !callback_) {
+                continue;  // Dropped or failed packet: just a placeholder for ordering
+            }
+            ready.push_back(std::move(frame));
+        }
+    }
+
+    for (PendingFrame& frame : ready) {
+        const qint64 deliver_start_ns = clock_.nsecsElapsed();
+        frame.timing.reorder_us = (deliver_start_ns - frame.ready_ns) / 1000;
+        callback_(frame.image, frame.timing);
+        deliver_timer_.Add((clock_.nsecsElapsed() - deliver_start_ns) / 1000);
+        delivered_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+FFmpegDecodePipeline::Stats FFmpegDecodePipeline::GetStats() const
+{
+    Stats stats;
+    stats.workers = worker_count_.load(std::memory_order_relaxed);
+    stats.ring_depth = static_cast<int>(ring_.Size());
+    stats.ring_capacity = static_cast<int>(ring_.Capacity());
+    {
+        QMutexLocker locker(&reorder_mutex_);
+        stats.reorder_depth = static_cast<int>(pending_.size());
+    }
+    stats.submitted = submitted_.load(std::memory_order_relaxed);
+    stats.delivered = delivered_.load(std::memory_order_relaxed);
+    stats.ring_drops = ring_drops_.load(std::memory_order_relaxed);
+    stats.decode_failures = decode_failures_.load(std::memory_order_relaxed);
+    stats.reorder_skips = reorder_skips_.load(std::memory_order_relaxed);
+    stats.avg_read_ms = read_timer_.AverageMs();
+    stats.max_read_ms = read_timer_.MaxMs();
+    stats.avg_queue_ms = queue_timer_.AverageMs();
+    stats.max_queue_ms = queue_timer_.MaxMs();
+    stats.avg_decode_ms = decode_timer_.AverageMs();
+    stats.max_decode_ms = decode_timer_.MaxMs();
+    stats.avg_deliver_ms = deliver_timer_.AverageMs();
+    stats.max_deliver_ms = deliver_timer_.MaxMs();
+    return stats;
+}
+
+void FFmpegDecodePipeline::ResetStats()
+{
+    submitted_.store(0, std::memory_order_relaxed);
+    delivered_.store(0, std::memory_order_relaxed);
+    ring_drops_.store(0, std::memory_order_relaxed);
+    decode_failures_.store(0, std::memory_order_relaxed);
+    reorder_skips_.store(0, std::memory_order_relaxed);
+    read_timer_.Reset();
+    queue_timer_.Reset();
+    decode_timer_.Reset();
+    deliver_timer_.Reset();
+}
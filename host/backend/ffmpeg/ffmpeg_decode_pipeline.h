@@ -0,0 +1,195 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#ifndef FFMPEG_DECODE_PIPELINE_H
+#define FFMPEG_DECODE_PIPELINE_H
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QMutex>
+#include <QRectF>
+#include <QSemaphore>
+#include <QSize>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <vector>
+#include "ffmpeg_packet_ring.h"
+
+class QThread;
+class FFmpegFrameProcessor;
+struct AVPacket;
+struct AVCodecContext;
+
+/**
+ * @brief Decode stage of the FFmpeg capture pipeline
+ *
+ * The capture thread only reads packets (reader stage) and hands them to
+ * Submit(), which moves the packet payload into a bounded lock-free ring.
+ * A pool of decoder workers pops packets and decodes them through
+ * FFmpegFrameProcessor; a reorder stage then delivers the decoded frames to
+ * the callback strictly in capture order, so a slow JPEG never lets a newer
+ * frame overtake it on screen or in a recording.
+ *
+ * When the ring is full the oldest queued packet is dropped to stay on the
+ * live edge.  Codecs that cannot be decoded concurrently (hardware decoders,
+ * libavcodec fallback) are decoded one packet at a time in submission order.
+ *
+ * Every stage reports its queue depth and timing through GetStats().
+ */
+class FFmpegDecodePipeline {
+public:
+    // Per-frame timing handed to the delivery callback
+    struct FrameTiming {
+        quint64 sequence = 0;
+        qint64 capture_us = 0;   // FFmpegMonotonicTimeUs() when the packet was read
+        qint64 read_us = 0;      // Reader stage: av_read_frame incl. live-edge discards
+        qint64 queue_us = 0;     // Time the packet waited in the ring
+        qint64 decode_us = 0;    // Decoder worker time
+        qint64 reorder_us = 0;   // Time the decoded frame waited for earlier frames
+    };
+
+    struct Stats {
+        int workers = 0;
+        int ring_depth = 0;          // Packets waiting for a decoder
+        int ring_capacity = 0;
+        int reorder_depth = 0;       // Decoded frames waiting for an earlier sequence
+        quint64 submitted = 0;
+        quint64 delivered = 0;
+        quint64 ring_drops = 0;      // Oldest packets dropped because the ring was full
+        quint64 decode_failures = 0;
+        quint64 reorder_skips = 0;   // Sequences given up on by the reorder stage
+        double avg_read_ms = 0.0;
+        double max_read_ms = 0.0;
+        double avg_queue_ms = 0.0;
+        double max_queue_ms = 0.0;
+        double avg_decode_ms = 0.0;
+        double max_decode_ms = 0.0;
+        double avg_deliver_ms = 0.0;
+        double max_deliver_ms = 0.0;
+    };
+
+    using DeliverCallback = std::function<void(const QImage& image, const FrameTiming& timing)>;
+
+    static constexpr int kDefaultRingCapacity = 8;
+    static constexpr int kMaxWorkers = 8;
+    static constexpr int kMaxReorderFrames = 8;
+
+    explicit FFmpegDecodePipeline(FFmpegFrameProcessor* processor);
+    ~FFmpegDecodePipeline();
+
+    FFmpegDecodePipeline(const FFmpegDecodePipeline&) = delete;
+    FFmpegDecodePipeline& operator=(const FFmpegDecodePipeline&) = delete;
+
+    // Starts `worker_count` decoder threads (0 = pick from CPU count).
+    bool Start(int worker_count, DeliverCallback callback);
+
+    // Joins the workers and releases every queued packet.  Must be called
+    // before the codec context passed to Submit() is freed.
+    void Stop();
+
+    bool IsRunning() const { return running_.load(std::memory_order_acquire); }
+
+    // Reader stage entry point.  Takes over the payload of `packet` (the
+    // caller's packet is left blank and can be reused for the next read).
+    // `region` is forwarded to FFmpegFrameProcessor::DecodePacketToImage().
+    bool Submit(AVPacket* packet, AVCodecContext* codec_context,
+                const QSize& target_size, qint64 read_us, const QRectF& region = QRectF());
+
+    Stats GetStats() const;
+    void ResetStats();
+
+    // Worker count used for `requested` (0 = auto)
+    static int ResolveWorkerCount(int requested);
+
+private:
+    struct QueuedPacket {
+        AVPacket* packet = nullptr;
+        AVCodecContext* codec_context = nullptr;
+        QSize target_size;
+        QRectF region;
+        quint64 sequence = 0;
+        qint64 capture_us = 0;
+        qint64 read_us = 0;
+        qint64 enqueue_ns = 0;
+    };
+
+    struct PendingFrame {
+        QImage image;
+        FrameTiming timing;
+        qint64 ready_ns = 0;
+    };
+
+    // Lock-free running sum/max for one stage
+    struct StageTimer {
+        std::atomic<quint64> total_us{0};
+        std::atomic<quint64> samples{0};
+        std::atomic<qint64> max_us{0};
+
+        void Add(qint64 us);
+        void Reset();
+        double AverageMs() const;
+        double MaxMs() const { return max_us.load(std::memory_order_relaxed) / 1000.0; }
+    };
+
+    void WorkerLoop();
+    void DecodeOne(QueuedPacket& item);
+    void Complete(quint64 sequence, const QImage& image, const FrameTiming& timing);
+    AVPacket* AcquirePacketShell();
+    void RecyclePacketShell(AVPacket* packet);
+    void DrainQueues();
+
+    FFmpegFrameProcessor* processor_;  // Not owned
+    DeliverCallback callback_;
+    QElapsedTimer clock_;              // Monotonic time base for stage timing
+
+    std::vector<QThread*> workers_;
+    std::atomic<int> worker_count_{0};
+    std::atomic<bool> running_{false};
+    std::atomic<bool> parallel_decode_{false};
+
+    // Reader -> decoder hand-off
+    FFmpegPacketRing<QueuedPacket> ring_;
+    FFmpegPacketRing<AVPacket*> free_packets_;  // Recycled AVPacket shells
+    QSemaphore available_;
+    QMutex serial_decode_mutex_;                // Keeps pop+decode ordered for non-parallel codecs
+    quint64 next_sequence_ = 0;                 // Reader thread only
+
+    // Decoder -> delivery reorder stage
+    mutable QMutex reorder_mutex_;
+    std::map<quint64, PendingFrame> pending_;
+    quint64 next_delivery_ = 1;
+    QMutex deliver_mutex_;                      // Serialises callback_ so delivery stays in order
+
+    // Statistics
+    std::atomic<quint64> submitted_{0};
+    std::atomic<quint64> delivered_{0};
+    std::atomic<quint64> ring_drops_{0};
+    std::atomic<quint64> decode_failures_{0};
+    std::atomic<quint64> reorder_skips_{0};
+    StageTimer read_timer_;
+    StageTimer queue_timer_;
+    StageTimer decode_timer_;
+    StageTimer deliver_timer_;
+};
+
+#endif // FFMPEG_DECODE_PIPELINE_H
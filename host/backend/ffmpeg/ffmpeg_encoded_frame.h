@@ -0,0 +1,46 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#ifndef FFMPEG_ENCODED_FRAME_H
+#define FFMPEG_ENCODED_FRAME_H
+
+#include <QByteArray>
+#include <QSize>
+
+/**
+ * @brief Compressed frame exactly as delivered by the capture card
+ *
+ * For MJPEG sources `data` is a complete, standalone JPEG file (Huffman
+ * tables are inserted when the camera omits them), so it can be written to
+ * disk or sent to a client without a decode/encode round trip.  `frame_id`
+ * matches the decoded frame returned by GetLatestOriginalFrame() at the
+ * time it was stored.
+ */
+struct EncodedFrame {
+    QByteArray data;
+    QSize size;            // Native frame size from the JPEG header
+    quint64 frame_id = 0;
+
+    bool isNull() const { return data.isEmpty(); }
+};
+
+#endif // FFMPEG_ENCODED_FRAME_H
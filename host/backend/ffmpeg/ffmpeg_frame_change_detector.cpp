@@ -0,0 +1,265 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#include "ffmpeg_frame_change_detector.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OPF_TILE_HASH_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define OPF_TILE_HASH_NEON 1
+#endif
+
+namespace {
+
+constexpr quint64 kPrime64 = 0x9E3779B185EBCA87ULL;
+constexpr quint32 kPrime32 = 0x9E3779B1U;
+
+// 256 bytes of per-column keys: one tile row of 64 ARGB pixels.  Keys make the
+// hash position-dependent, and the per-row scramble makes row order matter,
+// so scrolling content inside a tile is detected.
+constexpr int kKeyBytes = 256;
+
+struct TileKeys {
+    alignas(16) quint64 words[kKeyBytes / 8];
+
+    TileKeys()
+    {
+        quint64 state = 0x243F6A8885A308D3ULL;  // splitmix64
+        for (quint64& word : words) {
+            quint64 z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            word = z ^ (z >> 31);
+        }
+    }
+};
+
+const TileKeys& Keys()
+{
+    static const TileKeys keys;
+    return keys;
+}
+
+inline quint64 Mix64(quint64 h)
+{
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+} // namespace
+
+quint64 FFmpegFrameChangeDetector::HashTile(const uchar* data, qsizetype stride, int byte_width, int rows) const
+{
+    const TileKeys& keys = Keys();
+    const int chunks = byte_width / 16;
+    const int tail = byte_width - chunks * 16;
+    quint64 tail_hash = 0;
+
+#if defined(OPF_TILE_HASH_SSE2)
+    const auto* key_vecs = reinterpret_cast<const __m128i*>(keys.words);
+    const __m128i prime = _mm_set1_epi32(static_cast<int>(kPrime32));
+    __m128i acc = _mm_set_epi64x(static_cast<long long>(kPrime64), static_cast<long long>(~kPrime64));
+
+    for (int y = 0; y < rows; ++y) {
+        const uchar* row = data + y * stride;
+        for (int i = 0; i < chunks; ++i) {
+            const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i * 16));
+            const __m128i keyed = _mm_xor_si128(value, _mm_load_si128(key_vecs + (i % (kKeyBytes / 16))));
+            const __m128i product = _mm_mul_epu32(keyed, _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+            const __m128i swapped = _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+            acc = _mm_add_epi64(acc, _mm_add_epi64(product, swapped));
+        }
+        // Scramble once per row so identical rows at different heights differ
+        acc = _mm_xor_si128(acc, _mm_srli_epi64(acc, 47));
+        acc = _mm_xor_si128(acc, _mm_load_si128(key_vecs + (y % (kKeyBytes / 16))));
+        const __m128i lo = _mm_mul_epu32(acc, prime);
+        const __m128i hi = _mm_mul_epu32(_mm_srli_epi64(acc, 32), prime);
+        acc = _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+
+        for (int i = 0; i < tail; ++i) {
+            tail_hash = (tail_hash ^ row[chunks * 16 + i]) * kPrime64;
+        }
+    }
+
+    alignas(16) quint64 lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+#elif defined(OPF_TILE_HASH_NEON)
+    const auto* key_words = reinterpret_cast<const uint64_t*>(keys.words);
+    uint64x2_t acc = vcombine_u64(vcreate_u64(~kPrime64), vcreate_u64(kPrime64));
+
+    for (int y = 0; y < rows; ++y) {
+        const uchar* row = data + y * stride;
+        for (int i = 0; i < chunks; ++i) {
+            const uint64x2_t value = vreinterpretq_u64_u8(vld1q_u8(row + i * 16));
+            const uint64x2_t keyed = veorq_u64(value, vld1q_u64(key_words + 2 * (i % (kKeyBytes / 16))));
+            const uint64x2_t product = vmull_u32(vmovn_u64(keyed), vshrn_n_u64(keyed, 32));
+            const uint64x2_t swapped = vextq_u64(value, value, 1);
+            acc = vaddq_u64(acc, vaddq_u64(product, swapped));
+        }
+        acc = veorq_u64(acc, vshrq_n_u64(acc, 47));
+        acc = veorq_u64(acc, vld1q_u64(key_words + 2 * (y % (kKeyBytes / 16))));
+        const uint32x2_t prime = vdup_n_u32(kPrime32);
+        const uint64x2_t lo = vmull_u32(vmovn_u64(acc), prime);
+        const uint64x2_t hi = vmull_u32(vshrn_n_u64(acc, 32), prime);
+        acc = vaddq_u64(lo, vshlq_n_u64(hi, 32));
+
+        for (int i = 0; i < tail; ++i) {
+            tail_hash = (tail_hash ^ row[chunks * 16 + i]) * kPrime64;
+        }
+    }
+
+    quint64 lanes[2] = { vgetq_lane_u64(acc, 0), vgetq_lane_u64(acc, 1) };
+#else
+    quint64 lanes[2] = { ~kPrime64, kPrime64 };
+
+    for (int y = 0; y < rows; ++y) {
+        const uchar* row = data + y * stride;
+        for (int i = 0; i < chunks * 2; ++i) {
+            quint64 value;
+            std::memcpy(&value, row + i * 8, sizeof(value));
+            const quint64 keyed = value ^ keys.words[i % (kKeyBytes / 8)];
+            lanes[i & 1] += (keyed & 0xFFFFFFFFULL) * (keyed >> 32) + ((value << 32) | (value >> 32));
+        }
+        for (int lane = 0; lane < 2; ++lane) {
+            quint64 a = lanes[lane];
+            a ^= a >> 47;
+            a ^= keys.words[(2 * y + lane) % (kKeyBytes / 8)];
+            lanes[lane] = (a & 0xFFFFFFFFULL) * kPrime32 + (((a >> 32) * kPrime32) << 32);
+        }
+
+        for (int i = 0; i < tail; ++i) {
+            tail_hash = (tail_hash ^ row[chunks * 16 + i]) * kPrime64;
+        }
+    }
+#endif
+
+    return Mix64(lanes[0] ^ Mix64(lanes[1] + tail_hash));
+}
+
+void FFmpegFrameChangeDetector::Reset()
+{
+    tile_hashes_.clear();
+    frame_size_ = QSize();
+    frame_format_ = QImage::Format_Invalid;
+    tiles_x_ = 0;
+    tiles_y_ = 0;
+    frames_since_full_ = 0;
+}
+
+bool FFmpegFrameChangeDetector::Detect(const QImage& image, QList<QRect>* dirty_rects)
+{
+    if (dirty_rects) {
+        dirty_rects->clear();
+    }
+    if (image.isNull()) {
+        return false;
+    }
+
+    const int bytes_per_pixel = image.depth() / 8;
+    const bool geometry_changed = image.size() != frame_size_ || image.format() != frame_format_;
+    const bool force_full = geometry_changed || bytes_per_pixel < 1 ||
+                            ++frames_since_full_ >= kForceFullRefreshFrames;
+
+    if (geometry_changed) {
+        frame_size_ = image.size();
+        frame_format_ = image.format();
+        tiles_x_ = (frame_size_.width() + kTileSize - 1) / kTileSize;
+        tiles_y_ = (frame_size_.height() + kTileSize - 1) / kTileSize;
+        tile_hashes_.assign(static_cast<size_t>(tiles_x_) * tiles_y_, 0);
+    }
+
+    const uchar* bits = image.constBits();
+    const qsizetype stride = image.bytesPerLine();
+
+    // Spans of dirty tiles on the previous tile row, extended downwards while
+    // the next row has a span with exactly the same columns.
+    QList<QRect> open_rects;
+    QList<QRect> result;
+
+    for (int ty = 0; ty < tiles_y_; ++ty) {
+        const int y = ty * kTileSize;
+        const int rows = qMin(kTileSize, frame_size_.height() - y);
+        QList<QRect> row_spans;
+        int span_start = -1;
+
+        for (int tx = 0; tx <= tiles_x_; ++tx) {
+            bool dirty = false;
+            if (tx < tiles_x_) {
+                const int x = tx * kTileSize;
+                const int width = qMin(kTileSize, frame_size_.width() - x);
+                quint64& stored = tile_hashes_[static_cast<size_t>(ty) * tiles_x_ + tx];
+                const quint64 hash = bytes_per_pixel >= 1
+                    ? HashTile(bits + y * stride + x * bytes_per_pixel, stride, width * bytes_per_pixel, rows)
+                    : 0;
+                dirty = force_full || hash != stored;
+                stored = hash;
+            }
+
+            if (dirty && span_start < 0) {
+                span_start = tx;
+            } else if (!dirty && span_start >= 0) {
+                const int x = span_start * kTileSize;
+                const int right = qMin(tx * kTileSize, frame_size_.width());
+                row_spans.append(QRect(x, y, right - x, rows));
+                span_start = -1;
+            }
+        }
+
+        QList<QRect> next_open;
+        for (const QRect& span : row_spans) {
+            bool merged = false;
+            for (int i = 0; i < open_rects.size(); ++i) {
+                const QRect& open = open_rects[i];
+                if (open.left() == span.left() && open.width() == span.width()) {
+                    next_open.append(QRect(open.left(), open.top(), open.width(), open.height() + span.height()));
+                    open_rects.removeAt(i);
+                    merged = true;
+                    break;
+                }
+            }
+            if (!merged) {
+                next_open.append(span);
+            }
+        }
+        result.append(open_rects);  // Spans that did not continue are complete
+        open_rects = next_open;
+    }
+    result.append(open_rects);
+
+    if (force_full) {
+        frames_since_full_ = 0;
+        result = { QRect(QPoint(0, 0), frame_size_) };
+    }
+
+    if (dirty_rects) {
+        *dirty_rects = result;
+    }
+    return !result.isEmpty();
+}
@@ -0,0 +1,71 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#ifndef FFMPEG_FRAME_CHANGE_DETECTOR_H
+#define FFMPEG_FRAME_CHANGE_DETECTOR_H
+
+#include <QImage>
+#include <QList>
+#include <QRect>
+#include <vector>
+
+/**
+ * @brief Tile-hash change detection between consecutive display frames
+ *
+ * The frame is split into fixed-size tiles and each tile is hashed (SSE2 or
+ * NEON when available, scalar otherwise).  Comparing against the hashes of
+ * the previous frame yields the list of changed tiles, merged into row spans.
+ * A KVM target usually shows a static BIOS or terminal screen, so most
+ * frames turn out identical and never need to reach the GUI thread.
+ *
+ * Not thread-safe: call from the (single) delivery stage only.
+ */
+class FFmpegFrameChangeDetector {
+public:
+    static constexpr int kTileSize = 64;
+
+    // A full refresh is forced this often so a hash collision can never leave
+    // a stale tile on screen indefinitely.
+    static constexpr int kForceFullRefreshFrames = 300;
+
+    FFmpegFrameChangeDetector() = default;
+
+    // Compares `image` with the previous frame passed in.  Returns false when
+    // the frame is identical; otherwise fills `dirty_rects` with the changed
+    // areas (a single full-frame rect after a size/format change).
+    bool Detect(const QImage& image, QList<QRect>* dirty_rects);
+
+    // Forget the previous frame; the next Detect() reports a full change.
+    void Reset();
+
+private:
+    quint64 HashTile(const uchar* data, qsizetype stride, int byte_width, int rows) const;
+
+    std::vector<quint64> tile_hashes_;
+    QSize frame_size_;
+    QImage::Format frame_format_ = QImage::Format_Invalid;
+    int tiles_x_ = 0;
+    int tiles_y_ = 0;
+    int frames_since_full_ = 0;
+};
+
+#endif // FFMPEG_FRAME_CHANGE_DETECTOR_H
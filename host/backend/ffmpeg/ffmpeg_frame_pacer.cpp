@@ -0,0 +1,238 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#include "ffmpeg_frame_pacer.h"
+#include "ffmpeg_clock.h"
+
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(log_ffmpeg_backend)
+
+namespace {
+
+constexpr double kScaleForStep[] = { 1.0, 0.75, 0.5 };
+
+// Decoder load above which decoding is the bottleneck, and below which
+// there is room to decode more
+constexpr double kDecoderBusyLoad = 0.85;
+constexpr double kDecoderIdleLoad = 0.6;
+
+// Share of the frames reaching the GUI that must actually be painted
+constexpr double kMinPaintRatio = 0.8;
+constexpr double kIdlePaintRatio = 0.95;
+
+} // namespace
+
+FFmpegFramePacer::FFmpegFramePacer()
+{
+    last_update_us_ = FFmpegMonotonicTimeUs();
+}
+
+const char* FFmpegFramePacer::StateName(State state)
+{
+    switch (state) {
+    case State::Steady: return "steady";
+    case State::BackingOff: return "backing off";
+    case State::RampingUp: return "ramping up";
+    case State::Hidden: return "hidden";
+    }
+    return "unknown";
+}
+
+bool FFmpegFramePacer::AdmitPacket(bool is_recording)
+{
+    const qint64 now = FFmpegMonotonicTimeUs();
+    qint64 interval = interval_us_.load(std::memory_order_relaxed);
+    if (is_recording) {
+        interval = qMin(interval, recording_interval_us_.load(std::memory_order_relaxed));
+    }
+
+    if (last_admit_us_ > 0 && now - last_admit_us_ < interval) {
+        paced_drops_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    last_admit_us_ = now;
+    admitted_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+double FFmpegFramePacer::GetDecodeScale() const
+{
+    return kScaleForStep[scale_step_.load(std::memory_order_relaxed)];
+}
+
+void FFmpegFramePacer::OnFrameDecoded(qint64 decode_us)
+{
+    decode_total_us_.fetch_add(static_cast<quint64>(qMax<qint64>(0, decode_us)), std::memory_order_relaxed);
+    decode_samples_.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool FFmpegFramePacer::TryQueueFrame()
+{
+    if (frames_in_flight_.fetch_add(1, std::memory_order_acq_rel) < kMaxFramesInFlight) {
+        return true;
+    }
+    frames_in_flight_.fetch_sub(1, std::memory_order_release);
+    gate_drops_.fetch_add(1, std::memory_order_relaxed);
+    step_gate_drops_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void FFmpegFramePacer::CancelQueuedFrame()
+{
+    frames_in_flight_.fetch_sub(1, std::memory_order_release);
+}
+
+void FFmpegFramePacer::OnFrameConsumed()
+{
+    frames_in_flight_.fetch_sub(1, std::memory_order_release);
+    consumed_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FFmpegFramePacer::OnFramePainted()
+{
+    painted_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FFmpegFramePacer::ResetQueue()
+{
+    frames_in_flight_.store(0, std::memory_order_release);
+}
+
+void FFmpegFramePacer::SetRecordingFrameRate(int fps)
+{
+    recording_interval_us_.store(fps > 0 ? 1000000 / fps : 33333, std::memory_order_relaxed);
+}
+
+void FFmpegFramePacer::Update(const Inputs& inputs)
+{
+    const qint64 now = FFmpegMonotonicTimeUs();
+    const qint64 elapsed_us = now - last_update_us_;
+    if (elapsed_us <= 0) {
+        return;
+    }
+    last_update_us_ = now;
+
+    const quint64 admitted = admitted_.exchange(0, std::memory_order_relaxed);
+    const quint64 consumed = consumed_.exchange(0, std::memory_order_relaxed);
+    const quint64 painted = painted_.exchange(0, std::memory_order_relaxed);
+    const quint64 decode_total_us = decode_total_us_.exchange(0, std::memory_order_relaxed);
+    const quint64 decode_samples = decode_samples_.exchange(0, std::memory_order_relaxed);
+    const quint64 gate_drops = step_gate_drops_.exchange(0, std::memory_order_relaxed);
+
+    const double admitted_fps = admitted * 1e6 / elapsed_us;
+    const double avg_decode_us = decode_samples > 0 ? static_cast<double>(decode_total_us) / decode_samples : 0.0;
+    const double decoder_load = avg_decode_us * admitted_fps / (qMax(1, inputs.decoder_workers) * 1e6);
+    paint_fps_.store(painted * 1e6 / elapsed_us, std::memory_order_relaxed);
+    admitted_fps_.store(admitted_fps, std::memory_order_relaxed);
+    avg_decode_ms_.store(avg_decode_us / 1000.0, std::memory_order_relaxed);
+    decoder_load_.store(decoder_load, std::memory_order_relaxed);
+
+    // Decoding faster than the source only burns CPU; stay slightly below
+    // its interval so capture jitter does not cost frames
+    qint64 floor_us = kMinIntervalUs;
+    if (inputs.source_fps > 0.0) {
+        floor_us = qMax(floor_us, static_cast<qint64>(0.9e6 / inputs.source_fps));
+    }
+
+    const qint64 interval = interval_us_.load(std::memory_order_relaxed);
+    const int scale_step = scale_step_.load(std::memory_order_relaxed);
+    qint64 new_interval = qMax(interval, floor_us);
+    int new_scale_step = scale_step;
+    State state;
+
+    if (!inputs.display_visible) {
+        if (interval != kHiddenIntervalUs) {
+            visible_interval_us_ = interval;
+        }
+        new_interval = kHiddenIntervalUs;
+        headroom_steps_ = 0;
+        state = State::Hidden;
+    } else {
+        if (interval == kHiddenIntervalUs) {
+            new_interval = qMax(visible_interval_us_, floor_us);  // Shown again
+        }
+
+        const bool decoder_busy = decoder_load > kDecoderBusyLoad;
+        // Several frames handed over per paint: the GUI cannot keep up
+        const bool paints_coalesced = inputs.paint_feedback && consumed >= 4 &&
+                                      painted < kMinPaintRatio * consumed;
+        const bool gui_lagging = gate_drops > 0 || paints_coalesced;
+        const bool queue_building = inputs.ring_depth > 1;
+
+        if (decoder_busy || gui_lagging || queue_building) {
+            if (decoder_busy && !gui_lagging && scale_step < kScaleSteps - 1) {
+                ++new_scale_step;  // Cheaper decodes keep the frame rate
+            } else {
+                new_interval = qMin(kMaxIntervalUs, qMax(new_interval + 1000, new_interval * 5 / 4));
+            }
+            headroom_steps_ = 0;
+            state = State::BackingOff;
+        } else if (decoder_load < kDecoderIdleLoad && inputs.ring_depth == 0 &&
+                   (!inputs.paint_feedback || painted >= kIdlePaintRatio * consumed)) {
+            state = State::Steady;
+            if (++headroom_steps_ >= kRampUpSteps) {
+                // Frame rate first; resolution once the source rate is reached
+                if (new_interval > floor_us) {
+                    new_interval = qMax(floor_us, new_interval * 17 / 20);
+                    state = State::RampingUp;
+                } else if (new_scale_step > 0) {
+                    --new_scale_step;
+                    state = State::RampingUp;
+                }
+                headroom_steps_ = 0;
+            }
+        } else {
+            headroom_steps_ = 0;
+            state = State::Steady;
+        }
+    }
+
+    if (new_interval != interval || new_scale_step != scale_step) {
+        adjustments_.fetch_add(1, std::memory_order_relaxed);
+        qCDebug(log_ffmpeg_backend) << "Frame pacing" << StateName(state)
+                                    << "- target fps:" << QString::number(1e6 / new_interval, 'f', 1)
+                                    << "decode scale:" << kScaleForStep[new_scale_step]
+                                    << "decoder load:" << QString::number(decoder_load, 'f', 2)
+                                    << "painted/consumed:" << painted << "/" << consumed;
+    }
+    interval_us_.store(new_interval, std::memory_order_relaxed);
+    scale_step_.store(new_scale_step, std::memory_order_relaxed);
+    state_.store(static_cast<int>(state), std::memory_order_relaxed);
+}
+
+FFmpegFramePacer::Metrics FFmpegFramePacer::GetMetrics() const
+{
+    Metrics metrics;
+    metrics.state = static_cast<State>(state_.load(std::memory_order_relaxed));
+    metrics.target_fps = 1e6 / interval_us_.load(std::memory_order_relaxed);
+    metrics.decode_scale = GetDecodeScale();
+    metrics.paint_fps = paint_fps_.load(std::memory_order_relaxed);
+    metrics.admitted_fps = admitted_fps_.load(std::memory_order_relaxed);
+    metrics.avg_decode_ms = avg_decode_ms_.load(std::memory_order_relaxed);
+    metrics.decoder_load = decoder_load_.load(std::memory_order_relaxed);
+    metrics.frames_in_flight = frames_in_flight_.load(std::memory_order_relaxed);
+    metrics.paced_drops = paced_drops_.load(std::memory_order_relaxed);
+    metrics.gate_drops = gate_drops_.load(std::memory_order_relaxed);
+    metrics.adjustments = adjustments_.load(std::memory_order_relaxed);
+    return metrics;
+}
@@ -0,0 +1,144 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#ifndef FFMPEG_FRAME_PACER_H
+#define FFMPEG_FRAME_PACER_H
+
+#include <QtGlobal>
+#include <atomic>
+
+/**
+ * @brief Closed-loop decode rate and resolution control for the display path
+ *
+ * The reader stage asks AdmitPacket() before handing a packet to the
+ * decoders; the delivery stage asks TryQueueFrame() before queueing a frame
+ * for the GUI (at most kMaxFramesInFlight frames wait in the event loop, so
+ * unconsumed frames cannot pile up in memory).
+ *
+ * Update() runs a few times per second on the GUI thread and adjusts the
+ * admitted frame interval and the decode scale from what was measured since
+ * the previous step: frames painted vs. frames handed to the GUI, decoder
+ * load (decode time x admitted rate / workers), ring depth and GUI
+ * backpressure drops.  Congestion backs off multiplicatively (decode
+ * resolution first when the decoders are the bottleneck, frame rate
+ * otherwise); sustained headroom ramps back up towards the source rate.
+ * While the video is hidden or minimised only a trickle of frames is
+ * decoded so latest-frame consumers (screenshots, TCP server) stay fresh.
+ */
+class FFmpegFramePacer {
+public:
+    enum class State { Steady, BackingOff, RampingUp, Hidden };
+
+    struct Inputs {
+        bool display_visible = true;
+        bool paint_feedback = false;  // OnFramePainted() is called for this output
+        double source_fps = 0.0;   // Capture frame rate (0 = unknown)
+        int ring_depth = 0;        // Packets waiting for a decoder
+        int decoder_workers = 1;
+    };
+
+    struct Metrics {
+        State state = State::Steady;
+        double target_fps = 0.0;     // Admitted decode rate
+        double decode_scale = 1.0;   // Fraction of the requested decode size
+        double paint_fps = 0.0;      // Measured over the last control step
+        double admitted_fps = 0.0;
+        double avg_decode_ms = 0.0;
+        double decoder_load = 0.0;   // 1.0 = decoders busy all the time
+        int frames_in_flight = 0;
+        quint64 paced_drops = 0;     // Packets not decoded (cumulative)
+        quint64 gate_drops = 0;      // Frames not queued for the GUI (cumulative)
+        quint64 adjustments = 0;     // Rate or scale changes (cumulative)
+    };
+
+    static constexpr int kMaxFramesInFlight = 2;
+    static constexpr int kUpdateIntervalMs = 250;
+    static constexpr qint64 kMinIntervalUs = 8333;        // 120 fps ceiling
+    static constexpr qint64 kMaxIntervalUs = 200000;      // 5 fps floor while visible
+    static constexpr qint64 kHiddenIntervalUs = 1000000;  // 1 fps while hidden
+
+    FFmpegFramePacer();
+
+    FFmpegFramePacer(const FFmpegFramePacer&) = delete;
+    FFmpegFramePacer& operator=(const FFmpegFramePacer&) = delete;
+
+    // Reader stage: false when the packet should be skipped.  Recording
+    // frames are admitted at least at the recording frame rate.
+    bool AdmitPacket(bool is_recording);
+
+    // Scale to apply to the display decode size
+    double GetDecodeScale() const;
+
+    // Delivery stage
+    void OnFrameDecoded(qint64 decode_us);
+    bool TryQueueFrame();       // Reserves a GUI slot; false = GUI backlogged, drop the frame
+    void CancelQueuedFrame();   // Reserved slot not used (frame unchanged)
+
+    // GUI thread
+    void OnFrameConsumed();     // Queued frame reached its slot
+    void OnFramePainted();
+    void ResetQueue();          // Old connection gone: queued frames will never be consumed
+    void Update(const Inputs& inputs);
+
+    void SetRecordingFrameRate(int fps);
+
+    Metrics GetMetrics() const;
+    static const char* StateName(State state);
+
+private:
+    static constexpr int kRampUpSteps = 4;    // Control steps of headroom before speeding up
+    static constexpr int kScaleSteps = 3;     // 1, 3/4, 1/2 of the requested size
+
+    // Admission
+    std::atomic<qint64> interval_us_{kMinIntervalUs};
+    std::atomic<qint64> recording_interval_us_{33333};
+    qint64 last_admit_us_ = 0;                // Reader thread only
+    std::atomic<int> scale_step_{0};
+
+    // GUI queue
+    std::atomic<int> frames_in_flight_{0};
+
+    // Counters for the current control step
+    std::atomic<quint64> admitted_{0};
+    std::atomic<quint64> consumed_{0};
+    std::atomic<quint64> painted_{0};
+    std::atomic<quint64> decode_total_us_{0};
+    std::atomic<quint64> decode_samples_{0};
+    std::atomic<quint64> step_gate_drops_{0};
+
+    // Cumulative counters
+    std::atomic<quint64> paced_drops_{0};
+    std::atomic<quint64> gate_drops_{0};
+    std::atomic<quint64> adjustments_{0};
+
+    // Controller state (GUI thread)
+    qint64 last_update_us_ = 0;
+    qint64 visible_interval_us_ = kMinIntervalUs;  // Restored when the video is shown again
+    int headroom_steps_ = 0;
+    std::atomic<int> state_{static_cast<int>(State::Steady)};
+    std::atomic<double> paint_fps_{0.0};
+    std::atomic<double> admitted_fps_{0.0};
+    std::atomic<double> avg_decode_ms_{0.0};
+    std::atomic<double> decoder_load_{0.0};
+};
+
+#endif // FFMPEG_FRAME_PACER_H
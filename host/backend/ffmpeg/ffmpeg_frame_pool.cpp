@@ -0,0 +1,285 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#include "ffmpeg_frame_pool.h"
+
+#include <QDebug>
+#include <QLoggingCategory>
+#include <QMutex>
+#include <QPixelFormat>
+#include <new>
+#include <vector>
+
+Q_DECLARE_LOGGING_CATEGORY(log_ffmpeg_backend)
+
+namespace {
+
+// Scanlines are padded to a cache line so SIMD row loops in TurboJPEG and
+// swscale never straddle two lines for the last pixels of a row.
+constexpr qsizetype kRowAlignment = 64;
+
+qsizetype AlignedStride(int width, int bits_per_pixel)
+{
+    const qsizetype raw = (static_cast<qsizetype>(width) * bits_per_pixel + 7) / 8;
+    return (raw + kRowAlignment - 1) & ~(kRowAlignment - 1);
+}
+
+} // namespace
+
+// One pooled allocation.  `owner` is only set while the buffer is handed out,
+// so buffers sitting in the free list never keep the pool state alive.
+struct PooledFrameBuffer {
+    uchar* data = nullptr;
+    qsizetype bytes = 0;
+    std::shared_ptr<FFmpegFramePool::State> owner;
+};
+
+struct FFmpegFramePool::State {
+    mutable QMutex mutex;
+    int capacity = kDefaultCapacity;
+    qsizetype buffer_bytes = 0;     // Size of buffers currently kept in the free list
+    int allocated = 0;
+    std::vector<PooledFrameBuffer*> free_list;
+    quint64 hits = 0;
+    quint64 misses = 0;
+    quint64 reallocations = 0;
+};
+
+static PooledFrameBuffer* CreatePooledBuffer(qsizetype bytes)
+{
+    auto* buffer = new (std::nothrow) PooledFrameBuffer;
+    if (!buffer) {
+        return nullptr;
+    }
+    buffer->data = static_cast<uchar*>(
+        ::operator new(static_cast<size_t>(bytes), std::align_val_t(kRowAlignment), std::nothrow));
+    if (!buffer->data) {
+        delete buffer;
+        return nullptr;
+    }
+    buffer->bytes = bytes;
+    return buffer;
+}
+
+static void DestroyPooledBuffer(PooledFrameBuffer* buffer)
+{
+    if (!buffer) {
+        return;
+    }
+    ::operator delete(buffer->data, std::align_val_t(kRowAlignment));
+    delete buffer;
+}
+
+// QImageCleanupFunction: runs on whichever thread drops the last reference.
+static void ReleasePooledBuffer(void* info)
+{
+    auto* buffer = static_cast<PooledFrameBuffer*>(info);
+    std::shared_ptr<FFmpegFramePool::State> state = std::move(buffer->owner);
+    if (!state) {
+        DestroyPooledBuffer(buffer);
+        return;
+    }
+
+    bool recycled = false;
+    {
+        QMutexLocker locker(&state->mutex);
+        if (buffer->bytes == state->buffer_bytes &&
+            static_cast<int>(state->free_list.size()) < state->capacity) {
+            state->free_list.push_back(buffer);
+            recycled = true;
+        } else {
+            --state->allocated;
+        }
+    }
+
+    if (!recycled) {
+        DestroyPooledBuffer(buffer);
+    }
+}
+
+FFmpegFramePool::FFmpegFramePool(int capacity)
+    : state_(std::make_shared<State>())
+{
+    state_->capacity = qMax(1, capacity);
+}
+
+FFmpegFramePool::~FFmpegFramePool()
+{
+    // Outstanding images keep the state alive through their buffer's owner;
+    // with capacity 0 they are freed instead of recycled when released.
+    {
+        QMutexLocker locker(&state_->mutex);
+        state_->capacity = 0;
+    }
+    Clear();
+}
+
+QImage FFmpegFramePool::Acquire(const QSize& size, QImage::Format format)
+{
+    if (!size.isValid() || size.isEmpty() || format == QImage::Format_Invalid) {
+        return QImage();
+    }
+
+    const int bits_per_pixel = QImage::toPixelFormat(format).bitsPerPixel();
+    const qsizetype stride = AlignedStride(size.width(), bits_per_pixel);
+    const qsizetype bytes = stride * size.height();
+
+    PooledFrameBuffer* buffer = nullptr;
+    std::vector<PooledFrameBuffer*> stale;
+    {
+        QMutexLocker locker(&state_->mutex);
+        if (bytes != state_->buffer_bytes) {
+            // Geometry changed: buffers of the old size can never be reused.
+            if (state_->buffer_bytes != 0) {
+                ++state_->reallocations;
+            }
+            stale.swap(state_->free_list);
+            state_->allocated -= static_cast<int>(stale.size());
+            state_->buffer_bytes = bytes;
+        }
+
+        if (!state_->free_list.empty()) {
+            buffer = state_->free_list.back();
+            state_->free_list.pop_back();
+            ++state_->hits;
+        } else {
+            ++state_->misses;
+        }
+    }
+
+    for (PooledFrameBuffer* old : stale) {
+        DestroyPooledBuffer(old);
+    }
+
+    if (!buffer) {
+        buffer = CreatePooledBuffer(bytes);
+        if (!buffer) {
+            qCWarning(log_ffmpeg_backend) << "Frame pool: failed to allocate" << bytes << "bytes for" << size;
+            return QImage();
+        }
+        QMutexLocker locker(&state_->mutex);
+        ++state_->allocated;
+    }
+
+    buffer->owner = state_;
+    return QImage(buffer->data, size.width(), size.height(), stride, format,
+                  &ReleasePooledBuffer, buffer);
+}
+
+void FFmpegFramePool::Preallocate(const QSize& size, QImage::Format format, int count)
+{
+    if (!size.isValid() || size.isEmpty() || format == QImage::Format_Invalid || count <= 0) {
+        return;
+    }
+
+    const int bits_per_pixel = QImage::toPixelFormat(format).bitsPerPixel();
+    const qsizetype bytes = AlignedStride(size.width(), bits_per_pixel) * size.height();
+
+    std::vector<PooledFrameBuffer*> stale;
+    int to_allocate = 0;
+    {
+        QMutexLocker locker(&state_->mutex);
+        if (bytes != state_->buffer_bytes) {
+            if (state_->buffer_bytes != 0) {
+                ++state_->reallocations;
+            }
+            stale.swap(state_->free_list);
+            state_->allocated -= static_cast<int>(stale.size());
+            state_->buffer_bytes = bytes;
+        }
+        to_allocate = qMin(count, state_->capacity) - static_cast<int>(state_->free_list.size());
+    }
+
+    for (PooledFrameBuffer* old : stale) {
+        DestroyPooledBuffer(old);
+    }
+
+    for (int i = 0; i < to_allocate; ++i) {
+        PooledFrameBuffer* buffer = CreatePooledBuffer(bytes);
+        if (!buffer) {
+            break;
+        }
+        QMutexLocker locker(&state_->mutex);
+        if (bytes != state_->buffer_bytes) {
+            // Geometry changed again while we were allocating.
+            locker.unlock();
+            DestroyPooledBuffer(buffer);
+            break;
+        }
+        state_->free_list.push_back(buffer);
+        ++state_->allocated;
+    }
+
+    qCDebug(log_ffmpeg_backend) << "Frame pool preallocated" << to_allocate << "buffers for" << size
+                                << "(" << bytes << "bytes each)";
+}
+
+void FFmpegFramePool::SetCapacity(int capacity)
+{
+    std::vector<PooledFrameBuffer*> excess;
+    {
+        QMutexLocker locker(&state_->mutex);
+        state_->capacity = qMax(1, capacity);
+        while (static_cast<int>(state_->free_list.size()) > state_->capacity) {
+            excess.push_back(state_->free_list.back());
+            state_->free_list.pop_back();
+            --state_->allocated;
+        }
+    }
+    for (PooledFrameBuffer* buffer : excess) {
+        DestroyPooledBuffer(buffer);
+    }
+}
+
+FFmpegFramePool::Stats FFmpegFramePool::GetStats() const
+{
+    QMutexLocker locker(&state_->mutex);
+    Stats stats;
+    stats.capacity = state_->capacity;
+    stats.allocated = state_->allocated;
+    stats.free = static_cast<int>(state_->free_list.size());
+    stats.hits = state_->hits;
+    stats.misses = state_->misses;
+    stats.reallocations = state_->reallocations;
+    return stats;
+}
+
+void FFmpegFramePool::ResetStats()
+{
+    QMutexLocker locker(&state_->mutex);
+    state_->hits = 0;
+    state_->misses = 0;
+    state_->reallocations = 0;
+}
+
+void FFmpegFramePool::Clear()
+{
+    std::vector<PooledFrameBuffer*> released;
+    {
+        QMutexLocker locker(&state_->mutex);
+        released.swap(state_->free_list);
+        state_->allocated -= static_cast<int>(released.size());
+    }
+    for (PooledFrameBuffer* buffer : released) {
+        DestroyPooledBuffer(buffer);
+    }
+}
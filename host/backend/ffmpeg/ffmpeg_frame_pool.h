@@ -0,0 +1,85 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#ifndef FFMPEG_FRAME_POOL_H
+#define FFMPEG_FRAME_POOL_H
+
+#include <QImage>
+#include <QSize>
+#include <memory>
+
+/**
+ * @brief Pool of preallocated, reference-counted frame buffers
+ *
+ * Decoders write into a buffer handed out by Acquire().  The returned QImage
+ * wraps pooled memory and carries a cleanup hook, so every consumer (display,
+ * screenshot, TCP, recorder) shares the same pixels through Qt's implicit
+ * sharing.  When the last QImage referencing a buffer is destroyed the buffer
+ * goes back to the free list instead of being freed, which keeps steady-state
+ * allocation at zero.
+ *
+ * Consumers must treat pooled images as read-only.  A write detaches the
+ * QImage into a private copy, which is safe but defeats the purpose.
+ */
+class FFmpegFramePool {
+public:
+    struct Stats {
+        int capacity = 0;           // Maximum number of buffers kept for reuse
+        int allocated = 0;          // Buffers currently owned by the pool (free + in use)
+        int free = 0;               // Buffers ready for the next Acquire()
+        quint64 hits = 0;           // Acquire() served from the free list
+        quint64 misses = 0;         // Acquire() had to allocate a new buffer
+        quint64 reallocations = 0;  // Geometry/format changes that flushed the pool
+    };
+
+    static constexpr int kDefaultCapacity = 6;
+
+    explicit FFmpegFramePool(int capacity = kDefaultCapacity);
+    ~FFmpegFramePool();
+
+    FFmpegFramePool(const FFmpegFramePool&) = delete;
+    FFmpegFramePool& operator=(const FFmpegFramePool&) = delete;
+
+    // Returns a writable image backed by pooled memory.  The caller fills it
+    // once and afterwards only hands out shallow copies.
+    QImage Acquire(const QSize& size, QImage::Format format);
+
+    // Allocates up to `count` free buffers for the given geometry so the first
+    // frames after a resolution change do not hit the allocator.
+    void Preallocate(const QSize& size, QImage::Format format, int count);
+
+    void SetCapacity(int capacity);
+    Stats GetStats() const;
+    void ResetStats();
+
+    // Releases every free buffer.  Buffers still referenced by consumers are
+    // freed when their last QImage goes away.
+    void Clear();
+
+    // Opaque pool state, shared with buffers that are still handed out.
+    struct State;
+
+private:
+    std::shared_ptr<State> state_;
+};
+
+#endif // FFMPEG_FRAME_POOL_H
@@ -21,10 +21,13 @@
 */
 
 #include "ffmpeg_frame_processor.h"
+#include "ffmpeg_yuv_convert.h"
+#include "../common/jpegutils.h"
 #include <QLoggingCategory>
 #include <QDebug>
 #include <QThread>
 #include <cstring>
+#include <cmath>
 #include <vector>
 #include <algorithm>
 
@@ -35,6 +38,63 @@ extern "C" {
 
 Q_DECLARE_LOGGING_CATEGORY(log_ffmpeg_backend)
 
+namespace {
+
+#ifdef HAVE_LIBJPEG_TURBO
+// Picks the TurboJPEG DCT scaling denominator (1, 2, 4 or 8) for decoding a
+// width x height JPEG towards `targetSize`.
+int SelectDctScaleDenominator(int width, int height, const QSize& targetSize)
+{
+    if (!targetSize.isValid() || targetSize.isEmpty()) {
+        return 1;
+    }
+
+    // TurboJPEG supports built-in DCT scaling at discrete ratios:
+    // 1/8, 1/4, 1/2, 1x, 2x, 4x, 8x.
+    //
+    // CRITICAL: Only use DCT downscaling when BOTH dimensions exceed the target.
+    // Using qMin(scale_x, scale_y) on mismatched aspect ratios causes one
+    // dimension to be unnecessarily shrunk. For example, a 960x540 image
+    // targeting a 1315x262 viewport has scale_x=1.37, scale_y=0.49.
+    // qMin picks 0.49 → 1/2 DCT scale → 480x270, making the width half
+    // of what the viewport can display, leaving large black bars.
+    //
+    // Instead: only DCT-downscale when the image is strictly larger than
+    // the target in both dimensions. Otherwise decode at full resolution
+    // and let the caller's Qt rescaler handle the final fit.
+    bool widthExceeds = targetSize.width() < width;
+    bool heightExceeds = targetSize.height() < height;
+    if (!widthExceeds || !heightExceeds) {
+        return 1;
+    }
+
+    // Both dimensions need shrinking — pick the DCT scale based on the
+    // more aggressive ratio (the dimension that needs the most reduction).
+    double scale_x = static_cast<double>(targetSize.width()) / width;
+    double scale_y = static_cast<double>(targetSize.height()) / height;
+    double scale = qMin(scale_x, scale_y);
+
+    if (scale <= 0.125) {
+        return 8;
+    } else if (scale <= 0.25) {
+        return 4;
+    } else if (scale <= 0.5) {
+        return 2;
+    }
+    return 1;
+}
+
+// Region decodes are skipped when the visible part covers more than this
+// share of the frame; a plain full decode is cheaper then.
+constexpr double kMaxRegionDecodeArea = 0.7;
+
+// Extra area decoded around the visible rect (fraction of its size per side)
+// so scrolling does not reveal undecoded pixels before the next frame.
+constexpr double kRegionDecodeMargin = 0.125;
+#endif
+
+} // namespace
+
 FFmpegFrameProcessor::FFmpegFrameProcessor()
     : sws_context_(nullptr)
     , last_width_(-1)
@@ -44,12 +104,11 @@ FFmpegFrameProcessor::FFmpegFrameProcessor()
     , last_target_width_(-1)
     , last_target_height_(-1)
     , scaling_algorithm_(SWS_BILINEAR)
-    , frame_drop_threshold_display_(8)     // allow ~8.33ms (120fps) intervals to pass reliably - adjusted to exactly 8.33ms for 120fps support
-    , frame_drop_threshold_recording_(33)  // Restore: ~30fps capable (drop if >33ms processing)
-    , last_process_time_(0)
-    , dropped_frames_(0)
     , frame_count_(0)
     , startup_frames_to_skip_(0)           // Don't skip startup frames for MJPEG
+    , next_sequence_(0)
+    , latest_sequence_(0)
+    , retain_yuv_frames_(false)
     , stop_requested_(false)
 #ifdef HAVE_LIBJPEG_TURBO
     , turbojpeg_handle_(nullptr)
@@ -70,8 +129,26 @@ FFmpegFrameProcessor::FFmpegFrameProcessor()
     }
 #endif
 
-    // Start high-resolution process timer used for frame pacing decisions
-    last_process_timer_.start();
+    // Optional frame pool size override (buffers kept for reuse across frames)
+    QByteArray poolSizeEnv = qgetenv("OPENTERFACE_FRAME_POOL_SIZE");
+    if (!poolSizeEnv.isEmpty()) {
+        bool ok = false;
+        int poolSize = poolSizeEnv.toInt(&ok);
+        if (ok && poolSize > 0) {
+            frame_pool_.SetCapacity(poolSize);
+            qCDebug(log_ffmpeg_backend) << "Frame pool capacity set to" << poolSize
+                                       << "from environment variable";
+        }
+    }
+
+    // Optional conversion benchmark: direct YUV kernels vs sws_scale at 1080p
+    QByteArray yuvBenchmarkEnv = qgetenv("OPENTERFACE_YUV_BENCHMARK");
+    if (!yuvBenchmarkEnv.isEmpty()) {
+        bool ok = false;
+        int iterations = yuvBenchmarkEnv.toInt(&ok);
+        qCInfo(log_ffmpeg_backend).noquote()
+            << FFmpegYuvConverter::RunBenchmark(1920, 1080, ok && iterations > 0 ? iterations : 100);
+    }
 
     // Initialize startup frame skip from environment variable
     if (startup_frames_to_skip_ == -1) {
@@ -117,6 +194,16 @@ void FFmpegFrameProcessor::Cleanup()
     if (frame_rgb_) {
         AV_FRAME_RESET(frame_rgb_);
     }
+    
+    // Drop our references so pooled buffers can be released
+    latest_frame_ = QImage();
+    latest_original_frame_ = QImage();
+    latest_sequence_ = 0;
+    latest_jpeg_.reset();
+    latest_jpeg_size_ = QSize();
+    frame_pool_.Clear();
+    last_pooled_size_ = QSize();
+    ClearRetainedYuvFrames();
 }
 
 void FFmpegFrameProcessor::StopCaptureGracefully()
@@ -127,12 +214,11 @@ void FFmpegFrameProcessor::StopCaptureGracefully()
 void FFmpegFrameProcessor::StartCapture()
 {
     stop_requested_ = false;
-}
-
-void FFmpegFrameProcessor::SetFrameDropThreshold(int display_threshold_ms, int recording_threshold_ms)
-{
-    frame_drop_threshold_display_ = display_threshold_ms;
-    frame_drop_threshold_recording_ = recording_threshold_ms;
+    
+    // Sequence numbers restart with every capture session
+    next_sequence_ = 0;
+    QMutexLocker locker(&mutex_);
+    latest_sequence_ = 0;
 }
 
 void FFmpegFrameProcessor::SetScalingQuality(const QString &quality)
@@ -168,24 +254,107 @@ void FFmpegFrameProcessor::SetScalingQuality(const QString &quality)
     }
 }
 
+void FFmpegFrameProcessor::SetYuvFrameRetention(bool enabled)
+{
+    retain_yuv_frames_.store(enabled, std::memory_order_release);
+    if (!enabled) {
+        ClearRetainedYuvFrames();
+    }
+}
+
+void FFmpegFrameProcessor::RetainYuvFrame(const AVFrame* frame, quint64 sequence)
+{
+    // A reference, not a copy: the planes stay in the decoder's buffer pool
+    AvFramePtr reference(av_frame_clone(frame));
+    if (!reference) {
+        return;
+    }
+    QMutexLocker locker(&yuv_mutex_);
+    retained_yuv_frames_.emplace_back(sequence, std::move(reference));
+    while (static_cast<int>(retained_yuv_frames_.size()) > kMaxRetainedYuvFrames) {
+        retained_yuv_frames_.pop_front();
+    }
+}
+
+AvFramePtr FFmpegFrameProcessor::TakeYuvFrame(quint64 sequence)
+{
+    AvFramePtr result;
+    QMutexLocker locker(&yuv_mutex_);
+    for (auto it = retained_yuv_frames_.begin(); it != retained_yuv_frames_.end();) {
+        if (it->first == sequence) {
+            result = std::move(it->second);
+        }
+        if (it->first <= sequence) {
+            it = retained_yuv_frames_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return result;
+}
+
+void FFmpegFrameProcessor::ClearRetainedYuvFrames()
+{
+    QMutexLocker locker(&yuv_mutex_);
+    retained_yuv_frames_.clear();
+}
+
 void FFmpegFrameProcessor::ResetFrameCount()
 {
     frame_count_ = 0;
-    dropped_frames_ = 0;
-    last_process_time_ = 0;
-    last_process_timer_.restart();
 }
 
+// Both accessors return shallow references to the pooled buffer.  Callers must not
+// write into the image; a write would detach it into a private copy.
 QImage FFmpegFrameProcessor::GetLatestFrame() const
 {
     QMutexLocker locker(&mutex_);
-    return latest_frame_.copy();
+    return latest_frame_;
 }
 
 QImage FFmpegFrameProcessor::GetLatestOriginalFrame() const
 {
+    std::shared_ptr<AVPacket> jpeg;
+    quint64 sequence = 0;
+    {
+        QMutexLocker locker(&mutex_);
+        if (!latest_original_frame_.isNull() || !latest_jpeg_) {
+            return latest_original_frame_;
+        }
+        // Region decode left the original undecoded; decode it now, once
+        jpeg = latest_jpeg_;
+        sequence = latest_sequence_;
+    }
+
+#ifdef HAVE_LIBJPEG_TURBO
+    // The packet reference keeps the bytes alive for the decode; no copy needed
+    QImage original = DecodeFullJpeg(QByteArray::fromRawData(reinterpret_cast<const char*>(jpeg->data), jpeg->size));
     QMutexLocker locker(&mutex_);
-    return latest_original_frame_.copy();
+    if (!original.isNull() && sequence == latest_sequence_ && latest_original_frame_.isNull()) {
+        latest_original_frame_ = original;
+    }
+    return original;
+#else
+    Q_UNUSED(sequence);
+    return QImage();
+#endif
+}
+
+std::function<QImage()> FFmpegFrameProcessor::GetLatestOriginalFrameSource() const
+{
+    QMutexLocker locker(&mutex_);
+    if (!latest_original_frame_.isNull() || !latest_jpeg_) {
+        const QImage original = latest_original_frame_;
+        return [original]() { return original; };
+    }
+#ifdef HAVE_LIBJPEG_TURBO
+    const std::shared_ptr<AVPacket> jpeg = latest_jpeg_;
+    return [jpeg]() {
+        return DecodeFullJpeg(QByteArray::fromRawData(reinterpret_cast<const char*>(jpeg->data), jpeg->size));
+    };
+#else
+    return []() { return QImage(); };
+#endif
 }
 
 QSize FFmpegFrameProcessor::GetNativeJpegSize() const
@@ -194,29 +363,72 @@ QSize FFmpegFrameProcessor::GetNativeJpegSize() const
     return native_jpeg_size_;
 }
 
-bool FFmpegFrameProcessor::ShouldDropFrame(bool is_recording)
+EncodedFrame FFmpegFrameProcessor::GetLatestEncodedFrame() const
 {
-    // Use high-resolution elapsed time (microsecond precision) to avoid millisecond rounding errors.
-    qint64 elapsed_us = last_process_timer_.nsecsElapsed() / 1000; // microseconds since last restart
-    qint64 threshold_us = (is_recording ? frame_drop_threshold_recording_ : frame_drop_threshold_display_) * 1000LL;
-
-    if (elapsed_us < threshold_us) {
-        ++dropped_frames_;
-        return true;
+    EncodedFrame encoded;
+    std::shared_ptr<AVPacket> packet;
+    {
+        QMutexLocker locker(&mutex_);
+        packet = latest_jpeg_;
+        encoded.size = latest_jpeg_size_;
+        encoded.frame_id = latest_sequence_;
+    }
+    if (!packet) {
+        return EncodedFrame();
     }
+    // The copy out of the capture buffer and the Huffman table fix-up run on
+    // the requesting thread, not per captured frame
+    const QByteArray raw(reinterpret_cast<const char*>(packet->data), packet->size);
+    encoded.data = JpegUtils::makeStandalone(raw);
+    return encoded;
+}
 
-    // Restart the timer to measure the next interval from the end of this processing step.
-    last_process_timer_.restart();
-    last_process_time_ = QDateTime::currentMSecsSinceEpoch();
+void FFmpegFrameProcessor::StoreLatestFrames(const QImage& frame, const QImage& original, quint64 sequence,
+                                             const AVPacket* jpeg_packet, const QSize& jpeg_size)
+{
+    // Take a reference to the compressed bytes before taking the lock; the
+    // caller's packet is recycled as soon as we return.  For the refcounted
+    // packets the demuxer produces this shares the buffer instead of copying.
+    // The size comes from this packet's own header: under parallel decode the
+    // processor-wide native size may already belong to another packet.
+    std::shared_ptr<AVPacket> jpeg;
+    QSize packet_size;
+    if (jpeg_packet && jpeg_packet->data && jpeg_packet->size > 0) {
+        AVPacket* ref = av_packet_alloc();
+        if (ref && av_packet_ref(ref, jpeg_packet) == 0) {
+            jpeg.reset(ref, [](AVPacket* packet) { av_packet_free(&packet); });
+            packet_size = jpeg_size.isValid() ? jpeg_size
+                                              : JpegUtils::frameSize(ref->data, ref->size);
+        } else {
+            av_packet_free(&ref);
+        }
+    }
 
-    // Log dropped frames occasionally
-    if (dropped_frames_ > 0 && frame_count_ % 1000 == 0) {
-        qCDebug(log_ffmpeg_backend) << "Dropped" << dropped_frames_
-                                   << "frames for responsiveness (last 1000 frames)";
-        dropped_frames_ = 0;
+    // QImage uses Qt's COW ref-counting which is thread-safe for shared ownership,
+    // so no deep copy is needed.  The mutex protects the slot assignment itself.
+    QMutexLocker locker(&mutex_);
+    if (sequence < latest_sequence_) {
+        return;  // A newer frame was already published by another decoder worker
     }
+    latest_sequence_ = sequence;
+    latest_frame_ = frame;
+    latest_original_frame_ = original;
+    latest_jpeg_ = std::move(jpeg);
+    latest_jpeg_size_ = !latest_jpeg_ ? QSize() : (packet_size.isValid() ? packet_size : original.size());
+}
 
+bool FFmpegFrameProcessor::SupportsParallelDecode(const AVCodecContext* codec_context) const
+{
+    if (!codec_context || IsHardwareDecoder(codec_context)) {
+        return false;
+    }
+#ifdef HAVE_LIBJPEG_TURBO
+    // Each MJPEG packet is an independent intra frame and every worker thread
+    // gets its own TurboJPEG handle, so packets can be decoded out of order.
+    return codec_context->codec_id == AV_CODEC_ID_MJPEG;
+#else
     return false;
+#endif
 }
 
 bool FFmpegFrameProcessor::IsHardwareDecoder(const AVCodecContext* codec_context) const
@@ -233,7 +445,7 @@ bool FFmpegFrameProcessor::IsHardwareDecoder(const AVCodecContext* codec_context
 
 
 QImage FFmpegFrameProcessor::ProcessPacketToImage(AVPacket* packet, AVCodecContext* codec_context, 
-                                                   bool is_recording, const QSize& targetSize)
+                                                   const QSize& targetSize)
 {
     if (stop_requested_) {
         return QImage();
@@ -248,8 +460,18 @@ QImage FFmpegFrameProcessor::ProcessPacketToImage(AVPacket* packet, AVCodecConte
         return QImage();
     }
     
-    // Frame dropping for responsiveness
-    if (ShouldDropFrame(is_recording)) {
+    return DecodePacketToImage(packet, codec_context, targetSize, ++next_sequence_);
+}
+
+QImage FFmpegFrameProcessor::DecodePacketToImage(AVPacket* packet, AVCodecContext* codec_context,
+                                                  const QSize& targetSize, quint64 sequence,
+                                                  const QRectF& region)
+{
+    if (stop_requested_) {
+        return QImage();
+    }
+    
+    if (!packet || !codec_context || packet->size <= 0 || !packet->data) {
         return QImage();
     }
     
@@ -259,13 +481,24 @@ QImage FFmpegFrameProcessor::ProcessPacketToImage(AVPacket* packet, AVCodecConte
     if (is_hardware_decoder) {
         qCDebug(log_ffmpeg_backend) << "Using hardware decoder:" << codec_context->codec->name;
         // Proceed directly to FFmpeg hardware decoding
-        return ProcessWithFFmpegDecoding(packet, codec_context, is_recording, targetSize);
+        return ProcessWithFFmpegDecoding(packet, codec_context, targetSize, sequence);
     }
     
 #ifdef HAVE_LIBJPEG_TURBO
     // PRIORITY 2: TurboJPEG acceleration (for MJPEG only, when no hardware acceleration)
     if (codec_context->codec_id == AV_CODEC_ID_MJPEG) {
         tjhandle handle = GetThreadLocalTurboJPEGHandle();
+        if (handle && region.isValid()) {
+            // Zoomed in: decode only the visible MCUs.  The full-resolution
+            // original is decoded from the kept JPEG bytes if a screenshot asks.
+            QImage region_result = DecodeMJPEGRegionWithTurboJPEG(packet, targetSize, region, handle);
+            if (!region_result.isNull()) {
+                if (++frame_count_ > startup_frames_to_skip_) {
+                    StoreLatestFrames(region_result, QImage(), sequence, packet);
+                }
+                return region_result;
+            }
+        }
         if (handle) {
             QImage turbojpeg_result = DecodeMJPEGWithTurboJPEG(packet, targetSize, handle);
             if (!turbojpeg_result.isNull()) {
@@ -274,12 +507,10 @@ QImage FFmpegFrameProcessor::ProcessPacketToImage(AVPacket* packet, AVCodecConte
                 // preserving fit with centering (letterboxing/pillarboxing).  Scaling to
                 // a narrow target with KeepAspectRatio would shrink the video unnecessarily.
 
-                // Update frame count and store frames
-                frame_count_++;
-                if (frame_count_ > startup_frames_to_skip_) {
-                    QMutexLocker locker(&mutex_);
-                    latest_frame_ = turbojpeg_result.copy();
-                    latest_original_frame_ = turbojpeg_result.copy();
+                // Update frame count and store frames.  The decoded image lives in a
+                // pooled buffer, so both slots share it instead of deep-copying.
+                if (++frame_count_ > startup_frames_to_skip_) {
+                    StoreLatestFrames(turbojpeg_result, turbojpeg_result, sequence, packet);
                 }
 
                 return turbojpeg_result;
@@ -291,12 +522,16 @@ QImage FFmpegFrameProcessor::ProcessPacketToImage(AVPacket* packet, AVCodecConte
     
     // PRIORITY 3: CPU direct decoding (fallback when no acceleration available)
     qCDebug(log_ffmpeg_backend) << "Using CPU decoder:" << codec_context->codec->name;
-    return ProcessWithFFmpegDecoding(packet, codec_context, is_recording, targetSize);
+    return ProcessWithFFmpegDecoding(packet, codec_context, targetSize, sequence);
 }
 
 QImage FFmpegFrameProcessor::ProcessWithFFmpegDecoding(AVPacket* packet, AVCodecContext* codec_context,
-                                                      bool /*is_recording*/, const QSize& targetSize)
+                                                      const QSize& targetSize, quint64 sequence)
 {
+    // The codec context, temp_frame_ and sws_context_ are shared state; decoder
+    // workers take turns on this path.
+    QMutexLocker decode_locker(&decode_mutex_);
+    
     if (!temp_frame_) {
         temp_frame_ = make_av_frame();
         if (!temp_frame_) {
@@ -376,27 +611,24 @@ QImage FFmpegFrameProcessor::ProcessWithFFmpegDecoding(AVPacket* packet, AVCodec
         originalResult = result;  // Same image serves as both
     }
     
+    if (!result.isNull() && retain_yuv_frames_.load(std::memory_order_acquire)) {
+        RetainYuvFrame(frame_to_convert, sequence);
+    }
+    
     if (sw_frame) {
         AV_FRAME_RESET(sw_frame);
     }
     
     // Update statistics and store latest frames
     if (!result.isNull()) {
-        frame_count_++;
-        
         // Skip startup frames if configured
-        if (frame_count_ <= startup_frames_to_skip_) {
+        if (++frame_count_ <= startup_frames_to_skip_) {
             return QImage();
         }
         
-        // Store frames.  QImage uses Qt's COW (copy-on-write) ref-counting which is
-        // thread-safe for shared ownership, so no redundant deep copy is needed here.
-        // The mutex protects the assignment of the pointer/ref-count itself.
-        {
-            QMutexLocker locker(&mutex_);
-            latest_frame_ = result;          // Frame for display (COW shared, deep copy on first write)
-            latest_original_frame_ = originalResult;  // Original frame for screenshots
-        }
+        const bool is_mjpeg = codec_context->codec_id == AV_CODEC_ID_MJPEG;
+        StoreLatestFrames(result, originalResult, sequence,
+                          is_mjpeg ? packet : nullptr, frameSize);
     }
     
     return result;  // result is a freshly-allocated QImage; no extra deep copy needed
@@ -445,6 +677,15 @@ QImage FFmpegFrameProcessor::ConvertFrameToImage(AVFrame* frame, const QSize& ta
         return ConvertRgbFrameDirectlyToImage(frame);  // Already returns deep copy
     }
 
+    // 1:1 YUV frames: SIMD conversion straight into a pooled display buffer
+    if ((!effectiveTarget.isValid() || (effectiveTarget.width() == width && effectiveTarget.height() == height)) &&
+        FFmpegYuvConverter::SupportsFormat(format)) {
+        QImage image = frame_pool_.Acquire(QSize(width, height), QImage::Format_ARGB32_Premultiplied);
+        if (!image.isNull() && FFmpegYuvConverter::ConvertToArgb32(frame, image.bits(), image.bytesPerLine())) {
+            return image;
+        }
+    }
+
     // Use scaling for other formats or when target size is specified
     return ConvertWithScalingToImage(frame, effectiveTarget);  // Already returns deep copy
 }
@@ -503,11 +744,11 @@ QImage FFmpegFrameProcessor::ConvertWithScalingToImage(AVFrame* frame, const QSi
     UpdateScalingContext(width, height, format, QSize(targetWidth, targetHeight));
     
     // CRITICAL FIX: Allocate image BEFORE locking mutex to reduce lock time
-    // OPTIMIZATION: Use ARGB32 (32-bit aligned, 4 bytes/pixel) instead of RGB888
-    // (24-bit unaligned, 3 bytes/pixel).  sws_scale writes BGRA which maps directly
-    // to QImage::Format_ARGB32 on little-endian platforms (BGRA bytes = 0xAARRGGBB).
-    // 32-bit alignment lets SIMD gather/scatter operate on natural word boundaries.
-    QImage image(targetWidth, targetHeight, QImage::Format_ARGB32);
+    // OPTIMIZATION: Use a 32-bit format (aligned, 4 bytes/pixel) instead of RGB888
+    // (24-bit unaligned, 3 bytes/pixel).  sws_scale writes opaque BGRA, which maps
+    // directly to QImage::Format_ARGB32_Premultiplied on little-endian platforms
+    // (BGRA bytes = 0xAARRGGBB) - the format the raster paint engine blends fastest.
+    QImage image = frame_pool_.Acquire(QSize(targetWidth, targetHeight), QImage::Format_ARGB32_Premultiplied);
     if (image.isNull()) {
         return QImage();
     }
@@ -537,7 +778,7 @@ QImage FFmpegFrameProcessor::ConvertWithScalingToImage(AVFrame* frame, const QSi
         return QImage();
     }
     
-    return image;  // image was constructed fresh above with its own storage; no copy needed
+    return image;  // pooled buffer owned by this frame only; no copy needed
 }
 
 #ifdef HAVE_LIBJPEG_TURBO
@@ -563,49 +804,11 @@ QImage FFmpegFrameProcessor::DecodeMJPEGWithTurboJPEG(AVPacket* packet, const QS
     }
     
     // Determine target size for scaling
-    int target_width = width;
-    int target_height = height;
-
-    if (targetSize.isValid() && !targetSize.isEmpty()) {
-        // TurboJPEG supports built-in DCT scaling at discrete ratios:
-        // 1/8, 1/4, 1/2, 1x, 2x, 4x, 8x.
-        //
-        // CRITICAL: Only use DCT downscaling when BOTH dimensions exceed the target.
-        // Using qMin(scale_x, scale_y) on mismatched aspect ratios causes one
-        // dimension to be unnecessarily shrunk. For example, a 960x540 image
-        // targeting a 1315x262 viewport has scale_x=1.37, scale_y=0.49.
-        // qMin picks 0.49 → 1/2 DCT scale → 480x270, making the width half
-        // of what the viewport can display, leaving large black bars.
-        //
-        // Instead: only DCT-downscale when the image is strictly larger than
-        // the target in both dimensions. Otherwise decode at full resolution
-        // and let the caller's Qt rescaler handle the final fit.
-        bool widthExceeds = targetSize.width() < width;
-        bool heightExceeds = targetSize.height() < height;
-
-        if (widthExceeds && heightExceeds) {
-            // Both dimensions need shrinking — pick the DCT scale based on the
-            // more aggressive ratio (the dimension that needs the most reduction).
-            double scale_x = static_cast<double>(targetSize.width()) / width;
-            double scale_y = static_cast<double>(targetSize.height()) / height;
-            double scale = qMin(scale_x, scale_y);
-
-            if (scale <= 0.125) {
-                target_width = width / 8;
-                target_height = height / 8;
-            } else if (scale <= 0.25) {
-                target_width = width / 4;
-                target_height = height / 4;
-            } else if (scale <= 0.5) {
-                target_width = width / 2;
-                target_height = height / 2;
-            }
-        }
-        // else: keep original size — caller will handle final scaling
-    }
+    const int denominator = SelectDctScaleDenominator(width, height, targetSize);
+    int target_width = width / denominator;
+    int target_height = height / denominator;
     
-    // Create QImage for output
-    QImage image(target_width, target_height, QImage::Format_RGB888);
+    QImage image = AcquireDecodeBuffer(QSize(target_width, target_height));
     if (image.isNull()) {
         return QImage();
     }
@@ -626,8 +829,159 @@ QImage FFmpegFrameProcessor::DecodeMJPEGWithTurboJPEG(AVPacket* packet, const QS
     
     return image;
 }
+
+QImage FFmpegFrameProcessor::DecodeMJPEGRegionWithTurboJPEG(AVPacket* packet, const QSize& targetSize,
+                                                             const QRectF& region, tjhandle handle)
+{
+    if (!handle || !packet || !packet->data || packet->size <= 0 || !region.isValid()) {
+        return QImage();
+    }
+
+    int width, height, subsamp, colorspace;
+    if (tjDecompressHeader3(handle, packet->data, packet->size,
+                            &width, &height, &subsamp, &colorspace) < 0) {
+        return QImage();
+    }
+    {
+        QMutexLocker locker(&mutex_);
+        native_jpeg_size_ = QSize(width, height);
+    }
+
+    // The output keeps the geometry of a full decode so the display does not
+    // need to know which part was decoded.  Require exact DCT scaling so the
+    // region lands on whole output pixels.
+    const int denominator = SelectDctScaleDenominator(width, height, targetSize);
+    if (subsamp < 0 || subsamp >= TJ_NUMSAMP || width % denominator != 0 || height % denominator != 0) {
+        return QImage();
+    }
+
+    // Visible rect plus margin, in native pixels, snapped out to whole MCUs
+    const double margin_x = region.width() * kRegionDecodeMargin;
+    const double margin_y = region.height() * kRegionDecodeMargin;
+    const QRectF expanded = region.adjusted(-margin_x, -margin_y, margin_x, margin_y)
+                                  .intersected(QRectF(0.0, 0.0, 1.0, 1.0));
+    const int mcu_width = tjMCUWidth[subsamp];
+    const int mcu_height = tjMCUHeight[subsamp];
+    const int left = static_cast<int>(expanded.left() * width) / mcu_width * mcu_width;
+    const int top = static_cast<int>(expanded.top() * height) / mcu_height * mcu_height;
+    const int right = qMin(width, (static_cast<int>(std::ceil(expanded.right() * width)) + mcu_width - 1)
+                                  / mcu_width * mcu_width);
+    const int bottom = qMin(height, (static_cast<int>(std::ceil(expanded.bottom() * height)) + mcu_height - 1)
+                                    / mcu_height * mcu_height);
+    if (right <= left || bottom <= top ||
+        static_cast<double>(right - left) * (bottom - top) > kMaxRegionDecodeArea * width * height) {
+        return QImage();
+    }
+
+    QImage image = AcquireDecodeBuffer(QSize(width / denominator, height / denominator));
+    if (image.isNull()) {
+        return QImage();
+    }
+
+    // Pooled buffers hold an older frame: blank everything outside the region
+    const QRect out(left / denominator, top / denominator,
+                    (right - left) / denominator, (bottom - top) / denominator);
+    const qsizetype stride = image.bytesPerLine();
+    uchar* bits = image.bits();
+    for (int y = 0; y < image.height(); ++y) {
+        uchar* row = bits + y * stride;
+        if (y < out.top() || y > out.bottom()) {
+            std::memset(row, 0, static_cast<size_t>(image.width()) * 3);
+        } else {
+            std::memset(row, 0, static_cast<size_t>(out.left()) * 3);
+            std::memset(row + (out.right() + 1) * 3, 0, static_cast<size_t>(image.width() - out.right() - 1) * 3);
+        }
+    }
+    uchar* destination = bits + out.top() * stride + out.left() * 3;
+
+#if defined(TJ_NUMINIT)
+    // TurboJPEG 3: skip the rows below the region and crop columns inside the
+    // decoder, so only the visible MCUs are entropy-decoded past the top edge.
+    const tjscalingfactor scaling = { 1, denominator };
+    const tjregion cropping = { out.left(), out.top(), out.width(), out.height() };
+    bool ok = tj3SetScalingFactor(handle, scaling) == 0 &&
+              tj3SetCroppingRegion(handle, cropping) == 0 &&
+              tj3Set(handle, TJPARAM_FASTDCT, 1) == 0 &&
+              tj3Decompress8(handle, packet->data, packet->size, destination,
+                             static_cast<int>(stride), TJPF_RGB) == 0;
+    if (!ok) {
+        qCDebug(log_ffmpeg_backend) << "TurboJPEG region decode failed:" << tj3GetErrorStr(handle);
+    }
+    // The handle is shared with full-frame decodes on this thread
+    tj3SetCroppingRegion(handle, TJUNCROPPED);
+    tj3SetScalingFactor(handle, TJUNSCALED);
+#else
+    // TurboJPEG 2: losslessly crop the MCUs out of the bitstream, then decode
+    // only the cropped JPEG.
+    tjhandle transformer = GetThreadLocalTurboJPEGTransformHandle();
+    if (!transformer) {
+        return QImage();
+    }
+    tjtransform transform;
+    std::memset(&transform, 0, sizeof(transform));
+    transform.r = { left, top, right - left, bottom - top };
+    transform.op = TJXOP_NONE;
+    transform.options = TJXOPT_CROP;
+
+    unsigned char* cropped = nullptr;
+    unsigned long cropped_size = 0;
+    bool ok = tjTransform(transformer, packet->data, packet->size, 1, &cropped, &cropped_size,
+                          &transform, 0) == 0 &&
+              tjDecompress2(handle, cropped, cropped_size, destination, out.width(),
+                            static_cast<int>(stride), out.height(), TJPF_RGB, TJFLAG_FASTDCT) == 0;
+    if (!ok) {
+        qCDebug(log_ffmpeg_backend) << "TurboJPEG region decode failed:" << tjGetErrorStr2(transformer);
+    }
+    tjFree(cropped);
+#endif
+
+    return ok ? image : QImage();
+}
+
+QImage FFmpegFrameProcessor::DecodeFullJpeg(const QByteArray& jpeg)
+{
+    tjhandle handle = GetThreadLocalTurboJPEGHandle();
+    if (!handle || jpeg.isEmpty()) {
+        return QImage();
+    }
+
+    const auto* data = reinterpret_cast<const unsigned char*>(jpeg.constData());
+    int width, height, subsamp, colorspace;
+    if (tjDecompressHeader3(handle, data, jpeg.size(), &width, &height, &subsamp, &colorspace) < 0) {
+        return QImage();
+    }
+
+    // Owned buffer rather than a pooled one: the result may be cached for a while
+    QImage image(width, height, QImage::Format_RGB888);
+    if (image.isNull() ||
+        tjDecompress2(handle, data, jpeg.size(), image.bits(), width, image.bytesPerLine(),
+                      height, TJPF_RGB, TJFLAG_FASTDCT) < 0) {
+        qCWarning(log_ffmpeg_backend) << "Full-frame JPEG decode failed:" << tjGetErrorStr();
+        return QImage();
+    }
+    return image;
+}
 #endif
 
+QImage FFmpegFrameProcessor::AcquireDecodeBuffer(const QSize& size)
+{
+    // Decode into a pooled buffer.  Warm the pool on a geometry change so the
+    // first frames at the new size (decoder + GUI queue + latest slot) do not
+    // each hit the allocator.
+    bool geometryChanged = false;
+    {
+        QMutexLocker locker(&mutex_);
+        if (size != last_pooled_size_) {
+            last_pooled_size_ = size;
+            geometryChanged = true;
+        }
+    }
+    if (geometryChanged) {
+        frame_pool_.Preallocate(size, QImage::Format_RGB888, 3);
+    }
+    return frame_pool_.Acquire(size, QImage::Format_RGB888);
+}
+
 void FFmpegFrameProcessor::UpdateScalingContext(int width, int height, AVPixelFormat format, const QSize& targetSize)
 {
     QMutexLocker locker(&mutex_);
@@ -667,7 +1021,7 @@ void FFmpegFrameProcessor::UpdateScalingContext(int width, int height, AVPixelFo
                                << width << "x" << height 
                                << "to" << targetWidth << "x" << targetHeight
                                << "from format" << format << "(" << (format_name ? format_name : "unknown") << ")"
-                               << "to BGRA (32-bit aligned, AV_PIX_FMT_BGRA → QImage::Format_ARGB32)"
+                               << "to BGRA (32-bit aligned, AV_PIX_FMT_BGRA → QImage::Format_ARGB32_Premultiplied)"
                                << "with algorithm" << algorithm_name;
     
     // OPTIMIZATION: Choose scaling algorithm based on performance needs
@@ -772,12 +1126,21 @@ void FFmpegFrameProcessor::CleanupScalingContext()
 #ifdef HAVE_LIBJPEG_TURBO
 tjhandle FFmpegFrameProcessor::GetThreadLocalTurboJPEGHandle()
 {
-    // Use thread-local storage for TurboJPEG handles to enable multi-threading
-    thread_local tjhandle local_handle = nullptr;
+    // Use thread-local storage for TurboJPEG handles to enable multi-threading.
+    // The holder destroys the handle when a decoder worker thread exits.
+    struct ThreadLocalHandle {
+        tjhandle handle = nullptr;
+        ~ThreadLocalHandle() {
+            if (handle) {
+                tjDestroy(handle);
+            }
+        }
+    };
+    thread_local ThreadLocalHandle local;
     
-    if (!local_handle) {
-        local_handle = tjInitDecompress();
-        if (!local_handle) {
+    if (!local.handle) {
+        local.handle = tjInitDecompress();
+        if (!local.handle) {
             qCWarning(log_ffmpeg_backend) << "Failed to initialize thread-local TurboJPEG handle";
             return nullptr;
         }
@@ -786,7 +1149,32 @@ tjhandle FFmpegFrameProcessor::GetThreadLocalTurboJPEGHandle()
                                    << QThread::currentThreadId();
     }
     
-    return local_handle;
+    return local.handle;
+}
+
+#if !defined(TJ_NUMINIT)
+tjhandle FFmpegFrameProcessor::GetThreadLocalTurboJPEGTransformHandle()
+{
+    // Separate from the decompressor: TurboJPEG 2 transform handles need the
+    // compressor half initialised as well.
+    struct ThreadLocalHandle {
+        tjhandle handle = nullptr;
+        ~ThreadLocalHandle() {
+            if (handle) {
+                tjDestroy(handle);
+            }
+        }
+    };
+    thread_local ThreadLocalHandle local;
+
+    if (!local.handle) {
+        local.handle = tjInitTransform();
+        if (!local.handle) {
+            qCWarning(log_ffmpeg_backend) << "Failed to initialize thread-local TurboJPEG transformer";
+        }
+    }
+    return local.handle;
 }
 #endif
+#endif
 
@@ -25,9 +25,17 @@
 
 #include <QImage>
 #include <QMutex>
+#include <QRectF>
 #include <QDateTime>
 #include <QElapsedTimer>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <utility>
 #include "ffmpegutils.h"
+#include "ffmpeg_frame_pool.h"
+#include "ffmpeg_encoded_frame.h"
 
 #ifdef HAVE_FFMPEG
 extern "C" {
@@ -47,39 +55,78 @@ extern "C" {
  * - Hardware-accelerated decoding
  * - TurboJPEG fast MJPEG decoding
  * - FFmpeg software decoding
- * - Frame format conversion
+ * - Frame format conversion (direct SIMD YUV kernels at 1:1, swscale otherwise)
  * - Frame dropping for responsiveness
  * - Latest frame storage for image capture
+ *
+ * DecodePacketToImage() may be called concurrently from several decoder
+ * workers.  The TurboJPEG path runs fully in parallel (one handle per thread);
+ * the AVCodecContext-based path is serialized internally because libavcodec
+ * contexts are not re-entrant.
  */
 class FFmpegFrameProcessor {
 public:
     FFmpegFrameProcessor();
     ~FFmpegFrameProcessor();
 
-    // Frame processing pipeline (returns QImage for thread safety)
+    // Frame processing pipeline (returns QImage for thread safety).  Not
+    // paced: callers decide which packets to decode (see FFmpegFramePacer).
     QImage ProcessPacketToImage(AVPacket* packet, AVCodecContext* codec_context, 
-                                bool is_recording, const QSize& targetSize = QSize());
+                                const QSize& targetSize = QSize());
+    
+    // Decode with an explicit sequence.  `sequence` orders the latest-frame
+    // slots so a worker finishing late never overwrites a newer frame.
+    // A valid `region` (normalized 0..1 source coordinates) limits MJPEG
+    // decoding to that area; the rest of the returned frame is black.
+    QImage DecodePacketToImage(AVPacket* packet, AVCodecContext* codec_context,
+                               const QSize& targetSize, quint64 sequence,
+                               const QRectF& region = QRectF());
+    
+    // True when packets for this codec can be decoded on several threads at once
+    bool SupportsParallelDecode(const AVCodecContext* codec_context) const;
     
     // Latest frame access (thread-safe)
     QImage GetLatestFrame() const;
-    QImage GetLatestOriginalFrame() const;
+    QImage GetLatestOriginalFrame() const;  // Decodes lazily after a region-only decode
+    // Snapshot of the latest original frame whose decode, if one is still
+    // needed, runs on the thread that calls it.  Owns its input, so it stays
+    // valid after the processor is gone.  Used to keep screenshot decodes off
+    // the GUI thread.
+    std::function<QImage()> GetLatestOriginalFrameSource() const;
     QSize GetNativeJpegSize() const;
     
+    // Raw MJPEG bytes of the latest original frame (null for other codecs).
+    // Lets screenshot and remote-screen paths skip a decode/encode cycle.
+    EncodedFrame GetLatestEncodedFrame() const;
+    
     // Configuration
-    void SetFrameDropThreshold(int display_threshold_ms, int recording_threshold_ms);
     void SetScalingQuality(const QString &quality);
     
+    // Keep the decoder's YUV output of the FFmpeg decode path for the
+    // recorder, so re-encoding skips the RGB round trip.  Frames are held
+    // by reference until taken (bounded; older ones are released).
+    void SetYuvFrameRetention(bool enabled);
+    // The YUV frame decoded for `sequence`, or null (TurboJPEG path, or
+    // retention off).  Frames of earlier sequences are released.
+    AvFramePtr TakeYuvFrame(quint64 sequence);
+    
 #ifdef HAVE_LIBJPEG_TURBO
     // TurboJPEG fast MJPEG decoding
     QImage DecodeMJPEGWithTurboJPEG(AVPacket* packet, const QSize& targetSize, tjhandle handle);
+    
+    // Decodes only the MCUs covering `region` (plus a small margin) into a
+    // frame of the same size DecodeMJPEGWithTurboJPEG() would return.  Returns
+    // a null image when a full decode is the better choice.
+    QImage DecodeMJPEGRegionWithTurboJPEG(AVPacket* packet, const QSize& targetSize,
+                                          const QRectF& region, tjhandle handle);
 #endif
     void StopCaptureGracefully();
     void StartCapture();
     void ResetFrameCount();
     
     // Statistics
-    int GetFrameCount() const { return frame_count_; }
-    int GetDroppedFrames() const { return dropped_frames_; }
+    int GetFrameCount() const { return frame_count_.load(std::memory_order_relaxed); }
+    FFmpegFramePool::Stats GetFramePoolStats() const { return frame_pool_.GetStats(); }
     
     // Cleanup
     void Cleanup();
@@ -92,10 +139,19 @@ private:
     
     // FFmpeg decoding implementation (extracted from main processing logic)
     QImage ProcessWithFFmpegDecoding(AVPacket* packet, AVCodecContext* codec_context, 
-                                     bool is_recording, const QSize& targetSize = QSize());
+                                     const QSize& targetSize, quint64 sequence);
+    
+    // Publish decoded frames to the latest-frame slots (ignores stale sequences).
+    // `jpeg_packet` is the MJPEG source of `original`, or null for other codecs;
+    // it is kept by reference.  An invalid `jpeg_size` is read from the packet.
+    void StoreLatestFrames(const QImage& frame, const QImage& original, quint64 sequence,
+                           const AVPacket* jpeg_packet = nullptr, const QSize& jpeg_size = QSize());
+    
+    // Pooled RGB888 destination for TurboJPEG decodes
+    QImage AcquireDecodeBuffer(const QSize& size);
     
-    // Frame dropping logic
-    bool ShouldDropFrame(bool is_recording);
+    void RetainYuvFrame(const AVFrame* frame, quint64 sequence);
+    void ClearRetainedYuvFrames();
     
     // Helper methods
     bool IsHardwareDecoder(const AVCodecContext* codec_context) const;
@@ -117,31 +173,49 @@ private:
     int last_target_height_;    // Thread-safe target height tracking
     int scaling_algorithm_;
     
-    // Frame dropping configuration
-    int frame_drop_threshold_display_;
-    int frame_drop_threshold_recording_;
-    qint64 last_process_time_;
-    int dropped_frames_;
-    QElapsedTimer last_process_timer_;   // high-resolution timer to avoid ms rounding issues
-
     // Statistics
-    int frame_count_;
+    std::atomic<int> frame_count_;
     int startup_frames_to_skip_;
+    std::atomic<quint64> next_sequence_;  // Sequence source for ProcessPacketToImage callers
+    
+    // Decoded frames live in pooled buffers shared (not copied) by all consumers
+    FFmpegFramePool frame_pool_;
+    QSize last_pooled_size_;         // Geometry the pool was last preallocated for
     
-    // Latest frame storage (thread-safe)
+    // Latest frame storage (thread-safe). Shallow QImage references into frame_pool_.
     mutable QMutex mutex_;
     QImage latest_frame_;
-    QImage latest_original_frame_;  // Original resolution frame before scaling
+    mutable QImage latest_original_frame_;  // Original resolution frame before scaling (null until decoded after a region decode)
+    quint64 latest_sequence_;        // Sequence of the frame held in the latest slots
+    // Compressed source of latest_original_frame_ (MJPEG only).  A reference to
+    // the capture buffer, not a copy; bytes are copied only when requested.
+    std::shared_ptr<AVPacket> latest_jpeg_;
+    QSize latest_jpeg_size_;         // From this packet's own SOF header
     QSize native_jpeg_size_;         // True JPEG dimensions from header (unaffected by DCT scaling)
     
+    // Serializes the libavcodec/swscale path, which is not re-entrant
+    QMutex decode_mutex_;
+    
+    // Decoded YUV frames waiting for the recorder, by sequence
+    static constexpr int kMaxRetainedYuvFrames = 8;
+    std::atomic<bool> retain_yuv_frames_;
+    QMutex yuv_mutex_;
+    std::deque<std::pair<quint64, AvFramePtr>> retained_yuv_frames_;
+    
     // Thread control
-    bool stop_requested_;
+    std::atomic<bool> stop_requested_;
     
 #ifdef HAVE_LIBJPEG_TURBO
     tjhandle turbojpeg_handle_;
     
     // Thread-safe TurboJPEG handle access
-    tjhandle GetThreadLocalTurboJPEGHandle();
+    static tjhandle GetThreadLocalTurboJPEGHandle();
+#if !defined(TJ_NUMINIT)
+    static tjhandle GetThreadLocalTurboJPEGTransformHandle();  // TurboJPEG 2 region decode
+#endif
+    
+    // Full native-resolution decode of stored MJPEG bytes (lazy original frame)
+    static QImage DecodeFullJpeg(const QByteArray& jpeg);
 #endif
 };
 
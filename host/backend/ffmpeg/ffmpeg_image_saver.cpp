@@ -0,0 +1,258 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#include "ffmpeg_image_saver.h"
+#include "ffmpeg_clock.h"
+
+#include <QFileInfo>
+#include <QImageWriter>
+#include <QLoggingCategory>
+#include <QSaveFile>
+#include <QThread>
+
+Q_DECLARE_LOGGING_CATEGORY(log_ffmpeg_backend)
+
+FFmpegImageSaver::FFmpegImageSaver(QObject* parent)
+    : QObject(parent),
+      queue_capacity_(kDefaultQueueCapacity),
+      worker_count_(qBound(1, QThread::idealThreadCount() / 2, kDefaultWorkers))
+{
+}
+
+FFmpegImageSaver::~FFmpegImageSaver()
+{
+    Stop();
+}
+
+void FFmpegImageSaver::StartWorkers()
+{
+    // Called with mutex_ held
+    for (int i = 0; i < worker_count_; ++i) {
+        QThread* worker = QThread::create([this]() { WorkerLoop(); });
+        worker->setObjectName(QString("FFmpegImageSaver-%1").arg(i));
+        // Screenshots are never more urgent than the live display
+        worker->start(QThread::LowPriority);
+        workers_.push_back(worker);
+    }
+}
+
+void FFmpegImageSaver::Stop()
+{
+    std::vector<QThread*> workers;
+    {
+        QMutexLocker locker(&mutex_);
+        if (workers_.empty()) {
+            return;
+        }
+        stopping_ = true;
+        workers.swap(workers_);
+    }
+    queue_not_empty_.wakeAll();
+
+    // Workers drain the queue before exiting: a requested screenshot is not lost
+    for (QThread* worker : workers) {
+        worker->wait();
+        delete worker;
+    }
+
+    QMutexLocker locker(&mutex_);
+    stopping_ = false;
+}
+
+bool FFmpegImageSaver::SaveImage(const QString& path, const QImage& image, const QRect& region,
+                                 const ImageSaveOptions& options)
+{
+    if (image.isNull()) {
+        qCWarning(log_ffmpeg_backend) << "No frame available for image capture";
+        return false;
+    }
+
+    SaveJob job;
+    job.path = path;
+    job.image = image;  // Shallow copy; cropped on the worker
+    job.region = region;
+    job.options = options;
+    return Enqueue(std::move(job));
+}
+
+bool FFmpegImageSaver::SaveEncoded(const QString& path, const QByteArray& jpeg_data)
+{
+    if (jpeg_data.isEmpty()) {
+        return false;
+    }
+
+    SaveJob job;
+    job.path = path;
+    job.encoded = jpeg_data;
+    return Enqueue(std::move(job));
+}
+
+bool FFmpegImageSaver::SaveDecoded(const QString& path, std::function<QImage()> source, const QRect& region,
+                                   const ImageSaveOptions& options)
+{
+    if (!source) {
+        return false;
+    }
+
+    SaveJob job;
+    job.path = path;
+    job.source = std::move(source);
+    job.region = region;
+    job.options = options;
+    return Enqueue(std::move(job));
+}
+
+bool FFmpegImageSaver::Enqueue(SaveJob job)
+{
+    job.enqueue_us = FFmpegMonotonicTimeUs();
+    const QString path = job.path;
+    {
+        QMutexLocker locker(&mutex_);
+        if (!stopping_ && static_cast<int>(queue_.size()) < queue_capacity_) {
+            if (workers_.empty()) {
+                StartWorkers();
+            }
+            queue_.push_back(std::move(job));
+            queue_not_empty_.wakeOne();
+            return true;
+        }
+    }
+
+    rejected_.fetch_add(1, std::memory_order_relaxed);
+    qCWarning(log_ffmpeg_backend) << "Screenshot queue full, not saving" << path;
+    emit ImageSaved(path, false, 0, 0);
+    return false;
+}
+
+void FFmpegImageSaver::WorkerLoop()
+{
+    for (;;) {
+        SaveJob job;
+        {
+            QMutexLocker locker(&mutex_);
+            while (queue_.empty() && !stopping_) {
+                queue_not_empty_.wait(&mutex_);
+            }
+            if (queue_.empty()) {
+                return;  // Stopping and drained
+            }
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        const qint64 start_us = FFmpegMonotonicTimeUs();
+        const bool ok = RunJob(job);
+        const qint64 end_us = FFmpegMonotonicTimeUs();
+        const qint64 save_us = end_us - start_us;
+
+        if (ok) {
+            saved_.fetch_add(1, std::memory_order_relaxed);
+            if (!job.encoded.isEmpty()) {
+                passthrough_.fetch_add(1, std::memory_order_relaxed);
+            }
+            total_save_us_.fetch_add(save_us, std::memory_order_relaxed);
+            qint64 max_us = max_save_us_.load(std::memory_order_relaxed);
+            while (save_us > max_us &&
+                   !max_save_us_.compare_exchange_weak(max_us, save_us, std::memory_order_relaxed)) {
+            }
+        } else {
+            failed_.fetch_add(1, std::memory_order_relaxed);
+        }
+        emit ImageSaved(job.path, ok, start_us - job.enqueue_us, save_us);
+    }
+}
+
+bool FFmpegImageSaver::RunJob(const SaveJob& job)
+{
+    QSaveFile file(job.path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(log_ffmpeg_backend) << "Failed to open image file" << job.path << ":" << file.errorString();
+        return false;
+    }
+
+    if (!job.encoded.isEmpty()) {
+        // Passthrough: the capture card already produced a JPEG, no re-encode needed
+        if (file.write(job.encoded) != job.encoded.size() || !file.commit()) {
+            qCWarning(log_ffmpeg_backend) << "Failed to write JPEG passthrough image to:" << job.path;
+            return false;
+        }
+        qCDebug(log_ffmpeg_backend) << "Image saved (JPEG passthrough," << job.encoded.size()
+                                    << "bytes) to:" << job.path;
+        return true;
+    }
+
+    const QImage source = job.source ? job.source() : job.image;
+    if (source.isNull()) {
+        qCWarning(log_ffmpeg_backend) << "No frame available for image capture:" << job.path;
+        file.cancelWriting();
+        return false;
+    }
+    const QImage image = job.region.isNull() ? source : source.copy(job.region);
+    const QString format = ResolveFormat(job.path, job.options);
+    QImageWriter writer(&file, format.toLatin1());
+    writer.setQuality(qBound(0, job.options.quality, 100));
+    if (!writer.canWrite()) {
+        qCWarning(log_ffmpeg_backend) << "Image format" << format << "is not supported:" << writer.errorString();
+        file.cancelWriting();
+        return false;
+    }
+    if (!writer.write(image) || !file.commit()) {
+        qCWarning(log_ffmpeg_backend) << "Failed to save image to:" << job.path << writer.errorString();
+        return false;
+    }
+
+    qCDebug(log_ffmpeg_backend) << "Image saved (" << format << image.size() << ") to:" << job.path;
+    return true;
+}
+
+FFmpegImageSaver::Stats FFmpegImageSaver::GetStats() const
+{
+    Stats stats;
+    {
+        QMutexLocker locker(&mutex_);
+        stats.workers = static_cast<int>(workers_.size());
+        stats.queue_depth = static_cast<int>(queue_.size());
+        stats.queue_capacity = queue_capacity_;
+    }
+    stats.saved = saved_.load(std::memory_order_relaxed);
+    stats.passthrough = passthrough_.load(std::memory_order_relaxed);
+    stats.failed = failed_.load(std::memory_order_relaxed);
+    stats.rejected = rejected_.load(std::memory_order_relaxed);
+    if (stats.saved > 0) {
+        stats.avg_save_ms = total_save_us_.load(std::memory_order_relaxed) / 1000.0 / stats.saved;
+    }
+    stats.max_save_ms = max_save_us_.load(std::memory_order_relaxed) / 1000.0;
+    return stats;
+}
+
+QString FFmpegImageSaver::ResolveFormat(const QString& path, const ImageSaveOptions& options)
+{
+    QString format = options.format.isEmpty() ? QFileInfo(path).suffix() : options.format;
+    format = format.toLower();
+    if (format == "jpeg") {
+        return QStringLiteral("jpg");
+    }
+    if (format == "png" || format == "webp") {
+        return format;
+    }
+    return QStringLiteral("jpg");
+}
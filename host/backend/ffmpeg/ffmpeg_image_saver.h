@@ -0,0 +1,138 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#ifndef FFMPEG_IMAGE_SAVER_H
+#define FFMPEG_IMAGE_SAVER_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QRect>
+#include <QString>
+#include <QWaitCondition>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <vector>
+
+class QThread;
+
+// Output format and quality for a screenshot
+struct ImageSaveOptions {
+    QString format;      // "jpg", "png" or "webp"; empty = from the file suffix
+    int quality = 90;    // 0-100; for PNG Qt maps it to the compression level
+};
+
+/**
+ * @brief Background screenshot encoder and writer
+ *
+ * SaveImage() and SaveEncoded() only queue the job: cropping, JPEG/PNG/WebP
+ * encoding and the disk write run on a small pool of worker threads, so a 4K
+ * screenshot or a burst of them never blocks the GUI, scripts or input
+ * handling.  The queue is bounded; a job that does not fit is rejected at
+ * once (and reported through ImageSaved) rather than waited for.
+ *
+ * SaveEncoded() is the passthrough path: the capture card's own JPEG is
+ * written as-is, with no decode or re-encode.  SaveDecoded() takes a frame
+ * source instead of an image, so a frame that still has to be decoded is
+ * decoded on the worker too.
+ *
+ * Files are written through QSaveFile, so a reader never sees a partial
+ * image.  ImageSaved() is emitted from a worker thread once the file is on
+ * disk (or the save failed).
+ */
+class FFmpegImageSaver : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Stats {
+        int workers = 0;
+        int queue_depth = 0;
+        int queue_capacity = 0;
+        quint64 saved = 0;
+        quint64 passthrough = 0;     // Saved from the camera's JPEG without re-encoding
+        quint64 failed = 0;
+        quint64 rejected = 0;        // Queue was full
+        double avg_save_ms = 0.0;    // Crop + encode + write
+        double max_save_ms = 0.0;
+    };
+
+    static constexpr int kDefaultQueueCapacity = 8;
+    static constexpr int kDefaultWorkers = 2;
+
+    explicit FFmpegImageSaver(QObject* parent = nullptr);
+    ~FFmpegImageSaver() override;
+
+    // Workers start with the first job; Stop() finishes the queued ones first
+    void Stop();
+
+    // Saves image.copy(region) (the whole image if region is null)
+    bool SaveImage(const QString& path, const QImage& image, const QRect& region = QRect(),
+                   const ImageSaveOptions& options = ImageSaveOptions());
+    bool SaveEncoded(const QString& path, const QByteArray& jpeg_data);
+    // Like SaveImage(), with the image produced by `source` on a worker thread
+    bool SaveDecoded(const QString& path, std::function<QImage()> source, const QRect& region = QRect(),
+                     const ImageSaveOptions& options = ImageSaveOptions());
+
+    Stats GetStats() const;
+
+    // Normalised format for a path ("jpg", "png", "webp"), options.format first
+    static QString ResolveFormat(const QString& path, const ImageSaveOptions& options);
+
+signals:
+    void ImageSaved(const QString& path, bool success, qint64 queue_us, qint64 save_us);
+
+private:
+    struct SaveJob {
+        QString path;
+        QImage image;
+        std::function<QImage()> source;  // Produces `image` on the worker when set
+        QRect region;
+        QByteArray encoded;       // Passthrough when not empty
+        ImageSaveOptions options;
+        qint64 enqueue_us = 0;
+    };
+
+    bool Enqueue(SaveJob job);
+    void StartWorkers();
+    void WorkerLoop();
+    bool RunJob(const SaveJob& job);
+
+    mutable QMutex mutex_;
+    QWaitCondition queue_not_empty_;
+    std::deque<SaveJob> queue_;
+    std::vector<QThread*> workers_;
+    bool stopping_ = false;
+    const int queue_capacity_;
+    const int worker_count_;
+
+    std::atomic<quint64> saved_{0};
+    std::atomic<quint64> passthrough_{0};
+    std::atomic<quint64> failed_{0};
+    std::atomic<quint64> rejected_{0};
+    std::atomic<qint64> total_save_us_{0};
+    std::atomic<qint64> max_save_us_{0};
+};
+
+#endif // FFMPEG_IMAGE_SAVER_H
@@ -0,0 +1,140 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#include "ffmpeg_latency_tracer.h"
+#include "ffmpeg_clock.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QTextStream>
+
+FFmpegLatencyTracer::FFmpegLatencyTracer()
+{
+    window_start_us_.store(FFmpegMonotonicTimeUs(), std::memory_order_relaxed);
+}
+
+const char* FFmpegLatencyTracer::StageName(Stage stage)
+{
+    switch (stage) {
+    case Stage::Read: return "read";
+    case Stage::Queue: return "queue";
+    case Stage::Decode: return "decode";
+    case Stage::Reorder: return "reorder";
+    case Stage::Dispatch: return "dispatch";
+    case Stage::Present: return "present";
+    case Stage::Total: return "total";
+    case Stage::Count: break;
+    }
+    return "unknown";
+}
+
+void FFmpegLatencyTracer::Record(Stage stage, qint64 us)
+{
+    if (stage == Stage::Count) {
+        return;
+    }
+    histograms_[static_cast<int>(stage)].record(us);
+}
+
+void FFmpegLatencyTracer::FrameReceived(qint64 read_start_us, qint64 receive_us)
+{
+    pending_read_start_us_ = read_start_us;
+    pending_receive_us_ = receive_us;
+}
+
+void FFmpegLatencyTracer::FramePainted(qint64 paint_us)
+{
+    if (pending_receive_us_ < 0) {
+        return;  // Repaint without a new frame
+    }
+    Record(Stage::Present, paint_us - pending_receive_us_);
+    if (pending_read_start_us_ > 0) {
+        Record(Stage::Total, paint_us - pending_read_start_us_);
+    }
+    pending_read_start_us_ = -1;
+    pending_receive_us_ = -1;
+}
+
+FFmpegLatencyTracer::Snapshot FFmpegLatencyTracer::GetSnapshot() const
+{
+    Snapshot snapshot;
+    for (int stage = 0; stage < kStageCount; ++stage) {
+        snapshot.stages[stage] = histograms_[stage].summary();
+    }
+    snapshot.gate_drops = gate_drops_.load(std::memory_order_relaxed);
+    snapshot.window_ms = (FFmpegMonotonicTimeUs() - window_start_us_.load(std::memory_order_relaxed)) / 1000;
+    return snapshot;
+}
+
+void FFmpegLatencyTracer::Reset()
+{
+    for (LatencyHistogram& histogram : histograms_) {
+        histogram.reset();
+    }
+    gate_drops_.store(0, std::memory_order_relaxed);
+    window_start_us_.store(FFmpegMonotonicTimeUs(), std::memory_order_relaxed);
+}
+
+QString FFmpegLatencyTracer::FormatSummary(const Snapshot& snapshot)
+{
+    QString text = QStringLiteral("Latency p50/p95/p99 ms");
+    for (int stage = 0; stage < kStageCount; ++stage) {
+        const StageSummary& summary = snapshot.stages[stage];
+        if (summary.samples == 0) {
+            continue;
+        }
+        text += QString("\n%1: %2/%3/%4")
+            .arg(QLatin1String(StageName(static_cast<Stage>(stage))))
+            .arg(summary.p50_ms, 0, 'f', 1)
+            .arg(summary.p95_ms, 0, 'f', 1)
+            .arg(summary.p99_ms, 0, 'f', 1);
+    }
+    text += QString("\nGUI backpressure drops: %1").arg(snapshot.gate_drops);
+    return text;
+}
+
+bool FFmpegLatencyTracer::AppendCsv(const QString& path, const Snapshot& snapshot)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        return false;
+    }
+
+    QTextStream out(&file);
+    if (file.size() == 0) {
+        out << "timestamp,window_ms,stage,samples,p50_ms,p95_ms,p99_ms,max_ms,gate_drops\n";
+    }
+    const QString timestamp = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+    for (int stage = 0; stage < kStageCount; ++stage) {
+        const StageSummary& summary = snapshot.stages[stage];
+        out << timestamp << ','
+            << snapshot.window_ms << ','
+            << StageName(static_cast<Stage>(stage)) << ','
+            << summary.samples << ','
+            << QString::number(summary.p50_ms, 'f', 3) << ','
+            << QString::number(summary.p95_ms, 'f', 3) << ','
+            << QString::number(summary.p99_ms, 'f', 3) << ','
+            << QString::number(summary.max_ms, 'f', 3) << ','
+            << snapshot.gate_drops << '\n';
+    }
+    return out.status() == QTextStream::Ok;
+}
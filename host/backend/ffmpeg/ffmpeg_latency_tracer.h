@@ -0,0 +1,101 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#ifndef FFMPEG_LATENCY_TRACER_H
+#define FFMPEG_LATENCY_TRACER_H
+
+#include "../common/latencyhistogram.h"
+
+#include <QString>
+#include <array>
+#include <atomic>
+
+/**
+ * @brief Per-stage frame latency histograms for the FFmpeg display path
+ *
+ * Each frame reports how long it spent in every stage, from av_read_frame to
+ * the paint that put it on screen.  Samples go into one LatencyHistogram
+ * per stage using relaxed atomic increments only: recording costs a handful
+ * of instructions per stage and never takes a lock, so tracing stays on.
+ *
+ * GetSnapshot() and Reset() may race with Record(); a sample landing in between
+ * is attributed to either window, which is fine for statistics.
+ */
+class FFmpegLatencyTracer {
+public:
+    enum class Stage {
+        Read,       // av_read_frame, including live-edge discards
+        Queue,      // Packet waiting in the decode ring
+        Decode,     // Decoder worker
+        Reorder,    // Decoded frame waiting for an earlier sequence
+        Dispatch,   // Emitted by the delivery stage until the GUI slot runs
+        Present,    // GUI slot until the first paint showing the frame
+        Total,      // Read start until paint
+        Count
+    };
+
+    static constexpr int kStageCount = static_cast<int>(Stage::Count);
+
+    using StageSummary = LatencyHistogram::Summary;
+
+    struct Snapshot {
+        std::array<StageSummary, kStageCount> stages;
+        quint64 gate_drops = 0;   // Frames dropped because the GUI still had frames queued
+        qint64 window_ms = 0;     // Time covered since the last Reset()
+    };
+
+    FFmpegLatencyTracer();
+
+    FFmpegLatencyTracer(const FFmpegLatencyTracer&) = delete;
+    FFmpegLatencyTracer& operator=(const FFmpegLatencyTracer&) = delete;
+
+    void Record(Stage stage, qint64 us);
+    void RecordGateDrop() { gate_drops_.fetch_add(1, std::memory_order_relaxed); }
+
+    // GUI thread: a frame reached the video pane / was painted.  Only the
+    // newest received frame is measured; frames replaced before a paint
+    // never became visible.
+    void FrameReceived(qint64 read_start_us, qint64 receive_us);
+    void FramePainted(qint64 paint_us);
+
+    Snapshot GetSnapshot() const;
+    void Reset();
+
+    // One line per stage for the status bar tooltip
+    static QString FormatSummary(const Snapshot& snapshot);
+
+    // Appends one row per stage to `path` (header written for a new file)
+    static bool AppendCsv(const QString& path, const Snapshot& snapshot);
+
+    static const char* StageName(Stage stage);
+
+private:
+    std::array<LatencyHistogram, kStageCount> histograms_;
+    std::atomic<quint64> gate_drops_{0};
+    std::atomic<qint64> window_start_us_{0};
+
+    // Written and read on the GUI thread only
+    qint64 pending_read_start_us_ = -1;
+    qint64 pending_receive_us_ = -1;
+};
+
+#endif // FFMPEG_LATENCY_TRACER_H
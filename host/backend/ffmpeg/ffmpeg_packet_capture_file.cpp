@@ -0,0 +1,141 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#include "ffmpeg_packet_capture_file.h"
+
+#include <QDataStream>
+#include <QLoggingCategory>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+Q_DECLARE_LOGGING_CATEGORY(log_ffmpeg_backend)
+
+FFmpegPacketCaptureWriter::~FFmpegPacketCaptureWriter()
+{
+    Close();
+}
+
+bool FFmpegPacketCaptureWriter::Open(const QString& path, int codec_id, const QSize& resolution,
+                                     int fps_num, int fps_den)
+{
+    QMutexLocker locker(&mutex_);
+    if (file_.isOpen()) {
+        file_.close();
+    }
+
+    file_.setFileName(path);
+    if (!file_.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(log_ffmpeg_backend) << "Cannot open packet capture file" << path << ":" << file_.errorString();
+        return false;
+    }
+
+    QDataStream out(&file_);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.writeRawData(FFmpegPacketCaptureFormat::kMagic, sizeof(FFmpegPacketCaptureFormat::kMagic));
+    out << FFmpegPacketCaptureFormat::kVersion
+        << static_cast<qint32>(codec_id)
+        << static_cast<qint32>(resolution.width())
+        << static_cast<qint32>(resolution.height())
+        << static_cast<qint32>(fps_num)
+        << static_cast<qint32>(qMax(1, fps_den));
+    if (out.status() != QDataStream::Ok || file_.pos() != FFmpegPacketCaptureFormat::kHeaderSize) {
+        qCWarning(log_ffmpeg_backend) << "Cannot write packet capture header to" << path;
+        file_.close();
+        return false;
+    }
+
+    first_capture_us_ = -1;
+    packet_count_ = 0;
+    bytes_written_ = file_.pos();
+    qCInfo(log_ffmpeg_backend) << "Packet capture started:" << path << resolution
+                               << "@" << fps_num << "/" << fps_den;
+    return true;
+}
+
+void FFmpegPacketCaptureWriter::Close()
+{
+    QMutexLocker locker(&mutex_);
+    if (!file_.isOpen()) {
+        return;
+    }
+    file_.close();
+    qCInfo(log_ffmpeg_backend) << "Packet capture finished:" << file_.fileName()
+                               << packet_count_ << "packets," << bytes_written_ << "bytes";
+}
+
+bool FFmpegPacketCaptureWriter::IsOpen() const
+{
+    QMutexLocker locker(&mutex_);
+    return file_.isOpen();
+}
+
+bool FFmpegPacketCaptureWriter::Write(const AVPacket* packet, qint64 capture_us)
+{
+    if (!packet || !packet->data || packet->size <= 0) {
+        return false;
+    }
+
+    QMutexLocker locker(&mutex_);
+    if (!file_.isOpen()) {
+        return false;
+    }
+    if (first_capture_us_ < 0) {
+        first_capture_us_ = capture_us;
+    }
+
+    QDataStream out(&file_);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out << static_cast<qint64>(capture_us - first_capture_us_)
+        << static_cast<quint32>(packet->flags)
+        << static_cast<quint32>(packet->size);
+    out.writeRawData(reinterpret_cast<const char*>(packet->data), packet->size);
+    if (out.status() != QDataStream::Ok) {
+        // Disk full or similar: stop here; the reader ignores a truncated last record
+        qCWarning(log_ffmpeg_backend) << "Packet capture write failed, closing" << file_.fileName();
+        file_.close();
+        return false;
+    }
+
+    ++packet_count_;
+    bytes_written_ += FFmpegPacketCaptureFormat::kPacketHeaderSize + packet->size;
+    return true;
+}
+
+QString FFmpegPacketCaptureWriter::GetPath() const
+{
+    QMutexLocker locker(&mutex_);
+    return file_.fileName();
+}
+
+quint64 FFmpegPacketCaptureWriter::GetPacketCount() const
+{
+    QMutexLocker locker(&mutex_);
+    return packet_count_;
+}
+
+qint64 FFmpegPacketCaptureWriter::GetBytesWritten() const
+{
+    QMutexLocker locker(&mutex_);
+    return bytes_written_;
+}
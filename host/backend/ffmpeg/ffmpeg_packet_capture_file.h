@@ -0,0 +1,87 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#ifndef FFMPEG_PACKET_CAPTURE_FILE_H
+#define FFMPEG_PACKET_CAPTURE_FILE_H
+
+#include <QFile>
+#include <QMutex>
+#include <QSize>
+#include <QString>
+
+struct AVPacket;
+
+/**
+ * @brief Layout of packet capture files (*.otpkt)
+ *
+ * Compressed packets exactly as av_read_frame() returned them from the
+ * capture device, with their capture times, so a session can be replayed
+ * without hardware (FFmpegReplayFrameReader).  All fields little-endian:
+ *
+ *   header:  "OTPKTCAP" | u32 version | i32 AVCodecID | i32 width | i32 height
+ *            | i32 frame rate numerator | i32 frame rate denominator
+ *   packet:  i64 capture time (us, first packet = 0) | u32 flags | u32 size | data
+ */
+struct FFmpegPacketCaptureFormat {
+    static constexpr char kMagic[8] = { 'O', 'T', 'P', 'K', 'T', 'C', 'A', 'P' };
+    static constexpr char kFileSuffix[] = ".otpkt";
+    static constexpr quint32 kVersion = 1;
+    static constexpr int kHeaderSize = 8 + 4 * 6;  // Magic + six 32-bit fields
+    static constexpr int kPacketHeaderSize = 8 + 4 + 4;
+    static constexpr quint32 kMaxPacketSize = 64 * 1024 * 1024;  // Sanity limit when reading
+};
+
+/**
+ * @brief Records live capture packets into a packet capture file
+ *
+ * Write() is called from the capture thread; Open()/Close() from anywhere.
+ * Packets are appended through QFile's buffer, no codec work is involved.
+ */
+class FFmpegPacketCaptureWriter {
+public:
+    FFmpegPacketCaptureWriter() = default;
+    ~FFmpegPacketCaptureWriter();
+
+    FFmpegPacketCaptureWriter(const FFmpegPacketCaptureWriter&) = delete;
+    FFmpegPacketCaptureWriter& operator=(const FFmpegPacketCaptureWriter&) = delete;
+
+    // `codec_id` is an AVCodecID; frame rate is fps_num / fps_den
+    bool Open(const QString& path, int codec_id, const QSize& resolution, int fps_num, int fps_den = 1);
+    void Close();
+    bool IsOpen() const;
+
+    // `capture_us` is the FFmpegMonotonicTimeUs() read time of the packet
+    bool Write(const AVPacket* packet, qint64 capture_us);
+
+    QString GetPath() const;
+    quint64 GetPacketCount() const;
+    qint64 GetBytesWritten() const;
+
+private:
+    mutable QMutex mutex_;
+    QFile file_;
+    qint64 first_capture_us_ = -1;
+    quint64 packet_count_ = 0;
+    qint64 bytes_written_ = 0;
+};
+
+#endif // FFMPEG_PACKET_CAPTURE_FILE_H
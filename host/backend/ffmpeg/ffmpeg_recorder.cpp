@@ -21,6 +21,7 @@
 */
 
 #include "ffmpeg_recorder.h"
+#include "ffmpeg_clock.h"
 
 #include <QDebug>
 #include <QLoggingCategory>
@@ -28,8 +29,8 @@
 #include <QFileInfo>
 #include <QImage>
 #include <QThread>
-#include <QImage>
 #include <QRect> 
+#include <QElapsedTimer>
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -41,6 +42,11 @@ extern "C" {
 
 Q_DECLARE_LOGGING_CATEGORY(log_ffmpeg_backend)
 
+namespace {
+// Captured PCM the audio FIFO holds before the oldest audio is dropped
+constexpr int kAudioQueueMs = 2000;
+}
+
 FFmpegRecorder::FFmpegRecorder()
     : format_context_(nullptr),
       codec_context_(nullptr),
@@ -54,8 +60,28 @@ FFmpegRecorder::FFmpegRecorder()
       recording_paused_time_(0),
       total_paused_duration_(0),
       last_recorded_frame_time_(0),
+      recording_start_us_(0),
+      pause_started_us_(0),
+      total_paused_us_(0),
+      last_pts_(-1),
       recording_target_framerate_(30),
-      recording_frame_number_(0)
+      recording_frame_number_(0),
+      recording_frames_queued_(0),
+      audio_enabled_(false),
+      encoder_thread_(nullptr),
+      queue_capacity_(8),
+      drop_policy_(RecordingDropPolicy::DropOldest),
+      encoder_stopping_(false),
+      audio_queued_bytes_(0),
+      audio_queue_limit_bytes_(0),
+      frames_queued_total_(0),
+      frames_encoded_(0),
+      frames_dropped_(0),
+      encode_failures_(0),
+      frames_yuv_(0),
+      encode_total_us_(0),
+      encode_max_us_(0),
+      audio_overflow_samples_(0)
 {
 }
 
@@ -64,6 +90,7 @@ FFmpegRecorder::~FFmpegRecorder()
     if (recording_active_) {
         ForceStopRecording();
     }
+    StopEncoderThread(true);
     CleanupRecording();
 }
 
@@ -82,6 +109,7 @@ bool FFmpegRecorder::StartRecording(const QString& output_path, const QString& f
     recording_config_.format = format;
     recording_config_.video_bitrate = video_bitrate;
     recording_output_path_ = output_path;
+    stream_copy_ = recording_config_.stream_copy;
     
     qCDebug(log_ffmpeg_backend) << "Starting recording to:" << output_path << "format:" << format;
     
@@ -96,8 +124,26 @@ bool FFmpegRecorder::StartRecording(const QString& output_path, const QString& f
     total_paused_duration_ = 0;
     last_recorded_frame_time_ = 0;
     recording_frame_number_ = 0;
+    recording_frames_queued_ = 0;
+    recording_start_us_ = FFmpegMonotonicTimeUs();
+    pause_started_us_ = 0;
+    total_paused_us_ = 0;
+    last_pts_ = -1;
     
-    qCInfo(log_ffmpeg_backend) << "Recording started successfully";
+    {
+        QMutexLocker queue_locker(&queue_mutex_);
+        queue_capacity_ = qMax(1, recording_config_.encoder_queue_capacity);
+        drop_policy_ = recording_config_.drop_policy;
+        audio_input_ = recording_config_.audio_input;
+        audio_queue_limit_bytes_ = static_cast<qint64>(audio_input_.sample_rate) *
+                                   audio_input_.BytesPerFrame() * kAudioQueueMs / 1000;
+    }
+    ResetEncoderStats();
+    StartEncoderThread();
+    audio_enabled_ = audio_encoder_ && audio_encoder_->IsOpen();
+    
+    qCInfo(log_ffmpeg_backend) << "Recording started successfully, encoder queue:" << queue_capacity_
+                               << "drop policy:" << (drop_policy_ == RecordingDropPolicy::DropOldest ? "oldest" : "newest");
     return true;
 }
 
@@ -116,8 +162,8 @@ bool FFmpegRecorder::StopRecording()
         recording_paused_ = false;
     }
     
-    // Small delay to ensure no frames are being processed
-    QThread::msleep(10);
+    // Encode whatever is still queued, then join the encoder thread
+    StopEncoderThread(false);
     
     {
         QMutexLocker locker(&mutex_);
@@ -140,6 +186,7 @@ void FFmpegRecorder::PauseRecording()
     
     recording_paused_ = true;
     recording_paused_time_ = QDateTime::currentMSecsSinceEpoch();
+    pause_started_us_ = FFmpegMonotonicTimeUs();
     
     qCDebug(log_ffmpeg_backend) << "Recording paused";
 }
@@ -156,9 +203,14 @@ void FFmpegRecorder::ResumeRecording()
     if (recording_paused_time_ > 0) {
         total_paused_duration_ += QDateTime::currentMSecsSinceEpoch() - recording_paused_time_;
     }
+    if (pause_started_us_ > 0) {
+        // Frames captured after resume continue where the paused ones left off
+        total_paused_us_ += FFmpegMonotonicTimeUs() - pause_started_us_;
+    }
     
     recording_paused_ = false;
     recording_paused_time_ = 0;
+    pause_started_us_ = 0;
     
     qCDebug(log_ffmpeg_backend) << "Recording resumed";
 }
@@ -168,7 +220,11 @@ bool FFmpegRecorder::ForceStopRecording()
     qCDebug(log_ffmpeg_backend) << "Force stopping recording";
     recording_active_ = false;
     recording_paused_ = false;
-    CleanupRecording();
+    StopEncoderThread(true);
+    {
+        QMutexLocker locker(&mutex_);
+        CleanupRecording();
+    }
     return true;
 }
 
@@ -218,59 +274,421 @@ qint64 FFmpegRecorder::GetRecordingFileSize() const
     return file_info.size();
 }
 
-bool FFmpegRecorder::WriteFrame(const QImage& image)
+bool FFmpegRecorder::WriteFrame(const QImage& image, qint64 capture_us)
 {
     // Quick check without lock
-    if (!recording_active_ || recording_paused_ || image.isNull()) {
+    if (!recording_active_ || recording_paused_ || stream_copy_ || image.isNull()) {
         return false;
     }
     
-    // Convert image to RGB888 format if needed
-    QImage sourceImage = image;
-    if (image.format() != QImage::Format_RGB888) {
-        sourceImage = image.convertToFormat(QImage::Format_RGB888);
-        if (sourceImage.isNull()) {
-            return false;
-        }
+    QueuedFrame item;
+    item.image = image;  // Implicitly shared, no pixel copy
+    return EnqueueFrame(item, capture_us);
+}
+
+bool FFmpegRecorder::WriteYuvFrame(const AVFrame* frame, qint64 capture_us)
+{
+    if (!recording_active_ || recording_paused_ || stream_copy_ || !frame || !frame->data[0]) {
+        return false;
     }
     
-    // Debug logging for recording frame processing
-    static int recording_debug_count = 0;
-    qint64 current_time = QDateTime::currentMSecsSinceEpoch();
-    if (++recording_debug_count <= 10 || recording_debug_count % 30 == 0) {
+    // A new reference to the decoder's buffers: the planes are not copied
+    QueuedFrame item;
+    item.yuv_frame = av_frame_clone(frame);
+    if (!item.yuv_frame) {
+        return false;
+    }
+    return EnqueueFrame(item, capture_us);
+}
+
+bool FFmpegRecorder::WritePacket(const AVPacket* packet, qint64 capture_us)
+{
+    if (!recording_active_ || recording_paused_ || !stream_copy_ || !packet || packet->size <= 0) {
+        return false;
+    }
+    
+    // A new reference to the same buffer: the compressed frame is not copied
+    QueuedFrame item;
+    item.packet = av_packet_clone(packet);
+    if (!item.packet) {
+        return false;
+    }
+    return EnqueueFrame(item, capture_us);
+}
+
+bool FFmpegRecorder::EnqueueFrame(QueuedFrame& item, qint64 capture_us)
+{
+    if (capture_us <= 0) {
+        capture_us = FFmpegMonotonicTimeUs();
+    }
+    
+    // The timestamp is fixed here, on the delivery thread, so a pause that
+    // starts while the frame is still queued does not shift it
+    bool accepted = false;
+    {
         QMutexLocker locker(&mutex_);
-        qCDebug(log_ffmpeg_backend) << "Writing recording frame" << recording_debug_count 
-                                   << "- image size:" << sourceImage.size()
-                                   << "recording frame size:" << AV_FRAME_RAW(recording_frame_)->width << "x" << AV_FRAME_RAW(recording_frame_)->height
-                                   << "frame interval:" << (current_time - last_recorded_frame_time_) << "ms";
+        if (recording_active_ && !recording_paused_) {
+            item.timestamp_us = qMax<qint64>(0, capture_us - recording_start_us_ - total_paused_us_);
+            recording_frames_queued_++;
+            accepted = true;
+        }
+    }
+    
+    if (accepted) {
+        QMutexLocker locker(&queue_mutex_);
+        if (!encoder_thread_ || encoder_stopping_) {
+            accepted = false;
+        } else {
+            frames_queued_total_.fetch_add(1, std::memory_order_relaxed);
+            if (static_cast<int>(frame_queue_.size()) >= queue_capacity_) {
+                frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+                if (drop_policy_ == RecordingDropPolicy::DropNewest) {
+                    accepted = false;
+                } else {
+                    ReleaseQueuedFrame(frame_queue_.front());
+                    frame_queue_.pop_front();
+                }
+            }
+            if (accepted) {
+                frame_queue_.push_back(std::move(item));
+                item.packet = nullptr;  // Ownership moved to the queue
+                item.yuv_frame = nullptr;
+            }
+        }
+    }
+    
+    if (!accepted) {
+        ReleaseQueuedFrame(item);
+        return false;
+    }
+    queue_not_empty_.wakeOne();
+    return true;
+}
+
+void FFmpegRecorder::ReleaseQueuedFrame(QueuedFrame& item)
+{
+    av_packet_free(&item.packet);
+    av_frame_free(&item.yuv_frame);
+}
+
+void FFmpegRecorder::DiscardQueuedFrames()
+{
+    for (QueuedFrame& item : frame_queue_) {
+        ReleaseQueuedFrame(item);
+    }
+    frame_queue_.clear();
+    audio_queue_.clear();
+    audio_queued_bytes_ = 0;
+}
+
+bool FFmpegRecorder::WriteAudio(const char* data, qint64 size, qint64 capture_us)
+{
+    if (!audio_enabled_ || !recording_active_ || recording_paused_ || !data || size <= 0) {
+        return false;
+    }
+    
+    if (capture_us <= 0) {
+        capture_us = FFmpegMonotonicTimeUs();
     }
     
-    bool can_write_frame = false;
+    AudioChunk chunk;
     {
         QMutexLocker locker(&mutex_);
-        can_write_frame = recording_active_ && !recording_paused_ && recording_frame_ && sws_context_;
+        if (!recording_active_ || recording_paused_) {
+            return false;
+        }
+        chunk.timestamp_us = capture_us - recording_start_us_ - total_paused_us_;
+    }
+    chunk.pcm = QByteArray(data, static_cast<qsizetype>(size));
+    
+    {
+        QMutexLocker locker(&queue_mutex_);
+        if (!encoder_thread_ || encoder_stopping_) {
+            return false;
+        }
+        // Bounded: a stalled encoder costs audio, never memory or the capture thread
+        const int bytes_per_frame = audio_input_.BytesPerFrame();
+        while (!audio_queue_.empty() && audio_queued_bytes_ + size > audio_queue_limit_bytes_) {
+            audio_queued_bytes_ -= audio_queue_.front().pcm.size();
+            audio_overflow_samples_.fetch_add(audio_queue_.front().pcm.size() / bytes_per_frame,
+                                              std::memory_order_relaxed);
+            audio_queue_.pop_front();
+        }
+        audio_queued_bytes_ += size;
+        audio_queue_.push_back(std::move(chunk));
+    }
+    queue_not_empty_.wakeOne();
+    return true;
+}
+
+FFmpegRecorder::EncoderStats FFmpegRecorder::GetEncoderStats() const
+{
+    EncoderStats stats;
+    {
+        QMutexLocker locker(&queue_mutex_);
+        stats.queue_depth = static_cast<int>(frame_queue_.size());
+        stats.queue_capacity = queue_capacity_;
+    }
+    stats.queued = frames_queued_total_.load(std::memory_order_relaxed);
+    stats.encoded = frames_encoded_.load(std::memory_order_relaxed);
+    stats.dropped = frames_dropped_.load(std::memory_order_relaxed);
+    stats.encode_failures = encode_failures_.load(std::memory_order_relaxed);
+    stats.yuv_frames = frames_yuv_.load(std::memory_order_relaxed);
+    const quint64 samples = stats.encoded + stats.encode_failures;
+    stats.avg_encode_ms = samples > 0
+        ? encode_total_us_.load(std::memory_order_relaxed) / 1000.0 / samples
+        : 0.0;
+    stats.max_encode_ms = encode_max_us_.load(std::memory_order_relaxed) / 1000.0;
+    
+    // audio_encoder_ is created and destroyed under queue_mutex_, so the
+    // snapshot cannot race CleanupRecording() on another thread
+    QMutexLocker locker(&queue_mutex_);
+    stats.audio_enabled = audio_enabled_.load(std::memory_order_acquire) && audio_encoder_;
+    if (stats.audio_enabled) {
+        const qint64 bytes_per_second = static_cast<qint64>(audio_input_.sample_rate) *
+                                        audio_input_.BytesPerFrame();
+        stats.audio_queue_ms = bytes_per_second > 0
+            ? static_cast<int>(audio_queued_bytes_ * 1000 / bytes_per_second)
+            : 0;
+        const FFmpegAudioEncoder::Stats audio = audio_encoder_->GetStats();
+        stats.audio_frames_encoded = audio.frames_encoded;
+        stats.audio_underruns = audio.underruns;
+        stats.audio_samples_dropped = audio.samples_dropped +
+                                      audio_overflow_samples_.load(std::memory_order_relaxed);
+        stats.audio_drift_ms = audio.drift_ms;
+        stats.audio_max_drift_ms = audio.max_drift_ms;
+    }
+    return stats;
+}
+
+void FFmpegRecorder::ResetEncoderStats()
+{
+    frames_queued_total_.store(0, std::memory_order_relaxed);
+    frames_encoded_.store(0, std::memory_order_relaxed);
+    frames_dropped_.store(0, std::memory_order_relaxed);
+    encode_failures_.store(0, std::memory_order_relaxed);
+    frames_yuv_.store(0, std::memory_order_relaxed);
+    encode_total_us_.store(0, std::memory_order_relaxed);
+    encode_max_us_.store(0, std::memory_order_relaxed);
+    audio_overflow_samples_.store(0, std::memory_order_relaxed);
+    QMutexLocker locker(&queue_mutex_);
+    if (audio_encoder_) {
+        audio_encoder_->ResetStats();
+    }
+}
+
+void FFmpegRecorder::StartEncoderThread()
+{
+    StopEncoderThread(true);
+    
+    encoder_thread_ = QThread::create([this]() { EncoderLoop(); });
+    encoder_thread_->setObjectName(QStringLiteral("FFmpegRecordingEncoder"));
+    // Below the capture and decode threads: when the CPU is short, the
+    // recording drops frames instead of the live display
+    encoder_thread_->start(QThread::LowPriority);
+}
+
+void FFmpegRecorder::StopEncoderThread(bool discard_queued)
+{
+    QThread* thread = nullptr;
+    {
+        QMutexLocker locker(&queue_mutex_);
+        thread = encoder_thread_;
+        if (!thread) {
+            DiscardQueuedFrames();
+            return;
+        }
+        if (discard_queued) {
+            frames_dropped_.fetch_add(frame_queue_.size(), std::memory_order_relaxed);
+            DiscardQueuedFrames();
+        }
+        audio_enabled_ = false;
+        encoder_stopping_ = true;
     }
+    queue_not_empty_.wakeAll();
+    
+    thread->wait();
+    delete thread;
     
-    if (!can_write_frame) {
+    QMutexLocker locker(&queue_mutex_);
+    encoder_thread_ = nullptr;
+    encoder_stopping_ = false;
+    DiscardQueuedFrames();
+}
+
+void FFmpegRecorder::EncoderLoop()
+{
+    for (;;) {
+        QueuedFrame item;
+        std::deque<AudioChunk> audio;
+        bool have_frame = false;
+        {
+            QMutexLocker locker(&queue_mutex_);
+            while (frame_queue_.empty() && audio_queue_.empty() && !encoder_stopping_) {
+                queue_not_empty_.wait(&queue_mutex_);
+            }
+            if (frame_queue_.empty() && audio_queue_.empty()) {
+                break;  // Stopping and fully drained
+            }
+            audio.swap(audio_queue_);
+            audio_queued_bytes_ = 0;
+            if (!frame_queue_.empty()) {
+                item = std::move(frame_queue_.front());
+                frame_queue_.pop_front();
+                have_frame = true;
+            }
+        }
+        
+        if (audio_encoder_) {
+            for (const AudioChunk& chunk : audio) {
+                if (!audio_encoder_->Encode(chunk.pcm, chunk.timestamp_us)) {
+                    break;
+                }
+            }
+        }
+        if (!have_frame) {
+            continue;
+        }
+        
+        QElapsedTimer timer;
+        timer.start();
+        bool ok = false;
+        if (item.packet) {
+            ok = WritePacketToFile(item.packet, item.timestamp_us);
+            av_packet_free(&item.packet);
+        } else if (item.yuv_frame) {
+            ok = EncodeYuvFrame(item.yuv_frame, item.timestamp_us);
+            av_frame_free(&item.yuv_frame);
+        } else {
+            ok = EncodeQueuedFrame(item);
+        }
+        const qint64 elapsed_us = timer.nsecsElapsed() / 1000;
+        
+        encode_total_us_.fetch_add(static_cast<quint64>(elapsed_us), std::memory_order_relaxed);
+        qint64 current_max = encode_max_us_.load(std::memory_order_relaxed);
+        while (elapsed_us > current_max &&
+               !encode_max_us_.compare_exchange_weak(current_max, elapsed_us, std::memory_order_relaxed)) {
+        }
+        (ok ? frames_encoded_ : encode_failures_).fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool FFmpegRecorder::EncodeQueuedFrame(const QueuedFrame& item)
+{
+    // The encoder contexts belong to this thread between StartEncoderThread()
+    // and StopEncoderThread(), so no lock is held while encoding
+    if (!codec_context_ || !recording_frame_) {
         return false;
     }
     
-    // Fill frame with image data
-    const uint8_t* src_data[1] = { sourceImage.constBits() };
-    int src_linesize[1] = { static_cast<int>(sourceImage.bytesPerLine()) };
+    // Feed swscale the decoder's own layout; only exotic formats need a
+    // QImage conversion first
+    QImage source_image = item.image;
+    AVPixelFormat source_format;
+    switch (source_image.format()) {
+    case QImage::Format_RGB888:
+        source_format = AV_PIX_FMT_RGB24;
+        break;
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+        source_format = AV_PIX_FMT_RGB32;  // 0xAARRGGBB in native byte order
+        break;
+    case QImage::Format_RGBX8888:
+    case QImage::Format_RGBA8888:
+    case QImage::Format_RGBA8888_Premultiplied:
+        source_format = AV_PIX_FMT_RGBA;
+        break;
+    default:
+        source_image = source_image.convertToFormat(QImage::Format_RGB888);
+        source_format = AV_PIX_FMT_RGB24;
+        break;
+    }
+    if (source_image.isNull()) {
+        return false;
+    }
     
-    // Convert RGB to target pixel format for encoding
-    int scale_result = sws_scale(sws_context_, src_data, src_linesize, 0, sourceImage.height(),
-                              AV_FRAME_RAW(recording_frame_)->data, AV_FRAME_RAW(recording_frame_)->linesize);
+    AVFrame* frame = AV_FRAME_RAW(recording_frame_);
+    sws_context_ = sws_getCachedContext(sws_context_,
+        source_image.width(), source_image.height(), source_format,
+        frame->width, frame->height, static_cast<AVPixelFormat>(frame->format),
+        SWS_BICUBIC, nullptr, nullptr, nullptr);
+    if (!sws_context_) {
+        qCWarning(log_ffmpeg_backend) << "Failed to create scaling context for recording frame" << source_image.size();
+        return false;
+    }
     
-    if (scale_result != sourceImage.height()) {
-        qCWarning(log_ffmpeg_backend) << "sws_scale conversion warning: converted" << scale_result << "lines, expected" << sourceImage.height();
+    // The encoder may still reference the previous frame's buffers
+    if (av_frame_make_writable(frame) < 0) {
+        return false;
+    }
+    
+    const uint8_t* src_data[1] = { source_image.constBits() };
+    int src_linesize[1] = { static_cast<int>(source_image.bytesPerLine()) };
+    int scale_result = sws_scale(sws_context_, src_data, src_linesize, 0, source_image.height(),
+                                 frame->data, frame->linesize);
+    if (scale_result != frame->height) {
+        qCWarning(log_ffmpeg_backend) << "sws_scale conversion warning: converted" << scale_result << "lines, expected" << frame->height;
+    }
+    
+    return WriteFrameToFile(frame, NextPts(item.timestamp_us));
+}
+
+bool FFmpegRecorder::EncodeYuvFrame(AVFrame* source, qint64 timestamp_us)
+{
+    if (!codec_context_ || !recording_frame_) {
+        return false;
+    }
+    
+    AVFrame* frame = AV_FRAME_RAW(recording_frame_);
+    if (source->format == frame->format && source->width == frame->width && source->height == frame->height) {
+        // Encoder takes the decoder's planes as they are.  Drop the decoder's
+        // picture type: MJPEG marks every frame intra, which the encoder
+        // would otherwise honour with a keyframe per frame.
+        source->pict_type = AV_PICTURE_TYPE_NONE;
+        if (!WriteFrameToFile(source, NextPts(timestamp_us))) {
+            return false;
+        }
+        frames_yuv_.fetch_add(1, std::memory_order_relaxed);
+        return true;
     }
     
-    // Write frame to file
-    return WriteFrameToFile(AV_FRAME_RAW(recording_frame_));
+    // Chroma subsampling, range or size differ: YUV to YUV, still no RGB step
+    sws_context_ = sws_getCachedContext(sws_context_,
+        source->width, source->height, static_cast<AVPixelFormat>(source->format),
+        frame->width, frame->height, static_cast<AVPixelFormat>(frame->format),
+        SWS_BICUBIC, nullptr, nullptr, nullptr);
+    if (!sws_context_) {
+        qCWarning(log_ffmpeg_backend) << "Failed to create YUV scaling context for recording frame"
+                                      << source->width << "x" << source->height;
+        return false;
+    }
+    if (av_frame_make_writable(frame) < 0) {
+        return false;
+    }
+    int scale_result = sws_scale(sws_context_, source->data, source->linesize, 0, source->height,
+                                 frame->data, frame->linesize);
+    if (scale_result != frame->height) {
+        qCWarning(log_ffmpeg_backend) << "sws_scale conversion warning: converted" << scale_result << "lines, expected" << frame->height;
+    }
+    if (!WriteFrameToFile(frame, NextPts(timestamp_us))) {
+        return false;
+    }
+    frames_yuv_.fetch_add(1, std::memory_order_relaxed);
+    return true;
 }
 
+int64_t FFmpegRecorder::NextPts(qint64 timestamp_us)
+{
+    // PTS from the capture timestamp.  Two frames can round to the same
+    // tick when capture jitters; nudge forward so PTS stays strictly increasing.
+    int64_t pts = av_rescale_q(timestamp_us, AVRational{1, 1000000}, codec_context_->time_base);
+    if (pts <= last_pts_) {
+        pts = last_pts_ + 1;
+    }
+    last_pts_ = pts;
+    return pts;
+}
 
 bool FFmpegRecorder::ShouldWriteFrame(qint64 current_time_ms)
 {
@@ -284,8 +702,9 @@ bool FFmpegRecorder::ShouldWriteFrame(qint64 current_time_ms)
     qint64 elapsed_ms = current_time_ms - recording_start_time_ - total_paused_duration_;
     int64_t expected_frame_number = (elapsed_ms * recording_target_framerate_) / 1000;
     
-    // Write frame if we're behind or at the expected frame count
-    if (recording_frame_number_ <= expected_frame_number) {
+    // Write frame if we're behind or at the expected frame count.  Counts
+    // queued frames: the encoder thread may not have caught up yet.
+    if (recording_frames_queued_ <= expected_frame_number) {
         last_recorded_frame_time_ = current_time_ms;
         return true;
     }
@@ -294,7 +713,7 @@ bool FFmpegRecorder::ShouldWriteFrame(qint64 current_time_ms)
     static int skip_log_count = 0;
     if (++skip_log_count % 100 == 0) {
         qCDebug(log_ffmpeg_backend) << "Skipping frame - ahead of schedule:" 
-                                   << "recorded:" << recording_frame_number_ 
+                                   << "queued:" << recording_frames_queued_ 
                                    << "expected:" << expected_frame_number;
     }
     return false;
@@ -312,43 +731,29 @@ RecordingConfig FFmpegRecorder::GetRecordingConfig() const
     return recording_config_;
 }
 
-bool FFmpegRecorder::SupportsAdvancedRecording() const
+QStringList FFmpegRecorder::SupportedFormats(const QStringList& candidates)
 {
-    return true;
+    QStringList formats;
+    for (const QString& format : candidates) {
+        // Same lookup InitializeRecording() relies on: muxer name, else file extension
+        const QByteArray name = format.toUtf8();
+        const QByteArray file_name = "recording." + name;
+        if (av_guess_format(name.constData(), nullptr, nullptr) ||
+            av_guess_format(nullptr, file_name.constData(), nullptr)) {
+            formats.append(format);
+        }
+    }
+    return formats;
 }
 
-bool FFmpegRecorder::SupportsRecordingStats() const
+bool FFmpegRecorder::SupportsAdvancedRecording() const
 {
     return true;
 }
 
-void FFmpegRecorder::TakeImage(const QString& file_path, const QImage& image)
-{
-    if (image.isNull()) {
-        qCWarning(log_ffmpeg_backend) << "No frame available for image capture";
-        return;
-    }
-    
-    if (image.save(file_path, "JPG", 90)) {
-        qCDebug(log_ffmpeg_backend) << "Image saved to:" << file_path;
-    } else {
-        qCWarning(log_ffmpeg_backend) << "Failed to save image to:" << file_path;
-    }
-}
-
-void FFmpegRecorder::TakeAreaImage(const QString& file_path, const QImage& image, const QRect& capture_area)
+bool FFmpegRecorder::SupportsRecordingStats() const
 {
-    if (image.isNull()) {
-        qCWarning(log_ffmpeg_backend) << "No frame available for area image capture";
-        return;
-    }
-    
-    QImage cropped = image.copy(capture_area);
-    if (cropped.save(file_path, "JPG", 85)) {
-        qCDebug(log_ffmpeg_backend) << "Cropped image saved to:" << file_path;
-    } else {
-        qCWarning(log_ffmpeg_backend) << "Failed to save cropped image to:" << file_path;
-    }
+    return true;
 }
 
 bool FFmpegRecorder::InitializeRecording(const QSize& resolution, int framerate)
@@ -382,12 +787,25 @@ bool FFmpegRecorder::InitializeRecording(const QSize& resolution, int framerate)
         }
     }
     
-    qCDebug(log_ffmpeg_backend) << "Configuring encoder with resolution:" << resolution << "framerate:" << framerate;
+    qCDebug(log_ffmpeg_backend) << "Configuring" << (stream_copy_ ? "MJPEG stream copy" : "encoder")
+                               << "with resolution:" << resolution << "framerate:" << framerate;
     
-    if (!ConfigureEncoder(resolution, framerate)) {
+    if (stream_copy_ ? !ConfigureStreamCopy(resolution, framerate) : !ConfigureEncoder(resolution, framerate)) {
         return false;
     }
     
+    // Audio is optional: without it the recording continues video-only
+    if (recording_config_.record_audio) {
+        auto audio_encoder = std::make_unique<FFmpegAudioEncoder>();
+        if (audio_encoder->Open(format_context_, recording_config_.audio_codec, recording_config_.audio_bitrate,
+                                recording_config_.audio_sample_rate, recording_config_.audio_input)) {
+            QMutexLocker queue_locker(&queue_mutex_);
+            audio_encoder_ = std::move(audio_encoder);
+        } else {
+            qCWarning(log_ffmpeg_backend) << "Audio encoder unavailable, recording video only";
+        }
+    }
+    
     // Open output file
     if (!(format_context_->oformat->flags & AVFMT_NOFILE)) {
         ret = avio_open(&format_context_->pb, recording_config_.output_path.toUtf8().data(), AVIO_FLAG_WRITE);
@@ -562,22 +980,44 @@ bool FFmpegRecorder::ConfigureEncoder(const QSize& resolution, int framerate)
     return true;
 }
 
-bool FFmpegRecorder::WriteFrameToFile(AVFrame* frame)
+bool FFmpegRecorder::ConfigureStreamCopy(const QSize& resolution, int framerate)
 {
-    QMutexLocker locker(&mutex_);
-    
-    // Quick check recording state
-    if (!recording_active_ || recording_paused_ || !codec_context_ || !frame 
-        || !format_context_ || !video_stream_ || !recording_packet_) {
+    // No codec context: packets go straight from the capture device to the muxer
+    video_stream_ = avformat_new_stream(format_context_, nullptr);
+    if (!video_stream_) {
+        qCWarning(log_ffmpeg_backend) << "Failed to create video stream for stream copy";
         return false;
     }
     
-    // Calculate PTS based on actual elapsed time for proper A/V synchronization
-    qint64 current_time = QDateTime::currentMSecsSinceEpoch();
-    qint64 elapsed_ms = current_time - recording_start_time_ - total_paused_duration_;
+    AVCodecParameters* params = video_stream_->codecpar;
+    params->codec_type = AVMEDIA_TYPE_VIDEO;
+    params->codec_id = AV_CODEC_ID_MJPEG;
+    params->codec_tag = 0;  // Let the muxer pick its own tag (MJPG for AVI)
+    params->width = resolution.width();
+    params->height = resolution.height();
+    
+    // AVI indexes by frame number, so it needs a frame-based time base.
+    // Matroska timestamps are milliseconds anyway.
+    const bool frame_based = qstrcmp(format_context_->oformat->name, "avi") == 0;
+    video_stream_->time_base = frame_based ? AVRational{1, framerate} : AVRational{1, 1000};
+    video_stream_->avg_frame_rate = AVRational{framerate, 1};
+    
+    recording_target_framerate_ = framerate;
+    
+    qCDebug(log_ffmpeg_backend) << "MJPEG stream copy configured"
+                               << "Resolution:" << resolution
+                               << "Framerate:" << framerate
+                               << "Muxer:" << format_context_->oformat->name;
+    return true;
+}
+
+bool FFmpegRecorder::WriteFrameToFile(AVFrame* frame, int64_t pts)
+{
+    // Runs on the encoder thread, which owns the contexts while recording
+    if (!codec_context_ || !frame || !format_context_ || !video_stream_ || !recording_packet_) {
+        return false;
+    }
     
-    // Convert elapsed milliseconds to PTS using the codec's time base
-    int64_t pts = av_rescale_q(elapsed_ms, AVRational{1, 1000}, codec_context_->time_base);
     frame->pts = pts;
     
     // Debug logging for first few frames
@@ -585,7 +1025,6 @@ bool FFmpegRecorder::WriteFrameToFile(AVFrame* frame)
     if (++debug_frame_count <= 5 || debug_frame_count % 100 == 0) {
         qCDebug(log_ffmpeg_backend) << "Writing frame" << recording_frame_number_ 
                                    << "with PTS" << pts 
-                                   << "(elapsed:" << elapsed_ms << "ms)"
                                    << "time_base" << codec_context_->time_base.num << "/" << codec_context_->time_base.den;
     }
     
@@ -612,13 +1051,6 @@ bool FFmpegRecorder::WriteFrameToFile(AVFrame* frame)
             return false;
         }
         
-        // Check if we're still recording
-        if (!recording_active_ || !format_context_) {
-            qCDebug(log_ffmpeg_backend) << "Recording stopped during packet processing, discarding packet";
-            av_packet_unref(AV_PACKET_RAW(recording_packet_));
-            return false;
-        }
-        
         // Scale packet timestamp
         av_packet_rescale_ts(AV_PACKET_RAW(recording_packet_), codec_context_->time_base, video_stream_->time_base);
         AV_PACKET_RAW(recording_packet_)->stream_index = video_stream_->index;
@@ -639,16 +1071,52 @@ bool FFmpegRecorder::WriteFrameToFile(AVFrame* frame)
     return true;
 }
 
+bool FFmpegRecorder::WritePacketToFile(AVPacket* packet, qint64 timestamp_us)
+{
+    // Runs on the encoder thread, which owns the contexts while recording
+    if (!format_context_ || !video_stream_ || !packet) {
+        return false;
+    }
+    
+    // avformat_write_header() may have replaced the requested time base
+    const AVRational time_base = video_stream_->time_base;
+    int64_t pts = av_rescale_q(timestamp_us, AVRational{1, 1000000}, time_base);
+    if (pts <= last_pts_) {
+        pts = last_pts_ + 1;
+    }
+    last_pts_ = pts;
+    
+    // Every MJPEG frame is a keyframe.  "AVI1" frames without Huffman tables
+    // are stored unchanged; that is the normal form of MJPEG in AVI/MKV.
+    packet->pts = pts;
+    packet->dts = pts;
+    packet->duration = av_rescale_q(1, AVRational{1, recording_target_framerate_}, time_base);
+    packet->pos = -1;
+    packet->stream_index = video_stream_->index;
+    packet->flags |= AV_PKT_FLAG_KEY;
+    
+    recording_frame_number_++;
+    
+    int ret = av_interleaved_write_frame(format_context_, packet);
+    if (ret < 0) {
+        char errbuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
+        qCWarning(log_ffmpeg_backend) << "Error writing stream-copy packet:" << QString::fromUtf8(errbuf);
+        return false;
+    }
+    return true;
+}
+
 void FFmpegRecorder::FinalizeRecording()
 {
-    if (!format_context_ || !codec_context_) {
+    if (!format_context_) {
         qCDebug(log_ffmpeg_backend) << "Recording context already cleaned up, skipping finalization";
         return;
     }
     
     qCDebug(log_ffmpeg_backend) << "Finalizing recording...";
     
-    // Flush encoder - send NULL frame to signal end of input
+    // Flush encoder - send NULL frame to signal end of input (none in stream-copy mode)
     if (codec_context_) {
         int ret = avcodec_send_frame(codec_context_, nullptr);
         if (ret < 0 && ret != AVERROR_EOF) {
@@ -679,6 +1147,10 @@ void FFmpegRecorder::FinalizeRecording()
         }
     }
     
+    if (audio_encoder_) {
+        audio_encoder_->Flush();
+    }
+    
     // Write trailer
     if (format_context_) {
         int ret = av_write_trailer(format_context_);
@@ -694,6 +1166,13 @@ void FFmpegRecorder::FinalizeRecording()
 
 void FFmpegRecorder::CleanupRecording()
 {
+    {
+        // GetEncoderStats() reads the encoder under queue_mutex_ from other threads
+        QMutexLocker queue_locker(&queue_mutex_);
+        audio_enabled_ = false;
+        audio_encoder_.reset();  // Before the format context that owns its stream
+    }
+    
     if (sws_context_) {
         sws_freeContext(sws_context_);
         sws_context_ = nullptr;
@@ -24,11 +24,17 @@
 #define FFMPEG_RECORDER_H
 
 #include <QString>
+#include <QStringList>
 #include <QSize>
 #include <QMutex>
+#include <QWaitCondition>
 #include <memory>
 #include <QImage>
 #include <QRect>
+#include <atomic>
+#include <deque>
+
+class QThread;
 
 // Forward declarations for FFmpeg types
 extern "C" {
@@ -42,6 +48,13 @@ struct AVPacket;
 
 // FFmpeg unique_ptr helpers
 #include "ffmpegutils.h"
+#include "ffmpeg_audio_encoder.h"
+
+// What the encoder queue does when a frame arrives and it is full
+enum class RecordingDropPolicy {
+    DropOldest,   // Discard the oldest queued frame (recording stays close to live)
+    DropNewest    // Discard the incoming frame (queued frames are never lost)
+};
 
 // RecordingConfig definition
 struct RecordingConfig {
@@ -51,6 +64,14 @@ struct RecordingConfig {
     int video_bitrate = 2000000;
     int video_quality = 23;
     bool use_hardware_acceleration = false;
+    int encoder_queue_capacity = 8;   // Frames waiting for the encoder thread
+    RecordingDropPolicy drop_policy = RecordingDropPolicy::DropOldest;
+    bool stream_copy = false;         // Remux the camera's MJPEG packets, no decode or encode (video_codec "copy")
+    bool record_audio = false;        // Mux the PCM passed to WriteAudio()
+    QString audio_codec = "aac";      // aac, opus, mp3, flac or pcm
+    int audio_bitrate = 128000;
+    int audio_sample_rate = 48000;    // Encoder rate; the input is resampled when it differs
+    FFmpegAudioEncoder::InputFormat audio_input;
 };
 
 /**
@@ -59,10 +80,48 @@ struct RecordingConfig {
  * This class encapsulates all video recording logic extracted from FFmpegBackendHandler.
  * It manages FFmpeg recording contexts, encoding, and file writing.
  * Follows Google C++ style guide with lowercase_with_underscores_ naming.
+ *
+ * WriteFrame() only queues the frame: pixel conversion, encoding and muxing
+ * run on a dedicated encoder thread, so a slow encoder or disk can never
+ * stall frame delivery.  The queue is bounded (see RecordingConfig) and
+ * timestamps come from the capture time of each frame, not from when the
+ * encoder got round to it.
+ *
+ * WriteYuvFrame() queues the software decoder's own YUV frame instead: the
+ * encoder thread hands it to the encoder as-is when layout and size match,
+ * or converts YUV to YUV otherwise, so no RGB round trip is involved.
+ *
+ * In stream-copy mode (RecordingConfig::stream_copy) the compressed MJPEG
+ * packets from the capture device are queued through WritePacket() and
+ * remuxed as-is: full native resolution, bit-exact, and no codec work at all.
+ *
+ * With RecordingConfig::record_audio, PCM from the audio capture path goes
+ * through WriteAudio() into a bounded FIFO of its own; the encoder thread
+ * encodes it (FFmpegAudioEncoder) into the same file.  Audio chunks and video
+ * frames are both stamped on the FFmpegMonotonicTimeUs() clock.
  */
 class FFmpegRecorder
 {
 public:
+    struct EncoderStats {
+        int queue_depth = 0;
+        int queue_capacity = 0;
+        quint64 queued = 0;
+        quint64 encoded = 0;
+        quint64 dropped = 0;          // Frames discarded because the queue was full
+        quint64 encode_failures = 0;
+        quint64 yuv_frames = 0;       // Encoded from the decoder's YUV planes
+        double avg_encode_ms = 0.0;   // Conversion + encode + mux per frame
+        double max_encode_ms = 0.0;
+        bool audio_enabled = false;
+        int audio_queue_ms = 0;       // PCM waiting for the encoder thread
+        quint64 audio_frames_encoded = 0;
+        quint64 audio_underruns = 0;  // Capture gaps filled with silence
+        quint64 audio_samples_dropped = 0;  // FIFO overflow + drift correction
+        double audio_drift_ms = 0.0;  // Capture clock minus audio sample clock
+        double audio_max_drift_ms = 0.0;
+    };
+
     FFmpegRecorder();
     ~FFmpegRecorder();
 
@@ -82,20 +141,36 @@ public:
     qint64 GetRecordingFileSize() const;
     
     // Frame writing
-    bool WriteFrame(const QImage& image);  // Thread-safe overload
+    // Queues `image` for the encoder thread.  `capture_us` is the
+    // FFmpegMonotonicTimeUs() capture time (0 = now).  Returns false when
+    // the frame was not accepted (not recording, or dropped as the newest).
+    bool WriteFrame(const QImage& image, qint64 capture_us = 0);
+    // Same as WriteFrame() for a decoded YUV frame; queues a new reference,
+    // the caller keeps its frame.
+    bool WriteYuvFrame(const AVFrame* frame, qint64 capture_us = 0);
+    // Stream-copy counterpart of WriteFrame(): queues a reference to the
+    // camera's MJPEG packet (the caller keeps its packet).
+    bool WritePacket(const AVPacket* packet, qint64 capture_us = 0);
+    // Queues interleaved PCM in the RecordingConfig::audio_input layout.
+    // Never blocks: when the audio FIFO is full the oldest audio is dropped.
+    bool WriteAudio(const char* data, qint64 size, qint64 capture_us = 0);
+    bool IsRecordingAudio() const { return audio_enabled_.load(std::memory_order_acquire); }
     bool ShouldWriteFrame(qint64 current_time_ms);
+    bool IsStreamCopy() const { return stream_copy_.load(std::memory_order_acquire); }
+    EncoderStats GetEncoderStats() const;
+    void ResetEncoderStats();
     
     // Configuration
     void SetRecordingConfig(const RecordingConfig& config);
     RecordingConfig GetRecordingConfig() const;
     
+    // Container formats (file extensions) from `candidates` whose muxer is
+    // compiled into the linked FFmpeg, in the same order
+    static QStringList SupportedFormats(const QStringList& candidates);
+    
     // Advanced features
     bool SupportsAdvancedRecording() const;
     bool SupportsRecordingStats() const;
-    
-    // Image capture
-    void TakeImage(const QString& file_path, const QImage& image);  // Thread-safe overload
-    void TakeAreaImage(const QString& file_path, const QImage& image, const QRect& capture_area);  // Thread-safe overload
 
 private:
     // Initialization and cleanup
@@ -105,9 +180,32 @@ private:
     
     // Encoder configuration
     bool ConfigureEncoder(const QSize& resolution, int framerate);
+    bool ConfigureStreamCopy(const QSize& resolution, int framerate);
+    
+    // Encoder thread
+    struct QueuedFrame {
+        QImage image;
+        AVPacket* packet = nullptr;   // Stream copy only; owned by the queue
+        AVFrame* yuv_frame = nullptr; // Decoded YUV instead of `image`; owned by the queue
+        qint64 timestamp_us = 0;      // Capture time relative to recording start, pauses excluded
+    };
+    bool EnqueueFrame(QueuedFrame& item, qint64 capture_us);  // Releases packet/frame if rejected
+    static void ReleaseQueuedFrame(QueuedFrame& item);
+    void DiscardQueuedFrames();       // Caller holds queue_mutex_
+    struct AudioChunk {
+        QByteArray pcm;
+        qint64 timestamp_us = 0;      // Capture time of the last sample, same clock as video
+    };
+    void StartEncoderThread();
+    void StopEncoderThread(bool discard_queued);
+    void EncoderLoop();
+    bool EncodeQueuedFrame(const QueuedFrame& item);
+    bool EncodeYuvFrame(AVFrame* source, qint64 timestamp_us);
+    int64_t NextPts(qint64 timestamp_us);
     
     // Frame writing
-    bool WriteFrameToFile(AVFrame* frame);
+    bool WriteFrameToFile(AVFrame* frame, int64_t pts);
+    bool WritePacketToFile(AVPacket* packet, qint64 timestamp_us);
     
     // Recording contexts
     AVFormatContext* format_context_;
@@ -123,9 +221,12 @@ private:
     AVPacket* recording_packet_;
 #endif
     
-    // Recording state
-    bool recording_active_;
-    bool recording_paused_;
+    // Recording state (flags are read without the lock on the delivery path)
+    std::atomic<bool> recording_active_;
+    std::atomic<bool> recording_paused_;
+    std::atomic<bool> stream_copy_;
+    std::atomic<bool> audio_enabled_;
+    std::unique_ptr<FFmpegAudioEncoder> audio_encoder_;
     QString recording_output_path_;
     RecordingConfig recording_config_;
     
@@ -135,9 +236,39 @@ private:
     qint64 total_paused_duration_;
     qint64 last_recorded_frame_time_;
     
+    // Capture-clock timing used for PTS (microseconds, FFmpegMonotonicTimeUs)
+    qint64 recording_start_us_;
+    qint64 pause_started_us_;
+    qint64 total_paused_us_;
+    int64_t last_pts_;                // Encoder thread only
+    
     // Frame tracking
     int recording_target_framerate_;
-    int64_t recording_frame_number_;
+    int64_t recording_frame_number_;  // Frames encoded (encoder thread)
+    int64_t recording_frames_queued_; // Frames accepted by WriteFrame
+    
+    // Encoder queue
+    QThread* encoder_thread_;
+    mutable QMutex queue_mutex_;
+    QWaitCondition queue_not_empty_;
+    std::deque<QueuedFrame> frame_queue_;
+    std::deque<AudioChunk> audio_queue_;
+    qint64 audio_queued_bytes_;
+    qint64 audio_queue_limit_bytes_;
+    FFmpegAudioEncoder::InputFormat audio_input_;
+    int queue_capacity_;
+    RecordingDropPolicy drop_policy_;
+    bool encoder_stopping_;
+    
+    // Encoder statistics
+    std::atomic<quint64> frames_queued_total_;
+    std::atomic<quint64> frames_encoded_;
+    std::atomic<quint64> frames_dropped_;
+    std::atomic<quint64> encode_failures_;
+    std::atomic<quint64> frames_yuv_;
+    std::atomic<quint64> encode_total_us_;
+    std::atomic<qint64> encode_max_us_;
+    std::atomic<quint64> audio_overflow_samples_;
     
     // Thread safety
     mutable QMutex mutex_;
@@ -0,0 +1,237 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#include "ffmpeg_replay_frame_reader.h"
+#include "ffmpeg_clock.h"
+#include "ffmpeg_packet_capture_file.h"
+
+#include <QLoggingCategory>
+#include <QThread>
+#include <QtEndian>
+#include <cstring>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+Q_DECLARE_LOGGING_CATEGORY(log_ffmpeg_backend)
+
+FFmpegReplayFrameReader::FFmpegReplayFrameReader()
+{
+}
+
+FFmpegReplayFrameReader::~FFmpegReplayFrameReader()
+{
+    Close();
+}
+
+bool FFmpegReplayFrameReader::Open(const QString& path, Timing timing, bool loop)
+{
+    Close();
+    last_error_.clear();
+
+    file_.setFileName(path);
+    if (!file_.open(QIODevice::ReadOnly)) {
+        last_error_ = QString("Cannot open %1: %2").arg(path, file_.errorString());
+        return false;
+    }
+    data_size_ = file_.size();
+    data_ = data_size_ > 0 ? file_.map(0, data_size_) : nullptr;
+    if (!data_) {
+        last_error_ = QString("Cannot map %1").arg(path);
+        Close();
+        return false;
+    }
+
+    if (data_size_ < FFmpegPacketCaptureFormat::kHeaderSize ||
+        std::memcmp(data_, FFmpegPacketCaptureFormat::kMagic, sizeof(FFmpegPacketCaptureFormat::kMagic)) != 0) {
+        last_error_ = QString("%1 is not a packet capture file").arg(path);
+        Close();
+        return false;
+    }
+    const uchar* header = data_ + sizeof(FFmpegPacketCaptureFormat::kMagic);
+    const quint32 version = qFromLittleEndian<quint32>(header);
+    if (version != FFmpegPacketCaptureFormat::kVersion) {
+        last_error_ = QString("Unsupported packet capture version %1").arg(version);
+        Close();
+        return false;
+    }
+    const int codec_id = qFromLittleEndian<qint32>(header + 4);
+    resolution_ = QSize(qFromLittleEndian<qint32>(header + 8), qFromLittleEndian<qint32>(header + 12));
+    fps_num_ = qFromLittleEndian<qint32>(header + 16);
+    fps_den_ = qMax(1, qFromLittleEndian<qint32>(header + 20));
+
+    if (!BuildIndex() || !OpenDecoder(codec_id)) {
+        Close();
+        return false;
+    }
+
+    packet_ = av_packet_alloc();
+    if (!packet_) {
+        last_error_ = QStringLiteral("Cannot allocate packet");
+        Close();
+        return false;
+    }
+
+    timing_ = timing;
+    loop_ = loop;
+    Rewind();
+    qCInfo(log_ffmpeg_backend) << "Replaying" << path << "-" << index_.size() << "packets,"
+                               << resolution_ << "@" << GetFrameRate() << "fps,"
+                               << (timing == Timing::Original ? "original timing" : "max speed");
+    return true;
+}
+
+void FFmpegReplayFrameReader::Close()
+{
+    if (codec_context_) {
+        avcodec_free_context(&codec_context_);
+    }
+    if (packet_) {
+        av_packet_free(&packet_);
+    }
+    if (data_) {
+        file_.unmap(data_);
+        data_ = nullptr;
+    }
+    if (file_.isOpen()) {
+        file_.close();
+    }
+    data_size_ = 0;
+    index_.clear();
+    resolution_ = QSize();
+    fps_num_ = 0;
+    fps_den_ = 1;
+}
+
+void FFmpegReplayFrameReader::Rewind()
+{
+    next_ = 0;
+    replay_start_us_ = -1;
+    loop_offset_us_ = 0;
+}
+
+bool FFmpegReplayFrameReader::BuildIndex()
+{
+    qint64 offset = FFmpegPacketCaptureFormat::kHeaderSize;
+    while (offset + FFmpegPacketCaptureFormat::kPacketHeaderSize <= data_size_) {
+        const uchar* record = data_ + offset;
+        IndexEntry entry;
+        entry.capture_us = qFromLittleEndian<qint64>(record);
+        entry.flags = qFromLittleEndian<quint32>(record + 8);
+        entry.size = qFromLittleEndian<quint32>(record + 12);
+        entry.offset = offset + FFmpegPacketCaptureFormat::kPacketHeaderSize;
+        if (entry.size == 0 || entry.size > FFmpegPacketCaptureFormat::kMaxPacketSize ||
+            entry.offset + entry.size > data_size_) {
+            break;  // Truncated final record (capture was interrupted)
+        }
+        index_.push_back(entry);
+        offset = entry.offset + entry.size;
+    }
+
+    if (index_.empty()) {
+        last_error_ = QStringLiteral("Packet capture file contains no packets");
+        return false;
+    }
+    return true;
+}
+
+bool FFmpegReplayFrameReader::OpenDecoder(int codec_id)
+{
+    const AVCodec* codec = avcodec_find_decoder(static_cast<AVCodecID>(codec_id));
+    if (!codec) {
+        last_error_ = QString("No decoder for codec id %1").arg(codec_id);
+        return false;
+    }
+    codec_context_ = avcodec_alloc_context3(codec);
+    if (!codec_context_) {
+        last_error_ = QStringLiteral("Cannot allocate decoder context");
+        return false;
+    }
+
+    // Same low-latency settings FFmpegDeviceManager uses for the live device
+    codec_context_->width = resolution_.width();
+    codec_context_->height = resolution_.height();
+    codec_context_->flags |= AV_CODEC_FLAG_LOW_DELAY;
+    codec_context_->thread_count = qMax(1, QThread::idealThreadCount());
+    codec_context_->thread_type = FF_THREAD_SLICE;
+
+    int ret = avcodec_open2(codec_context_, codec, nullptr);
+    if (ret < 0) {
+        char errbuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
+        last_error_ = QString("Cannot open decoder: %1").arg(QString::fromUtf8(errbuf));
+        return false;
+    }
+    return true;
+}
+
+double FFmpegReplayFrameReader::GetFrameRate() const
+{
+    return fps_num_ > 0 ? static_cast<double>(fps_num_) / fps_den_ : 0.0;
+}
+
+qint64 FFmpegReplayFrameReader::GetDurationUs() const
+{
+    return index_.empty() ? 0 : index_.back().capture_us;
+}
+
+bool FFmpegReplayFrameReader::readFrame()
+{
+    if (!data_ || !packet_ || index_.empty()) {
+        return false;
+    }
+    if (next_ >= index_.size()) {
+        if (!loop_) {
+            return false;
+        }
+        // Keep the cadence across the wrap: the first packet follows the last
+        // one after a normal frame interval
+        const double fps = GetFrameRate();
+        loop_offset_us_ += GetDurationUs() + (fps > 0.0 ? static_cast<qint64>(1e6 / fps) : 33333);
+        next_ = 0;
+    }
+
+    const IndexEntry& entry = index_[next_++];
+    const qint64 start_us = FFmpegMonotonicTimeUs();
+    if (timing_ == Timing::Original) {
+        if (replay_start_us_ < 0) {
+            replay_start_us_ = start_us;
+        }
+        const qint64 due_us = replay_start_us_ + loop_offset_us_ + entry.capture_us;
+        if (due_us > start_us) {
+            QThread::usleep(static_cast<unsigned long>(due_us - start_us));  // Device not ready yet
+        }
+    }
+
+    // A private copy, as av_read_frame() hands out
+    av_packet_unref(packet_);
+    if (av_new_packet(packet_, static_cast<int>(entry.size)) < 0) {
+        return false;
+    }
+    std::memcpy(packet_->data, data_ + entry.offset, entry.size);
+    packet_->flags = static_cast<int>(entry.flags);
+    packet_->pts = packet_->dts = loop_offset_us_ + entry.capture_us;  // Microseconds
+
+    last_read_us_ = FFmpegMonotonicTimeUs() - start_us;
+    return true;
+}
@@ -0,0 +1,109 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#ifndef FFMPEG_REPLAY_FRAME_READER_H
+#define FFMPEG_REPLAY_FRAME_READER_H
+
+#include <QFile>
+#include <QSize>
+#include <QString>
+#include <vector>
+#include "icapture_frame_reader.h"
+
+struct AVPacket;
+struct AVCodecContext;
+
+/**
+ * @brief Capture source that replays a packet capture file
+ *
+ * Stands in for FFmpegCaptureManager when no Openterface is attached: the
+ * file (see FFmpegPacketCaptureFormat) is memory-mapped and indexed once,
+ * and readFrame() copies the next packet into GetPacket() the way
+ * av_read_frame() would.
+ *
+ * Timing::Original sleeps until each packet's recorded capture time, so the
+ * pipeline sees the device's real cadence and jitter; Timing::MaxSpeed
+ * returns packets as fast as they are asked for.
+ */
+class FFmpegReplayFrameReader : public ICaptureFrameReader
+{
+public:
+    enum class Timing { Original, MaxSpeed };
+
+    FFmpegReplayFrameReader();
+    ~FFmpegReplayFrameReader() override;
+
+    FFmpegReplayFrameReader(const FFmpegReplayFrameReader&) = delete;
+    FFmpegReplayFrameReader& operator=(const FFmpegReplayFrameReader&) = delete;
+
+    bool Open(const QString& path, Timing timing, bool loop = false);
+    void Close();
+    void Rewind();
+
+    // ICaptureFrameReader: false at the end of the file (unless looping)
+    bool readFrame() override;
+
+    AVPacket* GetPacket() const { return packet_; }
+    qint64 GetLastReadDurationUs() const { return last_read_us_; }
+
+    // Opened decoder for the recorded codec, owned by the reader
+    AVCodecContext* GetCodecContext() const { return codec_context_; }
+
+    QSize GetResolution() const { return resolution_; }
+    double GetFrameRate() const;
+    int GetPacketCount() const { return static_cast<int>(index_.size()); }
+    qint64 GetDurationUs() const;
+    QString GetLastError() const { return last_error_; }
+
+private:
+    struct IndexEntry {
+        qint64 offset = 0;       // Payload offset in the file
+        quint32 size = 0;
+        quint32 flags = 0;
+        qint64 capture_us = 0;   // Relative to the first packet
+    };
+
+    bool BuildIndex();
+    bool OpenDecoder(int codec_id);
+
+    QFile file_;
+    uchar* data_ = nullptr;         // Mapped file
+    qint64 data_size_ = 0;
+    std::vector<IndexEntry> index_;
+
+    Timing timing_ = Timing::MaxSpeed;
+    bool loop_ = false;
+    size_t next_ = 0;
+    qint64 replay_start_us_ = -1;   // Monotonic time packet 0 is due
+    qint64 loop_offset_us_ = 0;     // Accumulated duration of completed loops
+
+    QSize resolution_;
+    int fps_num_ = 0;
+    int fps_den_ = 1;
+
+    AVPacket* packet_ = nullptr;
+    AVCodecContext* codec_context_ = nullptr;
+    qint64 last_read_us_ = 0;
+    QString last_error_;
+};
+
+#endif // FFMPEG_REPLAY_FRAME_READER_H
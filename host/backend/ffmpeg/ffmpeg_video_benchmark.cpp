@@ -0,0 +1,405 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#include "ffmpeg_video_benchmark.h"
+#include "ffmpeg_clock.h"
+#include "ffmpeg_decode_pipeline.h"
+#include "ffmpeg_frame_processor.h"
+#include "ffmpeg_packet_capture_file.h"
+#include "ffmpeg_recorder.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QPainter>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <memory>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+Q_DECLARE_LOGGING_CATEGORY(log_ffmpeg_backend)
+
+namespace {
+
+constexpr qint64 kDrainTimeoutMs = 10000;
+
+// Frames submitted but not yet delivered, failed or dropped
+qint64 FramesInFlight(const FFmpegDecodePipeline::Stats& stats)
+{
+    return static_cast<qint64>(stats.submitted) - static_cast<qint64>(stats.delivered) -
+           static_cast<qint64>(stats.decode_failures) - static_cast<qint64>(stats.ring_drops) -
+           static_cast<qint64>(stats.reorder_skips);
+}
+
+// Mostly flat desktop with a window of text-like detail that moves every
+// frame, so JPEG sizes and decode cost resemble a real remote screen
+void FillSyntheticFrame(AVFrame* frame, int index)
+{
+    const int width = frame->width;
+    const int height = frame->height;
+    const int window_w = width / 2;
+    const int window_h = height / 2;
+    const int window_x = (index * 8) % qMax(1, width - window_w);
+    const int window_y = height / 4;
+
+    for (int y = 0; y < height; ++y) {
+        uint8_t* luma = frame->data[0] + y * frame->linesize[0];
+        const bool in_rows = y >= window_y && y < window_y + window_h;
+        const bool text_row = in_rows && ((y - window_y) % 18) < 12;
+        for (int x = 0; x < width; ++x) {
+            uint8_t value = static_cast<uint8_t>(48 + y * 96 / height);
+            if (in_rows && x >= window_x && x < window_x + window_w) {
+                value = 235;
+                if (text_row && ((x * 7919 + y * 31 + (x / 7) * 13) % 5) < 2) {
+                    value = 24;
+                }
+            }
+            luma[x] = value;
+        }
+    }
+    // 4:2:2: chroma planes have full height, half width
+    for (int y = 0; y < height; ++y) {
+        uint8_t* cb = frame->data[1] + y * frame->linesize[1];
+        uint8_t* cr = frame->data[2] + y * frame->linesize[2];
+        for (int x = 0; x < (width + 1) / 2; ++x) {
+            cb[x] = static_cast<uint8_t>(108 + x * 40 / width);
+            cr[x] = static_cast<uint8_t>(140 - y * 24 / height);
+        }
+    }
+}
+
+} // namespace
+
+QSize FFmpegVideoBenchmark::SyntheticPresetSize(const QString& name)
+{
+    const QString preset = name.toLower();
+    if (preset == "720p") {
+        return QSize(1280, 720);
+    }
+    if (preset == "1080p") {
+        return QSize(1920, 1080);
+    }
+    if (preset == "4k" || preset == "2160p") {
+        return QSize(3840, 2160);
+    }
+    return QSize();
+}
+
+bool FFmpegVideoBenchmark::GenerateSyntheticCapture(const QString& path, const QSize& resolution,
+                                                    int frames, int fps, QString* error)
+{
+    auto fail = [error](const QString& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    const AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+    if (!codec) {
+        return fail(QStringLiteral("MJPEG encoder not available"));
+    }
+    AVCodecContext* context = avcodec_alloc_context3(codec);
+    AVFrame* frame = av_frame_alloc();
+    AVPacket* packet = av_packet_alloc();
+    auto cleanup = [&]() {
+        av_packet_free(&packet);
+        av_frame_free(&frame);
+        avcodec_free_context(&context);
+    };
+    if (!context || !frame || !packet) {
+        cleanup();
+        return fail(QStringLiteral("Out of memory"));
+    }
+
+    context->width = resolution.width();
+    context->height = resolution.height();
+    context->pix_fmt = AV_PIX_FMT_YUVJ422P;
+    context->time_base = AVRational{1, qMax(1, fps)};
+    context->flags |= AV_CODEC_FLAG_QSCALE;
+    context->global_quality = FF_QP2LAMBDA * 4;  // Roughly what capture chips produce
+    if (avcodec_open2(context, codec, nullptr) < 0) {
+        cleanup();
+        return fail(QStringLiteral("Cannot open MJPEG encoder"));
+    }
+
+    frame->format = context->pix_fmt;
+    frame->width = context->width;
+    frame->height = context->height;
+    if (av_frame_get_buffer(frame, 32) < 0) {
+        cleanup();
+        return fail(QStringLiteral("Cannot allocate frame"));
+    }
+
+    FFmpegPacketCaptureWriter writer;
+    if (!writer.Open(path, AV_CODEC_ID_MJPEG, resolution, qMax(1, fps))) {
+        cleanup();
+        return fail(QString("Cannot write %1").arg(path));
+    }
+
+    bool ok = true;
+    for (int i = 0; i < frames && ok; ++i) {
+        if (av_frame_make_writable(frame) < 0) {
+            ok = false;
+            break;
+        }
+        FillSyntheticFrame(frame, i);
+        frame->pts = i;
+        frame->quality = context->global_quality;
+        ok = avcodec_send_frame(context, frame) >= 0;
+        while (ok && avcodec_receive_packet(context, packet) >= 0) {
+            const qint64 capture_us = packet->pts * 1000000LL / qMax(1, fps);
+            ok = writer.Write(packet, capture_us);
+            av_packet_unref(packet);
+        }
+    }
+    writer.Close();
+    cleanup();
+    return ok ? true : fail(QStringLiteral("MJPEG encoding failed"));
+}
+
+FFmpegVideoBenchmark::Result FFmpegVideoBenchmark::Run(const QString& capture_path, const Options& options)
+{
+    Result result;
+    result.input = capture_path;
+
+    // Loop the file when more frames are asked for than it holds
+    FFmpegReplayFrameReader reader;
+    if (!reader.Open(capture_path, options.timing, options.max_frames > 0)) {
+        result.error = reader.GetLastError();
+        return result;
+    }
+    result.resolution = reader.GetResolution();
+    const quint64 frame_limit = options.max_frames > 0 ? options.max_frames : reader.GetPacketCount();
+
+    // Decode for the viewport the way processFrame() does: never above the source
+    QSize target_size = options.display_size;
+    if (target_size.isValid() && result.resolution.isValid()) {
+        target_size = target_size.boundedTo(result.resolution);
+    }
+    const QSize canvas_size = target_size.isValid() ? target_size : result.resolution;
+
+    FFmpegFrameProcessor processor;
+    processor.StartCapture();
+    FFmpegLatencyTracer tracer;
+
+    std::unique_ptr<FFmpegRecorder> recorder;
+    QTemporaryDir record_dir;
+    if (options.record) {
+        recorder = std::make_unique<FFmpegRecorder>();
+        RecordingConfig config = recorder->GetRecordingConfig();
+        config.stream_copy = false;
+        config.record_audio = false;
+        recorder->SetRecordingConfig(config);
+        const int fps = reader.GetFrameRate() > 0.0 ? qRound(reader.GetFrameRate()) : 30;
+        const QString output = record_dir.filePath(QString("benchmark.%1").arg(config.format));
+        if (!record_dir.isValid() ||
+            !recorder->StartRecording(output, config.format, config.video_bitrate, result.resolution, fps)) {
+            result.error = QStringLiteral("Cannot start the recorder");
+            return result;
+        }
+        processor.SetYuvFrameRetention(true);
+    }
+
+    // The delivery callback runs on the decoder workers, one frame at a time
+    QImage canvas(canvas_size, QImage::Format_ARGB32_Premultiplied);
+    canvas.fill(Qt::black);
+    FFmpegRecorder* recording = recorder.get();
+    FFmpegDecodePipeline pipeline(&processor);
+    pipeline.Start(options.decoder_workers,
+                   [&](const QImage& image, const FFmpegDecodePipeline::FrameTiming& timing) {
+        const qint64 paint_start_us = FFmpegMonotonicTimeUs();
+        {
+            // Same draw as VideoPane::paintRasterFrame(): aspect-fit, smooth when scaled
+            const QSizeF fitted = QSizeF(image.size()).scaled(QSizeF(canvas.size()), Qt::KeepAspectRatio);
+            const QRectF target(QPointF((canvas.width() - fitted.width()) / 2.0,
+                                        (canvas.height() - fitted.height()) / 2.0), fitted);
+            QPainter painter(&canvas);
+            painter.setRenderHint(QPainter::SmoothPixmapTransform, target.size() != QSizeF(image.size()));
+            painter.drawImage(target, image);
+        }
+        const qint64 now_us = FFmpegMonotonicTimeUs();
+
+        tracer.Record(FFmpegLatencyTracer::Stage::Read, timing.read_us);
+        tracer.Record(FFmpegLatencyTracer::Stage::Queue, timing.queue_us);
+        tracer.Record(FFmpegLatencyTracer::Stage::Decode, timing.decode_us);
+        tracer.Record(FFmpegLatencyTracer::Stage::Reorder, timing.reorder_us);
+        tracer.Record(FFmpegLatencyTracer::Stage::Present, now_us - paint_start_us);
+        tracer.Record(FFmpegLatencyTracer::Stage::Total, now_us - (timing.capture_us - timing.read_us));
+
+        if (recording) {
+            AvFramePtr yuv_frame = processor.TakeYuvFrame(timing.sequence);
+            if (yuv_frame) {
+                recording->WriteYuvFrame(AV_FRAME_RAW(yuv_frame), timing.capture_us);
+            } else {
+                recording->WriteFrame(image, timing.capture_us);
+            }
+        }
+    });
+
+    QElapsedTimer wall_clock;
+    wall_clock.start();
+    quint64 submitted = 0;
+    while (submitted < frame_limit && reader.readFrame()) {
+        if (options.timing == FFmpegReplayFrameReader::Timing::MaxSpeed) {
+            // Wait for ring space rather than let Submit() drop the oldest packet
+            while (FramesInFlight(pipeline.GetStats()) >= FFmpegDecodePipeline::kDefaultRingCapacity) {
+                QThread::usleep(100);
+            }
+        }
+        if (pipeline.Submit(reader.GetPacket(), reader.GetCodecContext(), target_size,
+                            reader.GetLastReadDurationUs())) {
+            ++submitted;
+        }
+    }
+
+    QElapsedTimer drain_clock;
+    drain_clock.start();
+    while (FramesInFlight(pipeline.GetStats()) > 0 && drain_clock.elapsed() < kDrainTimeoutMs) {
+        QThread::usleep(500);
+    }
+    result.wall_seconds = wall_clock.nsecsElapsed() / 1e9;
+
+    const FFmpegDecodePipeline::Stats stats = pipeline.GetStats();
+    pipeline.Stop();
+
+    if (recorder) {
+        processor.SetYuvFrameRetention(false);
+        recorder->StopRecording();
+        const FFmpegRecorder::EncoderStats encoder_stats = recorder->GetEncoderStats();
+        result.frames_recorded = encoder_stats.encoded;
+        result.frames_record_dropped = encoder_stats.dropped;
+    }
+
+    result.frames_submitted = stats.submitted;
+    result.frames_delivered = stats.delivered;
+    result.decode_failures = stats.decode_failures;
+    result.ring_drops = stats.ring_drops;
+    result.decode_fps = result.wall_seconds > 0.0 ? stats.delivered / result.wall_seconds : 0.0;
+    result.latency = tracer.GetSnapshot();
+    result.allocations_per_frame = stats.delivered > 0
+        ? static_cast<double>(processor.GetFramePoolStats().misses) / stats.delivered
+        : 0.0;
+    result.peak_rss_kb = PeakRssKb();
+    result.ok = stats.delivered > 0;
+    if (!result.ok) {
+        result.error = QStringLiteral("No frame was decoded");
+    }
+    return result;
+}
+
+QString FFmpegVideoBenchmark::FormatResult(const Result& result)
+{
+    if (!result.ok) {
+        return QString("%1: FAILED - %2").arg(result.input, result.error);
+    }
+
+    QString text = QString("%1 (%2x%3)\n"
+                           "  decoded: %4/%5 frames in %6 s = %7 fps (failures: %8, ring drops: %9)\n"
+                           "  frame buffer allocations per frame: %10, peak RSS: %11 MB")
+        .arg(result.input)
+        .arg(result.resolution.width())
+        .arg(result.resolution.height())
+        .arg(result.frames_delivered)
+        .arg(result.frames_submitted)
+        .arg(result.wall_seconds, 0, 'f', 2)
+        .arg(result.decode_fps, 0, 'f', 1)
+        .arg(result.decode_failures)
+        .arg(result.ring_drops)
+        .arg(result.allocations_per_frame, 0, 'f', 3)
+        .arg(result.peak_rss_kb / 1024.0, 0, 'f', 1);
+    if (result.frames_recorded > 0 || result.frames_record_dropped > 0) {
+        text += QString("\n  recorded: %1 frames (encoder queue drops: %2)")
+            .arg(result.frames_recorded)
+            .arg(result.frames_record_dropped);
+    }
+    const QString latency = FFmpegLatencyTracer::FormatSummary(result.latency);
+    for (const QString& line : latency.split('\n')) {
+        text += "\n  " + line;
+    }
+    return text;
+}
+
+bool FFmpegVideoBenchmark::AppendCsv(const QString& path, const Result& result)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        return false;
+    }
+
+    QTextStream out(&file);
+    if (file.size() == 0) {
+        out << "timestamp,input,width,height,frames,fps,total_p50_ms,total_p95_ms,total_p99_ms,"
+               "decode_p50_ms,decode_p99_ms,allocations_per_frame,peak_rss_kb,ok\n";
+    }
+    const auto& total = result.latency.stages[static_cast<int>(FFmpegLatencyTracer::Stage::Total)];
+    const auto& decode = result.latency.stages[static_cast<int>(FFmpegLatencyTracer::Stage::Decode)];
+    out << QDateTime::currentDateTime().toString(Qt::ISODate) << ','
+        << result.input << ','
+        << result.resolution.width() << ','
+        << result.resolution.height() << ','
+        << result.frames_delivered << ','
+        << QString::number(result.decode_fps, 'f', 2) << ','
+        << QString::number(total.p50_ms, 'f', 3) << ','
+        << QString::number(total.p95_ms, 'f', 3) << ','
+        << QString::number(total.p99_ms, 'f', 3) << ','
+        << QString::number(decode.p50_ms, 'f', 3) << ','
+        << QString::number(decode.p99_ms, 'f', 3) << ','
+        << QString::number(result.allocations_per_frame, 'f', 3) << ','
+        << result.peak_rss_kb << ','
+        << (result.ok ? 1 : 0) << '\n';
+    return out.status() == QTextStream::Ok;
+}
+
+qint64 FFmpegVideoBenchmark::PeakRssKb()
+{
+#ifdef Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<qint64>(counters.PeakWorkingSetSize / 1024);
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef Q_OS_MACOS
+    return static_cast<qint64>(usage.ru_maxrss / 1024);  // Bytes on macOS
+#else
+    return static_cast<qint64>(usage.ru_maxrss);         // Kilobytes on Linux
+#endif
+#endif
+}
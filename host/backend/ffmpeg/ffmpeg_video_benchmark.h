@@ -0,0 +1,91 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#ifndef FFMPEG_VIDEO_BENCHMARK_H
+#define FFMPEG_VIDEO_BENCHMARK_H
+
+#include <QSize>
+#include <QString>
+#include "ffmpeg_latency_tracer.h"
+#include "ffmpeg_replay_frame_reader.h"
+
+/**
+ * @brief Headless benchmark of the FFmpeg video path
+ *
+ * Replays a packet capture file through the same stages a live session
+ * uses: FFmpegReplayFrameReader as the reader, FFmpegDecodePipeline and
+ * FFmpegFrameProcessor for decoding, a raster paint of every delivered frame
+ * the way VideoPane's raster path draws it and, optionally, FFmpegRecorder
+ * re-encoding.  Reports decode fps, per-stage latency percentiles, frame
+ * buffer allocations per frame and the process's peak RSS.
+ *
+ * In MaxSpeed mode the reader waits for ring space instead of letting the
+ * pipeline drop packets, so every frame is decoded and fps is throughput.
+ *
+ * Run from the command line with --video-benchmark (see main.cpp); inputs
+ * are capture files or "720p", "1080p" and "4k" for generated content.
+ */
+class FFmpegVideoBenchmark {
+public:
+    struct Options {
+        FFmpegReplayFrameReader::Timing timing = FFmpegReplayFrameReader::Timing::MaxSpeed;
+        int max_frames = 0;                    // 0 = the whole file
+        QSize display_size = QSize(1920, 1080);  // Viewport frames are decoded and painted for
+        int decoder_workers = 0;               // 0 = pick from CPU count
+        bool record = false;                   // Also re-encode into a temporary file
+    };
+
+    struct Result {
+        bool ok = false;
+        QString error;
+        QString input;
+        QSize resolution;
+        quint64 frames_submitted = 0;
+        quint64 frames_delivered = 0;
+        quint64 decode_failures = 0;
+        quint64 ring_drops = 0;
+        double wall_seconds = 0.0;
+        double decode_fps = 0.0;
+        FFmpegLatencyTracer::Snapshot latency;
+        double allocations_per_frame = 0.0;   // Frame pool misses per delivered frame
+        qint64 peak_rss_kb = 0;
+        quint64 frames_recorded = 0;
+        quint64 frames_record_dropped = 0;
+    };
+
+    static Result Run(const QString& capture_path, const Options& options);
+
+    // Encodes `frames` of moving desktop-like content as MJPEG 4:2:2 (what
+    // capture cards deliver) into a packet capture file
+    static bool GenerateSyntheticCapture(const QString& path, const QSize& resolution,
+                                         int frames, int fps, QString* error = nullptr);
+
+    // Resolution for "720p" / "1080p" / "4k" (invalid otherwise)
+    static QSize SyntheticPresetSize(const QString& name);
+
+    static QString FormatResult(const Result& result);
+    static bool AppendCsv(const QString& path, const Result& result);
+
+    static qint64 PeakRssKb();
+};
+
+#endif // FFMPEG_VIDEO_BENCHMARK_H
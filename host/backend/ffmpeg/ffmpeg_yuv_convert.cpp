@@ -0,0 +1,385 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#include "ffmpeg_yuv_convert.h"
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QStringList>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OPF_YUV_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define OPF_YUV_NEON 1
+#endif
+
+namespace {
+
+// BT.709 in 6-bit fixed point.  Products stay within int16 except for
+// out-of-gamut limited-range input, where saturation clamps the same way
+// the final pack does.
+struct Coefficients {
+    int16_t y_offset;
+    int16_t y_gain;
+    int16_t v_to_r;
+    int16_t u_to_g;
+    int16_t v_to_g;
+    int16_t u_to_b;
+};
+
+constexpr Coefficients kFullRange = { 0, 64, 101, 12, 30, 119 };
+constexpr Coefficients kLimitedRange = { 16, 75, 115, 14, 34, 135 };
+
+constexpr int kRound = 32;
+
+// swscale is set up for full range whatever the frame says; only frames that
+// explicitly declare limited range get the limited-range expansion here.
+bool IsLimitedRange(const AVFrame* frame)
+{
+    const AVPixelFormat format = static_cast<AVPixelFormat>(frame->format);
+    return frame->color_range == AVCOL_RANGE_MPEG &&
+           format != AV_PIX_FMT_YUVJ420P && format != AV_PIX_FMT_YUVJ422P;
+}
+
+inline uint8_t Clamp255(int value)
+{
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+// Pixels [x_begin, width) of one row; chroma is shared by pixel pairs
+void ConvertRowScalar(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                      uint8_t* dst, int x_begin, int width, const Coefficients& c)
+{
+    for (int x = x_begin; x < width; ++x) {
+        const int luma = (y[x] - c.y_offset) * c.y_gain + kRound;
+        const int cb = u[x >> 1] - 128;
+        const int cr = v[x >> 1] - 128;
+        dst[x * 4 + 0] = Clamp255((luma + c.u_to_b * cb) >> 6);
+        dst[x * 4 + 1] = Clamp255((luma - c.u_to_g * cb - c.v_to_g * cr) >> 6);
+        dst[x * 4 + 2] = Clamp255((luma + c.v_to_r * cr) >> 6);
+        dst[x * 4 + 3] = 255;
+    }
+}
+
+#if defined(OPF_YUV_SSE2)
+// Returns the number of pixels converted (a multiple of 16)
+int ConvertRowSse2(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                   uint8_t* dst, int width, const Coefficients& c)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha = _mm_set1_epi8(static_cast<char>(0xFF));
+    const __m128i y_offset = _mm_set1_epi16(c.y_offset);
+    const __m128i y_gain = _mm_set1_epi16(c.y_gain);
+    const __m128i chroma_bias = _mm_set1_epi16(128);
+    const __m128i round = _mm_set1_epi16(kRound);
+    const __m128i v_to_r = _mm_set1_epi16(c.v_to_r);
+    const __m128i u_to_g = _mm_set1_epi16(c.u_to_g);
+    const __m128i v_to_g = _mm_set1_epi16(c.v_to_g);
+    const __m128i u_to_b = _mm_set1_epi16(c.u_to_b);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m128i y8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x));
+        const __m128i cb = _mm_sub_epi16(
+            _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x / 2)), zero), chroma_bias);
+        const __m128i cr = _mm_sub_epi16(
+            _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + x / 2)), zero), chroma_bias);
+
+        // One chroma term per pixel pair, widened to both pixels
+        const __m128i r_term = _mm_mullo_epi16(cr, v_to_r);
+        const __m128i g_term = _mm_adds_epi16(_mm_mullo_epi16(cb, u_to_g), _mm_mullo_epi16(cr, v_to_g));
+        const __m128i b_term = _mm_mullo_epi16(cb, u_to_b);
+
+        const __m128i luma_lo = _mm_add_epi16(
+            _mm_mullo_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(y8, zero), y_offset), y_gain), round);
+        const __m128i luma_hi = _mm_add_epi16(
+            _mm_mullo_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(y8, zero), y_offset), y_gain), round);
+
+        const __m128i b = _mm_packus_epi16(
+            _mm_srai_epi16(_mm_adds_epi16(luma_lo, _mm_unpacklo_epi16(b_term, b_term)), 6),
+            _mm_srai_epi16(_mm_adds_epi16(luma_hi, _mm_unpackhi_epi16(b_term, b_term)), 6));
+        const __m128i g = _mm_packus_epi16(
+            _mm_srai_epi16(_mm_subs_epi16(luma_lo, _mm_unpacklo_epi16(g_term, g_term)), 6),
+            _mm_srai_epi16(_mm_subs_epi16(luma_hi, _mm_unpackhi_epi16(g_term, g_term)), 6));
+        const __m128i r = _mm_packus_epi16(
+            _mm_srai_epi16(_mm_adds_epi16(luma_lo, _mm_unpacklo_epi16(r_term, r_term)), 6),
+            _mm_srai_epi16(_mm_adds_epi16(luma_hi, _mm_unpackhi_epi16(r_term, r_term)), 6));
+
+        // Interleave to B,G,R,A bytes
+        const __m128i bg_lo = _mm_unpacklo_epi8(b, g);
+        const __m128i bg_hi = _mm_unpackhi_epi8(b, g);
+        const __m128i ra_lo = _mm_unpacklo_epi8(r, alpha);
+        const __m128i ra_hi = _mm_unpackhi_epi8(r, alpha);
+        __m128i* out = reinterpret_cast<__m128i*>(dst + x * 4);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(bg_lo, ra_lo));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(bg_lo, ra_lo));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(bg_hi, ra_hi));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(bg_hi, ra_hi));
+    }
+    return x;
+}
+#elif defined(OPF_YUV_NEON)
+// Returns the number of pixels converted (a multiple of 16)
+int ConvertRowNeon(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                   uint8_t* dst, int width, const Coefficients& c)
+{
+    const int16x8_t y_offset = vdupq_n_s16(c.y_offset);
+    const int16x8_t chroma_bias = vdupq_n_s16(128);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const uint8x16_t y8 = vld1q_u8(y + x);
+        const int16x8_t cb = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(u + x / 2))), chroma_bias);
+        const int16x8_t cr = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(v + x / 2))), chroma_bias);
+
+        // One chroma term per pixel pair, widened to both pixels
+        const int16x8x2_t r_term = vzipq_s16(vmulq_n_s16(cr, c.v_to_r), vmulq_n_s16(cr, c.v_to_r));
+        const int16x8_t g_pair = vqaddq_s16(vmulq_n_s16(cb, c.u_to_g), vmulq_n_s16(cr, c.v_to_g));
+        const int16x8x2_t g_term = vzipq_s16(g_pair, g_pair);
+        const int16x8x2_t b_term = vzipq_s16(vmulq_n_s16(cb, c.u_to_b), vmulq_n_s16(cb, c.u_to_b));
+
+        const int16x8_t luma_lo = vmulq_n_s16(
+            vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(y8))), y_offset), c.y_gain);
+        const int16x8_t luma_hi = vmulq_n_s16(
+            vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(y8))), y_offset), c.y_gain);
+
+        // vqrshrun adds the rounding term, shifts and clamps to 0..255
+        uint8x16x4_t bgra;
+        bgra.val[0] = vcombine_u8(vqrshrun_n_s16(vqaddq_s16(luma_lo, b_term.val[0]), 6),
+                                  vqrshrun_n_s16(vqaddq_s16(luma_hi, b_term.val[1]), 6));
+        bgra.val[1] = vcombine_u8(vqrshrun_n_s16(vqsubq_s16(luma_lo, g_term.val[0]), 6),
+                                  vqrshrun_n_s16(vqsubq_s16(luma_hi, g_term.val[1]), 6));
+        bgra.val[2] = vcombine_u8(vqrshrun_n_s16(vqaddq_s16(luma_lo, r_term.val[0]), 6),
+                                  vqrshrun_n_s16(vqaddq_s16(luma_hi, r_term.val[1]), 6));
+        bgra.val[3] = vdupq_n_u8(255);
+        vst4q_u8(dst + x * 4, bgra);
+    }
+    return x;
+}
+#endif
+
+inline void ConvertRow(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                       uint8_t* dst, int width, const Coefficients& c)
+{
+    int x = 0;
+#if defined(OPF_YUV_SSE2)
+    x = ConvertRowSse2(y, u, v, dst, width, c);
+#elif defined(OPF_YUV_NEON)
+    x = ConvertRowNeon(y, u, v, dst, width, c);
+#endif
+    ConvertRowScalar(y, u, v, dst, x, width, c);
+}
+
+// Deterministic content with full-range luma and chroma ramps
+void FillTestPattern(AVFrame* frame)
+{
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(frame->format));
+    for (int plane = 0; plane < AV_NUM_DATA_POINTERS && frame->data[plane]; ++plane) {
+        const int shift = plane == 0 ? 0 : desc->log2_chroma_h;
+        const int rows = (frame->height + (1 << shift) - 1) >> shift;
+        for (int row = 0; row < rows; ++row) {
+            uint8_t* line = frame->data[plane] + row * frame->linesize[plane];
+            for (int i = 0; i < frame->linesize[plane]; ++i) {
+                line[i] = static_cast<uint8_t>(i * 7 + row * 13 + plane * 51);
+            }
+        }
+    }
+}
+
+} // namespace
+
+bool FFmpegYuvConverter::SupportsFormat(int pix_fmt)
+{
+    switch (pix_fmt) {
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+    case AV_PIX_FMT_YUV422P:
+    case AV_PIX_FMT_YUVJ422P:
+    case AV_PIX_FMT_NV12:
+    case AV_PIX_FMT_YUYV422:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool FFmpegYuvConverter::ConvertToArgb32(const AVFrame* frame, uchar* dst, qsizetype dst_stride)
+{
+    if (!frame || !dst || !frame->data[0] || frame->width <= 0 || frame->height <= 0 ||
+        !SupportsFormat(frame->format)) {
+        return false;
+    }
+
+    const Coefficients& c = IsLimitedRange(frame) ? kLimitedRange : kFullRange;
+    const AVPixelFormat format = static_cast<AVPixelFormat>(frame->format);
+    const int width = frame->width;
+    const int height = frame->height;
+    const int chroma_width = (width + 1) / 2;
+
+    switch (format) {
+    case AV_PIX_FMT_NV12: {
+        std::vector<uint8_t> cb(chroma_width);
+        std::vector<uint8_t> cr(chroma_width);
+        for (int row = 0; row < height; ++row) {
+            const uint8_t* uv = frame->data[1] + (row >> 1) * frame->linesize[1];
+            for (int i = 0; i < chroma_width; ++i) {
+                cb[i] = uv[i * 2];
+                cr[i] = uv[i * 2 + 1];
+            }
+            ConvertRow(frame->data[0] + row * frame->linesize[0], cb.data(), cr.data(),
+                       dst + row * dst_stride, width, c);
+        }
+        return true;
+    }
+    case AV_PIX_FMT_YUYV422: {
+        std::vector<uint8_t> luma(chroma_width * 2);
+        std::vector<uint8_t> cb(chroma_width);
+        std::vector<uint8_t> cr(chroma_width);
+        for (int row = 0; row < height; ++row) {
+            const uint8_t* yuyv = frame->data[0] + row * frame->linesize[0];
+            for (int i = 0; i < chroma_width; ++i) {
+                luma[i * 2] = yuyv[i * 4];
+                cb[i] = yuyv[i * 4 + 1];
+                luma[i * 2 + 1] = yuyv[i * 4 + 2];
+                cr[i] = yuyv[i * 4 + 3];
+            }
+            ConvertRow(luma.data(), cb.data(), cr.data(), dst + row * dst_stride, width, c);
+        }
+        return true;
+    }
+    default: {
+        const int chroma_shift = (format == AV_PIX_FMT_YUV420P || format == AV_PIX_FMT_YUVJ420P) ? 1 : 0;
+        for (int row = 0; row < height; ++row) {
+            const int chroma_row = row >> chroma_shift;
+            ConvertRow(frame->data[0] + row * frame->linesize[0],
+                       frame->data[1] + chroma_row * frame->linesize[1],
+                       frame->data[2] + chroma_row * frame->linesize[2],
+                       dst + row * dst_stride, width, c);
+        }
+        return true;
+    }
+    }
+}
+
+QString FFmpegYuvConverter::RunBenchmark(int width, int height, int iterations)
+{
+    iterations = qMax(1, iterations);
+#if defined(OPF_YUV_SSE2)
+    const char* kernel = "SSE2";
+#elif defined(OPF_YUV_NEON)
+    const char* kernel = "NEON";
+#else
+    const char* kernel = "scalar";
+#endif
+
+    QStringList lines;
+    lines << QString("YUV->ARGB32 %1x%2, %3 iterations, %4 kernels vs sws_scale")
+                 .arg(width).arg(height).arg(iterations).arg(QLatin1String(kernel));
+
+    QImage direct(width, height, QImage::Format_ARGB32_Premultiplied);
+    QImage reference(width, height, QImage::Format_ARGB32_Premultiplied);
+    if (direct.isNull() || reference.isNull()) {
+        return QString("YUV benchmark: cannot allocate %1x%2 images").arg(width).arg(height);
+    }
+
+    const AVPixelFormat formats[] = {
+        AV_PIX_FMT_YUVJ422P, AV_PIX_FMT_YUVJ420P, AV_PIX_FMT_NV12, AV_PIX_FMT_YUYV422
+    };
+    for (AVPixelFormat format : formats) {
+        AVFrame* frame = av_frame_alloc();
+        if (!frame) {
+            break;
+        }
+        frame->format = format;
+        frame->width = width;
+        frame->height = height;
+        if (av_frame_get_buffer(frame, 32) < 0) {
+            av_frame_free(&frame);
+            continue;
+        }
+        FillTestPattern(frame);
+
+        // Same setup as FFmpegFrameProcessor::UpdateScalingContext for a 1:1 conversion
+        SwsContext* sws = sws_getContext(width, height, format, width, height, AV_PIX_FMT_BGRA,
+                                         SWS_POINT, nullptr, nullptr, nullptr);
+        if (!sws) {
+            av_frame_free(&frame);
+            continue;
+        }
+        const int* coeffs = sws_getCoefficients(SWS_CS_ITU709);
+        sws_setColorspaceDetails(sws, coeffs, 1, coeffs, 1, 0, 1 << 16, 1 << 16);
+
+        uint8_t* sws_data[1] = { reference.bits() };
+        int sws_linesize[1] = { static_cast<int>(reference.bytesPerLine()) };
+
+        // Warm-up pass also produces the images compared below
+        ConvertToArgb32(frame, direct.bits(), direct.bytesPerLine());
+        sws_scale(sws, frame->data, frame->linesize, 0, height, sws_data, sws_linesize);
+
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < iterations; ++i) {
+            ConvertToArgb32(frame, direct.bits(), direct.bytesPerLine());
+        }
+        const double direct_ms = timer.nsecsElapsed() / 1e6 / iterations;
+
+        timer.restart();
+        for (int i = 0; i < iterations; ++i) {
+            sws_scale(sws, frame->data, frame->linesize, 0, height, sws_data, sws_linesize);
+        }
+        const double sws_ms = timer.nsecsElapsed() / 1e6 / iterations;
+
+        int max_diff = 0;
+        for (int row = 0; row < height; ++row) {
+            const uchar* a = direct.constScanLine(row);
+            const uchar* b = reference.constScanLine(row);
+            for (int i = 0; i < width * 4; ++i) {
+                if ((i & 3) != 3) {
+                    max_diff = qMax(max_diff, std::abs(a[i] - b[i]));
+                }
+            }
+        }
+
+        const char* name = av_get_pix_fmt_name(format);
+        lines << QString("%1: direct %2 ms, sws_scale %3 ms (x%4), max channel diff %5")
+                     .arg(QLatin1String(name ? name : "unknown"))
+                     .arg(direct_ms, 0, 'f', 3)
+                     .arg(sws_ms, 0, 'f', 3)
+                     .arg(direct_ms > 0.0 ? sws_ms / direct_ms : 0.0, 0, 'f', 2)
+                     .arg(max_diff);
+
+        sws_freeContext(sws);
+        av_frame_free(&frame);
+    }
+    return lines.join('\n');
+}
@@ -0,0 +1,61 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#ifndef FFMPEG_YUV_CONVERT_H
+#define FFMPEG_YUV_CONVERT_H
+
+#include <QString>
+#include <QtGlobal>
+
+struct AVFrame;
+
+/**
+ * @brief Direct YUV to display-format conversion for the software decode path
+ *
+ * Converts decoded frames at their native size straight into 32-bit
+ * BGRA (QImage::Format_ARGB32_Premultiplied; alpha is always 255) without
+ * going through swscale.  Covers the layouts capture devices and the MJPEG
+ * decoder actually produce: planar 4:2:0 and 4:2:2 (limited and full range),
+ * NV12 from hardware decoders and packed YUYV.  Rows are converted with
+ * SSE2 or NEON kernels, 16 pixels at a time, in 6-bit fixed point with the
+ * same BT.709 matrix the swscale path is configured for; the result is within
+ * a level or two of swscale's output.
+ *
+ * Scaled conversions stay on swscale, and the encoder is handed the decoded
+ * YUV planes directly (see FFmpegRecorder::WriteYuvFrame).
+ */
+class FFmpegYuvConverter {
+public:
+    // True when ConvertToArgb32() handles frames of this AVPixelFormat
+    static bool SupportsFormat(int pix_fmt);
+
+    // Converts the whole frame; `dst` must hold frame->height rows of
+    // frame->width pixels.  False for unsupported formats.
+    static bool ConvertToArgb32(const AVFrame* frame, uchar* dst, qsizetype dst_stride);
+
+    // Times the kernels against sws_scale on synthetic frames and returns a
+    // summary (ms per frame, speed-up and largest channel difference).
+    // Enabled at startup with OPENTERFACE_YUV_BENCHMARK=<iterations>.
+    static QString RunBenchmark(int width, int height, int iterations);
+};
+
+#endif // FFMPEG_YUV_CONVERT_H
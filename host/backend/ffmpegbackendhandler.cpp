@@ -27,6 +27,8 @@
 #include "device/DeviceManager.h"
 #include "device/HotplugMonitor.h"
 #include "device/DeviceInfo.h"
+#include "host/audiomanager.h"
+#include "host/framebus.h"
 
 #include <QThread>
 #include <QDebug>
@@ -39,6 +41,7 @@
 #include <QGraphicsScene>
 #include <QTimer>
 #include <QFileInfo>
+#include <QDir>
 #include <QMediaDevices>
 #include <QCameraDevice>
 
@@ -67,6 +70,8 @@ OPF_LOGGING_CATEGORY(log_ffmpeg_backend, "opf.backend.ffmpeg")
 #include "ffmpeg/ffmpeg_device_manager.h"
 #include "ffmpeg/ffmpeg_frame_processor.h"
 #include "ffmpeg/ffmpeg_recorder.h"
+#include "ffmpeg/ffmpeg_image_saver.h"
+#include "ffmpeg/ffmpeg_clock.h"
 #include "ffmpeg/ffmpeg_device_validator.h"
 #include "ffmpeg/ffmpeg_hotplug_handler.h"
 #include "ffmpeg/ffmpeg_capture_manager.h"
@@ -78,7 +83,10 @@ FFmpegBackendHandler::FFmpegBackendHandler(QObject *parent)
     m_deviceManager(std::make_unique<FFmpegDeviceManager>()),
     m_hardwareAccelerator(std::make_unique<FFmpegHardwareAccelerator>()),
     m_frameProcessor(std::make_unique<FFmpegFrameProcessor>()),
+    m_decodePipeline(std::make_unique<FFmpegDecodePipeline>(m_frameProcessor.get())),
+    m_changeDetector(std::make_unique<FFmpegFrameChangeDetector>()),
     m_recorder(std::make_unique<FFmpegRecorder>()),
+    m_imageSaver(std::make_unique<FFmpegImageSaver>()),
     m_deviceValidator(std::make_unique<FFmpegDeviceValidator>()),
     m_hotplugHandler(nullptr),  // Created after validator
     m_captureManager(nullptr),  // Created after dependencies
@@ -102,8 +110,18 @@ FFmpegBackendHandler::FFmpegBackendHandler(QObject *parent)
     m_ptsFrameCount(0),
     m_lastForceDisplayTime(0)
 {
-    // Initialize backpressure counter (shared with lambda captures in QueuedConnection slots)
-    m_pendingFrameCount = std::make_shared<std::atomic<int>>(0);
+    // Decode pacing / backpressure state (shared with lambda captures in QueuedConnection slots)
+    m_framePacer = std::make_shared<FFmpegFramePacer>();
+    m_latencyTracer = std::make_shared<FFmpegLatencyTracer>();
+    m_latencyCsvPath = QString::fromLocal8Bit(qgetenv("OPENTERFACE_LATENCY_CSV"));
+    m_packetCapture = std::make_unique<FFmpegPacketCaptureWriter>();
+    m_packetCaptureEnvPath = QString::fromLocal8Bit(qgetenv("OPENTERFACE_PACKET_CAPTURE"));
+    
+    // Emitted from a saver worker; receivers in other threads get it queued
+    connect(m_imageSaver.get(), &FFmpegImageSaver::ImageSaved, this,
+            [this](const QString& path, bool success, qint64 queueUs, qint64 saveUs) {
+                emit imageSaved(path, success, (queueUs + saveUs) / 1000);
+            }, Qt::DirectConnection);
     // m_videoOutputConnection is default-constructed (invalid/disconnected)
     m_config = getDefaultConfig();
     m_preferredHwAccel = GlobalSetting::instance().getHardwareAcceleration();
@@ -174,12 +192,35 @@ FFmpegBackendHandler::FFmpegBackendHandler(QObject *parent)
         qCCritical(log_ffmpeg_backend) << "Failed to initialize FFmpeg";
     }
     
+    // Closed-loop frame pacing: re-evaluated a few times per second from what the
+    // GUI actually painted and how busy the decoders were
+    m_pacingTimer = new QTimer(this);
+    m_pacingTimer->setInterval(FFmpegFramePacer::kUpdateIntervalMs);
+    connect(m_pacingTimer, &QTimer::timeout, this, [this]() {
+        FFmpegFramePacer::Inputs inputs;
+        if (m_videoPane) {
+            QWidget* window = m_videoPane->window();
+            inputs.display_visible = m_videoPane->isVisible() && !m_videoPane->visibleRegion().isEmpty() &&
+                                     !(window && window->isMinimized());
+            inputs.paint_feedback = true;
+        }
+        inputs.source_fps = m_currentFramerate;
+        if (m_decodePipeline) {
+            const FFmpegDecodePipeline::Stats stats = m_decodePipeline->GetStats();
+            inputs.ring_depth = stats.ring_depth;
+            inputs.decoder_workers = stats.workers;
+        }
+        m_framePacer->Update(inputs);
+    });
+    
     // Setup performance monitoring
     m_performanceTimer = new QTimer(this);
     m_performanceTimer->setInterval(5000); // Report every 5 seconds
     connect(m_performanceTimer, &QTimer::timeout, this, [this]() {
-        if (m_frameCount > 0) {
-            double actualFps = m_frameCount / 5.0;
+        // Decoder threads keep counting while we report; take and reset in one step
+        const int framesInWindow = m_frameCount.exchange(0, std::memory_order_relaxed);
+        if (framesInWindow > 0) {
+            double actualFps = framesInWindow / 5.0;
             
             // Get target framerate for comparison
             int targetFps = m_currentFramerate > 0 ? m_currentFramerate : 0;
@@ -199,7 +240,96 @@ FFmpegBackendHandler::FFmpegBackendHandler(QObject *parent)
                 emit fpsChanged(actualFps);
             }
             
-            m_frameCount = 0;
+            FFmpegFramePool::Stats poolStats = getFramePoolStats();
+            qCDebug(log_ffmpeg_backend) << QString("Frame pool - capacity: %1, allocated: %2, free: %3, hits: %4, misses: %5, reallocations: %6")
+                .arg(poolStats.capacity)
+                .arg(poolStats.allocated)
+                .arg(poolStats.free)
+                .arg(poolStats.hits)
+                .arg(poolStats.misses)
+                .arg(poolStats.reallocations);
+            
+            FFmpegDecodePipeline::Stats pipelineStats = getDecodePipelineStats();
+            qCDebug(log_ffmpeg_backend) << QString("Capture pipeline - workers: %1, ring: %2/%3, reorder: %4, "
+                                                   "submitted: %5, delivered: %6, ring drops: %7, failures: %8, skips: %9")
+                .arg(pipelineStats.workers)
+                .arg(pipelineStats.ring_depth)
+                .arg(pipelineStats.ring_capacity)
+                .arg(pipelineStats.reorder_depth)
+                .arg(pipelineStats.submitted)
+                .arg(pipelineStats.delivered)
+                .arg(pipelineStats.ring_drops)
+                .arg(pipelineStats.decode_failures)
+                .arg(pipelineStats.reorder_skips);
+            qCDebug(log_ffmpeg_backend) << QString("Capture pipeline timing (avg/max ms) - read: %1/%2, queue: %3/%4, "
+                                                   "decode: %5/%6, deliver: %7/%8")
+                .arg(pipelineStats.avg_read_ms, 0, 'f', 2).arg(pipelineStats.max_read_ms, 0, 'f', 2)
+                .arg(pipelineStats.avg_queue_ms, 0, 'f', 2).arg(pipelineStats.max_queue_ms, 0, 'f', 2)
+                .arg(pipelineStats.avg_decode_ms, 0, 'f', 2).arg(pipelineStats.max_decode_ms, 0, 'f', 2)
+                .arg(pipelineStats.avg_deliver_ms, 0, 'f', 2).arg(pipelineStats.max_deliver_ms, 0, 'f', 2);
+            if (m_decodePipeline) {
+                m_decodePipeline->ResetStats();  // Report per 5-second window
+            }
+            qCDebug(log_ffmpeg_backend) << "Static frames skipped:"
+                                        << m_staticFramesSkipped.exchange(0, std::memory_order_relaxed);
+            
+            const FFmpegLatencyTracer::Snapshot latency = m_latencyTracer->GetSnapshot();
+            const FFmpegLatencyTracer::StageSummary& total =
+                latency.stages[static_cast<int>(FFmpegLatencyTracer::Stage::Total)];
+            qCDebug(log_ffmpeg_backend) << QString("Frame latency read-to-paint p50/p95/p99/max ms: %1/%2/%3/%4, "
+                                                   "GUI backpressure drops: %5")
+                .arg(total.p50_ms, 0, 'f', 1).arg(total.p95_ms, 0, 'f', 1)
+                .arg(total.p99_ms, 0, 'f', 1).arg(total.max_ms, 0, 'f', 1)
+                .arg(latency.gate_drops);
+            const FFmpegFramePacer::Metrics pacing = m_framePacer->GetMetrics();
+            qCDebug(log_ffmpeg_backend) << QString("Frame pacing %1 - target fps: %2, decode scale: %3, paint fps: %4, "
+                                                   "decoder load: %5, avg decode ms: %6, paced drops: %7, "
+                                                   "GUI drops: %8, adjustments: %9")
+                .arg(QLatin1String(FFmpegFramePacer::StateName(pacing.state)))
+                .arg(pacing.target_fps, 0, 'f', 1)
+                .arg(pacing.decode_scale, 0, 'f', 2)
+                .arg(pacing.paint_fps, 0, 'f', 1)
+                .arg(pacing.decoder_load, 0, 'f', 2)
+                .arg(pacing.avg_decode_ms, 0, 'f', 2)
+                .arg(pacing.paced_drops)
+                .arg(pacing.gate_drops)
+                .arg(pacing.adjustments);
+            emit latencyStatsChanged(FFmpegLatencyTracer::FormatSummary(latency) +
+                                     QString("\nPacing: %1, %2 fps at %3% size")
+                                         .arg(QLatin1String(FFmpegFramePacer::StateName(pacing.state)))
+                                         .arg(pacing.target_fps, 0, 'f', 1)
+                                         .arg(qRound(pacing.decode_scale * 100)));
+            if (!m_latencyCsvPath.isEmpty() && !FFmpegLatencyTracer::AppendCsv(m_latencyCsvPath, latency)) {
+                qCWarning(log_ffmpeg_backend) << "Cannot write latency CSV:" << m_latencyCsvPath;
+                m_latencyCsvPath.clear();
+            }
+            m_latencyTracer->Reset();
+            
+            if (m_recorder && m_recorder->IsRecording()) {
+                FFmpegRecorder::EncoderStats encoderStats = m_recorder->GetEncoderStats();
+                qCDebug(log_ffmpeg_backend) << QString("Recording encoder - queue: %1/%2, queued: %3, encoded: %4, "
+                                                       "dropped: %5, failures: %6, encode avg/max ms: %7/%8, from YUV: %9")
+                    .arg(encoderStats.queue_depth)
+                    .arg(encoderStats.queue_capacity)
+                    .arg(encoderStats.queued)
+                    .arg(encoderStats.encoded)
+                    .arg(encoderStats.dropped)
+                    .arg(encoderStats.encode_failures)
+                    .arg(encoderStats.avg_encode_ms, 0, 'f', 2)
+                    .arg(encoderStats.max_encode_ms, 0, 'f', 2)
+                    .arg(encoderStats.yuv_frames);
+                if (encoderStats.audio_enabled) {
+                    qCDebug(log_ffmpeg_backend) << QString("Recording audio - queued ms: %1, frames: %2, underruns: %3, "
+                                                           "dropped samples: %4, drift ms (last/max): %5/%6")
+                        .arg(encoderStats.audio_queue_ms)
+                        .arg(encoderStats.audio_frames_encoded)
+                        .arg(encoderStats.audio_underruns)
+                        .arg(encoderStats.audio_samples_dropped)
+                        .arg(encoderStats.audio_drift_ms, 0, 'f', 1)
+                        .arg(encoderStats.audio_max_drift_ms, 0, 'f', 1);
+                }
+                m_recorder->ResetEncoderStats();
+            }
         } else {
             // Even if no frames were captured, emit the target framerate if available
             int targetFps = m_currentFramerate > 0 ? m_currentFramerate : 0;
@@ -214,6 +344,7 @@ FFmpegBackendHandler::~FFmpegBackendHandler()
 {
     // Stop recording first if active
     if (m_recorder && m_recorder->IsRecording()) {
+        AudioManager::getInstance().setPcmTap({});
         m_recorder->StopRecording();
     }
     
@@ -221,6 +352,14 @@ FFmpegBackendHandler::~FFmpegBackendHandler()
     disconnectFromHotplugMonitor();
     
     stopDirectCapture();
+    
+    // Decoder workers call back into this object; make sure they are gone
+    if (m_decodePipeline) {
+        m_decodePipeline->Stop();
+    }
+    // Finish screenshots already requested
+    m_imageSaver->Stop();
+    setFrameBus(nullptr);
     cleanupFFmpeg();
 }
 
@@ -523,6 +662,20 @@ bool FFmpegBackendHandler::startDirectCapture(const QString& devicePath, const Q
         qCDebug(log_ffmpeg_backend) << "Applied scaling quality:" << scalingQuality;
     }
     
+    // First frame of the new session is always a full update
+    if (m_changeDetector) {
+        m_changeDetector->Reset();
+    }
+    m_staticFramesSkipped.store(0, std::memory_order_relaxed);
+    
+    // Decoder workers must be ready before the capture thread submits packets
+    if (m_decodePipeline) {
+        m_decodePipeline->Start(GlobalSetting::instance().getDecodeWorkerCount(),
+                                [this](const QImage& image, const FFmpegDecodePipeline::FrameTiming& timing) {
+                                    deliverDecodedFrame(image, timing);
+                                });
+    }
+    
     // Delegate to capture manager
     if (m_captureManager && m_captureManager->StartCapture(devicePath, resolution, framerate)) {
         m_captureRunning = true;
@@ -536,11 +689,31 @@ bool FFmpegBackendHandler::startDirectCapture(const QString& devicePath, const Q
         if (m_performanceTimer) {
             m_performanceTimer->start();
         }
+        if (m_pacingTimer) {
+            m_pacingTimer->start();
+        }
+        
+        if (!m_packetCaptureEnvPath.isEmpty()) {
+            // Each session gets its own file; the writer truncates what it opens
+            QString path = m_packetCaptureEnvPath;
+            if (++m_packetCaptureSessions > 1) {
+                const QFileInfo info(path);
+                QString name = QString("%1-%2").arg(info.completeBaseName()).arg(m_packetCaptureSessions);
+                if (!info.suffix().isEmpty()) {
+                    name += "." + info.suffix();
+                }
+                path = info.dir().filePath(name);
+            }
+            startPacketCapture(path);
+        }
         
         qCDebug(log_ffmpeg_backend) << "Direct FFmpeg capture started successfully";
         return true;
     }
     
+    if (m_decodePipeline) {
+        m_decodePipeline->Stop();
+    }
     qCWarning(log_ffmpeg_backend) << "Failed to start direct FFmpeg capture";
     return false;
 }
@@ -568,9 +741,17 @@ void FFmpegBackendHandler::stopDirectCapture()
             m_hotplugHandler->SetCaptureRunning(false);
         }
 
-        // Delegate to capture manager
+        // Delegate to capture manager.  The decoder workers are joined once the
+        // capture thread can no longer submit packets, while the codec
+        // context is still alive.
         if (m_captureManager) {
-            m_captureManager->StopCapture();
+            m_captureManager->StopCapture([this]() {
+                if (m_decodePipeline) {
+                    m_decodePipeline->Stop();
+                }
+            });
+        } else if (m_decodePipeline) {
+            m_decodePipeline->Stop();
         }
     } // Release mutex
 
@@ -578,11 +759,15 @@ void FFmpegBackendHandler::stopDirectCapture()
     if (m_performanceTimer) {
         m_performanceTimer->stop();
     }
+    if (m_pacingTimer) {
+        m_pacingTimer->stop();
+    }
 
     // Sync wait: poll until capture thread fully stops (max 2s, 50ms intervals)
     if (!waitForCaptureStop(2000)) {
         qCWarning(log_ffmpeg_backend) << "Capture thread did not stop within timeout - may cause device conflict";
     }
+    stopPacketCapture();
 
     // Platform-specific settling delay before opening new device
 #ifdef Q_OS_LINUX
@@ -740,14 +925,30 @@ void FFmpegBackendHandler::processFrame()
     //     and shows a stale frame, giving a ~10 fps stuttering appearance during
     //     catch-up while the ring buffer is being consumed.
     //
-    // The ShouldDropFrame() gate inside ProcessPacketToImage() already provides correct
-    // rate-limiting (drops a frame if < 8.33 ms since the last one was shown, ≈120 fps
-    // cap).  That is all the rate control we need for a real-time KVM stream.
-    qint64 currentSystemTime = QDateTime::currentMSecsSinceEpoch();
-
+    // The FFmpegFramePacer gate below provides the rate control instead: it admits
+    // packets at a rate derived from what the GUI actually paints and how busy the
+    // decoders are (never faster than the source, at most 120 fps).
+    // Packet capture sees every packet the camera delivers, before any gate
+    if (m_packetCapture->IsOpen()) {
+        m_packetCapture->Write(packet, FFmpegMonotonicTimeUs());
+    }
+    
     // Check if recording is active
     bool isRecording = m_recorder && m_recorder->IsRecording() && !m_recorder->IsPaused();
     
+    // Stream-copy recording takes the camera's own packet before any display
+    // gate; decoding then only serves the screen, exactly as when not recording
+    if (isRecording && m_recorder->IsStreamCopy()) {
+        if (m_recorder->ShouldWriteFrame(QDateTime::currentMSecsSinceEpoch()) &&
+            m_recorder->WritePacket(packet, FFmpegMonotonicTimeUs())) {
+            static int streamCopyFrameCount = 0;
+            if (++streamCopyFrameCount % 30 == 0) {
+                emit recordingDurationChanged(m_recorder->GetRecordingDuration());
+            }
+        }
+        isRecording = false;
+    }
+    
     // Get viewport size from VideoPane if available
     QSize viewportSize;
     if (m_videoPane) {
@@ -797,78 +998,128 @@ void FFmpegBackendHandler::processFrame()
             qCDebug(log_ffmpeg_backend) << "FFmpeg direct decode target with zoom:" << zoomFactor
                                         << "viewport:" << viewportSize
                                         << "target:" << targetSize
-                                        << "source:" << (m_frameProcessor ? m_frameProcessor->GetLatestOriginalFrame().size() : QSize());
+                                        << "source:" << (m_frameProcessor ? m_frameProcessor->GetNativeJpegSize() : QSize());
         }
     }
 
-    // QImage is thread-safe and can be passed across thread boundaries efficiently
-    QImage image = m_frameProcessor->ProcessPacketToImage(packet, codecContext, isRecording, targetSize);
+    // Zoomed in: only the visible part needs decoding.  Recording always
+    // needs complete frames.
+    QRectF decodeRegion;
+    if (m_videoPane && m_videoPane->getZoomFactor() > 1.0 && !isRecording) {
+        QMutexLocker locker(&m_visibleSourceRectMutex);
+        decodeRegion = m_visibleSourceRect;
+    }
+
+    // Rate gate runs in the reader stage so dropped packets never reach a decoder
+    if (!m_framePacer->AdmitPacket(isRecording)) {
+        av_packet_unref(packet);
+        return;
+    }
+    
+    // Under load the pacer trades display resolution for frame rate.  Zoomed-in
+    // and recorded frames keep the full size.
+    const double decodeScale = m_framePacer->GetDecodeScale();
+    if (decodeScale < 1.0 && targetSize.isValid() && decodeRegion.isNull() && !isRecording) {
+        targetSize = QSize(qMax(1, qRound(targetSize.width() * decodeScale)),
+                           qMax(1, qRound(targetSize.height() * decodeScale)));
+    }
+
+    // Hand the packet to the decoder workers.  Submit() moves the payload out,
+    // leaving the capture manager's packet ready for the next av_read_frame.
+    if (!m_decodePipeline || !m_decodePipeline->Submit(packet, codecContext, targetSize,
+                                                       m_captureManager->GetLastReadDurationUs(),
+                                                       decodeRegion)) {
+        av_packet_unref(packet);
+    }
+}
+
+void FFmpegBackendHandler::deliverDecodedFrame(const QImage& image, const FFmpegDecodePipeline::FrameTiming& timing)
+{
+    // Runs on decoder-pool threads and the reader thread: only atomics are touched here
+    qint64 currentSystemTime = QDateTime::currentMSecsSinceEpoch();
+
+    const int frameNumber = m_frameCount.fetch_add(1, std::memory_order_relaxed) + 1;
+    m_lastFrameDisplayTime.store(currentSystemTime, std::memory_order_relaxed);
+    m_lastForceDisplayTime.store(currentSystemTime, std::memory_order_relaxed);  // Update force display timer
     
-    // Clean up packet
-    av_packet_unref(packet);
+    m_latencyTracer->Record(FFmpegLatencyTracer::Stage::Read, timing.read_us);
+    m_latencyTracer->Record(FFmpegLatencyTracer::Stage::Queue, timing.queue_us);
+    m_latencyTracer->Record(FFmpegLatencyTracer::Stage::Decode, timing.decode_us);
+    m_latencyTracer->Record(FFmpegLatencyTracer::Stage::Reorder, timing.reorder_us);
+    m_framePacer->OnFrameDecoded(timing.decode_us);
     
-    if (!image.isNull()) {
-        m_frameCount++;
-        m_lastFrameDisplayTime = currentSystemTime;
-        m_lastForceDisplayTime = currentSystemTime;  // Update force display timer
-        
-        // Log first few frames for debugging
-        if (m_frameCount <= 5 || m_frameCount % 1000 == 1) {
-            qCDebug(log_ffmpeg_backend) << "Processed frame" << m_frameCount << "size:" << image.size();
+    // Log first few frames for debugging
+    if (frameNumber <= 5 || frameNumber % 1000 == 1) {
+        qCDebug(log_ffmpeg_backend) << "Processed frame" << timing.sequence << "size:" << image.size()
+                                    << "read/queue/decode us:" << timing.read_us << timing.queue_us << timing.decode_us;
+    }
+    
+    // Other consumers (TCP, MCP, timelapse) pull from the bus at their own
+    // rate; nothing is copied or decoded for them unless one asks
+    if (m_frameBus && m_captureRunning) {
+        m_frameBus->publishFrame(timing.sequence);
+    }
+    
+    // Emit QImage to UI (QueuedConnection ensures thread safety).
+    // BACKPRESSURE: Only queue a new frame when fewer than
+    // FFmpegFramePacer::kMaxFramesInFlight frames are already waiting in the GUI
+    // event loop.  Without this limit each unconsumed frame holds its own ~8 MB
+    // buffer in the queue, rapidly exhausting RAM and triggering "QImage: out of
+    // memory" warnings at high frame rates.  The pacer also counts these drops
+    // and slows decoding down so they stay rare.
+    if (m_captureRunning) {
+        if (frameNumber <= 5) {
+            qCDebug(log_ffmpeg_backend) << "Emitting frameReadyImage signal for frame" << frameNumber;
         }
-        
-        // Emit QImage to UI (QueuedConnection ensures thread safety).
-        // BACKPRESSURE: Only queue a new frame when fewer than 2 frames are already
-        // waiting in the GUI event loop.  Without this limit each unconsumed frame
-        // holds its own ~8 MB buffer in the queue, rapidly exhausting RAM and
-        // triggering "QImage: out of memory" warnings at high frame rates.
-        if (m_captureRunning) {
-            if (m_frameCount <= 5) {
-                qCDebug(log_ffmpeg_backend) << "Emitting frameReadyImage signal for frame" << m_frameCount;
+        // Reserve a GUI slot; if none is free the GUI is still catching up - drop this frame.
+        if (m_framePacer->TryQueueFrame()) {
+            // Only frames that actually reach the GUI are hashed, so the
+            // detector always compares against what is on screen.
+            QList<QRect> dirtyRects;
+            if (m_changeDetector && m_changeDetectorResetPending.exchange(false, std::memory_order_acq_rel)) {
+                m_changeDetector->Reset();
             }
-            // Atomically increment; if the previous value was < 2 we may emit,
-            // otherwise the GUI is still catching up - drop this frame.
-            if (m_pendingFrameCount->fetch_add(1, std::memory_order_acq_rel) < 2) {
-                emit frameReadyImage(image);
+            if (m_changeDetector && !m_changeDetector->Detect(image, &dirtyRects)) {
+                // Nothing changed: skip the queued event and the repaint
+                m_framePacer->CancelQueuedFrame();
+                m_staticFramesSkipped.fetch_add(1, std::memory_order_relaxed);
             } else {
-                // GUI thread is backlogged – undo the increment and drop the frame
-                m_pendingFrameCount->fetch_sub(1, std::memory_order_release);
+                emit frameReadyImage(image);
+                emit frameReadyWithRegions(image, dirtyRects, timing.capture_us - timing.read_us,
+                                           FFmpegMonotonicTimeUs());
             }
+        } else {
+            // GUI thread is backlogged – drop the frame
+            m_latencyTracer->RecordGateDrop();
         }
+    }
+    
+    // Write frame to recording file if recording is active (stream copy is fed from processFrame)
+    if (m_recorder && m_recorder->IsRecording() && !m_recorder->IsPaused() && !m_recorder->IsStreamCopy()) {
+        // FRAME RATE CONTROL: Only write frames at the target recording framerate
+        qint64 currentTime = QDateTime::currentMSecsSinceEpoch();
         
-        // Write frame to recording file if recording is active
-        if (m_recorder && m_recorder->IsRecording() && !m_recorder->IsPaused()) {
-            // FRAME RATE CONTROL: Only write frames at the target recording framerate
-            qint64 currentTime = QDateTime::currentMSecsSinceEpoch();
-            
-            if (m_recorder->ShouldWriteFrame(currentTime)) {
-                // Pass QImage directly to recorder (worker thread safe)
-                if (m_recorder->WriteFrame(image)) {
-                    // Update recording duration periodically
-                    static int recordingFrameCount = 0;
-                    if (++recordingFrameCount % 30 == 0) { // Every 30 frames (~1 second at 30fps)
-                        emit recordingDurationChanged(m_recorder->GetRecordingDuration());
-                    }
+        if (m_recorder->ShouldWriteFrame(currentTime)) {
+            // Only queues the frame; the recorder's encoder thread does the
+            // conversion and encoding, stamped with the packet's capture time.
+            // The decoder's YUV frame is preferred (no RGB round trip); the
+            // TurboJPEG path only has the RGB image.
+            AvFramePtr yuvFrame = m_frameProcessor ? m_frameProcessor->TakeYuvFrame(timing.sequence) : AvFramePtr();
+            const bool queued = yuvFrame
+                ? m_recorder->WriteYuvFrame(AV_FRAME_RAW(yuvFrame), timing.capture_us)
+                : m_recorder->WriteFrame(image, timing.capture_us);
+            if (queued) {
+                // Update recording duration periodically
+                if (m_recordingFrameCount.fetch_add(1, std::memory_order_relaxed) % 30 == 29) { // Every 30 frames (~1 second at 30fps)
+                    emit recordingDurationChanged(m_recorder->GetRecordingDuration());
                 }
             }
         }
-        
-        // Reduce success logging frequency for performance
-        if (m_frameCount % 1000 == 1) {
-            qCDebug(log_ffmpeg_backend) << "frameReady signal emitted successfully for frame" << m_frameCount;
-        }
-        
-        // REMOVED: QCoreApplication::processEvents() - this was causing excessive CPU usage
-        // Let Qt's event loop handle frame processing naturally
-    } else {
-        // Only warn for decode failures on packets with actual data
-        if (packet->size > 0) {
-            qCWarning(log_ffmpeg_backend) << "Failed to decode frame - pixmap is null";
-            qCWarning(log_ffmpeg_backend) << "Frame decode failure details:";
-            qCWarning(log_ffmpeg_backend) << "  - Packet size:" << packet->size;
-            qCWarning(log_ffmpeg_backend) << "  - Codec ID:" << (codecContext ? codecContext->codec_id : -1);
-            qCWarning(log_ffmpeg_backend) << "  - Stream index:" << packet->stream_index;
-        }
+    }
+    
+    // Reduce success logging frequency for performance
+    if (frameNumber % 1000 == 1) {
+        qCDebug(log_ffmpeg_backend) << "frameReady signal emitted successfully for frame" << frameNumber;
     }
 }
 
@@ -884,7 +1135,10 @@ void FFmpegBackendHandler::setVideoOutput(QGraphicsVideoItem* videoItem)
     
     // Reset backpressure counter: any in-flight queued events from the old
     // connection will never decrement now, so start fresh.
-    m_pendingFrameCount->store(0, std::memory_order_release);
+    m_framePacer->ResetQueue();
+    
+    // The new output has nothing on screen yet: next frame must be a full update
+    m_changeDetectorResetPending.store(true, std::memory_order_release);
     
     m_graphicsVideoItem = videoItem;
     m_videoPane = nullptr;
@@ -909,10 +1163,10 @@ void FFmpegBackendHandler::setVideoOutput(QGraphicsVideoItem* videoItem)
             // while a frame is still queued in the event loop.
             QPointer<VideoPane> parentPtr(parentVideoPane);
             QPointer<QGraphicsVideoItem> itemPtr(videoItem);
-            auto pendingCount = m_pendingFrameCount;
+            auto pacer = m_framePacer;
             m_videoOutputConnection = connect(this, &FFmpegBackendHandler::frameReadyImage,
-                    parentVideoPane, [pendingCount, parentPtr, itemPtr](const QImage& image) {
-                        pendingCount->fetch_sub(1, std::memory_order_release);
+                    parentVideoPane, [pacer, parentPtr, itemPtr](const QImage& image) {
+                        pacer->OnFrameConsumed();
                         if (!parentPtr) return;
                         QGraphicsVideoItem* item = itemPtr.data();
                         if (!item) return;
@@ -934,13 +1188,22 @@ void FFmpegBackendHandler::setVideoOutput(VideoPane* videoPane)
     // left intact.
     disconnect(m_videoOutputConnection);
     m_videoOutputConnection = QMetaObject::Connection{};
+    disconnect(m_framePaintedConnection);
+    m_framePaintedConnection = QMetaObject::Connection{};
     
     // Reset backpressure counter: any in-flight queued events from the old
     // connection will never decrement now, so start fresh.
-    m_pendingFrameCount->store(0, std::memory_order_release);
+    m_framePacer->ResetQueue();
+    
+    // The new output has nothing on screen yet: next frame must be a full update
+    m_changeDetectorResetPending.store(true, std::memory_order_release);
     
     m_videoPane = videoPane;
     m_graphicsVideoItem = nullptr;
+    {
+        QMutexLocker regionLocker(&m_visibleSourceRectMutex);
+        m_visibleSourceRect = QRectF();
+    }
     
     if (videoPane) {
         qCDebug(log_ffmpeg_backend) << "VideoPane set for FFmpeg direct rendering";
@@ -949,14 +1212,34 @@ void FFmpegBackendHandler::setVideoOutput(VideoPane* videoPane)
         // is destroyed while a frame is still queued.  The lambda also releases
         // one backpressure slot so the capture thread can emit the next frame.
         QPointer<VideoPane> panePtr(videoPane);
-        auto pendingCount = m_pendingFrameCount;
-        m_videoOutputConnection = connect(this, &FFmpegBackendHandler::frameReadyImage,
-                videoPane, [pendingCount, panePtr](const QImage& image) {
-                    pendingCount->fetch_sub(1, std::memory_order_release);
+        auto pacer = m_framePacer;
+        auto tracer = m_latencyTracer;
+        m_videoOutputConnection = connect(this, &FFmpegBackendHandler::frameReadyWithRegions,
+                videoPane, [pacer, tracer, panePtr](const QImage& image, const QList<QRect>& dirtyRects,
+                                                   qint64 readStartUs, qint64 emitUs) {
+                    pacer->OnFrameConsumed();
                     if (!panePtr) return;
-                    panePtr->updateVideoFrameFromImage(image);
+                    const qint64 receiveUs = FFmpegMonotonicTimeUs();
+                    tracer->Record(FFmpegLatencyTracer::Stage::Dispatch, receiveUs - emitUs);
+                    panePtr->updateVideoFrameFromImage(image, dirtyRects);
+                    tracer->FrameReceived(readStartUs, receiveUs);
                 }, Qt::QueuedConnection);
         
+        // Closes the trace of the frame received above once it is on screen and
+        // gives the pacer its paint-rate feedback
+        m_framePaintedConnection = connect(videoPane, &VideoPane::framePainted,
+                this, [tracer, pacer]() {
+                    tracer->FramePainted(FFmpegMonotonicTimeUs());
+                    pacer->OnFramePainted();
+                });
+        
+        // Track the visible part of the frame for region-only decoding when zoomed
+        connect(videoPane, &VideoPane::visibleSourceRectChanged,
+                this, [this](const QRectF& rect) {
+                    QMutexLocker locker(&m_visibleSourceRectMutex);
+                    m_visibleSourceRect = rect;
+                });
+        
         // Connect viewport size changes to update frame scaling
         connect(videoPane, &VideoPane::viewportSizeChanged,
                 this, [this](const QSize& size) {
@@ -964,7 +1247,7 @@ void FFmpegBackendHandler::setVideoOutput(VideoPane* videoPane)
                     // The next frame will automatically use the new viewport size in processFrame
                 });
         
-        qCDebug(log_ffmpeg_backend) << "Connected frameReadyImage signal to VideoPane::updateVideoFrameFromImage with QueuedConnection";
+        qCDebug(log_ffmpeg_backend) << "Connected frameReadyWithRegions signal to VideoPane::updateVideoFrameFromImage with QueuedConnection";
         
         // Enable direct FFmpeg mode in the VideoPane
         videoPane->enableDirectFFmpegMode(true);
@@ -1169,8 +1452,51 @@ bool FFmpegBackendHandler::startRecording(const QString& outputPath, const QStri
     QSize resolution = m_currentResolution.isValid() ? m_currentResolution : QSize(1920, 1080);
     int framerate = m_currentFramerate > 0 ? m_currentFramerate : 30;
     
+    RecordingConfig config = m_recorder->GetRecordingConfig();
+    if (config.stream_copy) {
+        AVCodecContext* codecContext = m_deviceManager ? m_deviceManager->GetCodecContext() : nullptr;
+        if (!codecContext || codecContext->codec_id != AV_CODEC_ID_MJPEG) {
+            // Nothing to copy: the device is not delivering MJPEG
+            qCWarning(log_ffmpeg_backend) << "Stream copy needs an MJPEG source, falling back to re-encoding";
+            config.stream_copy = false;
+            config.video_codec = "mjpeg";
+            m_recorder->SetRecordingConfig(config);
+        } else if (m_frameProcessor && m_frameProcessor->GetNativeJpegSize().isValid()) {
+            // Packets are stored at the camera's native size, whatever the display decodes at
+            resolution = m_frameProcessor->GetNativeJpegSize();
+        }
+    }
+    
+    // Encoder backlog: how many frames may wait and which one goes when it is full
+    GlobalSetting& settings = GlobalSetting::instance();
+    config.encoder_queue_capacity = qBound(1, settings.getRecordingEncoderQueueCapacity(), 120);
+    config.drop_policy = settings.getRecordingDropPolicy() == "newest" ? RecordingDropPolicy::DropNewest
+                                                                       : RecordingDropPolicy::DropOldest;
+    
+    // HDMI audio: the PCM captured by AudioManager is tapped into the recorder
+    const QAudioFormat audioFormat = configureRecordingAudio(config);
+    m_recorder->SetRecordingConfig(config);
+    
+    // Recorded frames are decoded at least at the recording rate, whatever the display needs
+    m_framePacer->SetRecordingFrameRate(framerate);
     bool success = m_recorder->StartRecording(outputPath, format, videoBitrate, resolution, framerate);
     
+    if (success && m_recorder->IsRecordingAudio()) {
+        FFmpegRecorder* recorder = m_recorder.get();
+        AudioManager::getInstance().setPcmTap(
+            [recorder, audioFormat](const char* data, qint64 size, const QAudioFormat& format) {
+                // A device switch mid-recording changes the layout; skip until it matches again
+                if (format == audioFormat) {
+                    recorder->WriteAudio(data, size, FFmpegMonotonicTimeUs());
+                }
+            });
+    }
+    
+    if (m_frameProcessor) {
+        // Re-encoding takes the decoder's YUV planes instead of the display image
+        m_frameProcessor->SetYuvFrameRetention(success && !m_recorder->IsStreamCopy());
+    }
+    
     if (success) {
         m_recordingActive = true;
         emit recordingStarted(outputPath);
@@ -1187,6 +1513,10 @@ bool FFmpegBackendHandler::stopRecording()
         return false;
     }
     
+    AudioManager::getInstance().setPcmTap({});
+    if (m_frameProcessor) {
+        m_frameProcessor->SetYuvFrameRetention(false);
+    }
     bool success = m_recorder->StopRecording();
     
     if (success) {
@@ -1258,6 +1588,47 @@ bool FFmpegBackendHandler::supportsAdvancedRecording() const
     return m_recorder ? m_recorder->SupportsAdvancedRecording() : false;
 }
 
+QAudioFormat FFmpegBackendHandler::configureRecordingAudio(RecordingConfig& config) const
+{
+    GlobalSetting& settings = GlobalSetting::instance();
+    config.record_audio = settings.getRecordingAudioEnabled();
+    if (!config.record_audio) {
+        return QAudioFormat();
+    }
+    
+    config.audio_codec = settings.getRecordingAudioCodec().toLower();
+    config.audio_sample_rate = settings.getRecordingAudioSampleRate();
+    config.audio_bitrate = settings.getRecordingAudioBitrate() * 1000;  // Stored in kbps
+    
+    const QAudioFormat format = AudioManager::getInstance().getCurrentAudioFormat();
+    FFmpegAudioEncoder::InputFormat input;
+    input.sample_rate = format.sampleRate();
+    input.channels = format.channelCount();
+    switch (format.sampleFormat()) {
+    case QAudioFormat::Int16:
+        input.sample_format = FFmpegAudioEncoder::SampleFormat::Int16;
+        break;
+    case QAudioFormat::Int32:
+        input.sample_format = FFmpegAudioEncoder::SampleFormat::Int32;
+        break;
+    case QAudioFormat::Float:
+        input.sample_format = FFmpegAudioEncoder::SampleFormat::Float;
+        break;
+    default:
+        input.sample_rate = 0;
+        break;
+    }
+    
+    if (!format.isValid() || !input.IsValid()) {
+        qCWarning(log_ffmpeg_backend) << "No usable HDMI audio capture running, recording video only";
+        config.record_audio = false;
+        return QAudioFormat();
+    }
+    
+    config.audio_input = input;
+    return format;
+}
+
 bool FFmpegBackendHandler::startRecordingAdvanced(const QString& outputPath, const RecordingConfig& config)
 {
     if (!m_recorder) {
@@ -1274,6 +1645,10 @@ bool FFmpegBackendHandler::forceStopRecording()
         return false;
     }
     
+    AudioManager::getInstance().setPcmTap({});
+    if (m_frameProcessor) {
+        m_frameProcessor->SetYuvFrameRetention(false);
+    }
     bool success = m_recorder->ForceStopRecording();
     
     if (success) {
@@ -1307,36 +1682,115 @@ QImage FFmpegBackendHandler::getLatestOriginalFrame() const
     return m_frameProcessor->GetLatestOriginalFrame();
 }
 
+void FFmpegBackendHandler::setFrameBus(FrameBus* frameBus)
+{
+    if (m_frameBus && m_frameBus != frameBus) {
+        m_frameBus->setFrameProvider(nullptr);
+        m_frameBus->reset();
+    }
+    MultimediaBackendHandler::setFrameBus(frameBus);
+    if (m_frameBus) {
+        m_frameBus->setFrameProvider([this]() { return getLatestOriginalFrame(); });
+    }
+}
+
+EncodedFrame FFmpegBackendHandler::getLatestEncodedFrame() const
+{
+    if (!m_frameProcessor) {
+        return EncodedFrame();
+    }
+    return m_frameProcessor->GetLatestEncodedFrame();
+}
+
+FFmpegFramePool::Stats FFmpegBackendHandler::getFramePoolStats() const
+{
+    if (!m_frameProcessor) {
+        return FFmpegFramePool::Stats();
+    }
+    return m_frameProcessor->GetFramePoolStats();
+}
+
+FFmpegDecodePipeline::Stats FFmpegBackendHandler::getDecodePipelineStats() const
+{
+    if (!m_decodePipeline) {
+        return FFmpegDecodePipeline::Stats();
+    }
+    return m_decodePipeline->GetStats();
+}
+
+FFmpegFramePacer::Metrics FFmpegBackendHandler::getFramePacerMetrics() const
+{
+    return m_framePacer->GetMetrics();
+}
+
+FFmpegLatencyTracer::Snapshot FFmpegBackendHandler::getLatencySnapshot() const
+{
+    return m_latencyTracer->GetSnapshot();
+}
+
+bool FFmpegBackendHandler::dumpLatencyCsv(const QString& path) const
+{
+    return FFmpegLatencyTracer::AppendCsv(path, m_latencyTracer->GetSnapshot());
+}
+
+bool FFmpegBackendHandler::startPacketCapture(const QString& path)
+{
+    // The file header needs the stream's codec and size, so capture must be running
+    AVCodecContext* codecContext = m_deviceManager ? m_deviceManager->GetCodecContext() : nullptr;
+    if (!m_captureRunning || !codecContext) {
+        qCWarning(log_ffmpeg_backend) << "Cannot start packet capture: capture is not running";
+        return false;
+    }
+
+    QSize resolution(codecContext->width, codecContext->height);
+    if (resolution.isEmpty()) {
+        resolution = m_currentResolution;
+    }
+    return m_packetCapture->Open(path, codecContext->codec_id, resolution, qMax(0, m_currentFramerate));
+}
+
+void FFmpegBackendHandler::stopPacketCapture()
+{
+    m_packetCapture->Close();
+}
+
 void FFmpegBackendHandler::takeImage(const QString& filePath)
 {
-    if (!m_frameProcessor || !m_recorder) {
-        qCWarning(log_ffmpeg_backend) << "Frame processor or recorder not initialized";
+    if (!m_frameProcessor) {
+        qCWarning(log_ffmpeg_backend) << "Frame processor not initialized";
+        emit imageSaved(filePath, false, 0);
         return;
     }
     
-    QImage originalImage = m_frameProcessor->GetLatestOriginalFrame();
-    if (originalImage.isNull()) {
-        qCWarning(log_ffmpeg_backend) << "No original frame available for image capture";
-        return;
+    ImageSaveOptions options;
+    options.quality = GlobalSetting::instance().getScreenshotQuality();
+    
+    // Full-frame JPEG screenshots are written straight from the camera's MJPEG
+    // packet, skipping the decode/encode round trip.
+    if (FFmpegImageSaver::ResolveFormat(filePath, options) == "jpg") {
+        EncodedFrame encoded = m_frameProcessor->GetLatestEncodedFrame();
+        if (!encoded.isNull()) {
+            m_imageSaver->SaveEncoded(filePath, encoded.data);
+            return;
+        }
     }
     
-    m_recorder->TakeImage(filePath, originalImage);
+    // A frame left undecoded by a region-only decode is decoded on the saver's
+    // worker, not here on the GUI thread
+    m_imageSaver->SaveDecoded(filePath, m_frameProcessor->GetLatestOriginalFrameSource(), QRect(), options);
 }
 
 void FFmpegBackendHandler::takeAreaImage(const QString& filePath, const QRect& captureArea)
 {
-    if (!m_frameProcessor || !m_recorder) {
-        qCWarning(log_ffmpeg_backend) << "Frame processor or recorder not initialized";
-        return;
-    }
-    
-    QImage originalImage = m_frameProcessor->GetLatestOriginalFrame();
-    if (originalImage.isNull()) {
-        qCWarning(log_ffmpeg_backend) << "No original frame available for area image capture";
+    if (!m_frameProcessor) {
+        qCWarning(log_ffmpeg_backend) << "Frame processor not initialized";
+        emit imageSaved(filePath, false, 0);
         return;
     }
     
-    m_recorder->TakeAreaImage(filePath, originalImage, captureArea);
+    ImageSaveOptions options;
+    options.quality = GlobalSetting::instance().getScreenshotQuality();
+    m_imageSaver->SaveDecoded(filePath, m_frameProcessor->GetLatestOriginalFrameSource(), captureArea, options);
 }
 
 
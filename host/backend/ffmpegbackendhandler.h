@@ -25,10 +25,18 @@
 
 #include "../multimediabackend.h"
 #include "ffmpeg/icapture_frame_reader.h"
+#include "ffmpeg/ffmpeg_frame_pool.h"
+#include "ffmpeg/ffmpeg_decode_pipeline.h"
+#include "ffmpeg/ffmpeg_encoded_frame.h"
+#include "ffmpeg/ffmpeg_frame_change_detector.h"
+#include "ffmpeg/ffmpeg_latency_tracer.h"
+#include "ffmpeg/ffmpeg_frame_pacer.h"
+#include "ffmpeg/ffmpeg_packet_capture_file.h"
 #include <QThread>
 #include <QLoggingCategory>
 Q_DECLARE_LOGGING_CATEGORY(log_ffmpeg_backend)
 #include <QTimer>
+#include <QAudioFormat>
 #include <QMutex>
 #include <QWaitCondition>
 #include <memory>
@@ -57,6 +65,9 @@ class FFmpegFrameProcessor;
 class FFmpegRecorder;
 struct RecordingConfig; // Defined in ffmpeg_recorder.h
 
+// Forward declare FFmpegImageSaver class
+class FFmpegImageSaver;
+
 // Forward declare FFmpegDeviceValidator class
 class FFmpegDeviceValidator;
 
@@ -157,13 +168,43 @@ public:
     void setRecordingConfig(const RecordingConfig& config);
     RecordingConfig getRecordingConfig() const;
 
-    // Image capture methods
+    // Image capture methods; both return at once and report through imageSaved()
     void takeImage(const QString& filePath);
     void takeAreaImage(const QString& filePath, const QRect& captureArea);
 
     // Returns the latest frame at the camera's native resolution (before any display scaling).
+    // The image shares the decoder's pooled buffer; treat it as read-only.
     QImage getLatestOriginalFrame() const;
 
+    // Camera-supplied JPEG bytes for the same frame (null unless the source is MJPEG).
+    // Serve these directly whenever no crop or scale is needed.
+    EncodedFrame getLatestEncodedFrame() const;
+
+    // Publishes each decoded frame; the native image is decoded only when a bus consumer asks
+    void setFrameBus(FrameBus* frameBus) override;
+
+    // Frame buffer pool counters (hits/misses should stop growing once warmed up)
+    FFmpegFramePool::Stats getFramePoolStats() const;
+
+    // Reader/decode/delivery stage counters for the capture pipeline
+    FFmpegDecodePipeline::Stats getDecodePipelineStats() const;
+
+    // Current frame pacing decisions (decode rate/scale) and their inputs
+    FFmpegFramePacer::Metrics getFramePacerMetrics() const;
+
+    // Per-stage latency percentiles, read to paint (current 5-second stats window)
+    FFmpegLatencyTracer::Snapshot getLatencySnapshot() const;
+    bool dumpLatencyCsv(const QString& path) const;
+
+    // Copies every camera packet of the running capture into a packet capture
+    // file for offline replay (FFmpegReplayFrameReader / --video-benchmark)
+    bool startPacketCapture(const QString& path);
+    void stopPacketCapture();
+    bool isPacketCapturing() const { return m_packetCapture->IsOpen(); }
+
+    // Frames not sent to the GUI because no tile changed (current 5-second stats window)
+    quint64 getStaticFramesSkipped() const { return m_staticFramesSkipped.load(std::memory_order_relaxed); }
+
     // Update preferred hardware acceleration from settings
     void updatePreferredHardwareAcceleration();
 
@@ -193,6 +234,9 @@ public:
 signals:
     void frameReady(const QImage& frame);
     void frameReadyImage(const QImage& frame);  // Thread-safe QImage signal for better performance
+    // Same frame plus changed areas; the timestamps (FFmpegMonotonicTimeUs) feed the latency tracer
+    void frameReadyWithRegions(const QImage& frame, const QList<QRect>& dirtyRects, qint64 readStartUs, qint64 emitUs);
+    void latencyStatsChanged(const QString& summary);  // Per-stage p50/p95/p99, every stats window
     void captureError(const QString& error);
     void deviceConnectionChanged(const QString& devicePath, bool connected);
     void deviceActivated(const QString& devicePath);
@@ -207,6 +251,9 @@ signals:
     void recordingError(const QString& error);
     void recordingDurationChanged(qint64 duration);
 
+    // Screenshot written (or failed); elapsedMs covers queueing, encoding and the write
+    void imageSaved(const QString& filePath, bool success, qint64 elapsedMs);
+
 private:
     // FFmpeg interrupt callback (needs access to private members)
     static int interruptCallback(void* ctx);
@@ -218,6 +265,13 @@ private:
     bool openInputDevice(const QString& devicePath, const QSize& resolution, int framerate);
     void closeInputDevice();
     
+    // Delivery stage: runs in capture order on a decoder worker thread
+    void deliverDecodedFrame(const QImage& image, const FFmpegDecodePipeline::FrameTiming& timing);
+    
+    // Fills the audio part of `config` from settings and the running audio
+    // capture; returns the capture format the PCM tap must match.
+    QAudioFormat configureRecordingAudio(RecordingConfig& config) const;
+    
     // Hardware acceleration - delegated to FFmpegHardwareAccelerator
     bool initializeHardwareAcceleration();
     void cleanupHardwareAcceleration();
@@ -250,9 +304,21 @@ private:
     // Frame processing - managed by dedicated class
     std::unique_ptr<FFmpegFrameProcessor> m_frameProcessor;
     
+    // Multi-threaded decode stage between the capture thread and delivery
+    std::unique_ptr<FFmpegDecodePipeline> m_decodePipeline;
+    
+    // Tile-hash comparison of delivered frames; only used by the delivery stage
+    std::unique_ptr<FFmpegFrameChangeDetector> m_changeDetector;
+    std::atomic<quint64> m_staticFramesSkipped{0};
+    std::atomic<bool> m_changeDetectorResetPending{false};  // Set when a new output needs a full frame
+    std::atomic<int> m_recordingFrameCount{0};  // Frames queued to the recorder, for duration updates
+    
     // Video recording - managed by dedicated class
     std::unique_ptr<FFmpegRecorder> m_recorder;
     
+    // Screenshot encoding and writing - background worker pool
+    std::unique_ptr<FFmpegImageSaver> m_imageSaver;
+    
     // Device validation - managed by dedicated class
     std::unique_ptr<FFmpegDeviceValidator> m_deviceValidator;
     
@@ -294,15 +360,37 @@ private:
     // Disconnecting via handle targets only this specific lambda, leaving other
     // observers (e.g. CameraManager bridge) untouched.
     QMetaObject::Connection m_videoOutputConnection;
+    QMetaObject::Connection m_framePaintedConnection;
+    
+    // Part of the source frame visible in the VideoPane while zoomed in
+    // (normalized; null when the whole frame is visible).  Written on the GUI
+    // thread, read by the capture thread to request region-only decodes.
+    QRectF m_visibleSourceRect;
+    mutable QMutex m_visibleSourceRectMutex;
     
     // Error tracking
     QString m_lastError;
     
 
-    // Frame backpressure: limits the number of QImage copies queued in the GUI event
-    // loop via QueuedConnection, preventing unbounded memory growth and OOM conditions
-    // when the capture thread produces frames faster than the GUI thread consumes them.
-    std::shared_ptr<std::atomic<int>> m_pendingFrameCount;
+    // Decode pacing and frame backpressure: picks the decode rate and size from
+    // measured paint rate, decoder load and queue depth, and limits the number of
+    // QImage copies queued in the GUI event loop via QueuedConnection so frames
+    // produced faster than the GUI consumes them cannot exhaust memory.  Shared
+    // with the lambda captures in the GUI-side slots; updated by m_pacingTimer.
+    std::shared_ptr<FFmpegFramePacer> m_framePacer;
+    QTimer* m_pacingTimer;
+
+    // Per-stage frame latency, shared with the GUI-side slots like m_framePacer.
+    // Rows are appended to m_latencyCsvPath (OPENTERFACE_LATENCY_CSV) every stats window.
+    std::shared_ptr<FFmpegLatencyTracer> m_latencyTracer;
+    QString m_latencyCsvPath;
+
+    // Raw packet capture for replay; opened by startPacketCapture() or, for every
+    // capture session, by OPENTERFACE_PACKET_CAPTURE=<file>.otpkt.  Written by processFrame().
+    // Later sessions (restarts, hotplug) write <file>-2.otpkt, <file>-3.otpkt, ...
+    std::unique_ptr<FFmpegPacketCaptureWriter> m_packetCapture;
+    QString m_packetCaptureEnvPath;
+    int m_packetCaptureSessions = 0;
 
     // Thread safety
     mutable QMutex m_mutex;
@@ -310,12 +398,12 @@ private:
     
     // Performance monitoring
     QTimer* m_performanceTimer;
-    int m_frameCount;
+    std::atomic<int> m_frameCount;      // Written by decoder/reader threads, reset by the GUI timer
     qint64 m_lastFrameTime;
     
     // Frame rate control and timestamp synchronization
     double m_targetFrameIntervalMs;     // Target interval between frames in milliseconds
-    qint64 m_lastFrameDisplayTime;      // Timestamp of last displayed frame (system time)
+    std::atomic<qint64> m_lastFrameDisplayTime;   // Timestamp of last displayed frame (system time)
     qint64 m_firstFrameSystemTime;      // System time when first frame was captured
     qint64 m_firstFramePts;             // PTS value of first frame
     qint64 m_lastPacketPts;             // PTS of last packet for actual FPS detection
@@ -323,7 +411,7 @@ private:
     bool m_timeSyncInitialized;         // Whether time sync has been initialized
     double m_detectedFrameIntervalMs;   // Detected actual frame interval from stream PTS
     int m_ptsFrameCount;                // Count frames for FPS detection
-    qint64 m_lastForceDisplayTime;      // Last time a frame was force-displayed (safety fallback)
+    std::atomic<qint64> m_lastForceDisplayTime;   // Last time a frame was force-displayed (safety fallback)
 };
 
 #endif // FFMPEGBACKENDHANDLER_H
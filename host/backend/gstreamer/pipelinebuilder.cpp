@@ -9,17 +9,36 @@ OPF_LOGGING_CATEGORY(log_gstreamer_pipelinebuilder, "opf.backend.gstreamer.pipel
 
 using namespace Openterface::GStreamer;
 
+namespace {
+
+// Split the camera's JPEG before decoding. "jpegtee" feeds the frame tap
+// (latest native frame, held as a ref) and lets RecordingManager mux the
+// MJPEG as-is; the returned string ends on the branch that goes on to jpegdec.
+QString compressedTee()
+{
+    return QStringLiteral(
+        "tee name=jpegtee allow-not-linked=true "
+        "jpegtee. ! queue name=frame-tap-queue max-size-buffers=1 leaky=downstream ! "
+        "appsink name=frame-tap max-buffers=1 drop=true sync=false async=false emit-signals=false "
+        "jpegtee. ! queue name=decode-queue max-size-buffers=2");
+}
+
+} // namespace
+
 QString PipelineBuilder::buildFlexiblePipeline(const QString& device, const QSize& resolution, int framerate, const QString& videoSink, const QSize& widgetSize)
 {
     // Keep the same structure as old generatePipelineString to preserve recording/tee names
     QString sourceElement = "v4l2src device=%DEVICE% do-timestamp=true";
-    QString decoderElement = "image/jpeg,width=%WIDTH%,height=%HEIGHT%,framerate=%FRAMERATE%/1 ! jpegdec";
+    QString decoderElement = "image/jpeg,width=%WIDTH%,height=%HEIGHT%,framerate=%FRAMERATE%/1 ! " +
+                             compressedTee() + " ! jpegdec";
 
     // Calculate the output size for videoscale: output EXACTLY the display size with
     // black borders (letterbox/pillarbox) to fill the screen. This is critical on
     // small screens (e.g. 640x480 Pi touchscreens) where the camera resolution
     // (e.g. 1280x720) exceeds the display.
     // We use add-borders=true to fill the full display size with black bars.
+    // The caps sit in a named capsfilter ("display-caps") so the handler can
+    // change the size on resize and renegotiate without rebuilding the pipeline.
     QString scaleCaps = "video/x-raw,pixel-aspect-ratio=1/1";
     if (widgetSize.width() > 0 && widgetSize.height() > 0 && resolution.width() > 0 && resolution.height() > 0) {
         // Output exactly the display size; videoscale with add-borders=true will
@@ -31,7 +50,7 @@ QString PipelineBuilder::buildFlexiblePipeline(const QString& device, const QSiz
                       decoderElement + " ! " +
                       "videoconvert ! "
                       "videoscale method=lanczos ! "
-                      "%SCALE_CAPS% ! " +
+                      "capsfilter name=display-caps caps=\"%SCALE_CAPS%\" ! " +
                       "identity sync=true ! "
                       "tee name=t allow-not-linked=true "
                       "t. ! queue name=display-queue max-size-buffers=2 leaky=downstream ! " + videoSink + " name=videosink sync=true "
@@ -67,7 +86,8 @@ QString PipelineBuilder::buildV4l2JpegFallback(const QString& device, const QSiz
 {
     QString tmpl(
         "v4l2src device=%DEVICE% ! "
-        "image/jpeg,width=%WIDTH%,height=%HEIGHT%,framerate=%FRAMERATE%/1 ! "
+        "image/jpeg,width=%WIDTH%,height=%HEIGHT%,framerate=%FRAMERATE%/1 ! " +
+        compressedTee() + " ! "
         "jpegdec ! "
         "videoconvert ! "
         "tee name=t ! queue name=display-queue max-size-buffers=5 leaky=downstream ! %SINK% name=videosink sync=false "
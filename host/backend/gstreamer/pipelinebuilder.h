@@ -11,7 +11,9 @@ namespace GStreamer {
 class PipelineBuilder
 {
 public:
-    // Flexible pipeline - recording-enabled template using v4l2src + jpegdec and scaling
+    // Flexible pipeline - recording-enabled template using v4l2src + jpegdec and scaling.
+    // MJPEG pipelines split the camera JPEG at "jpegtee" before jpegdec: the
+    // "frame-tap" appsink holds the latest frame and recordings can mux it as-is.
     // widgetSize: optional target display size; if provided and valid, videoscale output
     // is constrained to fit the widget so video isn't clipped on small screens
     static QString buildFlexiblePipeline(const QString& device, const QSize& resolution, int framerate, const QString& videoSink, const QSize& widgetSize = QSize());
@@ -0,0 +1,398 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#include "pipelineprobes.h"
+#include "../common/latencyhistogram.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+#include <array>
+#include <atomic>
+
+#ifdef HAVE_GSTREAMER
+#include <gst/gst.h>
+#endif
+
+#include "log/opflogging.h"
+OPF_LOGGING_CATEGORY(log_gstreamer_probes, "opf.backend.gstreamer.probes")
+
+using namespace Openterface::GStreamer;
+
+namespace {
+
+constexpr quint64 kNoPts = ~0ULL;
+constexpr int kInFlightSlots = 16;   // Buffers an element may hold before its arrival time is forgotten
+
+qint64 monotonicUs()
+{
+#ifdef HAVE_GSTREAMER
+    return g_get_monotonic_time();
+#else
+    return QDateTime::currentMSecsSinceEpoch() * 1000;
+#endif
+}
+
+} // namespace
+
+struct PipelineProbes::Element
+{
+    QString name;
+    bool isQueue = false;
+    bool isSink = false;
+    bool timed = false;         // Has a sink pad, so time inside the element can be measured
+
+    LatencyHistogram residence;   // Same buckets as the FFmpeg latency tracer
+    LatencyHistogram age;
+    std::atomic<quint64> in{0};
+    std::atomic<quint64> out{0};
+    std::atomic<quint64> overruns{0};
+
+    // Arrival time per PTS, written on the sink pad and matched on the src pad
+    std::array<std::atomic<quint64>, kInFlightSlots> arrivalPts;
+    std::array<std::atomic<qint64>, kInFlightSlots> arrivalUs{};
+    std::atomic<quint32> nextSlot{0};
+
+    // GUI thread only
+    quint64 lastIn = 0;
+    quint64 lastOut = 0;
+    int lastLevel = 0;
+
+#ifdef HAVE_GSTREAMER
+    GstElement* element = nullptr;
+    GstClock* clock = nullptr;
+    GstClockTime baseTime = 0;
+    GstPad* sinkPad = nullptr;
+    GstPad* srcPad = nullptr;
+    gulong sinkProbe = 0;
+    gulong srcProbe = 0;
+    gulong overrunHandler = 0;
+#endif
+
+    Element()
+    {
+        for (auto& pts : arrivalPts) pts.store(kNoPts, std::memory_order_relaxed);
+    }
+
+    ~Element()
+    {
+#ifdef HAVE_GSTREAMER
+        if (clock) gst_object_unref(clock);
+        if (element) gst_object_unref(element);
+#endif
+    }
+
+#ifdef HAVE_GSTREAMER
+    qint64 ageUs(GstClockTime pts) const
+    {
+        if (!clock || !GST_CLOCK_TIME_IS_VALID(pts)) return -1;
+        // Live sources stamp PTS in running time (segment starts at 0), so no segment conversion
+        const GstClockTime now = gst_clock_get_time(clock);
+        if (now < baseTime + pts) return 0;
+        return static_cast<qint64>((now - baseTime - pts) / GST_USECOND);
+    }
+#endif
+};
+
+#ifdef HAVE_GSTREAMER
+namespace {
+
+using ElementRef = std::shared_ptr<PipelineProbes::Element>;
+
+void releaseElementRef(gpointer data)
+{
+    delete static_cast<ElementRef*>(data);
+}
+
+void releaseElementRefClosure(gpointer data, GClosure*)
+{
+    delete static_cast<ElementRef*>(data);
+}
+
+GstPadProbeReturn sinkProbeCb(GstPad*, GstPadProbeInfo* info, gpointer userData)
+{
+    PipelineProbes::Element* e = static_cast<ElementRef*>(userData)->get();
+    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (!buffer) return GST_PAD_PROBE_OK;
+
+    e->in.fetch_add(1, std::memory_order_relaxed);
+    const GstClockTime pts = GST_BUFFER_PTS(buffer);
+    if (e->isSink) {
+        // Nothing downstream: age on arrival is the end-to-end latency
+        const qint64 age = e->ageUs(pts);
+        if (age >= 0) e->age.record(age);
+        return GST_PAD_PROBE_OK;
+    }
+    if (!GST_CLOCK_TIME_IS_VALID(pts)) return GST_PAD_PROBE_OK;
+
+    const quint32 slot = e->nextSlot.fetch_add(1, std::memory_order_relaxed) % kInFlightSlots;
+    e->arrivalUs[slot].store(monotonicUs(), std::memory_order_relaxed);
+    e->arrivalPts[slot].store(pts, std::memory_order_release);
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn srcProbeCb(GstPad*, GstPadProbeInfo* info, gpointer userData)
+{
+    PipelineProbes::Element* e = static_cast<ElementRef*>(userData)->get();
+    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (!buffer) return GST_PAD_PROBE_OK;
+
+    e->out.fetch_add(1, std::memory_order_relaxed);
+    const GstClockTime pts = GST_BUFFER_PTS(buffer);
+    const qint64 age = e->ageUs(pts);
+    if (age >= 0) e->age.record(age);
+    if (!GST_CLOCK_TIME_IS_VALID(pts) || !e->timed) return GST_PAD_PROBE_OK;
+
+    for (int i = 0; i < kInFlightSlots; ++i) {
+        quint64 expected = pts;
+        if (e->arrivalPts[i].load(std::memory_order_acquire) == expected &&
+            e->arrivalPts[i].compare_exchange_strong(expected, kNoPts, std::memory_order_acq_rel)) {
+            e->residence.record(monotonicUs() - e->arrivalUs[i].load(std::memory_order_relaxed));
+            break;
+        }
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+void queueOverrunCb(GstElement*, gpointer userData)
+{
+    static_cast<ElementRef*>(userData)->get()->overruns.fetch_add(1, std::memory_order_relaxed);
+}
+
+int queueLevel(GstElement* queue, const char* property)
+{
+    guint value = 0;
+    g_object_get(queue, property, &value, nullptr);
+    return static_cast<int>(value);
+}
+
+} // namespace
+#endif
+
+PipelineProbes::PipelineProbes()
+{
+    m_windowStartUs = monotonicUs();
+}
+
+PipelineProbes::~PipelineProbes()
+{
+    detach();
+}
+
+bool PipelineProbes::enabledByEnvironment()
+{
+    return qEnvironmentVariableIntValue("OPENTERFACE_GST_PROBES") != 0;
+}
+
+void PipelineProbes::attach(void* pipeline)
+{
+    detach();
+#ifdef HAVE_GSTREAMER
+    GstElement* bin = static_cast<GstElement*>(pipeline);
+    if (!bin || !GST_IS_PIPELINE(bin)) return;
+
+    GstClock* clock = gst_pipeline_get_clock(GST_PIPELINE(bin));
+    const GstClockTime baseTime = gst_element_get_base_time(bin);
+
+    // Sorted iteration runs sinks first; collect, then reverse to read upstream to downstream
+    std::vector<GstElement*> found;
+    GstIterator* it = gst_bin_iterate_sorted(GST_BIN(bin));
+    GValue item = G_VALUE_INIT;
+    bool done = false;
+    while (!done) {
+        switch (gst_iterator_next(it, &item)) {
+        case GST_ITERATOR_OK:
+            found.push_back(GST_ELEMENT(gst_object_ref(g_value_get_object(&item))));
+            g_value_reset(&item);
+            break;
+        case GST_ITERATOR_RESYNC:
+            for (GstElement* element : found) gst_object_unref(element);
+            found.clear();
+            gst_iterator_resync(it);
+            break;
+        default:
+            done = true;
+            break;
+        }
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+    std::reverse(found.begin(), found.end());
+
+    for (GstElement* gstElement : found) {
+        GstPad* sinkPad = gst_element_get_static_pad(gstElement, "sink");
+        GstPad* srcPad = gst_element_get_static_pad(gstElement, "src");
+        const bool isSink = GST_OBJECT_FLAG_IS_SET(gstElement, GST_ELEMENT_FLAG_SINK) && !srcPad;
+        // Tees and other request-pad elements have no single in/out pair to time
+        if (!srcPad && !isSink) {
+            if (sinkPad) gst_object_unref(sinkPad);
+            gst_object_unref(gstElement);
+            continue;
+        }
+
+        auto element = std::make_shared<Element>();
+        element->name = QString::fromUtf8(GST_ELEMENT_NAME(gstElement));
+        element->isQueue = g_strcmp0(G_OBJECT_TYPE_NAME(gstElement), "GstQueue") == 0;
+        element->isSink = isSink;
+        element->timed = sinkPad != nullptr;
+        element->element = gstElement;
+        element->clock = clock ? GST_CLOCK(gst_object_ref(clock)) : nullptr;
+        element->baseTime = baseTime;
+        element->sinkPad = sinkPad;
+        element->srcPad = srcPad;
+
+        if (sinkPad) {
+            element->sinkProbe = gst_pad_add_probe(sinkPad, GST_PAD_PROBE_TYPE_BUFFER, sinkProbeCb,
+                                                   new ElementRef(element), releaseElementRef);
+        }
+        if (srcPad) {
+            element->srcProbe = gst_pad_add_probe(srcPad, GST_PAD_PROBE_TYPE_BUFFER, srcProbeCb,
+                                                  new ElementRef(element), releaseElementRef);
+        }
+        if (element->isQueue) {
+            element->overrunHandler = g_signal_connect_data(gstElement, "overrun", G_CALLBACK(queueOverrunCb),
+                                                            new ElementRef(element), releaseElementRefClosure,
+                                                            GConnectFlags(0));
+            element->lastLevel = queueLevel(gstElement, "current-level-buffers");
+        }
+        m_elements.push_back(element);
+    }
+    if (clock) gst_object_unref(clock);
+
+    m_windowStartUs = monotonicUs();
+    qCDebug(log_gstreamer_probes) << "Pipeline probes attached to" << m_elements.size() << "elements";
+#else
+    Q_UNUSED(pipeline);
+#endif
+}
+
+void PipelineProbes::detach()
+{
+#ifdef HAVE_GSTREAMER
+    // Each probe/handler owns its own reference, so an in-flight callback outlives this
+    for (const auto& element : m_elements) {
+        if (element->sinkPad) {
+            if (element->sinkProbe) gst_pad_remove_probe(element->sinkPad, element->sinkProbe);
+            gst_object_unref(element->sinkPad);
+            element->sinkPad = nullptr;
+        }
+        if (element->srcPad) {
+            if (element->srcProbe) gst_pad_remove_probe(element->srcPad, element->srcProbe);
+            gst_object_unref(element->srcPad);
+            element->srcPad = nullptr;
+        }
+        if (element->overrunHandler) {
+            g_signal_handler_disconnect(element->element, element->overrunHandler);
+            element->overrunHandler = 0;
+        }
+    }
+    if (!m_elements.empty()) {
+        qCDebug(log_gstreamer_probes) << "Pipeline probes detached";
+    }
+#endif
+    m_elements.clear();
+}
+
+bool PipelineProbes::isAttached() const
+{
+    return !m_elements.empty();
+}
+
+PipelineProbes::Snapshot PipelineProbes::takeSnapshot()
+{
+    Snapshot snapshot;
+    const qint64 now = monotonicUs();
+    snapshot.window_ms = (now - m_windowStartUs) / 1000;
+    m_windowStartUs = now;
+
+    for (const auto& element : m_elements) {
+        ElementSummary summary;
+        summary.name = element->name;
+        summary.isQueue = element->isQueue;
+        const LatencyHistogram::Summary residence = element->residence.takeSummary();
+        summary.buffers = residence.samples;
+        summary.p50_ms = residence.p50_ms;
+        summary.p95_ms = residence.p95_ms;
+        summary.p99_ms = residence.p99_ms;
+        summary.max_ms = residence.max_ms;
+        const LatencyHistogram::Summary age = element->age.takeSummary();
+        summary.age_p50_ms = age.p50_ms;
+        summary.age_p95_ms = age.p95_ms;
+
+        const quint64 in = element->in.load(std::memory_order_relaxed);
+        const quint64 out = element->out.load(std::memory_order_relaxed);
+        if (summary.buffers == 0) {
+            summary.buffers = (element->isSink ? in : out) - (element->isSink ? element->lastIn : element->lastOut);
+        }
+#ifdef HAVE_GSTREAMER
+        if (element->isQueue && element->element) {
+            summary.level = queueLevel(element->element, "current-level-buffers");
+            summary.capacity = queueLevel(element->element, "max-size-buffers");
+            summary.overruns = element->overruns.exchange(0, std::memory_order_relaxed);
+            const qint64 unaccounted = static_cast<qint64>(in - element->lastIn) - static_cast<qint64>(out - element->lastOut)
+                                       - (summary.level - element->lastLevel);
+            summary.dropped = unaccounted > 0 ? static_cast<quint64>(unaccounted) : 0;
+            element->lastLevel = summary.level;
+        }
+#endif
+        element->lastIn = in;
+        element->lastOut = out;
+        snapshot.elements.push_back(summary);
+    }
+    return snapshot;
+}
+
+QString PipelineProbes::formatSummary(const Snapshot& snapshot)
+{
+    QString text = QStringLiteral("Element time p50/p95 ms, age p50 ms");
+    for (const ElementSummary& summary : snapshot.elements) {
+        if (summary.buffers == 0 && summary.dropped == 0) {
+            continue;
+        }
+        text += QString("\n%1: %2/%3, age %4")
+            .arg(summary.name)
+            .arg(summary.p50_ms, 0, 'f', 1)
+            .arg(summary.p95_ms, 0, 'f', 1)
+            .arg(summary.age_p50_ms, 0, 'f', 1);
+        if (summary.isQueue) {
+            text += QString(", fill %1/%2, full %3x, dropped %4")
+                .arg(summary.level)
+                .arg(summary.capacity)
+                .arg(summary.overruns)
+                .arg(summary.dropped);
+        }
+    }
+    return text;
+}
+
+bool PipelineProbes::appendCsv(const QString& path, const Snapshot& snapshot)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        return false;
+    }
+
+    QTextStream out(&file);
+    if (file.size() == 0) {
+        out << "timestamp,window_ms,element,buffers,p50_ms,p95_ms,p99_ms,max_ms,age_p50_ms,age_p95_ms,"
+               "level,capacity,overruns,dropped\n";
+    }
+    const QString timestamp = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+    for (const ElementSummary& summary : snapshot.elements) {
+        out << timestamp << ','
+            << snapshot.window_ms << ','
+            << summary.name << ','
+            << summary.buffers << ','
+            << QString::number(summary.p50_ms, 'f', 3) << ','
+            << QString::number(summary.p95_ms, 'f', 3) << ','
+            << QString::number(summary.p99_ms, 'f', 3) << ','
+            << QString::number(summary.max_ms, 'f', 3) << ','
+            << QString::number(summary.age_p50_ms, 'f', 3) << ','
+            << QString::number(summary.age_p95_ms, 'f', 3) << ','
+            << summary.level << ','
+            << summary.capacity << ','
+            << summary.overruns << ','
+            << summary.dropped << '\n';
+    }
+    return out.status() == QTextStream::Ok;
+}
@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#ifndef OPENTERFACE_GSTREAMER_PIPELINEPROBES_H
+#define OPENTERFACE_GSTREAMER_PIPELINEPROBES_H
+
+#include <QString>
+#include <memory>
+#include <vector>
+
+namespace Openterface {
+namespace GStreamer {
+
+// Optional per-element diagnostics for a running pipeline.
+//
+// Pad probes on every element boundary record how long each buffer spent inside
+// the element (matched by PTS between its sink and src pad) and how old it was
+// on the way out (running time minus PTS). Queues additionally report their fill
+// level, how often they ran full, and how many buffers a leaky queue threw away.
+// Recording is lock-free atomics only; the GUI thread takes a snapshot once per
+// stats interval, which also starts a new window.
+class PipelineProbes
+{
+public:
+    struct ElementSummary {
+        QString name;
+        bool isQueue = false;
+        quint64 buffers = 0;        // Buffers that left the element in this window
+        double p50_ms = 0.0;        // Time inside the element
+        double p95_ms = 0.0;
+        double p99_ms = 0.0;
+        double max_ms = 0.0;
+        double age_p50_ms = 0.0;    // Buffer age leaving the element (running time - PTS)
+        double age_p95_ms = 0.0;
+        int level = 0;              // Queues: current-level-buffers at snapshot time
+        int capacity = 0;           // Queues: max-size-buffers (0 = unlimited)
+        quint64 overruns = 0;       // Queues: times the queue ran full
+        quint64 dropped = 0;        // Queues: buffers in minus buffers out, less the level change
+    };
+
+    struct Snapshot {
+        std::vector<ElementSummary> elements;   // Upstream to downstream
+        qint64 window_ms = 0;
+    };
+
+    PipelineProbes();
+    ~PipelineProbes();
+
+    PipelineProbes(const PipelineProbes&) = delete;
+    PipelineProbes& operator=(const PipelineProbes&) = delete;
+
+    // OPENTERFACE_GST_PROBES=1 turns the probes on; they cost a few atomics per buffer per pad
+    static bool enabledByEnvironment();
+
+    // pipeline is a GstElement* (a playing GstPipeline); attaching again replaces the old probes
+    void attach(void* pipeline);
+    void detach();
+    bool isAttached() const;
+
+    Snapshot takeSnapshot();
+
+    // One line per element for the status bar tooltip
+    static QString formatSummary(const Snapshot& snapshot);
+
+    // Appends one row per element to `path` (header written for a new file)
+    static bool appendCsv(const QString& path, const Snapshot& snapshot);
+
+    // Per-element counters, shared with the pad probe callbacks
+    struct Element;
+
+private:
+    std::vector<std::shared_ptr<Element>> m_elements;
+    qint64 m_windowStartUs = 0;
+};
+
+} // namespace GStreamer
+} // namespace Openterface
+
+#endif // OPENTERFACE_GSTREAMER_PIPELINEPROBES_H
@@ -2,6 +2,9 @@
 #include <QDebug>
 #include <QLoggingCategory>
 #include <QThread>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <atomic>
 #ifdef HAVE_GSTREAMER
 #include <gst/app/gstappsink.h>
 #endif
@@ -23,7 +26,12 @@ RecordingManager::RecordingManager(QObject* parent)
 RecordingManager::~RecordingManager()
 {
 #ifdef HAVE_GSTREAMER
-    // Clean up any active recording branch
+    // Clean up any active recording branch; at shutdown a stopping file gets
+    // the chance to finish before its branch goes away
+    if (m_recordingPassthrough) {
+        beginPassthroughFinalize(false);
+    }
+    finishPendingFinalize(3000);
     removeRecordingBranch();
 #endif
 }
@@ -66,8 +74,11 @@ bool RecordingManager::startRecording(GstElement* mainPipeline, const QString& o
     }
 
 #ifdef HAVE_GSTREAMER
-    // Prefer valve-based recording when possible. If that fails, try separate branch or frame-based fallbacks.
-    if (!createRecordingBranch(outputPath, format, videoBitrate)) {
+    // Muxing the camera's MJPEG as-is costs almost no CPU and keeps the native
+    // resolution; otherwise prefer valve-based recording, then the fallbacks.
+    if (createPassthroughRecordingBranch(outputPath, format)) {
+        qCInfo(log_gst_recording) << "Recording camera MJPEG without re-encoding";
+    } else if (!createRecordingBranch(outputPath, format, videoBitrate)) {
         qCWarning(log_gst_recording) << "Valve-based recording not available, attempting separate branch or frame-based fallback";
         // Try adding a separate branch (encoder+filesink) first
         if (!createSeparateRecordingPipeline(outputPath, format, videoBitrate)) {
@@ -227,6 +238,272 @@ bool RecordingManager::createSeparateRecordingPipeline(const QString& outputPath
     return true;
 }
 
+bool RecordingManager::createPassthroughRecordingBranch(const QString& outputPath, const QString& format)
+{
+    const QString container = format.toLower();
+    const char* muxerFactory = nullptr;
+    if (container == "mkv" || container == "matroska") {
+        muxerFactory = "matroskamux";
+    } else if (container == "avi") {
+        muxerFactory = "avimux";
+    } else if (container == "mov") {
+        muxerFactory = "qtmux";
+    } else {
+        qCDebug(log_gst_recording) << "No MJPEG passthrough for format" << format << "- re-encoding";
+        return false;
+    }
+
+    if (!m_mainPipeline) {
+        return false;
+    }
+    GstElement* jpegTee = gst_bin_get_by_name(GST_BIN(m_mainPipeline), "jpegtee");
+    if (!jpegTee) {
+        qCDebug(log_gst_recording) << "Pipeline has no compressed tee - re-encoding";
+        return false;
+    }
+
+    // Names differ from the template's "recording-*" elements, which stay in the pipeline
+    // Numbered, since the previous branch may still be finalizing in the same bin
+    const QByteArray serial = QByteArray::number(++m_passthroughSerial);
+    auto elementName = [&serial](const char* base) { return QByteArray(base) + '-' + serial; };
+    GstElement* valve = gst_element_factory_make("valve", elementName("mjpeg-recording-valve").constData());
+    GstElement* queue = gst_element_factory_make("queue", elementName("mjpeg-recording-queue").constData());
+    GstElement* parser = gst_element_factory_make("jpegparse", elementName("mjpeg-recording-parser").constData());   // Optional
+    GstElement* muxer = gst_element_factory_make(muxerFactory, elementName("mjpeg-recording-muxer").constData());
+    GstElement* filesink = gst_element_factory_make("filesink", elementName("mjpeg-recording-filesink").constData());
+    if (!valve || !queue || !muxer || !filesink) {
+        qCWarning(log_gst_recording) << "MJPEG passthrough elements unavailable (" << muxerFactory << ")";
+        if (valve) gst_object_unref(valve);
+        if (queue) gst_object_unref(queue);
+        if (parser) gst_object_unref(parser);
+        if (muxer) gst_object_unref(muxer);
+        if (filesink) gst_object_unref(filesink);
+        gst_object_unref(jpegTee);
+        return false;
+    }
+
+    // Disk stalls must not reach the display branch: drop the oldest frames instead
+    g_object_set(queue,
+                 "max-size-buffers", 0,
+                 "max-size-bytes", 0,
+                 "max-size-time", (guint64)(2 * GST_SECOND),
+                 "leaky", 2,
+                 NULL);
+    g_object_set(valve, "drop", FALSE, NULL);
+    g_object_set(filesink, "location", outputPath.toUtf8().constData(), "async", FALSE, NULL);
+
+    // Keep references of our own; the bin holds the floating ones
+    gst_object_ref(valve);
+    gst_object_ref(queue);
+    if (parser) gst_object_ref(parser);
+    gst_object_ref(muxer);
+    gst_object_ref(filesink);
+    gst_bin_add_many(GST_BIN(m_mainPipeline), valve, queue, muxer, filesink, NULL);
+    if (parser) gst_bin_add(GST_BIN(m_mainPipeline), parser);
+
+    const bool linked = parser
+        ? gst_element_link_many(valve, queue, parser, muxer, filesink, NULL)
+        : gst_element_link_many(valve, queue, muxer, filesink, NULL);
+    GstPad* teeSrcPad = linked ? gst_element_request_pad_simple(jpegTee, "src_%u") : nullptr;
+    GstPad* valveSinkPad = gst_element_get_static_pad(valve, "sink");
+
+    if (teeSrcPad && valveSinkPad) {
+        // Start the file at zero rather than at the pipeline's running time
+        GstClock* clock = gst_element_get_clock(m_mainPipeline);
+        if (clock) {
+            const GstClockTime now = gst_clock_get_time(clock);
+            const GstClockTime base = gst_element_get_base_time(m_mainPipeline);
+            if (now > base) {
+                gst_pad_set_offset(valveSinkPad, -static_cast<gint64>(now - base));
+            }
+            gst_object_unref(clock);
+        }
+    }
+
+    GstElement* branch[] = { valve, queue, parser, muxer, filesink };
+    bool started = teeSrcPad && valveSinkPad;
+    if (started) {
+        for (GstElement* element : branch) {
+            if (element && !gst_element_sync_state_with_parent(element)) {
+                started = false;
+            }
+        }
+    }
+    if (started && gst_pad_link(teeSrcPad, valveSinkPad) != GST_PAD_LINK_OK) {
+        started = false;
+    }
+    if (valveSinkPad) gst_object_unref(valveSinkPad);
+
+    if (!started) {
+        qCWarning(log_gst_recording) << "Failed to attach MJPEG passthrough branch";
+        if (teeSrcPad) {
+            gst_element_release_request_pad(jpegTee, teeSrcPad);
+            gst_object_unref(teeSrcPad);
+        }
+        for (GstElement* element : branch) {
+            if (!element) continue;
+            gst_element_set_state(element, GST_STATE_NULL);
+            gst_bin_remove(GST_BIN(m_mainPipeline), element);
+            gst_object_unref(element);
+        }
+        gst_object_unref(jpegTee);
+        return false;
+    }
+
+    if (m_recordingTee) gst_object_unref(m_recordingTee);
+    m_recordingTee = jpegTee;
+    m_recordingTeeSrcPad = teeSrcPad;
+    m_recordingValve = valve;
+    m_recordingQueue = queue;
+    m_recordingParser = parser;
+    m_recordingMuxer = muxer;
+    m_recordingFileSink = filesink;
+    m_recordingPassthrough = true;
+    m_recordingOutputPath = outputPath;
+    qCInfo(log_gst_recording) << "MJPEG passthrough branch (" << muxerFactory << ") writing to" << outputPath;
+    return true;
+}
+
+// Shared with the EOS probe, which runs on a streaming thread and may outlive
+// the finalization it was installed for
+struct PassthroughEosState {
+    QMutex mutex;
+    RecordingManager* manager = nullptr;    // Null once the finalization is over
+    quint64 generation = 0;
+    std::atomic<bool> eosReached{false};
+};
+
+// Detach the branch from the tee and push EOS through it so the muxer writes
+// its index/header; without this the file is truncated or unseekable.  The
+// branch is removed once the EOS reaches the filesink (or after a timeout), on
+// this object's thread; nothing here waits for it.
+bool RecordingManager::beginPassthroughFinalize(bool notifyStopped)
+{
+    if (!m_mainPipeline || !m_recordingValve || !m_recordingFileSink) {
+        return false;
+    }
+    GstPad* valveSinkPad = gst_element_get_static_pad(m_recordingValve, "sink");
+    GstPad* fileSinkPad = gst_element_get_static_pad(m_recordingFileSink, "sink");
+    if (!valveSinkPad || !fileSinkPad) {
+        if (valveSinkPad) gst_object_unref(valveSinkPad);
+        if (fileSinkPad) gst_object_unref(fileSinkPad);
+        return false;
+    }
+
+    // Only one file finalizes in the background; an older one is cut short
+    if (m_finalizing.pipeline) {
+        qCWarning(log_gst_recording) << "Previous recording still finalizing; removing it now";
+        completePassthroughFinalize(m_finalizing.generation);
+    }
+
+    auto eos = std::make_shared<PassthroughEosState>();
+    eos->manager = this;
+    eos->generation = ++m_finalizeGeneration;
+
+    FinalizingBranch& branch = m_finalizing;
+    branch.generation = eos->generation;
+    branch.pipeline = GST_ELEMENT(gst_object_ref(m_mainPipeline));   // Outlives a pipeline teardown meanwhile
+    branch.tee = m_recordingTee ? GST_ELEMENT(gst_object_ref(m_recordingTee)) : nullptr;
+    branch.teeSrcPad = m_recordingTeeSrcPad;
+    branch.fileSinkPad = fileSinkPad;
+    branch.eos = eos;
+    branch.notifyStopped = notifyStopped;
+    GstElement** elements[] = { &m_recordingFileSink, &m_recordingMuxer, &m_recordingParser,
+                                &m_recordingQueue, &m_recordingValve };
+    for (int i = 0; i < 5; ++i) {
+        branch.elements[i] = *elements[i];
+        *elements[i] = nullptr;
+    }
+    m_recordingTeeSrcPad = nullptr;
+    m_recordingPassthrough = false;
+
+    branch.probeId = gst_pad_add_probe(fileSinkPad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+        +[](GstPad*, GstPadProbeInfo* info, gpointer userData) -> GstPadProbeReturn {
+            if (GST_EVENT_TYPE(GST_PAD_PROBE_INFO_EVENT(info)) != GST_EVENT_EOS) {
+                return GST_PAD_PROBE_OK;
+            }
+            const auto& state = *static_cast<std::shared_ptr<PassthroughEosState>*>(userData);
+            state->eosReached = true;
+            QMutexLocker locker(&state->mutex);
+            if (RecordingManager* manager = state->manager) {
+                const quint64 generation = state->generation;
+                QMetaObject::invokeMethod(manager, [manager, generation]() {
+                    manager->completePassthroughFinalize(generation);
+                }, Qt::QueuedConnection);
+            }
+            return GST_PAD_PROBE_OK;
+        },
+        new std::shared_ptr<PassthroughEosState>(eos),
+        +[](gpointer userData) { delete static_cast<std::shared_ptr<PassthroughEosState>*>(userData); });
+
+    if (branch.teeSrcPad) {
+        gst_pad_unlink(branch.teeSrcPad, valveSinkPad);
+    }
+    g_object_set(branch.elements[4], "drop", FALSE, NULL);   // A paused valve would swallow the EOS
+    gst_pad_send_event(valveSinkPad, gst_event_new_eos());
+    gst_object_unref(valveSinkPad);
+
+    const quint64 generation = branch.generation;
+    QTimer::singleShot(3000, this, [this, generation]() {
+        if (m_finalizing.pipeline && m_finalizing.generation == generation) {
+            qCWarning(log_gst_recording) << "Recording EOS did not reach the file within 3 s; file may be incomplete";
+            completePassthroughFinalize(generation);
+        }
+    });
+    qCDebug(log_gst_recording) << "MJPEG passthrough branch detached; finalizing file";
+    return true;
+}
+
+void RecordingManager::completePassthroughFinalize(quint64 generation)
+{
+    FinalizingBranch& branch = m_finalizing;
+    if (!branch.pipeline || branch.generation != generation) {
+        return;     // Already removed (EOS and timeout both fire, or cut short)
+    }
+
+    {
+        QMutexLocker locker(&branch.eos->mutex);
+        branch.eos->manager = nullptr;
+    }
+    gst_pad_remove_probe(branch.fileSinkPad, branch.probeId);
+    gst_object_unref(branch.fileSinkPad);
+
+    if (branch.tee && branch.teeSrcPad) {
+        gst_element_release_request_pad(branch.tee, branch.teeSrcPad);
+    }
+    if (branch.teeSrcPad) gst_object_unref(branch.teeSrcPad);
+    if (branch.tee) gst_object_unref(branch.tee);
+    for (GstElement* element : branch.elements) {
+        if (!element) continue;
+        gst_element_set_state(element, GST_STATE_NULL);
+        gst_bin_remove(GST_BIN(branch.pipeline), element);
+        gst_object_unref(element);
+    }
+    gst_object_unref(branch.pipeline);
+
+    const bool notifyStopped = branch.notifyStopped;
+    m_finalizing = FinalizingBranch();
+    qCInfo(log_gst_recording) << "MJPEG passthrough recording finalized";
+    if (notifyStopped) {
+        emit recordingStopped();
+    }
+}
+
+void RecordingManager::finishPendingFinalize(int waitMs)
+{
+    if (!m_finalizing.pipeline) {
+        return;
+    }
+    // The queued completion cannot run from here (destructor), so poll the flag
+    QElapsedTimer waited;
+    waited.start();
+    while (!m_finalizing.eos->eosReached.load() && waited.elapsed() < waitMs) {
+        QThread::msleep(10);
+    }
+    m_finalizing.notifyStopped = false;
+    completePassthroughFinalize(m_finalizing.generation);
+}
+
 bool RecordingManager::initializeFrameBasedRecording(const QString& format)
 {
     qCDebug(log_gst_recording) << "RecordingManager::initializeFrameBasedRecording format" << format;
@@ -566,8 +843,14 @@ bool RecordingManager::stopRecording()
         return false;
     }
 
+    bool finalizing = false;
 #ifdef HAVE_GSTREAMER
-    removeRecordingBranch();
+    // A passthrough file is finished in the background; recordingStopped()
+    // follows once its muxer has written the index
+    finalizing = m_recordingPassthrough && beginPassthroughFinalize(true);
+    if (!finalizing) {
+        removeRecordingBranch();
+    }
 #else
     // Nothing to do for external process recording in this manager
 #endif
@@ -576,8 +859,10 @@ bool RecordingManager::stopRecording()
     m_recordingPaused = false;
     m_recordingOutputPath.clear();
 
-    qCInfo(log_gst_recording) << "Recording stopped";
-    emit recordingStopped();
+    qCInfo(log_gst_recording) << (finalizing ? "Recording stopped; finalizing file" : "Recording stopped");
+    if (!finalizing) {
+        emit recordingStopped();
+    }
     return true;
 }
 
@@ -630,6 +915,15 @@ bool RecordingManager::isRecording() const
     return m_recordingActive;
 }
 
+bool RecordingManager::isPassthrough() const
+{
+#ifdef HAVE_GSTREAMER
+    return m_recordingActive && m_recordingPassthrough;
+#else
+    return false;
+#endif
+}
+
 QString RecordingManager::getCurrentRecordingPath() const
 {
     return m_recordingOutputPath;
@@ -774,6 +1068,28 @@ void RecordingManager::removeRecordingBranch()
 
     if (!m_mainPipeline) return;
 
+    if (m_recordingPassthrough) {
+        // Could not be finalized (see beginPassthroughFinalize()): tear down as is
+        m_recordingPassthrough = false;
+
+        if (m_recordingTee && m_recordingTeeSrcPad) {
+            gst_element_release_request_pad(m_recordingTee, m_recordingTeeSrcPad);
+            gst_object_unref(m_recordingTeeSrcPad);
+            m_recordingTeeSrcPad = nullptr;
+        }
+        GstElement** branch[] = { &m_recordingFileSink, &m_recordingMuxer, &m_recordingParser,
+                                  &m_recordingQueue, &m_recordingValve };
+        for (GstElement** element : branch) {
+            if (!*element) continue;
+            gst_element_set_state(*element, GST_STATE_NULL);
+            gst_bin_remove(GST_BIN(m_mainPipeline), *element);
+            gst_object_unref(*element);
+            *element = nullptr;
+        }
+        qCDebug(log_gst_recording) << "MJPEG passthrough branch removed";
+        return;
+    }
+
     // Unlink and remove elements if present
     if (m_recordingTeeSrcPad && m_recordingQueue) {
         GstPad* queueSink = gst_element_get_static_pad(m_recordingQueue, "sink");
@@ -10,10 +10,13 @@
 #include <QProcess>
 #include <QFileInfo>
 #include <QDir>
+#include <memory>
 
 #ifdef HAVE_GSTREAMER
 #include <gst/gst.h>
 #include <gst/app/gstappsink.h>
+
+struct PassthroughEosState;
 #endif
 
 class RecordingManager : public QObject
@@ -31,6 +34,8 @@ public:
     void resumeRecording();
 
     bool isRecording() const;
+    // True while the active recording muxes the camera JPEG (not the scaled display branch)
+    bool isPassthrough() const;
     QString getCurrentRecordingPath() const;
     qint64 getRecordingDuration() const;
 
@@ -42,6 +47,9 @@ public:
     GstFlowReturn onNewRecordingSample(GstAppSink* sink);
     // Exposed helpers that create separate recording branches (available only if GStreamer present)
     bool createSeparateRecordingPipeline(const QString& outputPath, const QString& format, int videoBitrate);
+    // Muxes the camera's MJPEG from the "jpegtee" tee (before jpegdec) without re-encoding.
+    // Only for containers that take MJPEG as-is (mkv, avi, mov); false if unsupported or no tee.
+    bool createPassthroughRecordingBranch(const QString& outputPath, const QString& format);
     bool initializeDirectFilesinkRecording(const QString& outputPath, const QString& format);
 #endif
 
@@ -73,6 +81,26 @@ private:
     GstElement* m_recordingFileSink;
     GstElement* m_recordingAppSink;
     GstPad* m_recordingTeeSrcPad;
+    GstElement* m_recordingParser = nullptr;
+    bool m_recordingPassthrough = false;   // Branch ends in a muxer that needs EOS to finalize
+    quint64 m_passthroughSerial = 0;       // Keeps element names unique while an old branch finalizes
+
+    // Passthrough branch detached by stopRecording() and still writing its
+    // index; removed (and recordingStopped() emitted) once its EOS reaches the
+    // filesink, or after a timeout
+    struct FinalizingBranch {
+        quint64 generation = 0;
+        GstElement* pipeline = nullptr;
+        GstElement* tee = nullptr;
+        GstPad* teeSrcPad = nullptr;
+        GstPad* fileSinkPad = nullptr;
+        gulong probeId = 0;
+        GstElement* elements[5] = {};
+        std::shared_ptr<PassthroughEosState> eos;
+        bool notifyStopped = false;
+    };
+    FinalizingBranch m_finalizing;
+    quint64 m_finalizeGeneration = 0;
 #endif
 
     bool m_recordingActive;
@@ -94,6 +122,13 @@ private:
     QString m_recordingFormat;
     bool createRecordingBranch(const QString& outputPath, const QString& format, int videoBitrate);
     void removeRecordingBranch();
+#ifdef HAVE_GSTREAMER
+    // Detach the passthrough branch and send it EOS; false if it cannot be finalized
+    bool beginPassthroughFinalize(bool notifyStopped);
+    void completePassthroughFinalize(quint64 generation);
+    // Shutdown only: waits (bounded) for a pending EOS before tearing down
+    void finishPendingFinalize(int waitMs);
+#endif
     QString computeAdjustedOutputPath(const QString& outputPath, bool directMJPEG);
 };
 
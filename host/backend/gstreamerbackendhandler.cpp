@@ -27,6 +27,8 @@
 #include "../../device/DeviceManager.h"
 #include "../../device/HotplugMonitor.h"
 #include "../../device/DeviceInfo.h"
+#include "../framebus.h"
+#include "common/jpegutils.h"
 #include <QThread>
 #include <QApplication>
 #include <QGuiApplication>
@@ -60,6 +62,7 @@
 #include "gstreamer/inprocessgstrunner.h"
 #include "gstreamer/externalgstrunner.h"
 #include "gstreamer/recordingmanager.h"
+#include "gstreamer/pipelineprobes.h"
 
 #include "log/opflogging.h"
 
@@ -107,12 +110,14 @@ QList<int> GStreamerBackendHandler::getSupportedFrameRates(const QCameraFormat&
 // Pad probe used to count frames for realtime FPS logging
 GstPadProbeReturn GStreamerBackendHandler::gstreamer_frame_probe_cb(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
 {
-    Q_UNUSED(pad)
     if (!user_data) return GST_PAD_PROBE_OK;
     if (info->type & GST_PAD_PROBE_TYPE_BUFFER) {
         GStreamerBackendHandler* self = static_cast<GStreamerBackendHandler*>(user_data);
         if (self) {
             self->incrementFrameCount();
+            if (self->m_resizeRequestedUs.load(std::memory_order_relaxed) != 0) {
+                self->checkResizeCompleted(pad);
+            }
         }
     }
     return GST_PAD_PROBE_OK;
@@ -149,6 +154,13 @@ GStreamerBackendHandler::GStreamerBackendHandler(QObject *parent)
     m_overlayRebuildTimer->setSingleShot(true);
     connect(m_overlayRebuildTimer, &QTimer::timeout, this, &GStreamerBackendHandler::handleOverlayResizeRebuildTimeout);
 
+    // Optional per-element diagnostics; the CSV path is shared with the FFmpeg latency tracer
+    if (Openterface::GStreamer::PipelineProbes::enabledByEnvironment()) {
+        m_pipelineProbes = std::make_unique<Openterface::GStreamer::PipelineProbes>();
+        m_latencyCsvPath = QString::fromLocal8Bit(qgetenv("OPENTERFACE_LATENCY_CSV"));
+        qCInfo(log_gstreamer_backend) << "Per-element pipeline probes enabled";
+    }
+
     // runners
     m_inProcessRunner = new InProcessGstRunner(this);
     m_externalRunner = new ExternalGstRunner(this);
@@ -185,6 +197,8 @@ GStreamerBackendHandler::~GStreamerBackendHandler()
     // Simply clear our tracking set.
     m_watchedObjects.clear();
 
+    setFrameBus(nullptr);
+
     // Stop camera / pipelines cleanly
     stopCamera();
 
@@ -606,6 +620,7 @@ bool GStreamerBackendHandler::startGStreamerPipeline()
                 // Attach frame probe to count buffers and show realtime FPS
                 m_frameCount.store(0, std::memory_order_relaxed);
                 attachFrameProbe();
+                attachFrameTap();
                 if (m_healthCheckTimer && !m_healthCheckTimer->isActive()) m_healthCheckTimer->start(1000);
                 return true;
             }
@@ -637,6 +652,7 @@ bool GStreamerBackendHandler::startGStreamerPipeline()
     // Attach frame probe and start health check timer
     m_frameCount.store(0, std::memory_order_relaxed);
     attachFrameProbe();
+    attachFrameTap();
     if (m_healthCheckTimer && !m_healthCheckTimer->isActive()) m_healthCheckTimer->start(1000);
     return true;
     }
@@ -709,6 +725,7 @@ void GStreamerBackendHandler::stopGStreamerPipeline()
         }
         // Detach any frame probe we may have installed
         detachFrameProbe();
+        detachFrameTap();
         qCDebug(log_gstreamer_backend) << "GStreamer pipeline stopped";
     }
 #else
@@ -1143,14 +1160,13 @@ bool GStreamerBackendHandler::eventFilter(QObject *watched, QEvent *event)
                     QSize newSize = re->size();
                     qCDebug(log_gstreamer_backend) << "Video widget resize event: new size=" << newSize;
 
-                    // Rebuild pipeline if the widget grew or shrank significantly compared
-                    // to the size used at pipeline creation. Coalesce rapid resize events
-                    // using a single timer so the pipeline is rebuilt only once after resize
-                    // activity settles.
+                    // Resize the pipeline output if the widget size no longer matches the
+                    // size the pipeline is producing. Coalesce rapid resize events using a
+                    // single timer so the output changes only once after resize activity settles.
                     if (m_videoPane && m_videoPane->isDirectGStreamerModeEnabled() && m_pipelineRunning && !m_pipelineDisplaySize.isEmpty() &&
                         overlayPipelineSizeChangeRequiresRebuild(newSize)) {
-                        qCDebug(log_gstreamer_backend) << "Video widget resize changed from" << m_pipelineDisplaySize << "to" << newSize << "- scheduling pipeline rebuild";
-                        scheduleOverlayPipelineRebuild(500);
+                        qCDebug(log_gstreamer_backend) << "Video widget resize changed from" << m_pipelineDisplaySize << "to" << newSize << "- scheduling pipeline resize";
+                        scheduleOverlayPipelineRebuild(overlayResizeDelayMs());
                         return true;
                     }
 
@@ -1237,13 +1253,13 @@ bool GStreamerBackendHandler::eventFilter(QObject *watched, QEvent *event)
 
                     // If the pipeline was created before the window finished layout,
                     // the display size used for pipeline creation may be smaller than
-                    // the actual widget now. Rebuild when the overlay grows or shrinks
-                    // significantly, but coalesce rapid changes into a single rebuild.
+                    // the actual widget now. Resize the output when the overlay grows or
+                    // shrinks, but coalesce rapid changes into a single resize.
                     if (m_videoPane && m_videoPane->isDirectGStreamerModeEnabled() && m_pipelineRunning && !m_pipelineDisplaySize.isEmpty()) {
                         QSize newSize = re->size();
                         if (overlayPipelineSizeChangeRequiresRebuild(newSize)) {
-                            qCDebug(log_gstreamer_backend) << "Overlay resize changed from pipeline display size" << m_pipelineDisplaySize << "to" << newSize << "- scheduling pipeline rebuild";
-                            scheduleOverlayPipelineRebuild(500);
+                            qCDebug(log_gstreamer_backend) << "Overlay resize changed from pipeline display size" << m_pipelineDisplaySize << "to" << newSize << "- scheduling pipeline resize";
+                            scheduleOverlayPipelineRebuild(overlayResizeDelayMs());
                             return true;
                         }
 
@@ -1386,6 +1402,7 @@ void GStreamerBackendHandler::checkPipelineHealth()
             quint64 framesSinceLast = m_frameCount.exchange(0, std::memory_order_relaxed);
             qCDebug(log_gstreamer_backend) << "Realtime GStreamer FPS (last interval):" << framesSinceLast;
             emit fpsChanged(static_cast<double>(framesSinceLast));
+            reportPipelineProbes();
         }
     }
 #else
@@ -1562,6 +1579,12 @@ bool GStreamerBackendHandler::overlayPipelineSizeChangeRequiresRebuild(const QSi
     if (m_pipelineDisplaySize.isEmpty()) {
         return false;
     }
+#ifdef HAVE_GSTREAMER
+    // Renegotiation is cheap, so follow the widget exactly when it is available
+    if (m_displayCaps) {
+        return newSize != m_pipelineDisplaySize;
+    }
+#endif
     return (newSize.width() > m_pipelineDisplaySize.width() + 20 ||
             newSize.height() > m_pipelineDisplaySize.height() + 20 ||
             newSize.width() + 20 < m_pipelineDisplaySize.width() ||
@@ -1590,12 +1613,84 @@ void GStreamerBackendHandler::handleOverlayResizeRebuildTimeout()
         return;
     }
 
+    // A re-encoding recording consumes the scaled branch; changing its caps mid-file
+    // would break the encoder, so hold the current size until the recording ends
+    if (m_recordingManager && m_recordingManager->isRecording() && !m_recordingManager->isPassthrough()) {
+        qCDebug(log_gstreamer_backend) << "Overlay resize deferred while recording from the display branch";
+        scheduleOverlayPipelineRebuild(1000);
+        return;
+    }
+
+    // Same screen clamping as at pipeline creation
+    if (renegotiateDisplaySize(getDisplaySizeForPipeline())) {
+        return;
+    }
+
     qCDebug(log_gstreamer_backend) << "Overlay resize rebuild timer fired; rebuilding pipeline from" << m_pipelineDisplaySize << "to" << currentOverlaySize;
+#ifdef HAVE_GSTREAMER
+    markResizeRequested(currentOverlaySize, false);
+#endif
     stopGStreamerPipeline();
     cleanupGStreamer();
     if (createGStreamerPipeline(m_currentDevicePath, m_currentResolution, m_currentFramerate)) {
         startGStreamerPipeline();
     }
+#ifdef HAVE_GSTREAMER
+    if (m_pipelineRunning) {
+        // The new pipeline may have clamped the overlay size to the screen
+        m_resizeTargetWidth.store(m_pipelineDisplaySize.width(), std::memory_order_relaxed);
+        m_resizeTargetHeight.store(m_pipelineDisplaySize.height(), std::memory_order_relaxed);
+    } else {
+        m_resizeRequestedUs.store(0, std::memory_order_relaxed);
+    }
+#endif
+}
+
+int GStreamerBackendHandler::overlayResizeDelayMs() const
+{
+#ifdef HAVE_GSTREAMER
+    // Renegotiation keeps the source running, so only debounce the drag itself
+    if (m_displayCaps) {
+        return 100;
+    }
+#endif
+    return 500;
+}
+
+bool GStreamerBackendHandler::renegotiateDisplaySize(const QSize& size)
+{
+#ifdef HAVE_GSTREAMER
+    if (!m_pipeline || !m_displayCaps || size.isEmpty()) {
+        return false;
+    }
+    if (size == m_pipelineDisplaySize) {
+        return true;    // Overlay is larger than the screen; output is already clamped
+    }
+
+    GstCaps* caps = gst_caps_new_simple("video/x-raw",
+                                        "width", G_TYPE_INT, size.width(),
+                                        "height", G_TYPE_INT, size.height(),
+                                        "pixel-aspect-ratio", GST_TYPE_FRACTION, 1, 1,
+                                        nullptr);
+    markResizeRequested(size, true);
+    g_object_set(m_displayCaps, "caps", caps, nullptr);
+    gst_caps_unref(caps);
+
+    // capsfilter flags its own pad on a caps change, but older releases only do so on
+    // the next buffer; push a reconfigure so videoscale picks the new size right away
+    if (GstPad* sinkPad = gst_element_get_static_pad(m_displayCaps, "sink")) {
+        gst_pad_push_event(sinkPad, gst_event_new_reconfigure());
+        gst_object_unref(sinkPad);
+    }
+
+    qCDebug(log_gstreamer_backend) << "Renegotiating display caps from" << m_pipelineDisplaySize << "to" << size << "without pipeline rebuild";
+    m_pipelineDisplaySize = size;
+    updateVideoRenderRectangle(size);
+    return true;
+#else
+    Q_UNUSED(size)
+    return false;
+#endif
 }
 
 WId GStreamerBackendHandler::getVideoWidgetWindowId() const
@@ -1748,6 +1843,7 @@ void GStreamerBackendHandler::cleanupGStreamer()
     if (m_pipeline) {
         // Detach any frame probe attached to this pipeline
         detachFrameProbe();
+        detachFrameTap();
         // Clear any overlay sink cached
         if (m_currentOverlaySink) {
             if (GST_IS_VIDEO_OVERLAY(m_currentOverlaySink))
@@ -1961,6 +2057,14 @@ void GStreamerBackendHandler::attachFrameProbe()
     // Ensure we don't attach twice
     if (m_frameProbePad && m_frameProbeId) return;
 
+    // Only the flexible pipeline scales through "display-caps"; fallbacks rebuild on resize
+    if (!m_displayCaps) {
+        m_displayCaps = gst_bin_get_by_name(GST_BIN(m_pipeline), "display-caps");
+    }
+    if (m_pipelineProbes && !m_pipelineProbes->isAttached()) {
+        m_pipelineProbes->attach(m_pipeline);
+    }
+
     GstPad* sinkPad = nullptr;
     GstElement* q = gst_bin_get_by_name(GST_BIN(m_pipeline), "display-queue");
     if (q) {
@@ -2007,6 +2111,13 @@ void GStreamerBackendHandler::attachFrameProbe()
 
 void GStreamerBackendHandler::detachFrameProbe()
 {
+    if (m_pipelineProbes) {
+        m_pipelineProbes->detach();
+    }
+    if (m_displayCaps) {
+        gst_object_unref(m_displayCaps);
+        m_displayCaps = nullptr;
+    }
     if (!m_frameProbePad) return;
     if (m_frameProbeId) {
         gst_pad_remove_probe(m_frameProbePad, m_frameProbeId);
@@ -2016,6 +2127,139 @@ void GStreamerBackendHandler::detachFrameProbe()
     m_frameProbePad = nullptr;
     qCDebug(log_gstreamer_backend) << "detachFrameProbe: pad probe removed";
 }
+
+void GStreamerBackendHandler::reportPipelineProbes()
+{
+    if (!m_pipelineProbes || !m_pipelineProbes->isAttached()) return;
+
+    const Openterface::GStreamer::PipelineProbes::Snapshot snapshot = m_pipelineProbes->takeSnapshot();
+    for (const auto& element : snapshot.elements) {
+        if (element.isQueue) {
+            qCDebug(log_gstreamer_backend) << QString("Probe %1 - buffers: %2, p50/p95/max ms: %3/%4/%5, fill: %6/%7, full: %8, dropped: %9")
+                .arg(element.name).arg(element.buffers)
+                .arg(element.p50_ms, 0, 'f', 2).arg(element.p95_ms, 0, 'f', 2).arg(element.max_ms, 0, 'f', 2)
+                .arg(element.level).arg(element.capacity).arg(element.overruns).arg(element.dropped);
+        } else {
+            qCDebug(log_gstreamer_backend) << QString("Probe %1 - buffers: %2, p50/p95/max ms: %3/%4/%5, age p50/p95 ms: %6/%7")
+                .arg(element.name).arg(element.buffers)
+                .arg(element.p50_ms, 0, 'f', 2).arg(element.p95_ms, 0, 'f', 2).arg(element.max_ms, 0, 'f', 2)
+                .arg(element.age_p50_ms, 0, 'f', 2).arg(element.age_p95_ms, 0, 'f', 2);
+        }
+    }
+    emit latencyStatsChanged(Openterface::GStreamer::PipelineProbes::formatSummary(snapshot));
+    if (!m_latencyCsvPath.isEmpty() && !Openterface::GStreamer::PipelineProbes::appendCsv(m_latencyCsvPath, snapshot)) {
+        qCWarning(log_gstreamer_backend) << "Cannot write latency CSV:" << m_latencyCsvPath;
+        m_latencyCsvPath.clear();
+    }
+}
+
+void GStreamerBackendHandler::markResizeRequested(const QSize& size, bool live)
+{
+    m_resizeTargetWidth.store(size.width(), std::memory_order_relaxed);
+    m_resizeTargetHeight.store(size.height(), std::memory_order_relaxed);
+    m_resizeLive.store(live, std::memory_order_relaxed);
+    m_resizeRequestedUs.store(g_get_monotonic_time(), std::memory_order_release);
+}
+
+// Runs on the streaming thread while a resize is outstanding
+void GStreamerBackendHandler::checkResizeCompleted(GstPad* pad)
+{
+    GstCaps* caps = pad ? gst_pad_get_current_caps(pad) : nullptr;
+    if (!caps) return;
+
+    int width = 0;
+    int height = 0;
+    GstStructure* structure = gst_caps_get_structure(caps, 0);
+    if (structure) {
+        gst_structure_get_int(structure, "width", &width);
+        gst_structure_get_int(structure, "height", &height);
+    }
+    gst_caps_unref(caps);
+
+    if (width != m_resizeTargetWidth.load(std::memory_order_relaxed) ||
+        height != m_resizeTargetHeight.load(std::memory_order_relaxed)) {
+        return;    // Still draining frames scaled to the old size
+    }
+
+    const qint64 requestedUs = m_resizeRequestedUs.exchange(0, std::memory_order_acq_rel);
+    if (requestedUs == 0) return;
+    qCInfo(log_gstreamer_backend) << "Resize to first frame at" << QSize(width, height) << "took"
+                                  << (g_get_monotonic_time() - requestedUs) / 1000.0 << "ms via"
+                                  << (m_resizeLive.load(std::memory_order_relaxed) ? "caps renegotiation" : "pipeline rebuild");
+}
+#endif
+
+#ifdef HAVE_GSTREAMER
+// Frame tap: the streaming thread only swaps a sample ref; mapping and
+// decoding happen in whichever consumer asks for the frame
+GstFlowReturn GStreamerBackendHandler::frame_tap_new_sample_cb(GstAppSink* sink, gpointer user_data)
+{
+    GStreamerBackendHandler* self = static_cast<GStreamerBackendHandler*>(user_data);
+    GstSample* sample = gst_app_sink_pull_sample(sink);
+    if (!self || !sample) {
+        if (sample) gst_sample_unref(sample);
+        return GST_FLOW_OK;
+    }
+
+    GstSample* previous = nullptr;
+    quint64 sequence = 0;
+    {
+        QMutexLocker locker(&self->m_frameTapMutex);
+        previous = self->m_frameTapSample;
+        self->m_frameTapSample = sample;
+        sequence = ++self->m_frameTapSequence;
+    }
+    if (previous) gst_sample_unref(previous);
+
+    if (FrameBus* frameBus = self->m_frameBus) {
+        frameBus->publishFrame(sequence);
+    }
+    return GST_FLOW_OK;
+}
+
+void GStreamerBackendHandler::attachFrameTap()
+{
+    if (!m_pipeline || m_frameTapSink) return;
+
+    // Only the flexible pipeline has a tap; fallbacks use the on-demand capture appsink
+    m_frameTapSink = gst_bin_get_by_name(GST_BIN(m_pipeline), "frame-tap");
+    if (!m_frameTapSink) {
+        qCDebug(log_gstreamer_backend) << "attachFrameTap: no frame-tap in pipeline, frames pulled on demand";
+        return;
+    }
+
+    GstAppSinkCallbacks callbacks = {};
+    callbacks.new_sample = GStreamerBackendHandler::frame_tap_new_sample_cb;
+    gst_app_sink_set_callbacks(GST_APP_SINK(m_frameTapSink), &callbacks, this, nullptr);
+    qCDebug(log_gstreamer_backend) << "attachFrameTap: holding latest camera frame in memory";
+}
+
+void GStreamerBackendHandler::detachFrameTap()
+{
+    if (m_frameTapSink) {
+        GstAppSinkCallbacks callbacks = {};
+        gst_app_sink_set_callbacks(GST_APP_SINK(m_frameTapSink), &callbacks, nullptr, nullptr);
+        gst_object_unref(m_frameTapSink);
+        m_frameTapSink = nullptr;
+    }
+
+    GstSample* sample = nullptr;
+    {
+        QMutexLocker locker(&m_frameTapMutex);
+        sample = m_frameTapSample;
+        m_frameTapSample = nullptr;
+    }
+    if (sample) gst_sample_unref(sample);
+    if (m_frameBus) m_frameBus->reset();
+}
+
+GstSample* GStreamerBackendHandler::takeFrameTapSample(quint64* sequence) const
+{
+    QMutexLocker locker(&m_frameTapMutex);
+    if (!m_frameTapSample) return nullptr;
+    if (sequence) *sequence = m_frameTapSequence;
+    return gst_sample_ref(m_frameTapSample);
+}
 #endif
 
 // No-op fallback if HAVE_GSTREAMER is not defined
@@ -2285,6 +2529,79 @@ void GStreamerBackendHandler::takeImage(const QString& filePath)
 #endif
 }
 
+QImage GStreamerBackendHandler::grabLatestFrame()
+{
+#ifdef HAVE_GSTREAMER
+    if (!m_pipeline || !m_pipelineRunning) {
+        return QImage();
+    }
+    if (GstSample* tapSample = takeFrameTapSample(nullptr)) {
+        QImage image = gstSampleToQImage(tapSample);
+        gst_sample_unref(tapSample);
+        return image;
+    }
+    if (m_frameTapSink) {
+        return QImage();    // Tap present but no frame yet
+    }
+    if (!m_captureAppSink && !createCaptureAppSink()) {
+        qCWarning(log_gstreamer_backend) << "Failed to create capture appsink";
+        return QImage();
+    }
+    GstSample* sample = getLatestSampleFromPipeline();
+    if (!sample) {
+        return QImage();
+    }
+    QImage image = gstSampleToQImage(sample);
+    gst_sample_unref(sample);
+    return image;
+#else
+    return QImage();
+#endif
+}
+
+EncodedFrame GStreamerBackendHandler::getLatestEncodedFrame() const
+{
+    EncodedFrame encoded;
+#ifdef HAVE_GSTREAMER
+    quint64 sequence = 0;
+    GstSample* sample = takeFrameTapSample(&sequence);
+    if (!sample) {
+        return encoded;
+    }
+    GstBuffer* buffer = gst_sample_get_buffer(sample);
+    GstCaps* caps = gst_sample_get_caps(sample);
+    GstStructure* structure = caps ? gst_caps_get_structure(caps, 0) : nullptr;
+    GstMapInfo mapInfo;
+    if (buffer && structure && gst_structure_has_name(structure, "image/jpeg") &&
+        gst_buffer_map(buffer, &mapInfo, GST_MAP_READ)) {
+        int width = 0;
+        int height = 0;
+        gst_structure_get_int(structure, "width", &width);
+        gst_structure_get_int(structure, "height", &height);
+        // UVC MJPEG usually omits the Huffman tables; make it a file any reader accepts
+        encoded.data = JpegUtils::makeStandalone(
+            QByteArray(reinterpret_cast<const char*>(mapInfo.data), static_cast<int>(mapInfo.size)));
+        encoded.size = QSize(width, height);
+        encoded.frame_id = sequence;
+        gst_buffer_unmap(buffer, &mapInfo);
+    }
+    gst_sample_unref(sample);
+#endif
+    return encoded;
+}
+
+void GStreamerBackendHandler::setFrameBus(FrameBus* frameBus)
+{
+    if (m_frameBus && m_frameBus != frameBus) {
+        m_frameBus->setFrameProvider(nullptr);
+        m_frameBus->reset();
+    }
+    MultimediaBackendHandler::setFrameBus(frameBus);
+    if (m_frameBus) {
+        m_frameBus->setFrameProvider([this]() { return grabLatestFrame(); });
+    }
+}
+
 void GStreamerBackendHandler::takeAreaImage(const QString& filePath, const QRect& captureArea)
 {
 #ifdef HAVE_GSTREAMER
@@ -2362,6 +2679,18 @@ QImage GStreamerBackendHandler::gstSampleToQImage(GstSample* sample)
         return QImage();
     }
     
+    // Frame tap samples are the camera's JPEG: decode straight from the mapped buffer
+    GstStructure* structure = gst_caps_get_structure(caps, 0);
+    if (structure && gst_structure_has_name(structure, "image/jpeg")) {
+        GstMapInfo jpegMap;
+        if (!gst_buffer_map(buffer, &jpegMap, GST_MAP_READ)) {
+            return QImage();
+        }
+        QImage image = QImage::fromData(jpegMap.data, static_cast<int>(jpegMap.size), "JPG");
+        gst_buffer_unmap(buffer, &jpegMap);
+        return image;
+    }
+    
     // Get the video info from the buffer
     GstVideoInfo videoInfo;
     if (!gst_video_info_from_caps(&videoInfo, caps)) {
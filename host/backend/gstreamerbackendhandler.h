@@ -24,13 +24,16 @@
 #define GSTREAMERBACKENDHANDLER_H
 
 #include "../multimediabackend.h"
+#include "ffmpeg/ffmpeg_encoded_frame.h"
 #include <QProcess>
 #include <QWidget>
 #include <QEvent>
 #include <QTimer>
+#include <QMutex>
 #include <gst/gst.h>
 #include <gst/app/gstappsink.h>
 #include <atomic>
+#include <memory>
 
 // Forward declarations for Qt types
 #include "../../ui/videopane.h"
@@ -40,6 +43,7 @@
 // Forward declarations
 class HotplugMonitor;
 struct DeviceInfo;
+namespace Openterface { namespace GStreamer { class PipelineProbes; } }
 
 // Forward declarations for GStreamer types - now properly defined via includes above
 // typedef struct _GstElement GstElement;
@@ -129,6 +133,16 @@ public:
     // Image capture methods
     void takeImage(const QString& filePath);
     void takeAreaImage(const QString& filePath, const QRect& captureArea);
+
+    // Latest frame, in memory (null if not running).  Decoded from the frame
+    // tap when the pipeline has one, else pulled from the capture appsink.
+    QImage grabLatestFrame();
+
+    // Camera JPEG held by the frame tap, unchanged (null for non-MJPEG pipelines)
+    EncodedFrame getLatestEncodedFrame() const;
+
+    // The frame tap publishes each camera frame; the bus decodes via grabLatestFrame() on demand
+    void setFrameBus(FrameBus* frameBus) override;
     
     // Advanced recording methods
     bool isPipelineReady() const;
@@ -155,6 +169,9 @@ public:
     // Returns true on successful create + start, false otherwise
     // NOTE: moved to private section
 
+signals:
+    void latencyStatsChanged(const QString& summary);  // Per-element probes, every health check
+
 private slots:
     void onPipelineMessage();
     void checkPipelineHealth();
@@ -286,10 +303,16 @@ private:
     // displays like 640x480 Pi touchscreens.
     QSize getDisplaySizeForPipeline() const;
 
-    // Schedule a deferred rebuild of the running pipeline when the overlay size
-    // changes significantly during resize or layout transitions.
+    // Schedule a deferred resize of the running pipeline when the overlay size
+    // changes during resize, fullscreen or layout transitions. Pipelines with a
+    // "display-caps" capsfilter renegotiate in place; others are rebuilt.
     void scheduleOverlayPipelineRebuild(int delayMs);
     bool overlayPipelineSizeChangeRequiresRebuild(const QSize& newSize) const;
+    int overlayResizeDelayMs() const;
+
+    // Set new output caps on "display-caps" and ask upstream to renegotiate.
+    // Returns false when the pipeline has no such capsfilter.
+    bool renegotiateDisplaySize(const QSize& size);
 
     // Ensure a QWidget has a native window (winId()) by creating the window and waiting up to timeoutMs.
     // Returns true if a native window is available.
@@ -318,11 +341,39 @@ private:
     guint m_frameProbeId{0};
     // GstPad probe callback (static so it can be passed to C API without instance)
     static GstPadProbeReturn gstreamer_frame_probe_cb(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    // Capsfilter after videoscale; held with the frame probe so resizes can skip a rebuild
+    GstElement* m_displayCaps{nullptr};
+
+    // Resize-to-first-frame timing: set when a resize is applied, completed by the
+    // frame probe on the first buffer whose caps match the target size
+    void markResizeRequested(const QSize& size, bool live);
+    void checkResizeCompleted(GstPad* pad);
+    std::atomic<qint64> m_resizeRequestedUs{0};
+    std::atomic<int> m_resizeTargetWidth{0};
+    std::atomic<int> m_resizeTargetHeight{0};
+    std::atomic<bool> m_resizeLive{false};
 #endif
 
     // Add helpers to manage frame probe
     void attachFrameProbe();
     void detachFrameProbe();
+
+    // Per-element latency/queue probes, only created when OPENTERFACE_GST_PROBES is set
+    void reportPipelineProbes();
+    std::unique_ptr<Openterface::GStreamer::PipelineProbes> m_pipelineProbes;
+    QString m_latencyCsvPath;
+
+    // Frame tap: "frame-tap" appsink on the camera JPEG, latest sample kept in memory
+    void attachFrameTap();
+    void detachFrameTap();
+#ifdef HAVE_GSTREAMER
+    GstSample* takeFrameTapSample(quint64* sequence) const;   // New ref or nullptr
+    static GstFlowReturn frame_tap_new_sample_cb(GstAppSink* sink, gpointer user_data);
+    GstElement* m_frameTapSink{nullptr};
+    GstSample* m_frameTapSample{nullptr};
+    quint64 m_frameTapSequence{0};
+    mutable QMutex m_frameTapMutex;
+#endif
 };
 
 #endif // GSTREAMERBACKENDHANDLER_H
@@ -18,6 +18,7 @@
 #endif
 
 #include "ui/videopane.h"
+#include "host/framebus.h"
 
 #include <QLoggingCategory>
 #include <QSettings>
@@ -40,7 +41,7 @@ OPF_LOGGING_CATEGORY(log_ui_camera, "opf.ui.camera")
 OPF_LOGGING_CATEGORY(log_backend, "opf.backend")
 
 CameraManager::CameraManager(QObject *parent)
-    : QObject(parent), m_graphicsVideoOutput(nullptr), m_video_width(0), m_video_height(0)
+    : QObject(parent), m_frameBus(new FrameBus(this)), m_graphicsVideoOutput(nullptr), m_video_width(0), m_video_height(0)
 {
     qCDebug(log_ui_camera) << "CameraManager init...";
     
@@ -65,6 +66,11 @@ CameraManager::CameraManager(QObject *parent)
 CameraManager::~CameraManager() {
     // Disconnect from hotplug monitoring
     disconnectFromHotplugMonitor();
+
+    // The bus outlives the handler; stop it calling into a destroyed backend
+    if (m_backendHandler) {
+        m_backendHandler->setFrameBus(nullptr);
+    }
 }
 
 bool CameraManager::isWindowsPlatform()
@@ -99,11 +105,26 @@ bool CameraManager::isMediaFoundationBackend() const
 #endif
 
 QImage CameraManager::getLatestOriginalFrame() const
+{
+    return m_frameBus->latestFrame();
+}
+
+FrameBus* CameraManager::frameBus() const
+{
+    return m_frameBus;
+}
+
+EncodedFrame CameraManager::getLatestEncodedFrame() const
 {
     if (FFmpegBackendHandler* ffmpeg = getFFmpegBackend()) {
-        return ffmpeg->getLatestOriginalFrame();
+        return ffmpeg->getLatestEncodedFrame();
+    }
+#ifndef Q_OS_WIN
+    if (GStreamerBackendHandler* gstreamer = getGStreamerBackend()) {
+        return gstreamer->getLatestEncodedFrame();
     }
-    return QImage();
+#endif
+    return EncodedFrame();
 }
 
 FFmpegBackendHandler* CameraManager::getFFmpegBackend() const
@@ -143,8 +164,13 @@ void CameraManager::initializeBackendHandler()
 {
     qCDebug(log_ui_camera) << "Initializing multimedia backend handler";
     try {
+        if (m_backendHandler) {
+            m_backendHandler->setFrameBus(nullptr);
+        }
         m_backendHandler = MultimediaBackendFactory::createAutoDetectedHandler(this);
         if (m_backendHandler) {
+            m_backendHandler->setFrameBus(m_frameBus);
+
             qCDebug(log_ui_camera) << "Backend handler initialized:" << m_backendHandler->getBackendName();
             qCDebug(log_ui_camera) << "Backend handler type:" << static_cast<int>(m_backendHandler->getBackendType());
             qCDebug(log_ui_camera) << "Backend handler pointer:" << m_backendHandler.get();
@@ -211,8 +237,30 @@ void CameraManager::initializeBackendHandler()
                             emit cameraError("FFmpeg: " + error);
                         });
 
+                connect(ffmpegHandler, &FFmpegBackendHandler::latencyStatsChanged,
+                        this, &CameraManager::latencyStatsChanged);
+
+                // Screenshots are saved in the background; announce the path once it is on disk
+                connect(ffmpegHandler, &FFmpegBackendHandler::imageSaved,
+                        this, [this](const QString& path, bool success, qint64 elapsedMs) {
+                            if (success) {
+                                qCDebug(log_ui_camera) << "Image saved to" << path << "in" << elapsedMs << "ms";
+                                emit lastImagePath(path);
+                            } else {
+                                qCWarning(log_ui_camera) << "Failed to save image" << path;
+                            }
+                            emit imageSaved(path, success, elapsedMs);
+                        });
+
                 qCDebug(log_ui_camera) << "FFmpeg backend signal connections established";
             }
+
+#ifndef Q_OS_WIN
+            if (auto gstHandler = qobject_cast<GStreamerBackendHandler*>(m_backendHandler.get())) {
+                connect(gstHandler, &GStreamerBackendHandler::latencyStatsChanged,
+                        this, &CameraManager::latencyStatsChanged);
+            }
+#endif
             
             // Qt backend setup - no longer needed for FFmpeg-only approach
 #ifdef Q_OS_WIN
@@ -415,10 +463,9 @@ void CameraManager::takeImage(const QString& file)
                     qCWarning(log_ui_camera) << "Failed to create directory:" << customFolderPath;
                     return;
                 }
-                actualFile = customFolderPath + "/" + timestamp + ".jpg";
+                actualFile = customFolderPath + "/" + timestamp + "." + GlobalSetting::instance().getScreenshotFormat();
             }
-            ffmpeg->takeImage(actualFile);
-            emit lastImagePath(actualFile);
+            ffmpeg->takeImage(actualFile);  // lastImagePath follows from imageSaved
         }
 #ifndef Q_OS_WIN
     } else if (isGStreamerBackend()) {
@@ -478,10 +525,9 @@ void CameraManager::takeAreaImage(const QString& file, const QRect& captureArea)
                     qCWarning(log_ui_camera) << "Failed to create directory:" << customFolderPath;
                     return;
                 }
-                actualFile = customFolderPath + "/" + timestamp + ".jpg";
+                actualFile = customFolderPath + "/" + timestamp + "." + GlobalSetting::instance().getScreenshotFormat();
             }
-            ffmpeg->takeAreaImage(actualFile, captureArea);
-            emit lastImagePath(actualFile);
+            ffmpeg->takeAreaImage(actualFile, captureArea);  // lastImagePath follows from imageSaved
         }
 #ifndef Q_OS_WIN
     } else if (isGStreamerBackend()) {
@@ -11,6 +11,7 @@
 #include <QSize>
 #include <QVideoFrameFormat>
 #include "host/multimediabackend.h"
+#include "host/backend/ffmpeg/ffmpeg_encoded_frame.h"
 #include "../device/DeviceInfo.h"
 #include <QLoggingCategory>
 
@@ -19,6 +20,7 @@ class GStreamerBackendHandler;
 class FFmpegBackendHandler;
 class QtBackendHandler;
 class VideoPane;
+class FrameBus;
 
 // Struct to represent a video format key, used for comparing and sorting video formats
 // It includes resolution, frame rate range, and pixel format
@@ -73,6 +75,14 @@ public:
 
     // Returns the latest camera frame at native (unscaled) resolution.
     QImage getLatestOriginalFrame() const;
+
+    // Shared frame source for TCP, MCP and timelapse consumers (any backend).
+    // Ask it for the size/format you need rather than converting a full frame.
+    FrameBus* frameBus() const;
+
+    // Returns the camera's own JPEG for the latest frame (null if unavailable).
+    // Use when the full frame is needed unchanged; avoids a decode/encode cycle.
+    EncodedFrame getLatestEncodedFrame() const;
     
     // Video output management
     void setVideoOutput(QGraphicsVideoItem* videoOutput);
@@ -128,6 +138,7 @@ signals:
     void resolutionsUpdated(int input_width, int input_height, float input_fps, int capture_width, int capture_height, int capture_fps, float pixelClk);
     void imageCaptured(int id, const QImage& img);
     void lastImagePath(const QString& imagePath);
+    void imageSaved(const QString& imagePath, bool success, qint64 elapsedMs);  // FFmpeg background save finished
     void cameraDeviceChanged(const QString& newDeviceId, const QString& oldDeviceId);
     void cameraDeviceSwitched(const QString& fromDeviceId, const QString& toDeviceId);
     void cameraDeviceConnected(const QString& deviceId, const QString& portChain);
@@ -137,6 +148,7 @@ signals:
     void availableCameraDevicesChanged(int deviceCount);
     void newDeviceAutoConnected(const QCameraDevice& device, const QString& portChain);
     void fpsChanged(double fps);
+    void latencyStatsChanged(const QString& summary);  // FFmpeg per-stage / GStreamer per-element latency
     
 public slots:
     // Note: Automatic device coordination slots have been removed
@@ -183,6 +195,7 @@ private:
     
     // Member variables - FFmpeg backend only
     std::unique_ptr<MultimediaBackendHandler> m_backendHandler;
+    FrameBus* m_frameBus;
     QGraphicsVideoItem* m_graphicsVideoOutput;
     int m_video_width;
     int m_video_height;
@@ -0,0 +1,268 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#include "framebus.h"
+
+#include <QLoggingCategory>
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <algorithm>
+
+Q_DECLARE_LOGGING_CATEGORY(log_ui_camera)
+
+namespace {
+
+constexpr qint64 kSlowReportIntervalUs = 1000000;
+
+} // namespace
+
+FrameBus::FrameBus(QObject *parent)
+    : QObject(parent)
+{
+    m_clock.start();
+}
+
+FrameBus::~FrameBus()
+{
+    QMutexLocker locker(&m_mutex);
+    for (const auto& subscriber : m_subscribers) {
+        subscriber->active = false;
+    }
+}
+
+void FrameBus::setFrameProvider(FrameProvider provider)
+{
+    QMutexLocker locker(&m_mutex);
+    m_provider = std::move(provider);
+    m_nativeFrame = QImage();
+    m_variants.clear();
+}
+
+void FrameBus::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_frameId = 0;
+    m_nativeFrame = QImage();
+    m_variants.clear();
+}
+
+void FrameBus::publishFrame(quint64 frameId, const QImage& frame)
+{
+    std::vector<std::shared_ptr<Subscriber>> due;
+    std::vector<std::pair<QString, quint64>> slow;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_frameId = frameId;
+        m_nativeFrame = frame;
+        m_variants.clear();
+
+        const qint64 now = nowUs();
+        for (const auto& subscriber : m_subscribers) {
+            const FrameBusFormat& format = subscriber->format;
+            if (format.maxFps > 0.0 && subscriber->lastDeliveryUs >= 0 &&
+                now - subscriber->lastDeliveryUs < static_cast<qint64>(1000000.0 / format.maxFps)) {
+                continue;
+            }
+            if (subscriber->pending) {
+                // Still busy with the last frame: drop instead of queueing behind it
+                const quint64 dropped = ++subscriber->dropped;
+                if (subscriber->lastSlowReportUs < 0 || now - subscriber->lastSlowReportUs >= kSlowReportIntervalUs) {
+                    subscriber->lastSlowReportUs = now;
+                    slow.emplace_back(subscriber->name, dropped);
+                }
+                continue;
+            }
+            subscriber->lastDeliveryUs = now;
+            subscriber->pending = true;
+            due.push_back(subscriber);
+        }
+    }
+
+    // Only the notification is queued here: the frame (lazy decode, scale, format
+    // conversion) is produced on the subscriber's thread, never the publisher's
+    const QPointer<FrameBus> bus(this);
+    for (const auto& subscriber : due) {
+        QObject* context = subscriber->context.data();
+        if (!context) {
+            subscriber->pending = false;
+            continue;
+        }
+        const bool queued = QMetaObject::invokeMethod(context, [bus, subscriber]() {
+            if (bus && subscriber->active) {
+                quint64 currentId = 0;
+                const QImage image = bus->currentFrame(subscriber->format, &currentId);
+                if (!image.isNull()) {
+                    subscriber->callback(image, currentId);
+                    ++subscriber->delivered;
+                }
+            }
+            subscriber->pending = false;
+        }, Qt::QueuedConnection);
+        if (!queued) {
+            subscriber->pending = false;
+        }
+    }
+
+    for (const auto& report : slow) {
+        qCDebug(log_ui_camera) << "Frame bus subscriber" << report.first << "is falling behind," << report.second << "frames dropped";
+        emit subscriberSlow(report.first, report.second);
+    }
+}
+
+int FrameBus::subscribe(const QString& name, const FrameBusFormat& format, QObject* context, FrameCallback callback)
+{
+    if (!context || !callback) {
+        return 0;
+    }
+    auto subscriber = std::make_shared<Subscriber>();
+    subscriber->name = name;
+    subscriber->format = format;
+    subscriber->context = context;
+    subscriber->callback = std::move(callback);
+
+    QMutexLocker locker(&m_mutex);
+    subscriber->id = m_nextId++;
+    m_subscribers.push_back(subscriber);
+    qCDebug(log_ui_camera) << "Frame bus subscriber added:" << name << format.maxSize << format.pixelFormat << format.maxFps << "fps";
+    return subscriber->id;
+}
+
+void FrameBus::unsubscribe(int id)
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = std::find_if(m_subscribers.begin(), m_subscribers.end(),
+                           [id](const std::shared_ptr<Subscriber>& subscriber) { return subscriber->id == id; });
+    if (it != m_subscribers.end()) {
+        // A delivery already queued still holds the subscriber; it sees active == false
+        (*it)->active = false;
+        m_subscribers.erase(it);
+    }
+}
+
+QImage FrameBus::latestFrame(const FrameBusFormat& format) const
+{
+    return currentFrame(format, nullptr);
+}
+
+QImage FrameBus::currentFrame(const FrameBusFormat& format, quint64* frameIdOut) const
+{
+    // A publish may land between reading the id and converting; retry on the newer frame
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        quint64 frameId = 0;
+        {
+            QMutexLocker locker(&m_mutex);
+            frameId = m_frameId;
+            if (frameId == 0 && !m_provider) {
+                return QImage();
+            }
+        }
+        const QImage image = frameFor(format, frameId);
+        if (!image.isNull() || latestFrameId() == frameId) {
+            if (frameIdOut) {
+                *frameIdOut = frameId;
+            }
+            return image;
+        }
+    }
+    return QImage();
+}
+
+quint64 FrameBus::latestFrameId() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_frameId;
+}
+
+QList<FrameBus::SubscriberStats> FrameBus::subscriberStats() const
+{
+    QMutexLocker locker(&m_mutex);
+    QList<SubscriberStats> stats;
+    for (const auto& subscriber : m_subscribers) {
+        SubscriberStats entry;
+        entry.name = subscriber->name;
+        entry.format = subscriber->format;
+        entry.delivered = subscriber->delivered;
+        entry.dropped = subscriber->dropped;
+        stats.append(entry);
+    }
+    return stats;
+}
+
+QImage FrameBus::frameFor(const FrameBusFormat& format, quint64 frameId) const
+{
+    QImage native;
+    FrameProvider provider;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (frameId != m_frameId) {
+            return QImage();    // Superseded while waiting; the next publish covers it
+        }
+        for (const Variant& variant : m_variants) {
+            if (variant.format.sameImage(format)) {
+                return variant.image;
+            }
+        }
+        native = m_nativeFrame;
+        provider = m_provider;
+    }
+
+    // Conversions run outside the lock so a large scale never blocks the publisher
+    if (native.isNull()) {
+        if (!provider) {
+            return QImage();
+        }
+        native = provider();
+        if (native.isNull()) {
+            return QImage();
+        }
+    }
+    const QImage converted = convert(native, format);
+
+    // Frame id 0 means a pull-only source: nothing to key a cache on
+    QMutexLocker locker(&m_mutex);
+    if (frameId != 0 && frameId == m_frameId) {
+        if (m_nativeFrame.isNull()) {
+            m_nativeFrame = native;
+        }
+        // Another caller may have made the same variant meanwhile; share theirs
+        for (const Variant& variant : m_variants) {
+            if (variant.format.sameImage(format)) {
+                return variant.image;
+            }
+        }
+        m_variants.push_back({format, converted});
+    }
+    return converted;
+}
+
+QImage FrameBus::convert(const QImage& source, const FrameBusFormat& format)
+{
+    QImage image = source;
+    if (format.maxSize.isValid() &&
+        (image.width() > format.maxSize.width() || image.height() > format.maxSize.height())) {
+        image = image.scaled(format.maxSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    if (format.pixelFormat != QImage::Format_Invalid && image.format() != format.pixelFormat) {
+        image = image.convertToFormat(format.pixelFormat);
+    }
+    return image;
+}
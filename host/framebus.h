@@ -0,0 +1,146 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#ifndef FRAMEBUS_H
+#define FRAMEBUS_H
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QPointer>
+#include <QSize>
+#include <QString>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief What a frame bus consumer wants to receive
+ */
+struct FrameBusFormat {
+    QSize maxSize;                                  // Fit inside, keeping aspect; invalid = native size
+    QImage::Format pixelFormat = QImage::Format_Invalid;  // Invalid = as published
+    double maxFps = 0.0;                            // Push subscriptions only; 0 = every frame
+
+    bool sameImage(const FrameBusFormat& other) const {
+        return maxSize == other.maxSize && pixelFormat == other.pixelFormat;
+    }
+};
+
+/**
+ * @brief Single distribution point for captured frames
+ *
+ * The active backend publishes every captured frame (FFmpeg and GStreamer
+ * alike); consumers either subscribe, to have frames pushed at their own
+ * rate, resolution and pixel format, or ask for latestFrame() on demand.
+ *
+ * Each distinct size/format is produced at most once per frame and shared
+ * (QImage is implicitly shared), so an extra consumer with the same needs
+ * costs no extra copy.  A backend may publish without a frame and register a
+ * frame provider instead; the native frame is then only produced when some
+ * consumer actually needs it.
+ *
+ * Push delivery never waits: a subscriber still busy with its previous frame
+ * has the new one dropped, counted and reported through subscriberSlow(), so a
+ * slow consumer cannot hold up capture or the other consumers.  Only the
+ * notification is queued; the subscriber's variant is made on its own thread
+ * when the notification runs, from whatever frame is newest by then.
+ *
+ * publishFrame() and latestFrame() may be called from any thread; callbacks
+ * run on the thread of the context object given to subscribe().
+ */
+class FrameBus : public QObject
+{
+    Q_OBJECT
+
+public:
+    using FrameCallback = std::function<void(const QImage& frame, quint64 frameId)>;
+    using FrameProvider = std::function<QImage()>;
+
+    struct SubscriberStats {
+        QString name;
+        FrameBusFormat format;
+        quint64 delivered = 0;
+        quint64 dropped = 0;        // Frames skipped because the previous one was still being handled
+    };
+
+    explicit FrameBus(QObject *parent = nullptr);
+    ~FrameBus() override;
+
+    // Backend side
+    void setFrameProvider(FrameProvider provider);
+    void publishFrame(quint64 frameId, const QImage& frame = QImage());
+    void reset();   // Source stopped: forget the latest frame
+
+    // Consumer side
+    int subscribe(const QString& name, const FrameBusFormat& format, QObject* context, FrameCallback callback);
+    void unsubscribe(int id);
+    QImage latestFrame(const FrameBusFormat& format = FrameBusFormat()) const;
+    quint64 latestFrameId() const;
+
+    QList<SubscriberStats> subscriberStats() const;
+
+signals:
+    void subscriberSlow(const QString& name, quint64 droppedFrames);
+
+private:
+    struct Subscriber {
+        int id = 0;
+        QString name;
+        FrameBusFormat format;
+        QPointer<QObject> context;
+        FrameCallback callback;
+        qint64 lastDeliveryUs = -1;
+        qint64 lastSlowReportUs = -1;
+        std::atomic<bool> pending{false};
+        std::atomic<bool> active{true};
+        std::atomic<quint64> delivered{0};
+        std::atomic<quint64> dropped{0};
+    };
+
+    struct Variant {
+        FrameBusFormat format;
+        QImage image;
+    };
+
+    QImage frameFor(const FrameBusFormat& format, quint64 frameId) const;
+    // Newest frame in `format`; *frameIdOut (if given) receives its id
+    QImage currentFrame(const FrameBusFormat& format, quint64* frameIdOut) const;
+    static QImage convert(const QImage& source, const FrameBusFormat& format);
+    qint64 nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+
+    mutable QMutex m_mutex;
+    QElapsedTimer m_clock;
+    FrameProvider m_provider;
+    std::vector<std::shared_ptr<Subscriber>> m_subscribers;
+    int m_nextId = 1;
+
+    // Latest frame and the variants made from it so far
+    quint64 m_frameId = 0;
+    mutable QImage m_nativeFrame;
+    mutable std::vector<Variant> m_variants;
+};
+
+#endif // FRAMEBUS_H
@@ -1,6 +1,9 @@
 #include "imagecapturer.h"
 #include "cameramanager.h"
+#include "timelapsearchive.h"
+#include "framebus.h"
 #include "../server/tcpServer.h"
+#include "../ui/globalsetting.h"
 #include <QDateTime>
 #include <QStandardPaths>
 #include <QDir>
@@ -8,6 +11,9 @@
 #include <QImage>
 #include <QLoggingCategory>
 #include <QFileInfo>
+#include <QBuffer>
+#include <QtConcurrent>
+#include <cstdlib>
 
 
 ImageCapturer::ImageCapturer(QObject *parent)
@@ -19,11 +25,14 @@ ImageCapturer::ImageCapturer(QObject *parent)
     , m_interval(1000) // default 1 second
     , m_fileName("real_time.jpg")
     , m_captureCount(0)
+    , m_changesOnly(true)
+    , m_lastFrameId(0)
 {
 }
 
 ImageCapturer::~ImageCapturer()
 {
+    stopCapturing();
     if (m_captureTimer) {
         m_captureTimer->stop();
         delete m_captureTimer;
@@ -36,6 +45,7 @@ void ImageCapturer::startCapturing(CameraManager* cameraManager, TcpServer* tcpS
         qCWarning(log_ui_camera) << "Invalid parameters for image capturer: cameraManager is null";
         return;
     }
+    stopCapturing();
     
     // Save state information
     m_cameraManager = cameraManager;
@@ -54,7 +64,10 @@ void ImageCapturer::startCapturing(CameraManager* cameraManager, TcpServer* tcpS
     }
     
     // set timer for periodic capture
-    m_captureTimer = new QTimer(this);
+    if (!m_captureTimer) {
+        m_captureTimer = new QTimer(this);
+    }
+    m_captureTimer->disconnect(this);
     connect(m_captureTimer, &QTimer::timeout, this, &ImageCapturer::captureImage);
     m_captureTimer->start(m_interval);
     
@@ -78,6 +91,50 @@ void ImageCapturer::startCapturingAuto(CameraManager* cameraManager, TcpServer*
     qCDebug(log_ui_camera) << "Saving images to:" << path;
 }
 
+bool ImageCapturer::startTimelapse(CameraManager* cameraManager, TcpServer* tcpServer, const QString& archiveDir,
+                                   int intervalSeconds, bool changesOnly)
+{
+    if (!cameraManager) {
+        qCWarning(log_ui_camera) << "Invalid parameters for timelapse: cameraManager is null";
+        return false;
+    }
+    stopCapturing();
+
+    QString path = archiveDir;
+    if (path.isEmpty()) {
+        path = QStandardPaths::writableLocation(QStandardPaths::PicturesLocation) + "/openterface/timelapse";
+    }
+    m_archive = std::make_unique<TimelapseArchive>();
+    if (!m_archive->open(path)) {
+        m_archive.reset();
+        return false;
+    }
+
+    m_cameraManager = cameraManager;
+    m_tcpServer = tcpServer;
+    m_savePath = path;
+    m_interval = qMax(1, intervalSeconds) * 1000;
+    m_changesOnly = changesOnly;
+    m_lastFrameId = 0;
+    m_lastSignature.clear();
+    m_unchangedSkips = 0;
+    if (m_tcpServer) {
+        m_tcpServer->setTimelapseArchive(m_archive.get());
+    }
+
+    if (!m_captureTimer) {
+        m_captureTimer = new QTimer(this);
+    }
+    m_captureTimer->disconnect(this);
+    connect(m_captureTimer, &QTimer::timeout, this, &ImageCapturer::captureTimelapseFrame);
+    m_captureTimer->start(m_interval);
+
+    m_isCapturing = true;
+    qCDebug(log_ui_camera) << "Timelapse started with interval:" << intervalSeconds << "seconds,"
+                           << (changesOnly ? "changes only" : "every frame") << "- archive:" << path;
+    return true;
+}
+
 void ImageCapturer::stopCapturing()
 {
     if (m_captureTimer) {
@@ -85,6 +142,114 @@ void ImageCapturer::stopCapturing()
         m_isCapturing = false;
         qCDebug(log_ui_camera) << "Image capturing stopped";
     }
+
+    if (m_archive) {
+        m_archiveWrite.waitForFinished();
+        if (m_tcpServer) {
+            m_tcpServer->setTimelapseArchive(nullptr);
+        }
+        qCDebug(log_ui_camera) << "Timelapse stopped:" << m_archive->frameCount() << "frames stored,"
+                               << m_unchangedSkips.load() << "unchanged frames skipped";
+        m_archive.reset();
+    }
+}
+
+void ImageCapturer::captureTimelapseFrame()
+{
+    if (!m_cameraManager || !m_isCapturing || !m_archive) {
+        return;
+    }
+    // Never queue up behind a slow disk: skip this tick instead
+    if (m_archiveWrite.isRunning()) {
+        qCDebug(log_ui_camera) << "Timelapse: previous frame still being written, tick skipped";
+        return;
+    }
+
+    // The camera's own JPEG is stored as-is when available (FFmpeg backend)
+    const EncodedFrame encoded = m_cameraManager->getLatestEncodedFrame();
+    if (m_changesOnly && !encoded.isNull() && encoded.frame_id == m_lastFrameId) {
+        m_unchangedSkips++;
+        return;  // No new frame since the last tick
+    }
+    FrameBus* frameBus = m_cameraManager->frameBus();
+    if (encoded.isNull() && !frameBus) {
+        qCDebug(log_ui_camera) << "Timelapse: no frame available";
+        return;
+    }
+    m_lastFrameId = encoded.frame_id;
+    m_lastCaptureTime = QDateTime::currentDateTime();
+    m_captureCount++;
+
+    // Frames come from the bus inside the task: the comparison only needs the
+    // small grey thumbnail, and the full frame is only made if there is no JPEG
+    const QDateTime timestamp = m_lastCaptureTime;
+    const int quality = GlobalSetting::instance().getScreenshotQuality();
+    m_archiveWrite = QtConcurrent::run([this, frameBus, encoded, timestamp, quality]() {
+        if (m_changesOnly && frameBus) {
+            const QImage thumbnail = frameBus->latestFrame(signatureFormat());
+            if (!thumbnail.isNull()) {
+                const QByteArray signature = frameSignature(thumbnail);
+                if (!signatureChanged(m_lastSignature, signature)) {
+                    m_unchangedSkips++;
+                    return;
+                }
+                m_lastSignature = signature;
+            }
+        }
+
+        QByteArray jpeg = encoded.data;
+        if (jpeg.isEmpty()) {
+            const QImage image = frameBus ? frameBus->latestFrame() : QImage();
+            if (image.isNull()) {
+                qCDebug(log_ui_camera) << "Timelapse: no frame available";
+                return;
+            }
+            QBuffer buffer(&jpeg);
+            buffer.open(QIODevice::WriteOnly);
+            if (!image.save(&buffer, "JPG", quality)) {
+                qCWarning(log_ui_camera) << "Timelapse: failed to encode frame";
+                return;
+            }
+        }
+        if (!m_archive->appendFrame(jpeg, timestamp)) {
+            qCWarning(log_ui_camera) << "Timelapse: failed to store frame";
+        }
+    });
+}
+
+// 64x36 grey thumbnail: cheap to compare, yet a cursor or a changed line of
+// text still moves at least one cell clearly
+FrameBusFormat ImageCapturer::signatureFormat()
+{
+    FrameBusFormat format;
+    format.maxSize = QSize(64, 36);
+    format.pixelFormat = QImage::Format_Grayscale8;
+    return format;
+}
+
+QByteArray ImageCapturer::frameSignature(const QImage& thumbnail)
+{
+    QByteArray signature;
+    signature.reserve(thumbnail.width() * thumbnail.height());
+    for (int y = 0; y < thumbnail.height(); ++y) {
+        signature.append(reinterpret_cast<const char*>(thumbnail.constScanLine(y)), thumbnail.width());
+    }
+    return signature;
+}
+
+bool ImageCapturer::signatureChanged(const QByteArray& previous, const QByteArray& current)
+{
+    // Above JPEG noise (a couple of levels), below any real screen change
+    constexpr int kCellThreshold = 6;
+    if (previous.size() != current.size()) {
+        return true;
+    }
+    for (qsizetype i = 0; i < current.size(); ++i) {
+        if (std::abs(static_cast<uchar>(current[i]) - static_cast<uchar>(previous[i])) > kCellThreshold) {
+            return true;
+        }
+    }
+    return false;
 }
 
 void ImageCapturer::captureImage()
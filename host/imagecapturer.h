@@ -8,9 +8,14 @@
 #include <QStandardPaths>
 #include <QDir>
 #include <QThread>
+#include <QFuture>
+#include <atomic>
+#include <memory>
 
 class TcpServer;
 class CameraManager;
+class TimelapseArchive;
+struct FrameBusFormat;
 
 class ImageCapturer : public QObject
 {
@@ -23,11 +28,18 @@ public:
     // Start capturing images at specified intervals (in seconds)
     void startCapturingAuto(CameraManager* cameraManager, TcpServer* tcpServer, const QString& savePath = QString(), int intervalSeconds = 1);
     void startCapturing(CameraManager* cameraManager, TcpServer* tcpServer, const QString& savePath, int intervalSeconds = 1);
+    // Timelapse mode: appends one JPEG per interval to a TimelapseArchive in
+    // archiveDir instead of writing a file per frame.  With changesOnly, frames
+    // that look the same as the last stored one are not stored again.
+    bool startTimelapse(CameraManager* cameraManager, TcpServer* tcpServer, const QString& archiveDir,
+                        int intervalSeconds = 1, bool changesOnly = true);
     void stopCapturing();
     bool isCapturing() const { return m_isCapturing; }
+    const TimelapseArchive* timelapseArchive() const { return m_archive.get(); }
 
 private slots:
     void captureImage();
+    void captureTimelapseFrame();
 
 private:
     QTimer* m_captureTimer;
@@ -39,6 +51,17 @@ private:
     QString m_fileName;
     int m_captureCount;
     QDateTime m_lastCaptureTime;
+
+    // Timelapse mode
+    static FrameBusFormat signatureFormat();
+    static QByteArray frameSignature(const QImage& thumbnail);
+    static bool signatureChanged(const QByteArray& previous, const QByteArray& current);
+    std::unique_ptr<TimelapseArchive> m_archive;
+    QFuture<void> m_archiveWrite;        // At most one frame being encoded/written
+    bool m_changesOnly;
+    quint64 m_lastFrameId;
+    QByteArray m_lastSignature;          // Only used by the archive write task
+    std::atomic<int> m_unchangedSkips{0};
 };
 
 #endif // IMAGECAPTURER_H
\ No newline at end of file
@@ -30,6 +30,8 @@
 #include <QLoggingCategory>
 #include <memory>
 
+class FrameBus;
+
 Q_DECLARE_LOGGING_CATEGORY(log_multimedia_backend)
 
 /**
@@ -123,6 +125,11 @@ public:
     virtual QString getCurrentRecordingPath() const { return QString(); }
     virtual qint64 getRecordingDuration() const { return 0; }
 
+    // Frames for consumers other than the video pane (TCP, MCP, timelapse)
+    // are published here; overrides register how to fetch the native frame
+    virtual void setFrameBus(FrameBus* frameBus) { m_frameBus = frameBus; }
+    FrameBus* frameBus() const { return m_frameBus; }
+
 signals:
     void backendMessage(const QString& message);
     void backendWarning(const QString& warning);
@@ -139,6 +146,7 @@ signals:
 
 protected:
     MultimediaBackendConfig m_config;
+    FrameBus* m_frameBus = nullptr;
     
     void logBackendMessage(const QString& message) const;
     void logBackendWarning(const QString& warning) const;
@@ -0,0 +1,291 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#include "timelapsearchive.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QLoggingCategory>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+Q_DECLARE_LOGGING_CATEGORY(log_ui_camera)
+
+namespace {
+
+const char kChunkMagic[8] = {'O', 'T', 'T', 'L', 'A', 'P', 'S', '1'};
+constexpr quint32 kRecordMagic = 0x5246544F;   // "OTFR" on disk
+constexpr int kRecordHeaderSize = 16;
+constexpr quint32 kMaxFrameBytes = 64u * 1024 * 1024;
+
+} // namespace
+
+TimelapseArchive::TimelapseArchive()
+{
+}
+
+TimelapseArchive::~TimelapseArchive()
+{
+    close();
+}
+
+QString TimelapseArchive::chunkPath(int chunk) const
+{
+    return QString("%1/timelapse_%2.otl").arg(m_directory).arg(chunk, 5, 10, QChar('0'));
+}
+
+bool TimelapseArchive::open(const QString& directory, qint64 maxChunkBytes)
+{
+    close();
+
+    QMutexLocker locker(&m_mutex);
+    QDir dir(directory);
+    if (!dir.exists() && !dir.mkpath(".")) {
+        qCWarning(log_ui_camera) << "Failed to create timelapse directory:" << directory;
+        return false;
+    }
+    m_directory = dir.absolutePath();
+    m_maxChunkBytes = qMax<qint64>(maxChunkBytes, 1024 * 1024);
+
+    // Chunk numbers come from the names; only the chunk files are listed
+    std::vector<int> chunks;
+    const QStringList names = dir.entryList(QStringList() << "timelapse_*.otl", QDir::Files, QDir::Name);
+    for (const QString& name : names) {
+        bool ok = false;
+        const int chunk = name.mid(10, name.length() - 14).toInt(&ok);
+        if (ok && chunk > 0) {
+            chunks.push_back(chunk);
+        }
+    }
+    std::sort(chunks.begin(), chunks.end());
+
+    qint64 lastGoodEnd = -1;
+    for (int chunk : chunks) {
+        lastGoodEnd = indexChunk(chunk);
+    }
+
+    // Append to the last chunk unless it is unreadable or full
+    int writeChunk = chunks.empty() ? 1 : chunks.back();
+    if (!chunks.empty() && (lastGoodEnd < 0 || lastGoodEnd >= m_maxChunkBytes)) {
+        ++writeChunk;
+    } else if (!chunks.empty() && QFileInfo(chunkPath(writeChunk)).size() > lastGoodEnd) {
+        // Drop a record torn by a crash so new records follow intact ones
+        QFile::resize(chunkPath(writeChunk), lastGoodEnd);
+        qCWarning(log_ui_camera) << "Timelapse chunk" << chunkPath(writeChunk) << "truncated to" << lastGoodEnd << "bytes";
+    }
+    if (!openChunkForAppend(writeChunk)) {
+        m_index.clear();
+        m_latestData.clear();
+        m_totalBytes = 0;
+        return false;
+    }
+
+    if (!m_index.empty() && !readPayload(m_index.back(), &m_latestData)) {
+        m_latestData.clear();
+    }
+    qCInfo(log_ui_camera) << "Timelapse archive opened:" << m_directory << "-" << m_index.size()
+                          << "frames in" << writeChunk << "chunk(s)";
+    return true;
+}
+
+qint64 TimelapseArchive::indexChunk(int chunk)
+{
+    QFile file(chunkPath(chunk));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    char magic[sizeof(kChunkMagic)];
+    if (file.read(magic, sizeof(magic)) != sizeof(magic) || std::memcmp(magic, kChunkMagic, sizeof(magic)) != 0) {
+        qCWarning(log_ui_camera) << "Not a timelapse chunk, skipped:" << file.fileName();
+        return -1;
+    }
+
+    const qint64 fileSize = file.size();
+    qint64 offset = sizeof(kChunkMagic);
+    uchar header[kRecordHeaderSize];
+    while (offset + kRecordHeaderSize <= fileSize) {
+        if (!file.seek(offset) || file.read(reinterpret_cast<char*>(header), kRecordHeaderSize) != kRecordHeaderSize) {
+            break;
+        }
+        Entry entry;
+        entry.chunk = chunk;
+        entry.timestampMs = qFromLittleEndian<qint64>(header + 4);
+        entry.size = qFromLittleEndian<quint32>(header + 12);
+        entry.offset = offset + kRecordHeaderSize;
+        if (qFromLittleEndian<quint32>(header) != kRecordMagic || entry.size == 0 ||
+            entry.size > kMaxFrameBytes || entry.offset + entry.size > fileSize) {
+            break;
+        }
+        m_index.push_back(entry);
+        m_totalBytes += entry.size;
+        offset = entry.offset + entry.size;
+    }
+    return offset;
+}
+
+bool TimelapseArchive::openChunkForAppend(int chunk)
+{
+    // Called with m_mutex held
+    if (m_writeFile.isOpen()) {
+        m_writeFile.close();
+    }
+    m_writeFile.setFileName(chunkPath(chunk));
+    if (!m_writeFile.open(QIODevice::ReadWrite)) {
+        qCWarning(log_ui_camera) << "Failed to open timelapse chunk:" << m_writeFile.fileName() << m_writeFile.errorString();
+        return false;
+    }
+    if (m_writeFile.size() == 0 && m_writeFile.write(kChunkMagic, sizeof(kChunkMagic)) != sizeof(kChunkMagic)) {
+        m_writeFile.close();
+        return false;
+    }
+    m_writeFile.seek(m_writeFile.size());
+    m_writeChunk = chunk;
+    return true;
+}
+
+void TimelapseArchive::close()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_writeFile.isOpen()) {
+        m_writeFile.close();
+    }
+    m_index.clear();
+    m_latestData.clear();
+    m_totalBytes = 0;
+    m_writeChunk = 0;
+}
+
+bool TimelapseArchive::isOpen() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_writeFile.isOpen();
+}
+
+bool TimelapseArchive::appendFrame(const QByteArray& jpegData, const QDateTime& timestamp)
+{
+    if (jpegData.isEmpty() || static_cast<quint64>(jpegData.size()) > kMaxFrameBytes) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_writeFile.isOpen()) {
+        return false;
+    }
+    if (m_writeFile.size() > static_cast<qint64>(sizeof(kChunkMagic)) &&
+        m_writeFile.size() + kRecordHeaderSize + jpegData.size() > m_maxChunkBytes &&
+        !openChunkForAppend(m_writeChunk + 1)) {
+        return false;
+    }
+
+    Entry entry;
+    entry.chunk = m_writeChunk;
+    entry.size = static_cast<quint32>(jpegData.size());
+    entry.timestampMs = timestamp.toMSecsSinceEpoch();
+    const qint64 recordStart = m_writeFile.size();
+    entry.offset = recordStart + kRecordHeaderSize;
+
+    uchar header[kRecordHeaderSize];
+    qToLittleEndian<quint32>(kRecordMagic, header);
+    qToLittleEndian<qint64>(entry.timestampMs, header + 4);
+    qToLittleEndian<quint32>(entry.size, header + 12);
+    if (m_writeFile.write(reinterpret_cast<const char*>(header), kRecordHeaderSize) != kRecordHeaderSize ||
+        m_writeFile.write(jpegData) != jpegData.size() || !m_writeFile.flush()) {
+        qCWarning(log_ui_camera) << "Failed to append timelapse frame:" << m_writeFile.errorString();
+        m_writeFile.resize(recordStart);
+        m_writeFile.seek(recordStart);
+        return false;
+    }
+
+    m_index.push_back(entry);
+    m_totalBytes += entry.size;
+    m_latestData = jpegData;
+    return true;
+}
+
+int TimelapseArchive::frameCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_index.size());
+}
+
+qint64 TimelapseArchive::totalBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_totalBytes;
+}
+
+QString TimelapseArchive::directory() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_directory;
+}
+
+bool TimelapseArchive::latestFrame(QByteArray* jpegData, QDateTime* timestamp) const
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_index.empty() || m_latestData.isEmpty()) {
+        return false;
+    }
+    if (jpegData) {
+        *jpegData = m_latestData;  // Implicitly shared, no copy
+    }
+    if (timestamp) {
+        *timestamp = QDateTime::fromMSecsSinceEpoch(m_index.back().timestampMs);
+    }
+    return true;
+}
+
+bool TimelapseArchive::frameAt(int index, QByteArray* jpegData, QDateTime* timestamp) const
+{
+    QMutexLocker locker(&m_mutex);
+    if (index < 0 || index >= static_cast<int>(m_index.size())) {
+        return false;
+    }
+    const Entry& entry = m_index[index];
+    if (jpegData && !readPayload(entry, jpegData)) {
+        return false;
+    }
+    if (timestamp) {
+        *timestamp = QDateTime::fromMSecsSinceEpoch(entry.timestampMs);
+    }
+    return true;
+}
+
+int TimelapseArchive::indexAt(const QDateTime& timestamp) const
+{
+    QMutexLocker locker(&m_mutex);
+    const qint64 ms = timestamp.toMSecsSinceEpoch();
+    auto it = std::upper_bound(m_index.begin(), m_index.end(), ms,
+                               [](qint64 value, const Entry& entry) { return value < entry.timestampMs; });
+    return static_cast<int>(it - m_index.begin()) - 1;
+}
+
+bool TimelapseArchive::readPayload(const Entry& entry, QByteArray* data) const
+{
+    QFile file(chunkPath(entry.chunk));
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(entry.offset)) {
+        return false;
+    }
+    *data = file.read(entry.size);
+    return data->size() == static_cast<qsizetype>(entry.size);
+}
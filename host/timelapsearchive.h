@@ -0,0 +1,102 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#ifndef TIMELAPSEARCHIVE_H
+#define TIMELAPSEARCHIVE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <vector>
+
+/**
+ * @brief Append-only JPEG frame archive for long timelapse captures
+ *
+ * Frames are appended to chunk files (timelapse_00001.otl, ...) in one
+ * directory instead of one file per frame, so a multi-day capture leaves a
+ * handful of files.  Each chunk starts with an 8-byte magic followed by
+ * records of:
+ *
+ *   u32 record magic, i64 timestamp (ms since epoch, UTC), u32 size, JPEG bytes
+ *
+ * all little-endian.  open() rebuilds the in-memory index by walking the
+ * record headers once and cuts off a record torn by a crash.  The newest
+ * frame is kept in memory, so latestFrame() is O(1) however long the
+ * archive grows; older frames are found by binary search on the timestamp.
+ *
+ * All methods are thread-safe.
+ */
+class TimelapseArchive
+{
+public:
+    static constexpr qint64 kDefaultMaxChunkBytes = 256LL * 1024 * 1024;
+
+    TimelapseArchive();
+    ~TimelapseArchive();
+
+    TimelapseArchive(const TimelapseArchive&) = delete;
+    TimelapseArchive& operator=(const TimelapseArchive&) = delete;
+
+    // Opens (or creates) the archive in directory and indexes existing chunks
+    bool open(const QString& directory, qint64 maxChunkBytes = kDefaultMaxChunkBytes);
+    void close();
+    bool isOpen() const;
+
+    bool appendFrame(const QByteArray& jpegData, const QDateTime& timestamp);
+
+    int frameCount() const;
+    qint64 totalBytes() const;
+    QString directory() const;
+
+    bool latestFrame(QByteArray* jpegData, QDateTime* timestamp) const;
+    bool frameAt(int index, QByteArray* jpegData, QDateTime* timestamp) const;
+
+    // Index of the last frame taken at or before timestamp, -1 if none
+    int indexAt(const QDateTime& timestamp) const;
+
+private:
+    struct Entry {
+        int chunk = 0;
+        qint64 offset = 0;       // Payload offset in the chunk file
+        quint32 size = 0;
+        qint64 timestampMs = 0;
+    };
+
+    QString chunkPath(int chunk) const;
+    qint64 indexChunk(int chunk);    // End of the last intact record, -1 if unreadable
+    bool openChunkForAppend(int chunk);
+    bool readPayload(const Entry& entry, QByteArray* data) const;
+
+    mutable QMutex m_mutex;
+    QString m_directory;
+    qint64 m_maxChunkBytes = kDefaultMaxChunkBytes;
+    std::vector<Entry> m_index;
+    QFile m_writeFile;
+    int m_writeChunk = 0;
+    qint64 m_totalBytes = 0;
+
+    QByteArray m_latestData;     // Payload of m_index.back()
+};
+
+#endif // TIMELAPSEARCHIVE_H
@@ -40,6 +40,7 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QTimer>
+#include <QTemporaryDir>
 #include <cstdio>
 
 // Stdio MCP transport support (headless mode for Claude Code)
@@ -47,6 +48,8 @@
 #include "device/DeviceManager.h"
 #include "serial/SerialPortManager.h"
 #include "host/cameramanager.h"
+#include "host/backend/ffmpeg/ffmpeg_packet_capture_file.h"
+#include "host/backend/ffmpeg/ffmpeg_video_benchmark.h"
 #include "video/videohid.h"
 
 #ifdef Q_OS_WIN
@@ -228,6 +231,47 @@ void applyMediaBackendSetting(){
 #endif
 }
 
+// Headless video pipeline benchmark (--video-benchmark). Each input is a packet
+// capture file or a synthetic preset ("720p", "1080p", "4k"). Returns 2 when a
+// run fails or decodes slower than minFps, so CI can gate on it.
+int runVideoBenchmark(const QStringList& inputs, const FFmpegVideoBenchmark::Options& options,
+                      const QString& csvPath, double minFps)
+{
+    constexpr int kSyntheticFrames = 300;
+    constexpr int kSyntheticFps = 30;
+
+    QTemporaryDir tempDir;
+    int exitCode = 0;
+    for (const QString& input : inputs) {
+        QString capturePath = input;
+        const QSize presetSize = FFmpegVideoBenchmark::SyntheticPresetSize(input);
+        if (presetSize.isValid()) {
+            const int frames = options.max_frames > 0 ? options.max_frames : kSyntheticFrames;
+            capturePath = tempDir.filePath(input + FFmpegPacketCaptureFormat::kFileSuffix);
+            QString error;
+            if (!tempDir.isValid() ||
+                !FFmpegVideoBenchmark::GenerateSyntheticCapture(capturePath, presetSize, frames, kSyntheticFps, &error)) {
+                printf("%s: FAILED - %s\n", qPrintable(input), qPrintable(error));
+                exitCode = 2;
+                continue;
+            }
+        }
+
+        FFmpegVideoBenchmark::Result result = FFmpegVideoBenchmark::Run(capturePath, options);
+        result.input = input;
+        printf("%s\n", qPrintable(FFmpegVideoBenchmark::FormatResult(result)));
+        fflush(stdout);
+
+        if (!csvPath.isEmpty() && !FFmpegVideoBenchmark::AppendCsv(csvPath, result)) {
+            qWarning() << "Cannot write benchmark CSV:" << csvPath;
+        }
+        if (!result.ok || (minFps > 0.0 && result.decode_fps < minFps)) {
+            exitCode = 2;
+        }
+    }
+    return exitCode;
+}
+
 int main(int argc, char *argv[])
 {
     // TEMP: Early startup logging
@@ -251,6 +295,10 @@ int main(int argc, char *argv[])
     int mcpSsePort = 0;  // 0 = disabled
     QString overrideBackend;
     bool listBackends = false;
+    QStringList benchmarkInputs;
+    FFmpegVideoBenchmark::Options benchmarkOptions;
+    QString benchmarkCsvPath;
+    double benchmarkMinFps = 0.0;
 
     for (int i = 1; i < argc; i++) {
         QString arg = QString::fromUtf8(argv[i]);
@@ -279,9 +327,27 @@ int main(int argc, char *argv[])
             qInfo() << "Override media backend from command line:" << overrideBackend;
         } else if (arg == "--list-backends") {
             listBackends = true;
+        } else if (arg == "--video-benchmark" && i + 1 < argc) {
+            benchmarkInputs << QString::fromLocal8Bit(argv[++i]);
+        } else if (arg == "--benchmark-realtime") {
+            benchmarkOptions.timing = FFmpegReplayFrameReader::Timing::Original;
+        } else if (arg == "--benchmark-frames" && i + 1 < argc) {
+            benchmarkOptions.max_frames = qMax(0, atoi(argv[++i]));
+        } else if (arg == "--benchmark-record") {
+            benchmarkOptions.record = true;
+        } else if (arg == "--benchmark-csv" && i + 1 < argc) {
+            benchmarkCsvPath = QString::fromLocal8Bit(argv[++i]);
+        } else if (arg == "--benchmark-min-fps" && i + 1 < argc) {
+            benchmarkMinFps = atof(argv[++i]);
         }
     }
 
+    // Benchmark mode: no window, no device, results on stdout
+    if (!benchmarkInputs.isEmpty()) {
+        QCoreApplication app(argc, argv);
+        return runVideoBenchmark(benchmarkInputs, benchmarkOptions, benchmarkCsvPath, benchmarkMinFps);
+    }
+
     // MCP headless mode: if --mcp-stdio or --mcp-sse-port, run a minimal Qt event
     // loop with the MCP server — no MainWindow, no GUI window.
     // We use QApplication (not QCoreApplication) because KeyboardManager calls
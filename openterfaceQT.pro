@@ -35,15 +35,29 @@ SOURCES += main.cpp \
     host/usbcontrol.cpp \
     host/multimediabackend.cpp \
     host/imagecapturer.cpp \
+    host/timelapsearchive.cpp \
+    host/framebus.cpp \
     host/backend/qtmultimediabackendhandler.cpp \
     host/backend/qtbackendhandler.cpp \
+    host/backend/common/jpegutils.cpp \
     host/backend/ffmpegbackendhandler.cpp \
     host/backend/ffmpeg/capturethread.cpp \
     host/backend/ffmpeg/ffmpeg_hardware_accelerator.cpp \
     host/backend/ffmpeg/ffmpeg_device_manager.cpp \
     host/backend/ffmpeg/ffmpeg_frame_processor.cpp \
+    host/backend/ffmpeg/ffmpeg_frame_pool.cpp \
+    host/backend/ffmpeg/ffmpeg_decode_pipeline.cpp \
+    host/backend/ffmpeg/ffmpeg_frame_change_detector.cpp \
+    host/backend/ffmpeg/ffmpeg_latency_tracer.cpp \
+    host/backend/ffmpeg/ffmpeg_frame_pacer.cpp \
+    host/backend/ffmpeg/ffmpeg_yuv_convert.cpp \
+    host/backend/ffmpeg/ffmpeg_packet_capture_file.cpp \
+    host/backend/ffmpeg/ffmpeg_replay_frame_reader.cpp \
+    host/backend/ffmpeg/ffmpeg_video_benchmark.cpp \
+    host/backend/ffmpeg/ffmpeg_image_saver.cpp \
     host/backend/ffmpeg/ffmpeg_amd_detector.cpp \
     host/backend/ffmpeg/ffmpeg_recorder.cpp \
+    host/backend/ffmpeg/ffmpeg_audio_encoder.cpp \
     host/backend/ffmpeg/ffmpeg_device_validator.cpp \
     host/backend/ffmpeg/ffmpeg_hotplug_handler.cpp \
     host/backend/ffmpeg/ffmpeg_capture_manager.cpp \
@@ -59,11 +73,14 @@ SOURCES += main.cpp \
     serial/SerialCommandCoordinator.cpp \
     serial/SerialStateManager.cpp \
     serial/SerialStatistics.cpp \
+    serial/SerialTraceRecorder.cpp \
+    serial/SerialTxScheduler.cpp \
     serial/FactoryResetManager.cpp \
     serial/chipstrategy/CH9329Strategy.cpp \
     serial/chipstrategy/CH32V208Strategy.cpp \
     serial/chipstrategy/ChipStrategyFactory.cpp \
     serial/protocol/SerialProtocol.cpp \
+    serial/protocol/SerialPacketFramer.cpp \
     serial/watchdog/ConnectionWatchdog.cpp \
     serial/serial_hotplug_handler.cpp \
     server/tcpServer.cpp \
@@ -164,7 +181,8 @@ SOURCES += main.cpp \
                host/backend/gstreamer/gstreamerhelpers.cpp \
                host/backend/gstreamer/inprocessgstrunner.cpp \
                host/backend/gstreamer/externalgstrunner.cpp \
-               host/backend/gstreamer/recordingmanager.cpp
+               host/backend/gstreamer/recordingmanager.cpp \
+               host/backend/gstreamer/pipelineprobes.cpp
     HEADERS += host/backend/gstreamerbackendhandler.h \
                host/backend/gstreamer/sinkselector.h \
                host/backend/gstreamer/queueconfigurator.h \
@@ -174,7 +192,8 @@ SOURCES += main.cpp \
                host/backend/gstreamer/gstreamerhelpers.h \
                host/backend/gstreamer/inprocessgstrunner.h \
                host/backend/gstreamer/externalgstrunner.h \
-               host/backend/gstreamer/recordingmanager.h
+               host/backend/gstreamer/recordingmanager.h \
+               host/backend/gstreamer/pipelineprobes.h
 }
 
 
@@ -195,15 +214,33 @@ HEADERS  += \
     host/usbcontrol.h \
     host/multimediabackend.h \
     host/imagecapturer.h \
+    host/timelapsearchive.h \
+    host/framebus.h \
     host/backend/qtmultimediabackendhandler.h \
     host/backend/qtbackendhandler.h \
+    host/backend/common/jpegutils.h \
+    host/backend/common/latencyhistogram.h \
     host/backend/ffmpegbackendhandler.h \
     host/backend/ffmpeg/capturethread.h \
     host/backend/ffmpeg/ffmpeg_hardware_accelerator.h \
     host/backend/ffmpeg/ffmpeg_device_manager.h \
     host/backend/ffmpeg/ffmpeg_frame_processor.h \
+    host/backend/ffmpeg/ffmpeg_frame_pool.h \
+    host/backend/ffmpeg/ffmpeg_decode_pipeline.h \
+    host/backend/ffmpeg/ffmpeg_packet_ring.h \
+    host/backend/ffmpeg/ffmpeg_clock.h \
+    host/backend/ffmpeg/ffmpeg_latency_tracer.h \
+    host/backend/ffmpeg/ffmpeg_frame_pacer.h \
+    host/backend/ffmpeg/ffmpeg_yuv_convert.h \
+    host/backend/ffmpeg/ffmpeg_packet_capture_file.h \
+    host/backend/ffmpeg/ffmpeg_replay_frame_reader.h \
+    host/backend/ffmpeg/ffmpeg_video_benchmark.h \
+    host/backend/ffmpeg/ffmpeg_image_saver.h \
+    host/backend/ffmpeg/ffmpeg_encoded_frame.h \
+    host/backend/ffmpeg/ffmpeg_frame_change_detector.h \
     host/backend/ffmpeg/ffmpeg_amd_detector.h \
     host/backend/ffmpeg/ffmpeg_recorder.h \
+    host/backend/ffmpeg/ffmpeg_audio_encoder.h \
     host/backend/ffmpeg/ffmpeg_device_validator.h \
     host/backend/ffmpeg/ffmpeg_hotplug_handler.h \
     host/backend/ffmpeg/ffmpeg_capture_manager.h \
@@ -222,6 +259,8 @@ HEADERS  += \
     serial/SerialCommandCoordinator.h \
     serial/SerialStateManager.h \
     serial/SerialStatistics.h \
+    serial/SerialTraceRecorder.h \
+    serial/SerialTxScheduler.h \
     serial/FactoryResetManager.h \
     serial/ch9329.h \
     serial/chipstrategy/IChipStrategy.h \
@@ -229,6 +268,7 @@ HEADERS  += \
     serial/chipstrategy/CH32V208Strategy.h \
     serial/chipstrategy/ChipStrategyFactory.h \
     serial/protocol/SerialProtocol.h \
+    serial/protocol/SerialPacketFramer.h \
     serial/watchdog/ConnectionWatchdog.h \
     serial/serial_hotplug_handler.h \
     server/tcpServer.h \
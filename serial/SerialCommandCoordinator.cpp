@@ -22,13 +22,11 @@
 
 #include "SerialCommandCoordinator.h"
 #include "SerialStatistics.h"
+#include "SerialTraceRecorder.h"
+#include "protocol/SerialPacketFramer.h"
 #include "SerialPortManager.h"
-#include <QTimer>
 #include <QLoggingCategory>
-#include <QEventLoop>
 #include <QElapsedTimer>
-#include <QFile>
-#include <QTextStream>
 
 // Declare the unified serial logging category (defined in SerialPortManager.cpp)
 Q_DECLARE_LOGGING_CATEGORY(log_core_serial)
@@ -52,30 +50,12 @@ SerialCommandCoordinator::~SerialCommandCoordinator()
 
 bool SerialCommandCoordinator::sendAsyncCommand(QSerialPort* serialPort, const QByteArray &data, bool force)
 {
-    // DEBUG: Log to file for MCP keyboard diagnostics
-    {
-        QFile debugLog("/tmp/serial-command-debug.log");
-        if (debugLog.open(QIODevice::Append | QIODevice::Text)) {
-            QTextStream out(&debugLog);
-            out << "=== sendAsyncCommand called ===\n";
-            out << "m_ready: " << m_ready << "\n";
-            out << "force: " << force << "\n";
-            out << "serialPort: " << (void*)serialPort << "\n";
-            out << "serialPort->isOpen(): " << (serialPort ? serialPort->isOpen() : false) << "\n";
-            out << "data: " << QString::fromLatin1(data.toHex(' ')) << "\n";
-            debugLog.close();
-        }
-    }
-
     if (!force && !m_ready) {
         qCWarning(log_core_serial) << "⚠️ COMMAND DROPPED: not ready (m_ready=" << m_ready << ", force=" << force << ")";
-        // Log dropped command
-        QFile debugLog("/tmp/serial-command-debug.log");
-        if (debugLog.open(QIODevice::Append | QIODevice::Text)) {
-            QTextStream out(&debugLog);
-            out << "⚠️ COMMAND DROPPED: m_ready=" << m_ready << "\n";
-            out << "   data: " << QString::fromLatin1(data.toHex(' ')) << "\n";
-            debugLog.close();
+        if (SerialTraceRecorder::isEnabled()) {
+            SerialTraceRecorder::getInstance().record(SerialTraceRecorder::Direction::Tx, data,
+                                                      serialPort ? serialPort->baudRate() : 0,
+                                                      SerialTraceRecorder::Event::Dropped);
         }
         return false;
     }
@@ -106,18 +86,11 @@ bool SerialCommandCoordinator::sendAsyncCommand(QSerialPort* serialPort, const Q
         m_statsSent++;
     }
 
-    // Check command delay
-    if (m_lastCommandTime.isValid() && m_lastCommandTime.elapsed() < m_commandDelayMs) {
-        int remainingDelay = m_commandDelayMs - m_lastCommandTime.elapsed();
-        qCDebug(log_core_serial) << "Delaying command by" << remainingDelay << "ms";
-
-        QEventLoop loop;
-        QTimer::singleShot(remainingDelay, &loop, &QEventLoop::quit);
-        loop.exec();
-    }
-
+    // Inter-command spacing (m_commandDelayMs, chip minimum) is applied by
+    // SerialTxScheduler; SerialPortManager::sendAsyncCommand() always goes
+    // through it, so this path never waits
     qCInfo(log_core_serial) << "▶️ Executing command on serial port...";
-    bool result = executeCommand(serialPort, command);
+    bool result = executeCommand(serialPort, command, false);
     m_lastCommandTime.start();
 
     qCInfo(log_core_serial) << "✅ Command execution result:" << (result ? "SUCCESS" : "FAILED");
@@ -125,7 +98,8 @@ bool SerialCommandCoordinator::sendAsyncCommand(QSerialPort* serialPort, const Q
     return result;
 }
 
-QByteArray SerialCommandCoordinator::sendSyncCommand(QSerialPort* serialPort, const QByteArray &data, bool force, int timeoutMs)
+QByteArray SerialCommandCoordinator::sendSyncCommand(QSerialPort* serialPort, const QByteArray &data, bool force, int timeoutMs,
+                                                     QByteArray* rxCarry)
 {
     if (!force && !m_ready) {
         qCDebug(log_core_serial) << "Cannot send sync command: not ready";
@@ -159,16 +133,15 @@ QByteArray SerialCommandCoordinator::sendSyncCommand(QSerialPort* serialPort, co
         }
     }
 
-    serialPort->readAll(); // Clear any existing data in the buffer before sending command
     command.append(calculateChecksum(command));
     
-    if (!executeCommand(serialPort, command)) {
+    if (!executeCommand(serialPort, command, true)) {
         qCWarning(log_core_serial) << "Failed to execute sync command";
         return QByteArray();
     }
     
     // Use helper to wait for and collect the sync response
-    QByteArray responseData = collectSyncResponse(serialPort, timeoutMs, 100);
+    QByteArray responseData = collectSyncResponse(serialPort, static_cast<quint8>(commandCode), timeoutMs, 100, rxCarry);
 
     // Verify response command code matches expected
     if (responseData.size() >= 4) {
@@ -301,7 +274,8 @@ int SerialCommandCoordinator::getQueueSize() const
     return m_commandQueue.size();
 }
 
-QByteArray SerialCommandCoordinator::collectSyncResponse(QSerialPort* serialPort, int totalTimeoutMs, int waitStepMs)
+QByteArray SerialCommandCoordinator::collectSyncResponse(QSerialPort* serialPort, quint8 commandCode, int totalTimeoutMs, int waitStepMs,
+                                                         QByteArray* rxCarry)
 {
     if (!serialPort || !serialPort->isOpen()) {
         qCWarning(log_core_serial) << "Cannot collect response: port not available";
@@ -311,45 +285,56 @@ QByteArray SerialCommandCoordinator::collectSyncResponse(QSerialPort* serialPort
     QElapsedTimer timer;
     timer.start();
     QByteArray responseData;
-
-    int expectedResponseLength = MIN_PACKET_SIZE; // minimal header + checksum
-
-    while (timer.elapsed() < totalTimeoutMs && responseData.size() < expectedResponseLength) {
-        if (!serialPort->waitForReadyRead(waitStepMs)) {
+    const quint8 responseCode = commandCode | 0x80;
+
+    // Frame everything that arrives and pick out our response by code; ACKs for
+    // async input and answers to other requests are passed on, not mistaken for it
+    // Start from the partial packet the main RX path was holding, so stream order is kept
+    SerialPacketFramer framer(MAX_ACCEPTABLE_PACKET);
+    framer.setDiscardHandler([serialPort](const QByteArray& bytes) {
+        if (SerialTraceRecorder::isEnabled()) {
+            SerialTraceRecorder::getInstance().record(SerialTraceRecorder::Direction::Rx, bytes,
+                                                      serialPort->baudRate(),
+                                                      SerialTraceRecorder::Event::Discarded);
+        }
+    });
+    if (rxCarry && !rxCarry->isEmpty()) {
+        framer.append(*rxCarry);
+        rxCarry->clear();
+    }
+    while (responseData.isEmpty() && timer.elapsed() < totalTimeoutMs) {
+        if (serialPort->bytesAvailable() <= 0 && !serialPort->waitForReadyRead(waitStepMs)) {
             continue; // Timeout on this wait step, but continue if overall timeout not reached
         }
 
-        QByteArray newData = serialPort->readAll();
-        if (!newData.isEmpty()) {
-            responseData.append(newData);
-            // qCDebug(log_core_serial) << "Collected" << newData.size() << "bytes, total:" << responseData.size();
-            
-            // If we have enough data to determine packet length, update expected length
-            // Protocol header: [0]=0x57 [1]=0xAB [2]=addr [3]=cmd [4]=len
-            const int HEADER_MIN = 5; // need at least up to len byte
-            if (responseData.size() >= HEADER_MIN && expectedResponseLength == MIN_PACKET_SIZE) {
-                int lenField = static_cast<unsigned char>(responseData[4]);
-                // Total packet size = header(5) + payload(lenField) + checksum(1) == lenField + 6
-                int total = lenField + 6;
-                if (total > MIN_PACKET_SIZE && total <= MAX_ACCEPTABLE_PACKET) {
-                    expectedResponseLength = total;
-                    // qCDebug(log_core_serial) << "Updated expected response length to:" << expectedResponseLength;
-                } else {
-                    qCWarning(log_core_serial) << "Invalid packet length detected:" << total << "ignoring";
-                }
+        framer.append(serialPort->readAll());
+        framer.drain([&](const QByteArray& view, bool checksumOk) {
+            Q_UNUSED(checksumOk)
+            const QByteArray packet(view.constData(), view.size());
+            // 0xC0 | cmd is the error form of the same response
+            if (responseData.isEmpty() && (static_cast<quint8>(packet[3]) & 0xBF) == responseCode) {
+                responseData = packet;
+                return;
             }
-        }
-        
-        // Break if we have collected enough data or hit maximum acceptable packet size
-        if (responseData.size() >= expectedResponseLength || responseData.size() >= MAX_ACCEPTABLE_PACKET) {
-            break;
-        }
+            // Handled (trace, statistics, dataReceived) by the main RX path
+            emit interleavedPacketReceived(packet);
+        });
+    }
+
+    // A packet cut off after our response belongs to the main RX path
+    if (rxCarry) {
+        *rxCarry = framer.takeBuffered();
+    } else if (framer.bufferedBytes() > 0) {
+        qCDebug(log_core_serial) << "Dropping" << framer.bufferedBytes() << "unframed bytes after sync response";
     }
 
     if (!responseData.isEmpty()) {
         QString portName = serialPort ? serialPort->portName() : QString();
         int baudrate = serialPort ? serialPort->baudRate() : 0;
         qCDebug(log_core_serial).nospace().noquote() << "RX (" << portName << "@" << baudrate << "bps): " << responseData.toHex(' ');
+        if (SerialTraceRecorder::isEnabled()) {
+            SerialTraceRecorder::getInstance().record(SerialTraceRecorder::Direction::Rx, responseData, baudrate);
+        }
         // Also write to diagnostics file if enabled
         if (SerialPortManager::getInstance().getSerialLogFilePath().contains("serial_log_diagnostics")) {
             SerialPortManager::getInstance().log(QString("RX (%1@%2bps): %3").arg(portName).arg(baudrate).arg(QString(responseData.toHex(' '))));
@@ -359,37 +344,20 @@ QByteArray SerialCommandCoordinator::collectSyncResponse(QSerialPort* serialPort
     return responseData;
 }
 
-bool SerialCommandCoordinator::executeCommand(QSerialPort* serialPort, const QByteArray &command)
+bool SerialCommandCoordinator::executeCommand(QSerialPort* serialPort, const QByteArray &command, bool waitForWritten)
 {
     if (!serialPort || !serialPort->isOpen()) {
         qCWarning(log_core_serial) << "Cannot execute command: port not available";
         return false;
     }
 
-    // DEBUG: Log command execution attempt
-    {
-        QFile debugLog("/tmp/serial-command-debug.log");
-        if (debugLog.open(QIODevice::Append | QIODevice::Text)) {
-            QTextStream out(&debugLog);
-            out << "=== executeCommand called ===\n";
-            out << "command size: " << command.size() << "\n";
-            out << "command: " << QString::fromLatin1(command.toHex(' ')) << "\n";
-            out << "port: " << serialPort->portName() << "\n";
-            out << "baudrate: " << serialPort->baudRate() << "\n";
-            debugLog.close();
-        }
-    }
-
     try {
         qint64 bytesWritten = serialPort->write(command);
         if (bytesWritten == -1) {
             qCWarning(log_core_serial) << "Failed to write command to serial port:" << serialPort->errorString();
-            // Log error
-            QFile debugLog("/tmp/serial-command-debug.log");
-            if (debugLog.open(QIODevice::Append | QIODevice::Text)) {
-                QTextStream out(&debugLog);
-                out << "⚠️ WRITE FAILED: " << serialPort->errorString() << "\n";
-                debugLog.close();
+            if (SerialTraceRecorder::isEnabled()) {
+                SerialTraceRecorder::getInstance().record(SerialTraceRecorder::Direction::Tx, command,
+                                                          serialPort->baudRate(), SerialTraceRecorder::Event::WriteFailed);
             }
             return false;
         }
@@ -397,36 +365,24 @@ bool SerialCommandCoordinator::executeCommand(QSerialPort* serialPort, const QBy
         if (bytesWritten != command.size()) {
             qCWarning(log_core_serial) << "Incomplete write: expected" << command.size()
                                          << "bytes, wrote" << bytesWritten;
-            // Log partial write
-            QFile debugLog("/tmp/serial-command-debug.log");
-            if (debugLog.open(QIODevice::Append | QIODevice::Text)) {
-                QTextStream out(&debugLog);
-                out << "⚠️ PARTIAL WRITE: expected " << command.size() << ", wrote " << bytesWritten << "\n";
-                debugLog.close();
+            if (SerialTraceRecorder::isEnabled()) {
+                SerialTraceRecorder::getInstance().record(SerialTraceRecorder::Direction::Tx, command.left(bytesWritten),
+                                                          serialPort->baudRate(), SerialTraceRecorder::Event::PartialWrite);
             }
             return false;
         }
 
-        if (!serialPort->waitForBytesWritten(1000)) {
+        if (waitForWritten && !serialPort->waitForBytesWritten(1000)) {
             qCWarning(log_core_serial) << "Timeout waiting for bytes to be written:" << serialPort->errorString();
-            // Log timeout
-            QFile debugLog("/tmp/serial-command-debug.log");
-            if (debugLog.open(QIODevice::Append | QIODevice::Text)) {
-                QTextStream out(&debugLog);
-                out << "⚠️ WRITE TIMEOUT: " << serialPort->errorString() << "\n";
-                debugLog.close();
+            if (SerialTraceRecorder::isEnabled()) {
+                SerialTraceRecorder::getInstance().record(SerialTraceRecorder::Direction::Tx, command,
+                                                          serialPort->baudRate(), SerialTraceRecorder::Event::WriteTimeout);
             }
             return false;
         }
 
-        // Log success
-        {
-            QFile debugLog("/tmp/serial-command-debug.log");
-            if (debugLog.open(QIODevice::Append | QIODevice::Text)) {
-                QTextStream out(&debugLog);
-                out << "✅ WRITE SUCCESS: " << bytesWritten << " bytes\n";
-                debugLog.close();
-            }
+        if (SerialTraceRecorder::isEnabled()) {
+            SerialTraceRecorder::getInstance().record(SerialTraceRecorder::Direction::Tx, command, serialPort->baudRate());
         }
 
         // Record command sent in statistics
@@ -447,11 +403,55 @@ bool SerialCommandCoordinator::executeCommand(QSerialPort* serialPort, const QBy
     }
 }
 
-void SerialCommandCoordinator::processCommandQueue()
+quint64 SerialCommandCoordinator::addPendingRequest(quint8 commandCode, ResponseCallback callback)
+{
+    PendingRequest request;
+    request.id = m_nextRequestId++;
+    request.responseCode = commandCode | 0x80;
+    request.callback = std::move(callback);
+    m_pendingRequests.append(std::move(request));
+    return m_pendingRequests.last().id;
+}
+
+bool SerialCommandCoordinator::completePendingRequest(const QByteArray &packet)
 {
-    // This method can be extended in the future for advanced queue processing
-    // Currently, commands are processed immediately rather than queued
-    qCDebug(log_core_serial) << "Processing command queue (currently immediate execution)";
+    if (m_pendingRequests.isEmpty() || packet.size() < 4) {
+        return false;
+    }
+
+    const quint8 responseCode = static_cast<quint8>(packet[3]) & 0xBF;
+    for (int i = 0; i < m_pendingRequests.size(); ++i) {
+        if (m_pendingRequests[i].responseCode != responseCode) {
+            continue;
+        }
+        // Remove before calling back: the callback may send the next request
+        ResponseCallback callback = std::move(m_pendingRequests[i].callback);
+        m_pendingRequests.removeAt(i);
+        if (callback) {
+            callback(packet);
+        }
+        return true;
+    }
+    return false;
+}
+
+bool SerialCommandCoordinator::expirePendingRequest(quint64 requestId)
+{
+    for (int i = 0; i < m_pendingRequests.size(); ++i) {
+        if (m_pendingRequests[i].id != requestId) {
+            continue;
+        }
+        ResponseCallback callback = std::move(m_pendingRequests[i].callback);
+        m_pendingRequests.removeAt(i);
+        if (m_statistics) {
+            m_statistics->recordCommandLost();
+        }
+        if (callback) {
+            callback(QByteArray());
+        }
+        return true;
+    }
+    return false;
 }
 
 void SerialCommandCoordinator::setStatisticsModule(SerialStatistics* statistics)
@@ -29,7 +29,9 @@
 #include <QElapsedTimer>
 #include <QSerialPort>
 #include <QDateTime>
+#include <QList>
 #include <atomic>
+#include <functional>
 
 /**
  * @brief Command structure for queued operations
@@ -65,7 +67,8 @@ public:
 
     // Command execution methods
     bool sendAsyncCommand(QSerialPort* serialPort, const QByteArray &data, bool force = false);
-    QByteArray sendSyncCommand(QSerialPort* serialPort, const QByteArray &data, bool force = false, int timeoutMs = 1000);
+    QByteArray sendSyncCommand(QSerialPort* serialPort, const QByteArray &data, bool force = false, int timeoutMs = 1000,
+                               QByteArray* rxCarry = nullptr);
     
     // Command delay management
     void setCommandDelay(int delayMs);
@@ -94,25 +97,57 @@ public:
     void clearCommandQueue();
     int getQueueSize() const;
 
+    // Response correlation for sendRequestAsync(); serial worker thread only
+    using ResponseCallback = std::function<void(const QByteArray &response)>;
+
+    /**
+     * @brief Register a request waiting for the response to commandCode
+     * @return Id for expirePendingRequest()
+     */
+    quint64 addPendingRequest(quint8 commandCode, ResponseCallback callback);
+
+    /**
+     * @brief Hand a received packet to the oldest request waiting for its code
+     * @return true if a request consumed it
+     */
+    bool completePendingRequest(const QByteArray &packet);
+
+    /**
+     * @brief Give up on a request; its callback gets an empty response
+     * @return false if it had already completed
+     */
+    bool expirePendingRequest(quint64 requestId);
+
+    int pendingRequestCount() const { return m_pendingRequests.size(); }
+
 signals:
     void dataSent(const QByteArray &data);
     void dataReceived(const QByteArray &data);
     void commandExecuted(const QByteArray &command, bool success);
     void statisticsUpdated(int sent, int received, double responseRate);
-
-private slots:
-    void processCommandQueue();
+    // A packet read while waiting for a sync response that was not that response
+    void interleavedPacketReceived(const QByteArray &packet);
 
 private:
-    // Response collection for sync commands
-    QByteArray collectSyncResponse(QSerialPort* serialPort, int totalTimeoutMs, int waitStepMs = 100);
+    // Response collection for sync commands. rxCarry, if given, holds unframed bytes
+    // from the main RX path on entry and the unframed remainder on return.
+    QByteArray collectSyncResponse(QSerialPort* serialPort, quint8 commandCode, int totalTimeoutMs, int waitStepMs = 100,
+                                   QByteArray* rxCarry = nullptr);
     
-    // Internal command execution
-    bool executeCommand(QSerialPort* serialPort, const QByteArray &command);
+    // Internal command execution; async commands do not wait for the bytes to leave
+    bool executeCommand(QSerialPort* serialPort, const QByteArray &command, bool waitForWritten);
     
     // Command queue management
     QQueue<SerialCommand> m_commandQueue;
     mutable QMutex m_commandQueueMutex;
+
+    struct PendingRequest {
+        quint64 id;
+        quint8 responseCode;    // cmd | 0x80
+        ResponseCallback callback;
+    };
+    QList<PendingRequest> m_pendingRequests;
+    quint64 m_nextRequestId = 1;
     
     // Timing and delay management
     QElapsedTimer m_lastCommandTime;
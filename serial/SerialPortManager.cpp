@@ -25,6 +25,8 @@
 #include "SerialCommandCoordinator.h"
 #include "SerialStateManager.h"
 #include "SerialStatistics.h"
+#include "SerialTraceRecorder.h"
+#include "SerialTxScheduler.h"
 #include "serial_hotplug_handler.h"
 #include "../ui/globalsetting.h"
 #include "../host/cameramanager.h"
@@ -110,6 +112,26 @@ SerialPortManager::SerialPortManager(QObject *parent) : QObject(parent), serialP
     
     // Connect command coordinator with statistics module
     m_commandCoordinator->setStatisticsModule(m_statistics.get());
+
+    // Prioritised, paced queue for async commands; sends on the worker thread
+    m_txScheduler = std::make_unique<SerialTxScheduler>(nullptr);
+    m_txScheduler->moveToThread(m_serialWorkerThread);
+    m_txScheduler->setSendFunction([this](const QByteArray &data, bool force) {
+        if (serialPort) {
+            m_txScheduler->setBaudrate(serialPort->baudRate());
+        }
+        return writeAsyncCommand(data, force);
+    });
+
+    // Binary TX/RX trace, only when OPENTERFACE_SERIAL_TRACE is set
+    SerialTraceRecorder::getInstance().startFromEnvironment();
+    m_rxFramer.setDiscardHandler([this](const QByteArray& bytes) {
+        if (SerialTraceRecorder::isEnabled()) {
+            SerialTraceRecorder::getInstance().record(SerialTraceRecorder::Direction::Rx, bytes,
+                                                      serialPort ? serialPort->baudRate() : 0,
+                                                      SerialTraceRecorder::Event::Discarded);
+        }
+    });
     
     // Initialize connection watchdog (Phase 3 refactoring)
     m_watchdog = std::make_unique<ConnectionWatchdog>(nullptr);
@@ -139,6 +161,23 @@ SerialPortManager::SerialPortManager(QObject *parent) : QObject(parent), serialP
     // Connect command coordinator signals to SerialPortManager
     connect(m_commandCoordinator.get(), &SerialCommandCoordinator::dataSent, this, &SerialPortManager::dataSent);
     connect(m_commandCoordinator.get(), &SerialCommandCoordinator::dataReceived, this, &SerialPortManager::dataReceived);
+    // Packets that arrived during a sync command (input ACKs, status, answers to
+    // async requests) are handled on the worker thread exactly as readData() would
+    connect(m_commandCoordinator.get(), &SerialCommandCoordinator::interleavedPacketReceived, this, [this](const QByteArray& packet) {
+        if (m_isShuttingDown || !serialPort) {
+            return;
+        }
+        ParsedPacket parsed = SerialProtocol::parsePacket(packet);
+        parsed.rawPacket = packet;
+        bool response = false;
+        {
+            QMutexLocker locker(&m_serialPortMutex);
+            response = handleReceivedPacket(parsed);
+        }
+        if (m_statistics && response) {
+            m_statistics->recordResponsesReceived(1);
+        }
+    }, Qt::QueuedConnection);
     connect(m_commandCoordinator.get(), &SerialCommandCoordinator::commandExecuted, this, [this](const QByteArray& cmd, bool success) {
         QString portName = serialPort ? serialPort->portName() : QString();
         int baud = serialPort ? serialPort->baudRate() : 0;
@@ -400,7 +439,8 @@ void SerialPortManager::observeSerialPortNotification(){
 
     connect(m_serialWorkerThread, &QThread::finished, serialTimer, &QObject::deleteLater);
     connect(m_serialWorkerThread, &QThread::finished, m_serialWorkerThread, &QObject::deleteLater);
-    connect(this, &SerialPortManager::sendCommandAsync, this, &SerialPortManager::sendCommand, Qt::QueuedConnection);
+    // Runs in the emitting thread; sendCommand() only queues into the TX scheduler
+    connect(this, &SerialPortManager::sendCommandAsync, this, &SerialPortManager::sendCommand, Qt::DirectConnection);
 
     m_serialWorkerThread->start();
 }
@@ -756,6 +796,9 @@ void SerialPortManager::onSerialPortConnected(const QString &portName){
     // Create appropriate chip strategy based on detected chip type
     m_chipStrategy = ChipStrategyFactory::createStrategyForPort(portName);
     qCInfo(log_core_serial_config) << "Using chip strategy:" << m_chipStrategy->chipName();
+    if (m_txScheduler) {
+        m_txScheduler->setMinPacketIntervalUs(m_chipStrategy->minPacketIntervalUs());
+    }
     
     if (m_currentChipType == ChipType::CH9329) {
         // Start async initialization for CH9329
@@ -1472,6 +1515,7 @@ bool SerialPortManager::openPort(const QString &portName, int baudRate) {
         // This is critical when device is unplugged and replugged
         qCDebug(log_core_serial_conn) << "Clearing serial port buffers to remove stale data";
         serialPort->clear(QSerialPort::AllDirections);
+        m_rxFramer.clear();
 
         // Log buffer sizes after clearing to confirm the clear worked
         qCDebug(log_core_serial_conn) << "Serial buffer sizes after clear - bytesAvailable:" << serialPort->bytesAvailable()
@@ -1565,6 +1609,10 @@ void SerialPortManager::closePortInternal() {
                 
                 // Clear the read buffer to prevent stale data issues
                 serialPort->clear();
+                m_rxFramer.clear();
+                if (m_txScheduler) {
+                    m_txScheduler->clear();  // Input queued for this connection is stale now
+                }
                 
                 // Close synchronously in worker thread
                 serialPort->close();
@@ -1923,37 +1971,42 @@ void SerialPortManager::readData() {
         return;
     }
     
-    QByteArray data;
+    // Read straight into the RX framer. Everything available is consumed, in
+    // chunks if needed, so a burst is framed rather than discarded.
+    QVector<ParsedPacket> packets;
     try {
-        // Check bytes available before reading to avoid potential buffer issues
         qint64 bytesAvailable = serialPort->bytesAvailable();
         if (bytesAvailable <= 0) {
             return;
         }
-        
-        // FIXED: Improved buffer management to prevent memory overflow
-        const qint64 MAX_READ_SIZE = 4096;  // Reduced to 4KB for better memory control
+
         const qint64 WARN_THRESHOLD = 2048; // Warn if buffer is getting large
-        
         if (bytesAvailable > WARN_THRESHOLD) {
             qCWarning(log_core_serial_rx) << "Large buffer detected:" << bytesAvailable << "bytes - possible data burst or slow processing";
         }
-        
-        if (bytesAvailable > MAX_READ_SIZE) {
-            qCWarning(log_core_serial_rx) << "Limiting read to" << MAX_READ_SIZE << "bytes (" << bytesAvailable << "available)";
-            data = serialPort->read(MAX_READ_SIZE);
-            
-            // Clear excess data to prevent indefinite accumulation
-            if (bytesAvailable > MAX_READ_SIZE * 4) {
-                qCCritical(log_core_serial_rx) << "CRITICAL: Buffer overflow detected, clearing excess data to prevent crash";
-                serialPort->clear();
+
+        while (bytesAvailable > 0) {
+            int space = 0;
+            char* dst = m_rxFramer.writeBuffer(static_cast<int>(qMin<qint64>(bytesAvailable, SerialPacketFramer::DEFAULT_CAPACITY)), &space);
+            const qint64 bytesRead = serialPort->read(dst, space);
+            if (bytesRead <= 0) {
+                break;
             }
-        } else {
-            data = serialPort->readAll();
+            m_rxFramer.commitWrite(static_cast<int>(bytesRead));
+
+            m_rxFramer.drain([&packets](const QByteArray& view, bool checksumOk) {
+                Q_UNUSED(checksumOk)
+                // Parse the view in place; the copy kept for consumers must own its bytes
+                ParsedPacket parsed = SerialProtocol::parsePacket(view);
+                parsed.rawPacket = QByteArray(view.constData(), view.size());
+                packets.append(parsed);
+            });
+            bytesAvailable = serialPort->bytesAvailable();
         }
     } catch (const std::exception& e) {
         qCCritical(log_core_serial_rx) << "Exception occurred while reading serial data:" << e.what();
         // Clear buffer to prevent crash
+        m_rxFramer.clear();
         if (serialPort && serialPort->isOpen()) {
             serialPort->clear();
         }
@@ -1964,6 +2017,7 @@ void SerialPortManager::readData() {
     } catch (...) {
         qCCritical(log_core_serial_rx) << "Unknown exception occurred while reading serial data";
         // Clear buffer to prevent crash
+        m_rxFramer.clear();
         if (serialPort && serialPort->isOpen()) {
             serialPort->clear();
         }
@@ -1972,40 +2026,49 @@ void SerialPortManager::readData() {
         }
         return;
     }
-    
-    if (data.isEmpty()) {
-        qCDebug(log_core_serial_rx) << "Received empty data from serial port";
+
+    if (packets.isEmpty()) {
+        if (m_rxFramer.bufferedBytes() > 0) {
+            qCDebug(log_core_serial_rx) << "Partial packet buffered:" << m_rxFramer.bufferedBytes() << "bytes";
+        }
         checkAndLogAsyncMessageStatistics();
         return;
     }
 
-    // Use protocol layer for packet parsing (Phase 2 refactoring)
-    using namespace SerialProtocolConstants;
-    
-    // Validate minimum packet size
-    if (data.size() < MIN_PACKET_SIZE) {
-        qCWarning(log_core_serial_rx) << "Received packet too small, size:" << data.size() << "Data:" << data.toHex(' ');
-        return;
+    int responses = 0;
+    for (const ParsedPacket& parsed : packets) {
+        if (handleReceivedPacket(parsed)) {
+            ++responses;
+        }
     }
-    
-    // Use protocol layer to extract packet size
-    int packetSize = m_protocol->extractPacketSize(data);
-    if (packetSize < 0 || packetSize > data.size()) {
-        qCWarning(log_core_serial_rx) << "Invalid packet size:" << packetSize 
-                                   << "actual data size:" << data.size()
-                                   << "Data:" << data.toHex(' ');
-        return;
+
+    // One call for the whole read: back-to-back ACKs are distinct responses, not duplicates
+    if (m_statistics && responses > 0) {
+        m_statistics->recordResponsesReceived(responses);
     }
-    
-    QByteArray packet = data.left(packetSize);
-    
-    // Use protocol layer to parse packet
-    ParsedPacket parsed = m_protocol->parsePacket(packet);
+    checkAndLogAsyncMessageStatistics();
+}
+
+/*
+ * Handle one framed packet from the RX stream
+ */
+bool SerialPortManager::handleReceivedPacket(const ParsedPacket& parsed)
+{
+    using namespace SerialProtocolConstants;
+
+    const QByteArray& packet = parsed.rawPacket;
+    // Traced before validation: packets that fail to parse are what a trace is for
+    if (SerialTraceRecorder::isEnabled()) {
+        SerialTraceRecorder::getInstance().record(SerialTraceRecorder::Direction::Rx, packet,
+                                                  serialPort ? serialPort->baudRate() : 0);
+    }
+
     if (!parsed.valid) {
         qCWarning(log_core_serial_rx) << "Failed to parse packet:" << parsed.errorMessage;
-        return;
+        return false;
     }
-    
+
+    bool response = false;
     // Check for error status in certain command ranges
     if (parsed.status != STATUS_SUCCESS && (parsed.commandCode >= 0xC0 && parsed.commandCode <= 0xCF)) {
         dumpError(parsed.status, packet);
@@ -2013,28 +2076,6 @@ void SerialPortManager::readData() {
         qCDebug(log_core_serial_rx).nospace().noquote() << "RX (" << serialPort->portName() << "@"
             << (serialPort ? serialPort->baudRate() : 0) << "bps): " << packet.toHex(' ');
 
-        // RX-DIAG: fprintf to stderr so responses are visible in sse_server.log
-        {
-            uint8_t cmdCode = packet.size() > 3 ? static_cast<uint8_t>(packet[3]) : 0;
-            uint8_t statusByte = packet.size() > 5 ? static_cast<uint8_t>(packet[5]) : 0xFF;
-            const char* cmdName = "UNKNOWN";
-            switch (cmdCode) {
-                case 0x81: cmdName = "GET_INFO_RSP"; break;
-                case 0x82: cmdName = "KB_RSP"; break;
-                case 0x84: cmdName = "MOUSE_ABS_RSP"; break;
-                case 0x85: cmdName = "MOUSE_REL_RSP"; break;
-                case 0x88: cmdName = "GET_PARA_CFG_RSP"; break;
-                case 0x89: cmdName = "SET_PARA_CFG_RSP"; break;
-                case 0x8F: cmdName = "RESET_RSP"; break;
-                case 0x97: cmdName = "USB_SWITCH_RSP"; break;
-                case 0x99: cmdName = "USB_STATUS_RSP"; break;
-                default: break;
-            }
-            fprintf(stderr, "[RX-DIAG] Received: [%s] cmd=0x%02x(%s) status=0x%02x size=%d\n",
-                    packet.toHex(' ').constData(), cmdCode, cmdName, statusByte, packet.size());
-            fflush(stderr);
-        }
-
         // Also explicitly log RX to file during diagnostics
         if (!m_logFilePath.contains("serial_log.txt")) {
             log(QString("RX (%1): %2").arg(serialPort ? serialPort->baudRate() : 0).arg(QString(packet.toHex(' '))));
@@ -2048,20 +2089,26 @@ void SerialPortManager::readData() {
         }
         
         // Process response using protocol layer - signals are already connected
-        m_protocol->processRawData(packet);
+        m_protocol->processResponse(parsed);
+        response = true;
 
-        // Record response for statistics tracking (counts async responses)
-        if (m_statistics) {
-            m_statistics->recordResponseReceived();
-        }
-        
         // Track async message received
         m_asyncMessagesReceived++;
-        checkAndLogAsyncMessageStatistics();
     }
     
     // Callback for processed packet
     emit dataReceived(packet);
+
+    // Complete a sendRequestAsync() waiting for this response code. Deferred so the
+    // callback runs outside readData()'s port lock and may close or reopen the port.
+    if (m_commandCoordinator && m_commandCoordinator->pendingRequestCount() > 0) {
+        QMetaObject::invokeMethod(this, [this, packet]() {
+            if (m_commandCoordinator) {
+                m_commandCoordinator->completePendingRequest(packet);
+            }
+        }, Qt::QueuedConnection);
+    }
+    return response;
 }
 
 /*
@@ -2157,29 +2204,15 @@ bool SerialPortManager::writeData(const QByteArray &data) {
 }
 
 bool SerialPortManager::writeDataInThread(const QByteArray &data) {
-    // DEBUG: Log to file for MCP keyboard diagnostics
-    {
-        QFile debugLog("/tmp/write-data-debug.log");
-        if (debugLog.open(QIODevice::Append | QIODevice::Text)) {
-            QTextStream out(&debugLog);
-            out << "=== writeDataInThread called ===\n";
-            out << "data: " << QString::fromLatin1(data.toHex(' ')) << "\n";
-            debugLog.close();
-        }
-    }
-
     // Enhanced serial port validation with detailed diagnostics
     if (!isSerialPortValid()) {
         qCWarning(log_core_serial_conn) << "Serial port not valid for write operation - state:"
                                    << "serialPort=" << static_cast<void*>(serialPort)
                                    << "isOpen=" << (serialPort ? (serialPort->isOpen() ? "true" : "false") : "N/A")
                                    << "portName=" << (serialPort ? serialPort->portName() : "N/A");
-        // Log failure
-        QFile debugLog("/tmp/write-data-debug.log");
-        if (debugLog.open(QIODevice::Append | QIODevice::Text)) {
-            QTextStream out(&debugLog);
-            out << "⚠️ WRITE FAILED: serial port not valid\n";
-            debugLog.close();
+        if (SerialTraceRecorder::isEnabled()) {
+            SerialTraceRecorder::getInstance().record(SerialTraceRecorder::Direction::Tx, data, 0,
+                                                      SerialTraceRecorder::Event::Dropped);
         }
         ready = false;
         if (m_commandCoordinator) {
@@ -2193,12 +2226,9 @@ bool SerialPortManager::writeDataInThread(const QByteArray &data) {
     // Double-check after acquiring mutex
     if (!serialPort || !serialPort->isOpen()) {
         qCWarning(log_core_serial_conn) << "Serial port became invalid after mutex lock";
-        // Log failure
-        QFile debugLog("/tmp/write-data-debug.log");
-        if (debugLog.open(QIODevice::Append | QIODevice::Text)) {
-            QTextStream out(&debugLog);
-            out << "⚠️ WRITE FAILED: serial port invalid after mutex\n";
-            debugLog.close();
+        if (SerialTraceRecorder::isEnabled()) {
+            SerialTraceRecorder::getInstance().record(SerialTraceRecorder::Direction::Tx, data, 0,
+                                                      SerialTraceRecorder::Event::Dropped);
         }
         ready = false;
         if (m_commandCoordinator) {
@@ -2211,22 +2241,16 @@ bool SerialPortManager::writeDataInThread(const QByteArray &data) {
         qint64 bytesWritten = serialPort->write(data);
         if (bytesWritten == -1) {
             qCWarning(log_core_serial_tx) << "Failed to write data to serial port:" << serialPort->errorString();
-            // Log failure
-            QFile debugLog("/tmp/write-data-debug.log");
-            if (debugLog.open(QIODevice::Append | QIODevice::Text)) {
-                QTextStream out(&debugLog);
-                out << "⚠️ WRITE FAILED: " << serialPort->errorString() << "\n";
-                debugLog.close();
+            if (SerialTraceRecorder::isEnabled()) {
+                SerialTraceRecorder::getInstance().record(SerialTraceRecorder::Direction::Tx, data,
+                                                          serialPort->baudRate(), SerialTraceRecorder::Event::WriteFailed);
             }
             return false;
         } else if (bytesWritten != data.size()) {
             qCWarning(log_core_serial_tx) << "Partial write: expected" << data.size() << "bytes, wrote" << bytesWritten;
-            // Log failure
-            QFile debugLog("/tmp/write-data-debug.log");
-            if (debugLog.open(QIODevice::Append | QIODevice::Text)) {
-                QTextStream out(&debugLog);
-                out << "⚠️ PARTIAL WRITE: expected " << data.size() << ", wrote " << bytesWritten << "\n";
-                debugLog.close();
+            if (SerialTraceRecorder::isEnabled()) {
+                SerialTraceRecorder::getInstance().record(SerialTraceRecorder::Direction::Tx, data.left(bytesWritten),
+                                                          serialPort->baudRate(), SerialTraceRecorder::Event::PartialWrite);
             }
             return false;
         }
@@ -2242,17 +2266,10 @@ bool SerialPortManager::writeDataInThread(const QByteArray &data) {
             log(QString("TX (%1): %2").arg(serialPort->baudRate()).arg(QString(data.toHex(' '))));
         }
 
-        // Log success
-        {
-            QFile debugLog("/tmp/write-data-debug.log");
-            if (debugLog.open(QIODevice::Append | QIODevice::Text)) {
-                QTextStream out(&debugLog);
-                out << "✅ WRITE SUCCESS: " << bytesWritten << " bytes\n";
-                debugLog.close();
-            }
+        if (SerialTraceRecorder::isEnabled()) {
+            SerialTraceRecorder::getInstance().record(SerialTraceRecorder::Direction::Tx, data, serialPort->baudRate());
         }
 
-
         return true;
         
     } catch (...) {
@@ -2266,12 +2283,26 @@ bool SerialPortManager::writeDataInThread(const QByteArray &data) {
 }
 
 /*
- * Send the async command to the serial port
+ * Queue the async command; SerialTxScheduler spaces it from every other command
  */
 bool SerialPortManager::sendAsyncCommand(const QByteArray &data, bool force) {
     if (m_isShuttingDown || !m_commandCoordinator) {
         return false;
     }
+    if (!m_txScheduler) {
+        return writeAsyncCommand(data, force);
+    }
+    m_txScheduler->enqueue(data, force);
+    return true;
+}
+
+/*
+ * Write the async command to the serial port now
+ */
+bool SerialPortManager::writeAsyncCommand(const QByteArray &data, bool force) {
+    if (m_isShuttingDown || !m_commandCoordinator) {
+        return false;
+    }
     
     // Track async message sent
     m_asyncMessagesSent++;
@@ -2284,6 +2315,38 @@ bool SerialPortManager::sendAsyncCommand(const QByteArray &data, bool force) {
     return m_commandCoordinator->sendAsyncCommand(serialPort, data, force);
 }
 
+/*
+ * Send a command and deliver its response through a callback on the worker thread
+ */
+void SerialPortManager::sendRequestAsync(const QByteArray &data, ResponseCallback callback, int timeoutMs, bool force) {
+    if (QThread::currentThread() != m_serialWorkerThread) {
+        QMetaObject::invokeMethod(this, [this, data, callback, timeoutMs, force]() {
+            sendRequestAsync(data, callback, timeoutMs, force);
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    if (m_isShuttingDown || !m_commandCoordinator || data.size() < 4) {
+        if (callback) {
+            callback(QByteArray());
+        }
+        return;
+    }
+
+    // Register first: the response is read on this thread, so it cannot overtake us
+    const quint64 requestId = m_commandCoordinator->addPendingRequest(static_cast<quint8>(data[3]), callback);
+    if (!sendAsyncCommand(data, force)) {
+        m_commandCoordinator->expirePendingRequest(requestId);
+        return;
+    }
+
+    QTimer::singleShot(timeoutMs, this, [this, requestId, timeoutMs]() {
+        if (m_commandCoordinator && m_commandCoordinator->expirePendingRequest(requestId)) {
+            qCDebug(log_core_serial_cmd) << "Request" << requestId << "got no response within" << timeoutMs << "ms";
+        }
+    });
+}
+
  /*
  * Send the sync command to the serial port
  */
@@ -2295,8 +2358,23 @@ QByteArray SerialPortManager::sendSyncCommand(const QByteArray &data, bool force
     // Update command coordinator ready state with our current ready state
     m_commandCoordinator->setReady(ready.load());
     
+    // The sync read consumes the port directly; hand it any partial packet the RX
+    // framer holds and take back whatever partial packet follows the response
+    QByteArray rxCarry;
+    {
+        QMutexLocker locker(&m_serialPortMutex);
+        rxCarry = m_rxFramer.takeBuffered();
+    }
+
     // Delegate to command coordinator
-    return m_commandCoordinator->sendSyncCommand(serialPort, data, force);
+    QByteArray response = m_commandCoordinator->sendSyncCommand(serialPort, data, force, 1000, &rxCarry);
+
+    if (!rxCarry.isEmpty()) {
+        QMutexLocker locker(&m_serialPortMutex);
+        m_rxFramer.append(rxCarry);
+        qCDebug(log_core_serial_rx) << "Partial packet after sync response returned to RX framer:" << rxCarry.size() << "bytes";
+    }
+    return response;
 }
 
 /*
@@ -2540,8 +2618,10 @@ void SerialPortManager::changeUSBDescriptor() {
 void SerialPortManager::sendCommand(const QByteArray &command, bool waitForAck) {
     Q_UNUSED(waitForAck);
     // qCDebug(log_core_serial_tx)  << "sendCommand:" << command.toHex(' ');
-    sendAsyncCommand(command, false);
-
+    if (m_isShuttingDown || !m_txScheduler) {
+        return;
+    }
+    m_txScheduler->enqueue(command, false);
 }
 
 bool SerialPortManager::setBaudRate(int baudRate) {
@@ -2807,6 +2887,9 @@ void SerialPortManager::setCommandDelay(int delayMs) {
     if (m_commandCoordinator) {
         m_commandCoordinator->setCommandDelay(delayMs);
     }
+    if (m_txScheduler) {
+        m_txScheduler->setCommandDelayMs(delayMs);
+    }
     
     // Keep local setting for backward compatibility
     m_commandDelayMs = delayMs;
@@ -3403,6 +3486,27 @@ void SerialPortManager::checkAndLogAsyncMessageStatistics()
                                    << "Received/sec:" << QString::number(receivedRate, 'f', 2)
                                    << "Total sent:" << m_asyncMessagesSent
                                    << "Total received:" << m_asyncMessagesReceived;
+
+            const SerialTxScheduler::Stats tx = m_txScheduler->takeStats();
+            if (tx.sent > 0 || tx.backlog > 0) {
+                qCInfo(log_core_serial_tx) << "TX scheduler - packets/sec:" << QString::number(tx.packetsPerSecond, 'f', 1)
+                                           << "sent:" << tx.sent
+                                           << "failed:" << tx.failed
+                                           << "coalesced moves:" << tx.coalesced
+                                           << "backlog now/max:" << tx.backlog << tx.maxBacklog
+                                           << "residency avg/max ms:"
+                                           << QString::number(tx.sent > 0 ? tx.totalResidencyUs / 1000.0 / tx.sent : 0.0, 'f', 2)
+                                           << QString::number(tx.maxResidencyUs / 1000.0, 'f', 2);
+            }
+
+            const SerialPacketFramer::Counters rx = m_rxFramer.counters();
+            if (rx.resyncs > 0 || rx.checksumFailures > 0 || rx.overflows > 0) {
+                qCInfo(log_core_serial_rx) << "RX framer - packets:" << rx.packets
+                                           << "resyncs:" << rx.resyncs
+                                           << "discarded bytes:" << rx.discardedBytes
+                                           << "checksum failures:" << rx.checksumFailures
+                                           << "overflow bytes:" << rx.overflows;
+            }
             
             // ===== IMBALANCE DETECTION LOGIC =====
             // Only check imbalance if we actually sent messages (avoid division issues)
@@ -3502,8 +3606,13 @@ void SerialPortManager::continueInitializeWithBaudrates(const QString &portName,
 }
 
 void SerialPortManager::validatePortAfterSettle(const QString &portName, qint32 baud, int cycle, int cycles) {
-    // Send a synchronous GET_INFO and validate response to ensure the device is actually talking
-    QByteArray resp = sendSyncCommand(CMD_GET_INFO, true);
+    // Send GET_INFO and validate the response to ensure the device is actually talking
+    sendRequestAsync(CMD_GET_INFO, [this, portName, baud, cycle, cycles](const QByteArray &resp) {
+        handlePortValidationResponse(resp, portName, baud, cycle, cycles);
+    });
+}
+
+void SerialPortManager::handlePortValidationResponse(const QByteArray &resp, const QString &portName, qint32 baud, int cycle, int cycles) {
     bool valid = false;
     if (!resp.isEmpty() && resp.size() >= 4) {
         unsigned char b0 = static_cast<unsigned char>(resp[0]);
@@ -3561,6 +3670,7 @@ void SerialPortManager::continueOpenPortRetry(const QString &portName, qint32 ba
         // Clear any stale data in the serial port buffers
         qCDebug(log_core_serial_conn) << "Clearing serial port buffers to remove stale data";
         serialPort->clear();
+        m_rxFramer.clear();
         return; // Success - exit
     }
 
@@ -3631,8 +3741,17 @@ void SerialPortManager::validateAsyncPortRetry(const QString &portName, int baud
         return;
     }
     
-    // Send a synchronous GET_INFO and validate response
-    QByteArray resp = sendSyncCommand(CMD_GET_INFO, true);
+    // Send GET_INFO and validate the response
+    sendRequestAsync(CMD_GET_INFO, [this, portName, baud, baudOrder, baudIndex, cycle, maxCycles](const QByteArray &resp) {
+        handleAsyncPortRetryResponse(resp, portName, baud, baudOrder, baudIndex, cycle, maxCycles);
+    });
+}
+
+void SerialPortManager::handleAsyncPortRetryResponse(const QByteArray &resp, const QString &portName, int baud, const QList<int> &baudOrder, int baudIndex, int cycle, int maxCycles) {
+    if (m_isShuttingDown) {
+        return;
+    }
+
     bool valid = false;
     if (!resp.isEmpty() && resp.size() >= 4) {
         unsigned char b0 = static_cast<unsigned char>(resp[0]);
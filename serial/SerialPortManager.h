@@ -36,12 +36,14 @@
 #include <QWaitCondition>
 #include <QEventLoop>
 #include <atomic>
+#include <functional>
 #include <memory>
 
 #include "ch9329.h"
 #include "chipstrategy/IChipStrategy.h"
 #include "chipstrategy/ChipStrategyFactory.h"
 #include "protocol/SerialProtocol.h"
+#include "protocol/SerialPacketFramer.h"
 #include "watchdog/ConnectionWatchdog.h"
 #include "FactoryResetManager.h"
 #include "../ui/advance/diagnostics/LogWriter.h"
@@ -51,6 +53,7 @@ Q_DECLARE_LOGGING_CATEGORY(log_core_serial)
 // Forward declarations
 class DeviceInfo;
 class SerialCommandCoordinator;
+class SerialTxScheduler;
 class SerialStateManager;
 class SerialStatistics;
 class SerialHotplugHandler;
@@ -103,9 +106,29 @@ public:
 
     Q_INVOKABLE bool writeData(const QByteArray &data);
     bool writeDataInThread(const QByteArray &data);
+    /**
+     * @brief Queue a command on the paced TX scheduler (thread-safe, never blocks)
+     * @return false if the command could not be queued
+     */
     bool sendAsyncCommand(const QByteArray &data, bool force);
     bool sendResetCommand();
     QByteArray sendSyncCommand(const QByteArray &data, bool force);
+
+    /**
+     * @brief Called with the response packet, or an empty array on timeout or send failure
+     */
+    using ResponseCallback = std::function<void(const QByteArray &response)>;
+
+    /**
+     * @brief Send a command and receive its response without blocking
+     *
+     * The response is matched by code (cmd | 0x80, or the cmd | 0xC0 error form)
+     * as the RX framer delivers it, so mouse/keyboard ACKs and other requests can
+     * interleave freely and nothing is flushed. Safe to call from any thread.
+     *
+     * @param callback Runs on the serial worker thread
+     */
+    void sendRequestAsync(const QByteArray &data, ResponseCallback callback, int timeoutMs = 1000, bool force = true);
     
     // Lock key toggle commands (high-level interface)
     bool toggleNumLock();        // Send NumLock toggle command to device
@@ -253,6 +276,8 @@ private slots:
     bool completeSwitchSerialPort(const DeviceInfo& selectedDevice, const QString& previousPortPath, const QString& previousPortChain, const QString& portChain);
     void startAsyncPortRetries(const QString &portName, const QList<int> &baudOrder, int baudIndex, int cycle, int maxCycles);
     void validateAsyncPortRetry(const QString &portName, int baud, const QList<int> &baudOrder, int baudIndex, int cycle, int maxCycles);
+    void handlePortValidationResponse(const QByteArray &resp, const QString &portName, qint32 baud, int cycle, int cycles);
+    void handleAsyncPortRetryResponse(const QByteArray &resp, const QString &portName, int baud, const QList<int> &baudOrder, int baudIndex, int cycle, int maxCycles);
 
     // /*
     //  * Check if the USB switch status
@@ -273,6 +298,8 @@ private:
     QSerialPort *serialPort;
 
     void sendCommand(const QByteArray &command, bool waitForAck);
+    // Writes one command immediately; only SerialTxScheduler calls this
+    bool writeAsyncCommand(const QByteArray &data, bool force);
     
     // Refactored helper methods for onSerialPortConnected
     int determineBaudrate() const;
@@ -330,6 +357,10 @@ private:
     
     // Protocol layer for packet building/parsing (Phase 2 refactoring)
     std::unique_ptr<SerialProtocol> m_protocol;
+
+    // Persistent RX buffer: frames every packet per read and carries partial tails over
+    SerialPacketFramer m_rxFramer;
+    bool handleReceivedPacket(const ParsedPacket& parsed);
     
     // Command coordinator for command handling (Phase 4 refactoring)
     std::unique_ptr<SerialCommandCoordinator> m_commandCoordinator;
@@ -342,6 +373,9 @@ private:
     
     // Connection watchdog for monitoring and recovery (Phase 3 refactoring)
     std::unique_ptr<ConnectionWatchdog> m_watchdog;
+
+    // Prioritised, paced transmit queue for sendCommandAsync()
+    std::unique_ptr<SerialTxScheduler> m_txScheduler;
     
     // Enhanced stability members (some delegated to ConnectionWatchdog)
     std::atomic<bool> m_isShuttingDown = false;
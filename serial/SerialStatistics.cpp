@@ -145,6 +145,18 @@ void SerialStatistics::recordResponseReceived()
     qCDebug(log_serial_statistics) << "Response received recorded, total:" << m_data.responsesReceived;
 }
 
+void SerialStatistics::recordResponsesReceived(int count)
+{
+    if (!m_isTrackingEnabled || count <= 0) return;
+
+    QMutexLocker locker(&m_statisticsMutex);
+    // No duplicate suppression: the framer hands out each packet exactly once
+    m_data.responsesReceived += count;
+    m_data.consecutiveErrors = 0;
+    m_lastResponseTimer.start();
+    qCDebug(log_serial_statistics) << count << "responses received recorded, total:" << m_data.responsesReceived;
+}
+
 void SerialStatistics::recordCommandLost()
 {
     if (!m_isTrackingEnabled) return;
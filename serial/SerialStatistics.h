@@ -117,6 +117,7 @@ public:
     // Command tracking
     void recordCommandSent();
     void recordResponseReceived();
+    void recordResponsesReceived(int count);  // Distinct packets framed from one read
     void recordCommandLost();
     void recordConsecutiveError();
     void recordConnectionRetry();
@@ -0,0 +1,302 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#include "SerialTraceRecorder.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QLoggingCategory>
+#include <QMutexLocker>
+#include <QThread>
+#include <cstring>
+
+Q_DECLARE_LOGGING_CATEGORY(log_core_serial)
+
+namespace {
+const char TRACE_MAGIC[8] = {'O', 'P', 'F', 'S', 'T', 'R', 'C', '1'};
+const quint16 TRACE_VERSION = 1;
+const int RECORD_HEADER_SIZE = 8 + 4 + 1 + 1 + 2 + 2;
+}
+
+std::atomic<bool> SerialTraceRecorder::s_enabled{false};
+
+SerialTraceRecorder& SerialTraceRecorder::getInstance()
+{
+    static SerialTraceRecorder instance;
+    return instance;
+}
+
+SerialTraceRecorder::SerialTraceRecorder()
+{
+    static_assert((RING_CAPACITY & (RING_CAPACITY - 1)) == 0, "RING_CAPACITY must be a power of two");
+}
+
+SerialTraceRecorder::~SerialTraceRecorder()
+{
+    stop();
+}
+
+bool SerialTraceRecorder::start(const QString& filePath)
+{
+    QMutexLocker locker(&m_controlMutex);
+    if (m_writerThread) {
+        qCDebug(log_core_serial) << "Serial trace already running:" << m_file.fileName();
+        return m_file.fileName() == filePath;
+    }
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(log_core_serial) << "Cannot open serial trace file" << filePath << ":" << m_file.errorString();
+        return false;
+    }
+
+    if (!m_ring) {
+        m_ring.reset(new Slot[RING_CAPACITY]);
+        for (int i = 0; i < RING_CAPACITY; ++i) {
+            m_ring[i].sequence.store(static_cast<quint64>(i), std::memory_order_relaxed);
+        }
+        m_enqueuePos.store(0, std::memory_order_relaxed);
+        m_dequeuePos = 0;
+    }
+    m_reportedOverruns = m_overruns.load(std::memory_order_relaxed);
+    m_sessionOverrunBase = m_reportedOverruns;
+
+    QDataStream out(&m_file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.writeRawData(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    out << TRACE_VERSION << quint16(0) << QDateTime::currentMSecsSinceEpoch();
+
+    m_clock.start();
+    m_writerRunning.store(true);
+    m_writerThread = QThread::create([this]() { writerLoop(); });
+    m_writerThread->setObjectName("SerialTraceWriter");
+    m_writerThread->start(QThread::LowPriority);
+    s_enabled.store(true, std::memory_order_release);
+
+    qCInfo(log_core_serial) << "Serial trace started:" << filePath;
+    return true;
+}
+
+void SerialTraceRecorder::stop()
+{
+    QMutexLocker locker(&m_controlMutex);
+    if (!m_writerThread) {
+        return;
+    }
+
+    s_enabled.store(false, std::memory_order_release);
+    m_writerRunning.store(false);
+    {
+        QMutexLocker wakeLocker(&m_wakeMutex);
+        m_wakeCondition.wakeAll();
+    }
+    m_writerThread->wait();
+    delete m_writerThread;
+    m_writerThread = nullptr;
+
+    drainRing();
+    const qint64 size = m_file.size();
+    m_file.close();
+    qCInfo(log_core_serial) << "Serial trace stopped:" << m_file.fileName() << size << "bytes,"
+                            << (m_overruns.load() - m_sessionOverrunBase) << "records lost";
+}
+
+void SerialTraceRecorder::startFromEnvironment()
+{
+    const QString path = qEnvironmentVariable("OPENTERFACE_SERIAL_TRACE");
+    if (!path.isEmpty()) {
+        start(path);
+    }
+}
+
+QString SerialTraceRecorder::filePath() const
+{
+    QMutexLocker locker(&m_controlMutex);
+    return m_writerThread ? m_file.fileName() : QString();
+}
+
+void SerialTraceRecorder::record(Direction direction, const QByteArray& data, int baudrate, Event event)
+{
+    Slot* ring = m_ring.get();
+    if (!ring) {
+        return;
+    }
+
+    // Bounded multi-producer ring: a slot is free for position `pos` once its
+    // sequence equals pos, and published to the writer by setting it to pos + 1.
+    quint64 pos = m_enqueuePos.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    for (;;) {
+        slot = &ring[pos & (RING_CAPACITY - 1)];
+        const quint64 sequence = slot->sequence.load(std::memory_order_acquire);
+        const qint64 diff = static_cast<qint64>(sequence - pos);
+        if (diff == 0) {
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            m_overruns.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    const int stored = qMin(static_cast<int>(data.size()), MAX_RECORD_BYTES);
+    slot->timestampUs = m_clock.nsecsElapsed() / 1000;
+    slot->baudrate = static_cast<quint32>(qMax(baudrate, 0));
+    slot->direction = static_cast<quint8>(direction);
+    slot->event = static_cast<quint8>(event);
+    slot->length = static_cast<quint16>(qMin(static_cast<int>(data.size()), 0xFFFF));
+    slot->stored = static_cast<quint16>(stored);
+    if (stored > 0) {
+        std::memcpy(slot->data, data.constData(), static_cast<size_t>(stored));
+    }
+    slot->sequence.store(pos + 1, std::memory_order_release);
+}
+
+void SerialTraceRecorder::writerLoop()
+{
+    while (m_writerRunning.load()) {
+        {
+            QMutexLocker locker(&m_wakeMutex);
+            if (m_writerRunning.load()) {
+                m_wakeCondition.wait(&m_wakeMutex, FLUSH_INTERVAL_MS);
+            }
+        }
+        drainRing();
+        m_file.flush();
+    }
+}
+
+void SerialTraceRecorder::drainRing()
+{
+    Slot* ring = m_ring.get();
+    if (!ring || !m_file.isOpen()) {
+        return;
+    }
+
+    for (;;) {
+        Slot& slot = ring[m_dequeuePos & (RING_CAPACITY - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1) {
+            break;  // Empty, or the producer has not finished filling this slot
+        }
+        writeRecord(slot.timestampUs, slot.baudrate, slot.direction, slot.event,
+                    slot.length, slot.data, slot.stored);
+        slot.sequence.store(m_dequeuePos + RING_CAPACITY, std::memory_order_release);
+        ++m_dequeuePos;
+    }
+
+    const quint64 overruns = m_overruns.load(std::memory_order_relaxed);
+    if (overruns != m_reportedOverruns) {
+        const quint64 lost = overruns - m_reportedOverruns;
+        m_reportedOverruns = overruns;
+        writeRecord(m_clock.nsecsElapsed() / 1000, 0, 0, static_cast<quint8>(Event::Overrun),
+                    static_cast<quint16>(qMin<quint64>(lost, 0xFFFF)), nullptr, 0);
+    }
+}
+
+void SerialTraceRecorder::writeRecord(qint64 timestampUs, quint32 baudrate, quint8 direction, quint8 event,
+                                      quint16 length, const char* data, quint16 stored)
+{
+    char buffer[RECORD_HEADER_SIZE + MAX_RECORD_BYTES];
+    // Fixed little-endian layout, packed by hand to keep the writer allocation-free
+    char* p = buffer;
+    for (int i = 0; i < 8; ++i) {
+        *p++ = static_cast<char>((static_cast<quint64>(timestampUs) >> (8 * i)) & 0xFF);
+    }
+    for (int i = 0; i < 4; ++i) {
+        *p++ = static_cast<char>((baudrate >> (8 * i)) & 0xFF);
+    }
+    *p++ = static_cast<char>(direction);
+    *p++ = static_cast<char>(event);
+    *p++ = static_cast<char>(length & 0xFF);
+    *p++ = static_cast<char>(length >> 8);
+    *p++ = static_cast<char>(stored & 0xFF);
+    *p++ = static_cast<char>(stored >> 8);
+    if (stored > 0) {
+        std::memcpy(p, data, stored);
+    }
+    m_file.write(buffer, RECORD_HEADER_SIZE + stored);
+}
+
+QList<SerialTraceRecorder::Record> SerialTraceRecorder::decode(const QString& filePath, qint64* startMs, QString* errorMessage)
+{
+    QList<Record> records;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorMessage) *errorMessage = file.errorString();
+        return records;
+    }
+
+    QDataStream in(&file);
+    in.setByteOrder(QDataStream::LittleEndian);
+
+    char magic[sizeof(TRACE_MAGIC)];
+    quint16 version = 0;
+    quint16 reserved = 0;
+    qint64 start = 0;
+    if (in.readRawData(magic, sizeof(magic)) != sizeof(magic)
+        || std::memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0) {
+        if (errorMessage) *errorMessage = QStringLiteral("Not a serial trace file");
+        return records;
+    }
+    in >> version >> reserved >> start;
+    if (version != TRACE_VERSION) {
+        if (errorMessage) *errorMessage = QStringLiteral("Unsupported trace version %1").arg(version);
+        return records;
+    }
+    if (startMs) *startMs = start;
+
+    while (!in.atEnd()) {
+        Record record;
+        quint8 direction = 0;
+        quint8 event = 0;
+        quint16 stored = 0;
+        in >> record.timestampUs >> record.baudrate >> direction >> event >> record.length >> stored;
+        if (in.status() != QDataStream::Ok || stored > MAX_RECORD_BYTES) {
+            break;  // Truncated tail of a trace that was still being written
+        }
+        record.direction = static_cast<Direction>(direction);
+        record.event = static_cast<Event>(event);
+        record.data.resize(stored);
+        if (stored > 0 && in.readRawData(record.data.data(), stored) != stored) {
+            break;
+        }
+        records.append(record);
+    }
+    return records;
+}
+
+QString SerialTraceRecorder::eventName(Event event)
+{
+    switch (event) {
+        case Event::Packet: return QString();
+        case Event::WriteFailed: return QStringLiteral("WRITE FAILED");
+        case Event::PartialWrite: return QStringLiteral("PARTIAL WRITE");
+        case Event::WriteTimeout: return QStringLiteral("WRITE TIMEOUT");
+        case Event::Dropped: return QStringLiteral("DROPPED");
+        case Event::Overrun: return QStringLiteral("TRACE OVERRUN");
+        case Event::Discarded: return QStringLiteral("DISCARDED");
+    }
+    return QStringLiteral("EVENT %1").arg(static_cast<int>(event));
+}
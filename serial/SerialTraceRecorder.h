@@ -0,0 +1,165 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#ifndef SERIALTRACERECORDER_H
+#define SERIALTRACERECORDER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+#include <QtGlobal>
+#include <atomic>
+#include <memory>
+
+class QThread;
+
+/**
+ * @brief Binary trace of every packet crossing the serial port
+ *
+ * Producers (the serial worker thread, the command coordinator) push fixed-size
+ * records into a lock-free ring; a writer thread drains the ring into a compact
+ * binary file a few times per second. Call sites guard record() with
+ * isEnabled(), so with tracing off the hot path costs one relaxed load and a
+ * branch. Set OPENTERFACE_SERIAL_TRACE=<path> to trace from startup, or use the
+ * Serial Port Debug dialog.
+ *
+ * File layout (little endian):
+ *   header:  "OPFSTRC1" | quint16 version | quint16 reserved | qint64 start (ms since epoch)
+ *   record:  qint64 time (us since start) | quint32 baudrate | quint8 direction |
+ *            quint8 event | quint16 length | quint16 stored | stored bytes
+ * Packets longer than MAX_RECORD_BYTES are truncated; `length` keeps the real size.
+ */
+class SerialTraceRecorder
+{
+public:
+    enum class Direction : quint8 {
+        Tx = 0,
+        Rx = 1
+    };
+
+    enum class Event : quint8 {
+        Packet = 0,         // Bytes went out / came in
+        WriteFailed = 1,    // write() returned -1
+        PartialWrite = 2,   // Only the bytes that made it out are recorded
+        WriteTimeout = 3,   // waitForBytesWritten() gave up
+        Dropped = 4,        // Command refused before reaching the port
+        Overrun = 5,        // Ring was full; `length` records were lost
+        Discarded = 6       // RX bytes skipped while resynchronising to a packet header
+    };
+
+    struct Record {
+        qint64 timestampUs = 0;
+        quint32 baudrate = 0;
+        Direction direction = Direction::Tx;
+        Event event = Event::Packet;
+        quint16 length = 0;
+        QByteArray data;
+    };
+
+    static constexpr int RING_CAPACITY = 4096;     // Power of two
+    static constexpr int MAX_RECORD_BYTES = 64;
+    static constexpr int FLUSH_INTERVAL_MS = 200;
+
+    static SerialTraceRecorder& getInstance();
+
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Start tracing into a new file (an existing file is overwritten)
+     * @return false if the file could not be opened
+     */
+    bool start(const QString& filePath);
+
+    /**
+     * @brief Stop tracing, write out everything still in the ring and close the file
+     */
+    void stop();
+
+    /**
+     * @brief Start tracing if OPENTERFACE_SERIAL_TRACE names a file
+     */
+    void startFromEnvironment();
+
+    QString filePath() const;
+
+    /**
+     * @brief Queue one record; never blocks. Guard calls with isEnabled().
+     */
+    void record(Direction direction, const QByteArray& data, int baudrate, Event event = Event::Packet);
+
+    /**
+     * @brief Read a trace file back
+     * @param startMs Receives the wall-clock start time stored in the header
+     * @param errorMessage Receives a reason if the file is not a trace
+     */
+    static QList<Record> decode(const QString& filePath, qint64* startMs = nullptr, QString* errorMessage = nullptr);
+
+    static QString eventName(Event event);
+
+    SerialTraceRecorder(const SerialTraceRecorder&) = delete;
+    SerialTraceRecorder& operator=(const SerialTraceRecorder&) = delete;
+
+private:
+    SerialTraceRecorder();
+    ~SerialTraceRecorder();
+
+    struct Slot {
+        std::atomic<quint64> sequence{0};
+        qint64 timestampUs = 0;
+        quint32 baudrate = 0;
+        quint8 direction = 0;
+        quint8 event = 0;
+        quint16 length = 0;
+        quint16 stored = 0;
+        char data[MAX_RECORD_BYTES];
+    };
+
+    void writerLoop();
+    // Write every committed record to m_file; writer thread, or stop() after it has joined
+    void drainRing();
+    void writeRecord(qint64 timestampUs, quint32 baudrate, quint8 direction, quint8 event,
+                     quint16 length, const char* data, quint16 stored);
+
+    static std::atomic<bool> s_enabled;
+
+    // Allocated on the first start() and kept, so a producer racing stop() never touches freed memory
+    std::unique_ptr<Slot[]> m_ring;
+    std::atomic<quint64> m_enqueuePos{0};
+    quint64 m_dequeuePos = 0;
+    std::atomic<quint64> m_overruns{0};
+    quint64 m_reportedOverruns = 0;     // Already written out as an Overrun record
+    quint64 m_sessionOverrunBase = 0;
+
+    QElapsedTimer m_clock;
+    QFile m_file;
+    QThread* m_writerThread = nullptr;
+    std::atomic<bool> m_writerRunning{false};
+    mutable QMutex m_controlMutex;      // start()/stop()/filePath()
+    QMutex m_wakeMutex;
+    QWaitCondition m_wakeCondition;
+};
+
+#endif // SERIALTRACERECORDER_H
@@ -0,0 +1,237 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#include "SerialTxScheduler.h"
+
+#include <QLoggingCategory>
+#include <QTimer>
+
+Q_DECLARE_LOGGING_CATEGORY(log_core_serial)
+
+SerialTxScheduler::SerialTxScheduler(QObject *parent)
+    : QObject(parent)
+    , m_deadlineTimer(new QTimer(this))
+{
+    m_deadlineTimer->setSingleShot(true);
+    m_deadlineTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_deadlineTimer, &QTimer::timeout, this, &SerialTxScheduler::pump);
+    m_clock.start();
+}
+
+SerialTxScheduler::~SerialTxScheduler() = default;
+
+void SerialTxScheduler::setSendFunction(SendFunction send)
+{
+    m_send = std::move(send);
+}
+
+void SerialTxScheduler::setMinPacketIntervalUs(int intervalUs)
+{
+    m_minPacketIntervalUs = qMax(0, intervalUs);
+    qCDebug(log_core_serial) << "TX minimum packet interval set to" << qMax(0, intervalUs) << "us";
+}
+
+void SerialTxScheduler::setCommandDelayMs(int delayMs)
+{
+    m_commandDelayMs = qMax(0, delayMs);
+}
+
+void SerialTxScheduler::setBaudrate(int baudrate)
+{
+    m_baudrate = qMax(0, baudrate);
+}
+
+SerialTxScheduler::Priority SerialTxScheduler::classify(const QByteArray &data)
+{
+    if (data.size() < 4) {
+        return Priority::Control;
+    }
+    switch (static_cast<quint8>(data[3])) {
+        case 0x02:  // General keyboard report
+        case 0x03:  // Media/ACPI keys
+        case 0x04:  // Absolute mouse
+        case 0x05:  // Relative mouse
+            return Priority::Input;
+        default:
+            return Priority::Control;
+    }
+}
+
+bool SerialTxScheduler::isCoalescableMouseMove(const QByteArray &data)
+{
+    // 57 AB 00 04 07 02 | buttons | x lo hi | y lo hi | wheel  (checksum not yet appended)
+    return data.size() == 12
+        && static_cast<quint8>(data[0]) == 0x57 && static_cast<quint8>(data[1]) == 0xAB
+        && static_cast<quint8>(data[3]) == 0x04 && static_cast<quint8>(data[5]) == 0x02
+        && data[11] == 0;
+}
+
+int SerialTxScheduler::mouseButtons(const QByteArray &data)
+{
+    // Absolute (04) and relative (05) reports both carry the button byte at offset 6
+    if (data.size() < 7 || static_cast<quint8>(data[0]) != 0x57 || static_cast<quint8>(data[1]) != 0xAB) {
+        return -1;
+    }
+    const quint8 cmd = static_cast<quint8>(data[3]);
+    if (cmd != 0x04 && cmd != 0x05) {
+        return -1;
+    }
+    return static_cast<quint8>(data[6]);
+}
+
+void SerialTxScheduler::enqueue(const QByteArray &data, bool force)
+{
+    const Priority priority = classify(data);
+    const int buttons = mouseButtons(data);
+    {
+        QMutexLocker locker(&m_mutex);
+        QQueue<Entry> &queue = m_queues[static_cast<int>(priority)];
+
+        // Compare against the previous mouse report, queued or already sent, so the
+        // packet that presses or releases a button always reaches the target
+        bool buttonTransition = false;
+        if (buttons >= 0) {
+            buttonTransition = (buttons != m_lastQueuedButtons);
+            m_lastQueuedButtons = buttons;
+        }
+
+        if (priority == Priority::Input && !queue.isEmpty() && !buttonTransition
+            && isCoalescableMouseMove(data)) {
+            Entry &tail = queue.last();
+            if (isCoalescableMouseMove(tail.data) && !tail.buttonTransition
+                && tail.data[6] == data[6]) {
+                // Latest wins; keep the slot's queue time so residency covers the stale move too
+                tail.data = data;
+                ++m_stats.coalesced;
+                return;
+            }
+        }
+
+        Entry entry;
+        entry.data = data;
+        entry.force = force;
+        entry.queuedUs = nowUs();
+        entry.buttonTransition = buttonTransition;
+        queue.enqueue(entry);
+
+        int depth = 0;
+        for (const auto &q : m_queues) {
+            depth += q.size();
+        }
+        m_stats.maxBacklog = qMax(m_stats.maxBacklog, depth);
+
+        if (m_pumpScheduled) {
+            return;
+        }
+        m_pumpScheduled = true;
+    }
+    QMetaObject::invokeMethod(this, &SerialTxScheduler::pump, Qt::QueuedConnection);
+}
+
+void SerialTxScheduler::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    for (auto &queue : m_queues) {
+        queue.clear();
+    }
+    m_lastQueuedButtons = -1;
+}
+
+int SerialTxScheduler::backlog() const
+{
+    QMutexLocker locker(&m_mutex);
+    int depth = 0;
+    for (const auto &queue : m_queues) {
+        depth += queue.size();
+    }
+    return depth;
+}
+
+SerialTxScheduler::Stats SerialTxScheduler::takeStats()
+{
+    QMutexLocker locker(&m_mutex);
+    const qint64 now = nowUs();
+    Stats stats = m_stats;
+    for (const auto &queue : m_queues) {
+        stats.backlog += queue.size();
+    }
+    if (now > m_statsStartUs) {
+        stats.packetsPerSecond = stats.sent * 1000000.0 / (now - m_statsStartUs);
+    }
+    m_stats = Stats();
+    m_statsStartUs = now;
+    return stats;
+}
+
+qint64 SerialTxScheduler::spacingUs(int packetBytes) const
+{
+    qint64 spacing = qMax<qint64>(m_minPacketIntervalUs.load(), m_commandDelayMs.load() * 1000LL);
+    const int baudrate = m_baudrate.load();
+    if (baudrate > 0) {
+        // 8N1: ten bit times per byte
+        spacing = qMax<qint64>(spacing, packetBytes * 10LL * 1000000LL / baudrate);
+    }
+    return spacing;
+}
+
+void SerialTxScheduler::pump()
+{
+    const qint64 now = nowUs();
+    if (now < m_nextSendUs) {
+        m_deadlineTimer->start(static_cast<int>((m_nextSendUs - now + 999) / 1000));
+        return;
+    }
+
+    Entry entry;
+    {
+        QMutexLocker locker(&m_mutex);
+        QQueue<Entry> *queue = nullptr;
+        for (auto &candidate : m_queues) {
+            if (!candidate.isEmpty()) {
+                queue = &candidate;
+                break;
+            }
+        }
+        if (!queue) {
+            m_pumpScheduled = false;
+            return;
+        }
+        entry = queue->dequeue();
+        const qint64 residencyUs = now - entry.queuedUs;
+        m_stats.totalResidencyUs += residencyUs;
+        m_stats.maxResidencyUs = qMax(m_stats.maxResidencyUs, residencyUs);
+    }
+
+    const bool sent = m_send && m_send(entry.data, entry.force);
+    m_nextSendUs = now + spacingUs(entry.data.size() + 1);  // + checksum byte
+    {
+        QMutexLocker locker(&m_mutex);
+        if (sent) {
+            ++m_stats.sent;
+        } else {
+            ++m_stats.failed;
+        }
+    }
+
+    // Come back for the next command; an empty queue ends the pump there
+    QMetaObject::invokeMethod(this, &SerialTxScheduler::pump, Qt::QueuedConnection);
+}
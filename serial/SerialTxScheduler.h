@@ -0,0 +1,143 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#ifndef SERIALTXSCHEDULER_H
+#define SERIALTXSCHEDULER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QQueue>
+#include <atomic>
+#include <functional>
+
+class QTimer;
+
+/**
+ * @brief Prioritised, paced transmit queue for async serial commands
+ *
+ * Commands queued from any thread are sent from the serial worker thread.
+ * Control commands (queries, USB switch, configuration) go ahead of input;
+ * keyboard and mouse reports share one FIFO, because their relative order is
+ * meaningful (a modifier held across a click). An unsent absolute mouse move
+ * is replaced by a newer one with the same button state, so the cursor never
+ * lags behind a backlog of stale positions. A move that changes the button
+ * state is a press or release and is never replaced.
+ *
+ * Packets are spaced by the chip's minimum inter-packet interval, the user's
+ * command delay and the time the previous packet needs on the wire at the
+ * current baudrate. Waiting is done with a deadline timer; the scheduler never
+ * blocks and never spins a nested event loop.
+ */
+class SerialTxScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Priority {
+        Control = 0,    // Everything that is not a HID report
+        Input = 1       // Keyboard (0x02/0x03) and mouse (0x04/0x05) reports, in order
+    };
+    static constexpr int PRIORITY_COUNT = 2;
+
+    /**
+     * @brief Sends one command (checksum not yet appended); returns false on failure
+     */
+    using SendFunction = std::function<bool(const QByteArray &data, bool force)>;
+
+    struct Stats {
+        quint64 sent = 0;               // Commands handed to the port
+        quint64 failed = 0;             // Commands the port refused
+        quint64 coalesced = 0;          // Mouse moves replaced before they were sent
+        int backlog = 0;                // Commands waiting at snapshot time
+        int maxBacklog = 0;
+        qint64 maxResidencyUs = 0;      // Longest time a command waited in the queue
+        qint64 totalResidencyUs = 0;
+        double packetsPerSecond = 0.0;  // Achieved send rate over the window
+    };
+
+    explicit SerialTxScheduler(QObject *parent = nullptr);
+    ~SerialTxScheduler() override;
+
+    void setSendFunction(SendFunction send);
+
+    // Pacing inputs; thread-safe
+    void setMinPacketIntervalUs(int intervalUs);
+    void setCommandDelayMs(int delayMs);
+    void setBaudrate(int baudrate);
+
+    /**
+     * @brief Queue a command for transmission (thread-safe, never blocks)
+     */
+    void enqueue(const QByteArray &data, bool force = false);
+
+    /**
+     * @brief Drop everything not yet sent
+     */
+    void clear();
+
+    int backlog() const;
+
+    /**
+     * @brief Statistics since the previous call
+     */
+    Stats takeStats();
+
+    static Priority classify(const QByteArray &data);
+
+private slots:
+    void pump();
+
+private:
+    struct Entry {
+        QByteArray data;
+        bool force = false;
+        qint64 queuedUs = 0;    // When the command (or the move it replaced) was queued
+        bool buttonTransition = false;  // Mouse report whose buttons differ from the previous one
+    };
+
+    static bool isCoalescableMouseMove(const QByteArray &data);
+    static int mouseButtons(const QByteArray &data);
+    qint64 nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+    qint64 spacingUs(int packetBytes) const;
+
+    SendFunction m_send;
+    QTimer *m_deadlineTimer;
+    QElapsedTimer m_clock;
+
+    mutable QMutex m_mutex;
+    QQueue<Entry> m_queues[PRIORITY_COUNT];
+    bool m_pumpScheduled = false;
+    int m_lastQueuedButtons = -1;   // Button byte of the newest queued mouse report, -1 if unknown
+    Stats m_stats;
+    qint64 m_statsStartUs = 0;
+
+    // Worker thread only
+    qint64 m_nextSendUs = 0;
+
+    std::atomic<int> m_minPacketIntervalUs{0};
+    std::atomic<int> m_commandDelayMs{0};
+    std::atomic<int> m_baudrate{0};
+};
+
+#endif // SERIALTXSCHEDULER_H
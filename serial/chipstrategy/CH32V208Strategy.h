@@ -58,6 +58,9 @@ public:
     bool supportsCommandBasedConfiguration() const override { return false; }
     bool supportsUsbSwitchCommand() const override { return true; }
     
+    // ========== Transmission ==========
+    int minPacketIntervalUs() const override { return 500; }
+    
     // ========== Reset Operations ==========
     bool performReset(
         QSerialPort* serialPort,
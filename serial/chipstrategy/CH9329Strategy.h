@@ -60,6 +60,9 @@ public:
     bool supportsCommandBasedConfiguration() const override { return true; }
     bool supportsUsbSwitchCommand() const override { return false; }
     
+    // ========== Transmission ==========
+    int minPacketIntervalUs() const override { return 2000; }  // Needs time to turn each packet into a HID report
+    
     // ========== Reset Operations ==========
     bool performReset(
         QSerialPort* serialPort,
@@ -95,6 +95,14 @@ public:
      */
     virtual bool supportsUsbSwitchCommand() const = 0;
     
+    // ========== Transmission ==========
+    
+    /**
+     * @brief Minimum gap between the starts of two async packets, in microseconds
+     * The TX scheduler also never sends faster than the line rate for the packet size.
+     */
+    virtual int minPacketIntervalUs() const = 0;
+    
     // ========== Reset Operations ==========
     
     /**
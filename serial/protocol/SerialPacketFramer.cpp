@@ -0,0 +1,174 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#include "SerialPacketFramer.h"
+#include "SerialProtocol.h"
+
+#include <cstring>
+
+using namespace SerialProtocolConstants;
+
+SerialPacketFramer::SerialPacketFramer(int capacity)
+    : m_buffer(qMax(capacity, MIN_PACKET_SIZE + 255), Qt::Uninitialized)
+{
+}
+
+char* SerialPacketFramer::writeBuffer(int wanted, int* available)
+{
+    if (m_buffer.size() - m_writePos < wanted) {
+        compact();
+    }
+    if (m_writePos == m_buffer.size()) {
+        // A full buffer with no packet in it can only be noise; start over
+        m_counters.overflows += static_cast<quint64>(m_writePos - m_readPos);
+        discard(m_readPos, m_writePos);
+        m_readPos = 0;
+        m_writePos = 0;
+    }
+    if (available) {
+        *available = qMin(qMax(wanted, 1), static_cast<int>(m_buffer.size()) - m_writePos);
+    }
+    return m_buffer.data() + m_writePos;
+}
+
+void SerialPacketFramer::commitWrite(int bytes)
+{
+    if (bytes > 0) {
+        m_writePos = qMin(m_writePos + bytes, static_cast<int>(m_buffer.size()));
+    }
+}
+
+void SerialPacketFramer::append(const QByteArray& data)
+{
+    int offset = 0;
+    while (offset < data.size()) {
+        int available = 0;
+        char* dst = writeBuffer(data.size() - offset, &available);
+        std::memcpy(dst, data.constData() + offset, available);
+        commitWrite(available);
+        offset += available;
+    }
+}
+
+int SerialPacketFramer::drain(const PacketHandler& handler)
+{
+    const uchar* bytes = reinterpret_cast<const uchar*>(m_buffer.constData());
+    int delivered = 0;
+
+    while (m_writePos - m_readPos >= HEADER_SIZE) {
+        if (bytes[m_readPos] != HEADER_BYTE_1 || bytes[m_readPos + 1] != HEADER_BYTE_2) {
+            const int next = findHeader(m_readPos + 1, m_writePos);
+            const int skipTo = next < 0 ? m_writePos : next;
+            ++m_counters.resyncs;
+            m_counters.discardedBytes += static_cast<quint64>(skipTo - m_readPos);
+            discard(m_readPos, skipTo);
+            m_readPos = skipTo;
+            continue;
+        }
+
+        // header(2) + addr(1) + cmd(1) + len(1) + payload(len) + checksum(1)
+        if (m_writePos - m_readPos < 5) {
+            break;
+        }
+        const int packetSize = MIN_PACKET_SIZE + bytes[m_readPos + 4];
+        if (m_writePos - m_readPos < packetSize) {
+            break;  // Tail of this packet is still on the wire
+        }
+
+        const char* packetData = m_buffer.constData() + m_readPos;
+        const uint8_t checksum = SerialProtocol::calculateChecksum(QByteArray::fromRawData(packetData, packetSize - 1));
+        const bool checksumOk = checksum == bytes[m_readPos + packetSize - 1];
+        if (!checksumOk) {
+            ++m_counters.checksumFailures;
+            // A header inside the claimed span means we framed on noise; restart there.
+            // Otherwise deliver it: some firmware sends responses with a bad checksum.
+            const int inner = findHeader(m_readPos + HEADER_SIZE, m_readPos + packetSize);
+            if (inner >= 0 && inner < m_readPos + packetSize - 1) {
+                ++m_counters.resyncs;
+                m_counters.discardedBytes += static_cast<quint64>(inner - m_readPos);
+                discard(m_readPos, inner);
+                m_readPos = inner;
+                continue;
+            }
+        }
+
+        if (handler) {
+            handler(QByteArray::fromRawData(packetData, packetSize), checksumOk);
+        }
+        m_readPos += packetSize;
+        ++m_counters.packets;
+        ++delivered;
+    }
+
+    if (m_readPos == m_writePos) {
+        m_readPos = 0;
+        m_writePos = 0;
+    }
+    return delivered;
+}
+
+void SerialPacketFramer::clear()
+{
+    m_readPos = 0;
+    m_writePos = 0;
+}
+
+QByteArray SerialPacketFramer::takeBuffered()
+{
+    QByteArray pending(m_buffer.constData() + m_readPos, m_writePos - m_readPos);
+    clear();
+    return pending;
+}
+
+int SerialPacketFramer::findHeader(int from, int to) const
+{
+    const uchar* bytes = reinterpret_cast<const uchar*>(m_buffer.constData());
+    for (int i = from; i < to; ++i) {
+        if (bytes[i] != HEADER_BYTE_1) {
+            continue;
+        }
+        if (i + 1 == to || bytes[i + 1] == HEADER_BYTE_2) {
+            return i;  // A lone 0x57 at the end may be the first half of a header
+        }
+    }
+    return -1;
+}
+
+void SerialPacketFramer::discard(int from, int to)
+{
+    if (m_discardHandler && to > from) {
+        m_discardHandler(QByteArray::fromRawData(m_buffer.constData() + from, to - from));
+    }
+}
+
+void SerialPacketFramer::compact()
+{
+    if (m_readPos == 0) {
+        return;
+    }
+    const int pending = m_writePos - m_readPos;
+    if (pending > 0) {
+        std::memmove(m_buffer.data(), m_buffer.constData() + m_readPos, pending);
+    }
+    m_readPos = 0;
+    m_writePos = pending;
+}
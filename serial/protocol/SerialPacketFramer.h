@@ -0,0 +1,119 @@
+/*
+* ========================================================================== *
+*                                                                            *
+*    This file is part of the Openterface Mini KVM App QT version            *
+*                                                                            *
+*    Copyright (C) 2024   <info@openterface.com>                             *
+*                                                                            *
+*    This program is free software: you can redistribute it and/or modify    *
+*    it under the terms of the GNU General Public License as published by    *
+*    the Free Software Foundation version 3.                                 *
+*                                                                            *
+*    This program is distributed in the hope that it will be useful, but     *
+*    WITHOUT ANY WARRANTY; without even the implied warranty of              *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU        *
+*    General Public License for more details.                                *
+*                                                                            *
+*    You should have received a copy of the GNU General Public License       *
+*    along with this program. If not, see <http://www.gnu.org/licenses/>.    *
+*                                                                            *
+* ========================================================================== *
+*/
+
+#ifndef SERIALPACKETFRAMER_H
+#define SERIALPACKETFRAMER_H
+
+#include <QByteArray>
+#include <QtGlobal>
+#include <functional>
+
+/**
+ * @brief Incremental packet framer for the CH9329/CH32V208 RX stream
+ *
+ * Bytes read from the serial port are appended to a persistent receive
+ * buffer; drain() then cuts out every complete `57 AB` packet, skipping
+ * noise until the next header and keeping an incomplete tail for the next
+ * read. Packets are handed out as views into the buffer, so framing and the
+ * checksum check copy nothing.
+ *
+ * Not thread-safe: owned and used by the serial worker thread only.
+ */
+class SerialPacketFramer
+{
+public:
+    struct Counters {
+        quint64 packets = 0;           // Complete packets delivered
+        quint64 resyncs = 0;           // Times the stream had to be searched for a header
+        quint64 discardedBytes = 0;    // Bytes skipped while resynchronising
+        quint64 checksumFailures = 0;  // Framed packets whose checksum did not match
+        quint64 overflows = 0;         // Unframed bytes dropped because the buffer was full
+    };
+
+    /**
+     * @brief Called once per packet
+     * @param packet View into the receive buffer; valid only during the call
+     * @param checksumOk false if the checksum did not match (the packet is still delivered)
+     */
+    using PacketHandler = std::function<void(const QByteArray& packet, bool checksumOk)>;
+
+    /**
+     * @brief Called with bytes skipped while resynchronising or dropped on overflow
+     * @param bytes View into the receive buffer; valid only during the call
+     */
+    using DiscardHandler = std::function<void(const QByteArray& bytes)>;
+
+    static constexpr int DEFAULT_CAPACITY = 4096;
+
+    explicit SerialPacketFramer(int capacity = DEFAULT_CAPACITY);
+
+    /**
+     * @brief Reserve space to read into directly
+     * @param wanted Bytes the caller would like to write
+     * @return Write pointer; *available receives how many bytes fit (at least 1)
+     */
+    char* writeBuffer(int wanted, int* available);
+
+    /**
+     * @brief Mark bytes written through writeBuffer() as received
+     */
+    void commitWrite(int bytes);
+
+    /**
+     * @brief Copy bytes into the receive buffer
+     */
+    void append(const QByteArray& data);
+
+    /**
+     * @brief Deliver every complete packet in the buffer
+     * @return Number of packets delivered
+     */
+    int drain(const PacketHandler& handler);
+
+    void clear();
+
+    void setDiscardHandler(DiscardHandler handler) { m_discardHandler = std::move(handler); }
+
+    /**
+     * @brief Remove and return the bytes not yet framed (a partial packet)
+     */
+    QByteArray takeBuffered();
+
+    int bufferedBytes() const { return m_writePos - m_readPos; }
+
+    Counters counters() const { return m_counters; }
+    void resetCounters() { m_counters = Counters(); }
+
+private:
+    // Index of the next 0x57 0xAB in [from, to), or a trailing 0x57 at to - 1; -1 if none
+    int findHeader(int from, int to) const;
+    void compact();
+    void discard(int from, int to);
+
+    QByteArray m_buffer;
+    int m_readPos = 0;
+    int m_writePos = 0;
+    Counters m_counters;
+    DiscardHandler m_discardHandler;
+};
+
+#endif // SERIALPACKETFRAMER_H
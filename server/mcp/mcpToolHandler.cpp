@@ -24,6 +24,7 @@
 #include "mcpProtocol.h"
 #include "host/HostManager.h"
 #include "host/cameramanager.h"
+#include "host/framebus.h"
 #include "target/MouseManager.h"
 #include "target/KeyboardManager.h"
 #include "scripts/KeyboardMouse.h"
@@ -243,7 +244,9 @@ QJsonArray McpToolHandler::listTools() const
         QJsonObject schema;
         schema["type"] = "object";
         QJsonObject props;
-        props["quality"] = QJsonObject{{"type", "integer"}, {"description", "JPEG quality (1-100)"}, {"default", 90}, {"minimum", 1}, {"maximum", 100}};
+        props["quality"] = QJsonObject{{"type", "integer"}, {"description", "JPEG quality (1-100). Omit to receive the capture card's original JPEG without re-encoding"}, {"minimum", 1}, {"maximum", 100}};
+        props["max_width"] = QJsonObject{{"type", "integer"}, {"description", "Scale down (keeping aspect) to at most this width in pixels"}, {"minimum", 16}};
+        props["max_height"] = QJsonObject{{"type", "integer"}, {"description", "Scale down (keeping aspect) to at most this height in pixels"}, {"minimum", 16}};
         schema["properties"] = props;
         schema["required"] = QJsonArray();
         tool["inputSchema"] = schema;
@@ -680,11 +683,33 @@ QJsonObject McpToolHandler::toolCaptureScreen(const QJsonObject& args)
         return errorResult("CameraManager not initialized");
     }
 
+    // Requested size; the frame bus scales once per distinct size and shares it
+    FrameBusFormat format;
+    const int maxWidth = args.value("max_width").toInt(0);
+    const int maxHeight = args.value("max_height").toInt(0);
+    if (maxWidth > 0 || maxHeight > 0) {
+        constexpr int kUnbounded = 1 << 16;
+        format.maxSize = QSize(maxWidth > 0 ? qMax(16, maxWidth) : kUnbounded,
+                               maxHeight > 0 ? qMax(16, maxHeight) : kUnbounded);
+    }
+
+    // Without an explicit quality or size the camera's own JPEG is returned
+    // as-is, avoiding a decode/encode cycle per request.
+    if (!args.contains("quality") && !format.maxSize.isValid()) {
+        EncodedFrame encoded = m_cameraManager->getLatestEncodedFrame();
+        if (!encoded.isNull()) {
+            QJsonObject content = McpProtocol::imageContent(encoded.data.toBase64(), "image/jpeg");
+            QJsonArray contents{ content };
+            return McpProtocol::toolResult(contents);
+        }
+    }
+
     int quality = args.value("quality").toInt(90);
     quality = qBound(1, quality, 100);
 
     // Get the current frame
-    QImage frame = m_cameraManager->getLatestOriginalFrame();
+    FrameBus* frameBus = m_cameraManager->frameBus();
+    QImage frame = frameBus ? frameBus->latestFrame(format) : QImage();
     if (frame.isNull()) {
         return errorResult("No frame available from camera");
     }
@@ -906,6 +931,17 @@ QJsonObject McpToolHandler::toolSystemStatus(const QJsonObject& args)
             camera["frame_width"]  = lastFrame.width();
             camera["frame_height"] = lastFrame.height();
         }
+        if (FrameBus* frameBus = m_cameraManager->frameBus()) {
+            QJsonArray subscribers;
+            for (const FrameBus::SubscriberStats& stats : frameBus->subscriberStats()) {
+                QJsonObject entry;
+                entry["name"] = stats.name;
+                entry["delivered"] = static_cast<qint64>(stats.delivered);
+                entry["dropped"] = static_cast<qint64>(stats.dropped);
+                subscribers.append(entry);
+            }
+            camera["frame_bus_subscribers"] = subscribers;
+        }
     } else {
         camera["active"] = false;
         camera["backend"] = "not_loaded";
@@ -9,17 +9,16 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QFileInfoList>
+#include <QDirIterator>
 #include <QDateTime>
 #include "../host/cameramanager.h"
-
-#ifndef Q_OS_WIN
-#include "../host/backend/gstreamerbackendhandler.h"
-#endif
+#include "../host/timelapsearchive.h"
+#include "../host/framebus.h"
 
 #include "log/opflogging.h"
 OPF_LOGGING_CATEGORY(log_server_tcp, "opf.server.tcp")
 
-TcpServer::TcpServer(QObject *parent) : QTcpServer(parent), currentClient(nullptr), m_cameraManager(nullptr), actionStatus(Finish) {}
+TcpServer::TcpServer(QObject *parent) : QTcpServer(parent), currentClient(nullptr), m_cameraManager(nullptr), m_timelapseArchive(nullptr), actionStatus(Finish) {}
 
 void TcpServer::startServer(quint16 port) {
     if (this->listen(QHostAddress::Any, port)) {
@@ -32,11 +31,16 @@ void TcpServer::setCameraManager(CameraManager* cameraManager) {
     m_cameraManager = cameraManager;
     if (m_cameraManager) {
         qCDebug(log_server_tcp) << "CameraManager connected to TcpServer";
-        // Note: frames are read on-demand via m_cameraManager->getLatestOriginalFrame()
+        // Note: frames are read on-demand from the camera manager's frame bus
         // inside sendScreenToClient(). There is no need to subscribe to every live frame.
     }
 }
 
+void TcpServer::setTimelapseArchive(const TimelapseArchive* archive) {
+    m_timelapseArchive = archive;
+    qCDebug(log_server_tcp) << "Timelapse archive" << (archive ? "attached" : "detached");
+}
+
 void TcpServer::onNewConnection() {
     currentClient = this->nextPendingConnection();
     connect(currentClient, &QTcpSocket::readyRead, this, &TcpServer::onReadyRead);
@@ -72,45 +76,6 @@ QImage TcpServer::getCurrentFrameFromCamera() {
     return m_currentFrame;
 }
 
-#ifndef Q_OS_WIN
-QImage TcpServer::captureFrameFromGStreamer() {
-    if (!m_cameraManager || !m_cameraManager->isGStreamerBackend()) {
-        return QImage();
-    }
-    
-    // GStreamer is only available on non-Windows platforms
-    GStreamerBackendHandler* gstBackend = m_cameraManager->getGStreamerBackend();
-    if (!gstBackend) {
-        qCDebug(log_server_tcp) << "Error: Could not get GStreamer backend";
-        return QImage();
-    }
-    
-    try {
-        // Use the GStreamer backend's takeImage method
-        // Save to a temporary file in the temp directory
-        QString tempPath = QStandardPaths::writableLocation(QStandardPaths::TempLocation) + "/openterface_gst_frame.jpg";
-        gstBackend->takeImage(tempPath);
-        
-        // Load the image from the temp file
-        QImage image(tempPath);
-        
-        // Delete the temp file
-        QFile::remove(tempPath);
-        
-        if (!image.isNull()) {
-            qCDebug(log_server_tcp) << "Successfully captured frame from GStreamer backend, size:" << image.size();
-        } else {
-            qCDebug(log_server_tcp) << "Failed to load image from GStreamer temp file";
-        }
-        
-        return image;
-    } catch (const std::exception &e) {
-        qCDebug(log_server_tcp) << "Exception while capturing from GStreamer:" << e.what();
-        return QImage();
-    }
-}
-#endif
-
 ActionCommand TcpServer::parseCommand(const QByteArray& data){
     QString command = QString(data).trimmed().toLower();
 
@@ -128,6 +93,7 @@ ActionCommand TcpServer::parseCommand(const QByteArray& data){
 
 // Returns the path of the newest image file in the openterface pictures folder,
 // or an empty string if the folder does not exist or contains no images.
+// Only used when nothing was captured in this session; one pass, no sorting.
 static QString findLatestImageInPicturesDir()
 {
     QString picturesPath = QStandardPaths::writableLocation(QStandardPaths::PicturesLocation);
@@ -135,25 +101,45 @@ static QString findLatestImageInPicturesDir()
         picturesPath = QDir::homePath() + "/Pictures";
     QString folderPath = picturesPath + "/openterface";
 
-    QDir dir(folderPath);
-    if (!dir.exists())
-        return QString();
-
-    // Sort by last-modified time descending – first entry is the newest file
-    QFileInfoList files = dir.entryInfoList(
-        QStringList() << "*.jpg" << "*.jpeg" << "*.png",
-        QDir::Files,
-        QDir::Time   // newest first
-    );
+    QDirIterator it(folderPath, QStringList() << "*.jpg" << "*.jpeg" << "*.png" << "*.webp", QDir::Files);
+    QString latestPath;
+    QDateTime latestTime;
+    while (it.hasNext()) {
+        it.next();
+        const QDateTime modified = it.fileInfo().lastModified();
+        if (latestPath.isEmpty() || modified > latestTime) {
+            latestPath = it.filePath();
+            latestTime = modified;
+        }
+    }
+    return latestPath;
+}
 
-    if (files.isEmpty())
-        return QString();
+// Newest timelapse frame, straight from the archive's in-memory copy
+bool TcpServer::sendTimelapseImageToClient(){
+    QByteArray imageData;
+    QDateTime captureTime;
+    if (!m_timelapseArchive || !m_timelapseArchive->latestFrame(&imageData, &captureTime)) {
+        return false;
+    }
 
-    return files.first().absoluteFilePath();
+    QByteArray responseData = TcpResponse::createImageResponse(
+        imageData, "jpeg", captureTime.toString(Qt::ISODate), m_timelapseArchive->directory());
+    if (currentClient && currentClient->state() == QAbstractSocket::ConnectedState) {
+        currentClient->write(responseData);
+        qCDebug(log_server_tcp) << "Sending timelapse frame to client, size:" << imageData.size()
+                               << "bytes, captureTime:" << captureTime;
+        currentClient->flush();
+    }
+    return true;
 }
 
 void TcpServer::sendImageToClient(){
     try {
+        if (sendTimelapseImageToClient()) {
+            return;
+        }
+
         // If no image was captured in this session, fall back to the newest
         // file already saved on disk in the openterface pictures folder.
         if (lastImgPath.isEmpty()) {
@@ -242,39 +228,30 @@ void TcpServer::sendScreenToClient(){
             return;
         }
         
-        if (m_cameraManager->isFFmpegBackend()) {
-            // FFmpeg backend - use the native-resolution original frame so that the
-            // client receives the true camera resolution, not the display-scaled copy.
-            frameToSend = m_cameraManager->getLatestOriginalFrame();
-            if (frameToSend.isNull()) {
-                QByteArray responseData = TcpResponse::createErrorResponse("No frame available from FFmpeg backend. Camera may not be running or no frames captured yet.");
-                qCDebug(log_server_tcp) << "Error: No frame captured yet from FFmpeg backend";
-                if (currentClient && currentClient->state() == QAbstractSocket::ConnectedState) {
-                    currentClient->write(responseData);
-                    currentClient->flush();
-                }
-                return;
-            }
-        }
-#ifndef Q_OS_WIN
-        else if (m_cameraManager->isGStreamerBackend()) {
-            // GStreamer backend - capture frame directly
-            qCDebug(log_server_tcp) << "Capturing frame from GStreamer backend";
-            frameToSend = captureFrameFromGStreamer();
-            if (frameToSend.isNull()) {
-                QByteArray responseData = TcpResponse::createErrorResponse("Failed to capture frame from GStreamer backend. Check if camera is running.");
-                qCDebug(log_server_tcp) << "Error: GStreamer frame capture returned null";
-                if (currentClient && currentClient->state() == QAbstractSocket::ConnectedState) {
-                    currentClient->write(responseData);
-                    currentClient->flush();
-                }
-                return;
+        // Fast path: the full frame is requested unchanged, so forward the
+        // capture card's own JPEG instead of decoding and re-encoding it
+        // (FFmpeg, and GStreamer's frame tap).
+        EncodedFrame encoded = m_cameraManager->getLatestEncodedFrame();
+        if (!encoded.isNull()) {
+            QByteArray base64Data = encoded.data.toBase64();
+            QByteArray responseData = TcpResponse::createScreenResponse(base64Data, encoded.size.width(), encoded.size.height());
+            if (currentClient && currentClient->state() == QAbstractSocket::ConnectedState) {
+                currentClient->write(responseData);
+                qCDebug(log_server_tcp) << "Screen data (JPEG passthrough) - frame:" << encoded.frame_id
+                                       << "JPEG size:" << encoded.data.size()
+                                       << "bytes, Resolution:" << encoded.size.width() << "x" << encoded.size.height();
+                currentClient->flush();
             }
+            return;
         }
-#endif
-        else {
-            QByteArray responseData = TcpResponse::createErrorResponse("Unknown or unsupported backend. Please check your multimedia context setup.");
-            qCDebug(log_server_tcp) << "Error: Unable to determine active backend";
+
+        // Any backend: the bus's native-resolution frame, so the client receives
+        // the true camera resolution, not the display-scaled copy.
+        FrameBus* frameBus = m_cameraManager->frameBus();
+        frameToSend = frameBus ? frameBus->latestFrame() : QImage();
+        if (frameToSend.isNull()) {
+            QByteArray responseData = TcpResponse::createErrorResponse("No frame available. Camera may not be running or no frames captured yet.");
+            qCDebug(log_server_tcp) << "Error: No frame available from the frame bus";
             if (currentClient && currentClient->state() == QAbstractSocket::ConnectedState) {
                 currentClient->write(responseData);
                 currentClient->flush();
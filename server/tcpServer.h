@@ -12,9 +12,7 @@
 #include "tcpResponse.h"
 
 class CameraManager;
-#ifndef Q_OS_WIN
-class GStreamerBackendHandler;
-#endif
+class TimelapseArchive;
 
 enum ActionCommand {
     CmdUnknow = -1,
@@ -37,6 +35,8 @@ public:
     explicit TcpServer(QObject *parent = nullptr);
     void startServer(quint16 port);
     void setCameraManager(CameraManager* cameraManager);
+    // While set, "lastimage" answers with the archive's newest frame
+    void setTimelapseArchive(const TimelapseArchive* archive);
 
 signals:
     void syntaxTreeReady(std::shared_ptr<ASTNode> syntaxTree);
@@ -56,14 +56,13 @@ private:
     QTcpSocket *currentClient;
     QString lastImgPath;
     CameraManager* m_cameraManager;
+    const TimelapseArchive* m_timelapseArchive;
     QImage m_currentFrame;
     QMutex m_frameMutex;
     ActionCommand parseCommand(const QByteArray& data);
     void sendImageToClient();
+    bool sendTimelapseImageToClient();
     void sendScreenToClient();
-#ifndef Q_OS_WIN
-    QImage captureFrameFromGStreamer();
-#endif
     void processCommand(ActionCommand cmd);
     Lexer lexer;
     std::vector<Token> tokens;
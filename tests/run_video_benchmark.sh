@@ -0,0 +1,71 @@
+#!/bin/bash
+# =============================================================================
+# Video Pipeline Benchmark Runner
+# =============================================================================
+# Runs the headless FFmpeg video benchmark (openterfaceQT --video-benchmark)
+# on synthetic 720p/1080p/4K MJPEG content and/or recorded packet captures.
+# No device, display or X server is needed.
+#
+# A packet capture of a real session can be recorded with
+#   OPENTERFACE_PACKET_CAPTURE=/tmp/session.otpkt ./build/openterfaceQT
+#
+# Env vars:
+#   BENCH_INPUTS    - Space separated inputs (default "720p 1080p 4k")
+#   BENCH_FRAMES    - Frames per input (default 300)
+#   BENCH_MIN_FPS   - Fail (exit 2) if any input decodes slower (default 0 = off)
+#   BENCH_RECORD    - 1 to also re-encode every frame (default 0)
+#   BENCH_REALTIME  - 1 to replay with the recorded timing (default 0)
+#   BENCH_CSV       - CSV file results are appended to
+#                     (default tests/benchmark_logs/video_benchmark.csv)
+# =============================================================================
+
+set -euo pipefail
+
+PROJECT_DIR="${WORKSPACE:-$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)}"
+BUILD_DIR="${PROJECT_DIR}/build"
+LOG_DIR="${PROJECT_DIR}/tests/benchmark_logs"
+APP="${BENCH_APP:-${BUILD_DIR}/openterfaceQT}"
+
+INPUTS="${BENCH_INPUTS:-720p 1080p 4k}"
+FRAMES="${BENCH_FRAMES:-300}"
+MIN_FPS="${BENCH_MIN_FPS:-0}"
+CSV="${BENCH_CSV:-${LOG_DIR}/video_benchmark.csv}"
+
+if [ ! -x "${APP}" ]; then
+    echo "ERROR: binary not found: ${APP}"
+    exit 1
+fi
+mkdir -p "$(dirname "${CSV}")"
+
+ARGS=(--benchmark-frames "${FRAMES}" --benchmark-min-fps "${MIN_FPS}" --benchmark-csv "${CSV}")
+for input in ${INPUTS}; do
+    ARGS+=(--video-benchmark "${input}")
+done
+if [ "${BENCH_RECORD:-0}" = "1" ]; then
+    ARGS+=(--benchmark-record)
+fi
+if [ "${BENCH_REALTIME:-0}" = "1" ]; then
+    ARGS+=(--benchmark-realtime)
+fi
+
+echo "=== OpenterfaceQT Video Benchmark ==="
+echo "Binary:  ${APP}"
+echo "Inputs:  ${INPUTS}"
+echo "Frames:  ${FRAMES}"
+echo "Min fps: ${MIN_FPS}"
+echo "CSV:     ${CSV}"
+echo
+
+# Keep the benchmark output readable
+export QT_LOGGING_RULES="*.debug=false;opf.backend.ffmpeg.info=false"
+
+status=0
+"${APP}" "${ARGS[@]}" || status=$?
+
+echo
+if [ ${status} -eq 0 ]; then
+    echo "Video benchmark PASSED"
+else
+    echo "Video benchmark FAILED (exit ${status})"
+fi
+exit ${status}
@@ -285,8 +285,8 @@ void RecordingSettingsDialog::setupVideoSettings()
         m_videoCodecCombo->addItems({"mjpeg", "x264enc", "x265enc"}); // GStreamer codec names
         m_videoCodecCombo->setToolTip(tr("GStreamer codecs: mjpeg (fast), x264enc (good compression), x265enc (best compression)"));
     } else {
-        m_videoCodecCombo->addItems({"mjpeg"}); // FFmpeg/default - MJPEG encoder for AVI container creates playable video files
-        m_videoCodecCombo->setToolTip(tr("FFmpeg codec: mjpeg (compatible with AVI format)"));
+        m_videoCodecCombo->addItems({"mjpeg", "copy"}); // FFmpeg/default - MJPEG encoder for AVI container creates playable video files
+        m_videoCodecCombo->setToolTip(tr("FFmpeg codecs: mjpeg (compatible with AVI format), copy (store the camera's MJPEG stream unchanged, lowest CPU)"));
     }
     layout->addWidget(m_videoCodecCombo, row++, 1);
     
@@ -304,6 +304,28 @@ void RecordingSettingsDialog::setupVideoSettings()
     m_videoBitrateSpin->setSuffix(" kbps");
     layout->addWidget(m_videoBitrateSpin, row++, 1);
     
+    // Encoder backlog: frames waiting for the encoder and which one is dropped when it is full
+    layout->addWidget(new QLabel(tr("Encoder Queue:")), row, 0);
+    m_queueCapacitySpin = new QSpinBox();
+    m_queueCapacitySpin->setRange(1, 120);
+    m_queueCapacitySpin->setValue(8);
+    m_queueCapacitySpin->setSuffix(tr(" frames"));
+    layout->addWidget(m_queueCapacitySpin, row++, 1);
+    
+    layout->addWidget(new QLabel(tr("When Full:")), row, 0);
+    m_dropPolicyCombo = new QComboBox();
+    m_dropPolicyCombo->addItem(tr("Drop oldest frame"), "oldest");
+    m_dropPolicyCombo->addItem(tr("Drop newest frame"), "newest");
+    m_dropPolicyCombo->setToolTip(tr("Oldest keeps the recording close to live; newest keeps the frames already queued"));
+    layout->addWidget(m_dropPolicyCombo, row++, 1);
+    
+    // Stream copy stores the camera's bitstream: there is no bitrate to choose
+    connect(m_videoCodecCombo, &QComboBox::currentTextChanged, this, [this](const QString& codec) {
+        const bool streamCopy = codec == "copy";
+        m_videoQualityCombo->setEnabled(!streamCopy);
+        m_videoBitrateSpin->setEnabled(!streamCopy);
+    });
+    
     // Connect quality preset to update bitrate
     connect(m_videoQualityCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
             [this](int index) {
@@ -334,8 +356,13 @@ void RecordingSettingsDialog::setupOutputSettings()
         m_formatCombo->addItems({"avi", "mp4", "mkv"}); // GStreamer supports more formats
         m_formatCombo->setToolTip(tr("GStreamer formats: AVI (compatible), MP4 (modern), MKV (flexible)"));
     } else {
-        m_formatCombo->addItems({"avi"}); // FFmpeg build supports avi, mjpeg and rawvideo muxers - AVI with MJPEG creates playable video files
-        m_formatCombo->setToolTip(tr("FFmpeg format: AVI (most compatible with custom build)"));
+        // Only containers whose muxer is in the FFmpeg build (the bundled one has avi, mjpeg and rawvideo)
+#ifndef Q_OS_WIN
+        m_formatCombo->addItems(FFmpegRecorder::SupportedFormats({"avi", "mkv"}));
+#else
+        m_formatCombo->addItems({"avi"}); // Replaced by the Qt backend formats in refreshUIForBackend()
+#endif
+        m_formatCombo->setToolTip(tr("FFmpeg formats: AVI (most compatible with custom build), MKV (when the matroska muxer is available)"));
     }
     layout->addWidget(m_formatCombo, row++, 1);
     
@@ -569,9 +596,13 @@ void RecordingSettingsDialog::onApplySettings()
         RecordingConfig config;
         config.output_path = m_outputPathEdit->text();
         config.format = m_formatCombo->currentText();
-        config.video_codec = m_videoCodecCombo->currentText();
+        config.video_codec = m_videoCodecCombo->currentText();   // Same value saveSettings() stores
+        config.stream_copy = config.video_codec == "copy";
         config.video_bitrate = m_videoBitrateSpin->value() * 1000; // Convert to bps
         config.video_quality = 23; // Use default CRF value
+        config.encoder_queue_capacity = m_queueCapacitySpin->value();
+        config.drop_policy = m_dropPolicyCombo->currentData().toString() == "newest"
+            ? RecordingDropPolicy::DropNewest : RecordingDropPolicy::DropOldest;
         config.use_hardware_acceleration = false; // Default to false for compatibility
         
         m_ffmpegBackend->setRecordingConfig(config);
@@ -590,6 +621,8 @@ void RecordingSettingsDialog::onResetToDefaults()
     m_videoCodecCombo->setCurrentText("mjpeg");
     m_videoQualityCombo->setCurrentIndex(1); // Medium
     m_videoBitrateSpin->setValue(2000);
+    m_queueCapacitySpin->setValue(8);
+    m_dropPolicyCombo->setCurrentIndex(m_dropPolicyCombo->findData("oldest"));
     
     m_formatCombo->setCurrentText("avi");
     m_outputPathEdit->setText(generateDefaultOutputPath());
@@ -765,6 +798,8 @@ void RecordingSettingsDialog::refreshUIForBackend()
     m_formatCombo->clear();
     m_formatCombo->addItems({"mp4", "avi", "mov"}); 
     m_formatCombo->setToolTip(tr("Windows Qt backend formats: MP4 (recommended), AVI (compatible), MOV (QuickTime)"));
+    m_queueCapacitySpin->setEnabled(false);
+    m_dropPolicyCombo->setEnabled(false);
 #else
     // Linux/Unix - Update video codec options
     m_videoCodecCombo->clear();
@@ -772,8 +807,8 @@ void RecordingSettingsDialog::refreshUIForBackend()
         m_videoCodecCombo->addItems({"mjpeg", "x264enc", "x265enc"}); 
         m_videoCodecCombo->setToolTip(tr("GStreamer codecs: mjpeg (fast), x264enc (good compression), x265enc (best compression)"));
     } else {
-        m_videoCodecCombo->addItems({"mjpeg"}); 
-        m_videoCodecCombo->setToolTip(tr("FFmpeg codec: mjpeg (compatible with AVI format)"));
+        m_videoCodecCombo->addItems({"mjpeg", "copy"}); 
+        m_videoCodecCombo->setToolTip(tr("FFmpeg codecs: mjpeg (compatible with AVI format), copy (store the camera's MJPEG stream unchanged, lowest CPU)"));
     }
     
     // Update format options
@@ -782,9 +817,14 @@ void RecordingSettingsDialog::refreshUIForBackend()
         m_formatCombo->addItems({"avi", "mp4", "mkv"}); 
         m_formatCombo->setToolTip(tr("GStreamer formats: AVI (compatible), MP4 (modern), MKV (flexible)"));
     } else {
-        m_formatCombo->addItems({"avi"}); 
-        m_formatCombo->setToolTip(tr("FFmpeg format: AVI (most compatible with custom build)"));
+        m_formatCombo->addItems(FFmpegRecorder::SupportedFormats({"avi", "mkv"})); 
+        m_formatCombo->setToolTip(tr("FFmpeg formats: AVI (most compatible with custom build), MKV (when the matroska muxer is available)"));
     }
+    
+    // The encoder queue belongs to the FFmpeg recorder
+    const bool ffmpegRecorder = configuredBackend.toLower() != "gstreamer";
+    m_queueCapacitySpin->setEnabled(ffmpegRecorder);
+    m_dropPolicyCombo->setEnabled(ffmpegRecorder);
 #endif
     
     // Restore previously selected values if they're still available
@@ -808,6 +848,9 @@ void RecordingSettingsDialog::loadSettings()
     
     m_videoCodecCombo->setCurrentText(settings.getRecordingVideoCodec());
     m_videoBitrateSpin->setValue(settings.getRecordingVideoBitrate() / 1000);
+    m_queueCapacitySpin->setValue(settings.getRecordingEncoderQueueCapacity());
+    const int policyIndex = m_dropPolicyCombo->findData(settings.getRecordingDropPolicy());
+    m_dropPolicyCombo->setCurrentIndex(policyIndex >= 0 ? policyIndex : 0);
     
     m_formatCombo->setCurrentText(settings.getRecordingOutputFormat());
     
@@ -824,6 +867,8 @@ void RecordingSettingsDialog::saveSettings()
     
     settings.setRecordingVideoCodec(m_videoCodecCombo->currentText());
     settings.setRecordingVideoBitrate(m_videoBitrateSpin->value() * 1000);
+    settings.setRecordingEncoderQueueCapacity(m_queueCapacitySpin->value());
+    settings.setRecordingDropPolicy(m_dropPolicyCombo->currentData().toString());
     settings.setRecordingOutputFormat(m_formatCombo->currentText());
     settings.setRecordingOutputPath(m_outputPathEdit->text());
 }
@@ -135,6 +135,8 @@ private:
     QComboBox* m_videoCodecCombo;
     QComboBox* m_videoQualityCombo;
     QSpinBox* m_videoBitrateSpin;
+    QSpinBox* m_queueCapacitySpin;
+    QComboBox* m_dropPolicyCombo;
     
     // Output settings
     QGroupBox* m_outputGroup;
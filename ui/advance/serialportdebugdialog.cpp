@@ -23,6 +23,7 @@
 
 #include "serialportdebugdialog.h"
 #include "serial/SerialPortManager.h"
+#include "serial/SerialTraceRecorder.h"
 #include "ui/globalsetting.h"
 #include <QPushButton>
 #include <QVBoxLayout>
@@ -35,6 +36,10 @@
 #include <QDateTime>
 #include <QSettings>
 #include <QTextCursor>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QMessageBox>
+#include <QStandardPaths>
 
 // Define filter settings
 const SerialPortDebugDialog::FilterSettings SerialPortDebugDialog::FILTERS[] = {
@@ -49,6 +54,7 @@ const SerialPortDebugDialog::FilterSettings SerialPortDebugDialog::FILTERS[] = {
 SerialPortDebugDialog::SerialPortDebugDialog(QWidget *parent)
     : QDialog(parent)
     , textEdit(new QTextEdit(this))
+    , traceButton(nullptr)
     , debugButtonWidget(new QWidget(this))
     , filterCheckboxWidget(new QWidget(this))
 {
@@ -81,16 +87,97 @@ void SerialPortDebugDialog::createFilterCheckBox()
 }
 
 void SerialPortDebugDialog::createDebugButtonWidget(){
+    traceButton = new QPushButton;
+    QPushButton *openTraceButton = new QPushButton(tr("Open Trace"));
     QPushButton *clearButton = new QPushButton(tr("Clear"));
     QPushButton *closeButton = new QPushButton(tr("Close"));
+    traceButton->setFixedSize(90,30);
+    openTraceButton->setFixedSize(90,30);
     closeButton->setFixedSize(90,30);
     clearButton->setFixedSize(90,30);
+    updateTraceButton();
     QHBoxLayout *debugButtonLayout = new QHBoxLayout(debugButtonWidget);
+    debugButtonLayout->addWidget(traceButton);
+    debugButtonLayout->addWidget(openTraceButton);
     debugButtonLayout->addStretch();
     debugButtonLayout->addWidget(clearButton);
     debugButtonLayout->addWidget(closeButton);
     connect(closeButton, &QPushButton::clicked, this, &QDialog::reject);
     QObject::connect(clearButton, &QPushButton::clicked, textEdit, &QTextEdit::clear);
+    connect(traceButton, &QPushButton::clicked, this, &SerialPortDebugDialog::toggleTrace);
+    connect(openTraceButton, &QPushButton::clicked, this, &SerialPortDebugDialog::openTrace);
+}
+
+void SerialPortDebugDialog::updateTraceButton()
+{
+    const bool tracing = SerialTraceRecorder::isEnabled();
+    traceButton->setText(tracing ? tr("Stop Trace") : tr("Start Trace"));
+    traceButton->setToolTip(tracing ? SerialTraceRecorder::getInstance().filePath()
+                                    : tr("Record every serial packet to a binary trace file"));
+}
+
+void SerialPortDebugDialog::toggleTrace()
+{
+    SerialTraceRecorder &recorder = SerialTraceRecorder::getInstance();
+    if (SerialTraceRecorder::isEnabled()) {
+        recorder.stop();
+    } else {
+        const QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation)
+            + "/serial_trace_" + QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss") + ".optrace";
+        const QString path = QFileDialog::getSaveFileName(this, tr("Save Serial Trace"), defaultPath,
+                                                          tr("Serial trace (*.optrace);;All files (*)"));
+        if (path.isEmpty()) return;
+        if (!recorder.start(path)) {
+            QMessageBox::warning(this, tr("Serial Trace"), tr("Cannot write trace file %1").arg(path));
+        }
+    }
+    updateTraceButton();
+}
+
+void SerialPortDebugDialog::openTrace()
+{
+    const QString path = QFileDialog::getOpenFileName(this, tr("Open Serial Trace"),
+                                                      QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation),
+                                                      tr("Serial trace (*.optrace);;All files (*)"));
+    if (path.isEmpty()) return;
+
+    qint64 startMs = 0;
+    QString error;
+    const QList<SerialTraceRecorder::Record> records = SerialTraceRecorder::decode(path, &startMs, &error);
+    if (!error.isEmpty()) {
+        QMessageBox::warning(this, tr("Serial Trace"), tr("Cannot read %1: %2").arg(path, error));
+        return;
+    }
+
+    // Same layout as the live view, plus baudrate and any write failure
+    QString text;
+    for (const auto &record : records) {
+        const bool isPacket = record.event == SerialTraceRecorder::Event::Packet;
+        const unsigned char code = record.data.size() >= 4 ? static_cast<unsigned char>(record.data[3]) : 0;
+        if (isPacket && (record.data.size() < 4 || !shouldShowMessage(code))) continue;
+
+        const QDateTime time = QDateTime::fromMSecsSinceEpoch(startMs + record.timestampUs / 1000);
+        QString line = time.toString("MM-dd hh:mm:ss.zzz") + " ";
+        if (record.event == SerialTraceRecorder::Event::Overrun) {
+            text += line + tr("%1: %2 records lost").arg(SerialTraceRecorder::eventName(record.event)).arg(record.length) + "\n";
+            continue;
+        }
+        line += getCommandType(code);
+        line += record.direction == SerialTraceRecorder::Direction::Rx ? " << " : " >> ";
+        line += formatHexData(record.data.toHex().toUpper());
+        if (record.length > record.data.size()) {
+            line += tr(" ... (%1 bytes)").arg(record.length);
+        }
+        line += QString(" @%1").arg(record.baudrate);
+        if (!isPacket) {
+            line += " [" + SerialTraceRecorder::eventName(record.event) + "]";
+        }
+        text += line + "\n";
+    }
+
+    textEdit->setPlainText(text);
+    textEdit->moveCursor(QTextCursor::End);
+    setWindowTitle(tr("Serial Port Debug - %1 (%2 records)").arg(QFileInfo(path).fileName()).arg(records.size()));
 }
 
 void SerialPortDebugDialog::createLayout(){
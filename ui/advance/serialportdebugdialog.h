@@ -27,6 +27,8 @@
 #include <QDialog>
 #include <QTextEdit>
 
+class QPushButton;
+
 class SerialPortDebugDialog : public QDialog {
     Q_OBJECT
 public:
@@ -36,9 +38,12 @@ private slots:
     void handleSerialData(const QByteArray &data, bool isReceived);
     void getRecvDataAndInsertText(const QByteArray &data) { handleSerialData(data, true); }
     void getSentDataAndInsertText(const QByteArray &data) { handleSerialData(data, false); }
+    void toggleTrace();
+    void openTrace();
 
 private:
     QTextEdit *textEdit;
+    QPushButton *traceButton;
     QWidget *debugButtonWidget;
     QWidget *filterCheckboxWidget;
 
@@ -57,6 +62,7 @@ private:
     void loadSettings();
     QString formatHexData(const QString &hexString);
     bool shouldShowMessage(unsigned char code) const;
+    void updateTraceButton();
     QString getCommandType(unsigned char code) const;
 };
 
@@ -169,6 +169,31 @@ QString GlobalSetting::getScalingQuality() const {
     return m_settings.value("video/scalingQuality", "balanced").toString();
 }
 
+void GlobalSetting::setDecodeWorkerCount(int workers) {
+    m_settings.setValue("video/decodeWorkers", workers);
+    m_settings.sync();
+}
+
+int GlobalSetting::getDecodeWorkerCount() const {
+    return m_settings.value("video/decodeWorkers", 0).toInt();
+}
+
+void GlobalSetting::setScreenshotFormat(const QString &format) {
+    m_settings.setValue("video/screenshotFormat", format);
+}
+
+QString GlobalSetting::getScreenshotFormat() const {
+    return m_settings.value("video/screenshotFormat", "jpg").toString();
+}
+
+void GlobalSetting::setScreenshotQuality(int quality) {
+    m_settings.setValue("video/screenshotQuality", quality);
+}
+
+int GlobalSetting::getScreenshotQuality() const {
+    return m_settings.value("video/screenshotQuality", 90).toInt();
+}
+
 void GlobalSetting::setGStreamerPipelineTemplate(const QString &pipelineTemplate) {
     m_settings.setValue("video/gstreamerPipelineTemplate", pipelineTemplate);
 }
@@ -509,6 +534,26 @@ int GlobalSetting::getRecordingKeyframeInterval() const
     return m_settings.value("recording/keyframeInterval", 30).toInt();
 }
 
+void GlobalSetting::setRecordingEncoderQueueCapacity(int frames)
+{
+    m_settings.setValue("recording/encoderQueueCapacity", frames);
+}
+
+int GlobalSetting::getRecordingEncoderQueueCapacity() const
+{
+    return m_settings.value("recording/encoderQueueCapacity", 8).toInt();
+}
+
+void GlobalSetting::setRecordingDropPolicy(const QString& policy)
+{
+    m_settings.setValue("recording/dropPolicy", policy);
+}
+
+QString GlobalSetting::getRecordingDropPolicy() const
+{
+    return m_settings.value("recording/dropPolicy", "oldest").toString();
+}
+
 void GlobalSetting::setRecordingAudioCodec(const QString& codec)
 {
     m_settings.setValue("recording/audioCodec", codec);
@@ -519,14 +564,14 @@ QString GlobalSetting::getRecordingAudioCodec() const
     return m_settings.value("recording/audioCodec", "aac").toString();
 }
 
-void GlobalSetting::setRecordingAudioBitrate(int bitrate)
+void GlobalSetting::setRecordingAudioBitrate(int kbps)
 {
-    m_settings.setValue("recording/audioBitrate", bitrate);
+    m_settings.setValue("recording/audioBitrate", kbps);
 }
 
 int GlobalSetting::getRecordingAudioBitrate() const
 {
-    return m_settings.value("recording/audioBitrate", 128000).toInt();
+    return m_settings.value("recording/audioBitrate", 128).toInt();
 }
 
 void GlobalSetting::setRecordingAudioSampleRate(int sampleRate)
@@ -539,6 +584,16 @@ int GlobalSetting::getRecordingAudioSampleRate() const
     return m_settings.value("recording/audioSampleRate", 44100).toInt();
 }
 
+void GlobalSetting::setRecordingAudioEnabled(bool enabled)
+{
+    m_settings.setValue("recording/audioEnabled", enabled);
+}
+
+bool GlobalSetting::getRecordingAudioEnabled() const
+{
+    return m_settings.value("recording/audioEnabled", false).toBool();
+}
+
 void GlobalSetting::setRecordingOutputFormat(const QString& format)
 {
     m_settings.setValue("recording/outputFormat", format);
@@ -600,6 +655,16 @@ bool GlobalSetting::getVideoSmoothTransform() const
     return m_settings.value("video/smoothTransform", true).toBool();
 }
 
+void GlobalSetting::setVideoDirectRasterRendering(bool enabled)
+{
+    m_settings.setValue("video/directRasterRendering", enabled);
+}
+
+bool GlobalSetting::getVideoDirectRasterRendering() const
+{
+    return m_settings.value("video/directRasterRendering", false).toBool();
+}
+
 // Custom key import path settings
 void GlobalSetting::setLastCustomKeyImportPath(const QString& path)
 {
@@ -62,6 +62,16 @@ public:
     
     void setScalingQuality(const QString &quality);
     QString getScalingQuality() const;
+
+    // Number of FFmpeg decoder worker threads (0 = automatic)
+    void setDecodeWorkerCount(int workers);
+    int getDecodeWorkerCount() const;
+
+    // Screenshot file format ("jpg", "png" or "webp") and encoder quality (0-100)
+    void setScreenshotFormat(const QString &format);
+    QString getScreenshotFormat() const;
+    void setScreenshotQuality(int quality);
+    int getScreenshotQuality() const;
     
     void setGStreamerPipelineTemplate(const QString &pipelineTemplate);
     QString getGStreamerPipelineTemplate() const;
@@ -135,13 +145,19 @@ public:
     QString getRecordingPixelFormat() const;
     void setRecordingKeyframeInterval(int interval);
     int getRecordingKeyframeInterval() const;
+    void setRecordingEncoderQueueCapacity(int frames);
+    int getRecordingEncoderQueueCapacity() const;
+    void setRecordingDropPolicy(const QString& policy);  // "oldest" or "newest"
+    QString getRecordingDropPolicy() const;
     
     void setRecordingAudioCodec(const QString& codec);
     QString getRecordingAudioCodec() const;
-    void setRecordingAudioBitrate(int bitrate);
-    int getRecordingAudioBitrate() const;
+    void setRecordingAudioBitrate(int kbps);
+    int getRecordingAudioBitrate() const;  // kbps
     void setRecordingAudioSampleRate(int sampleRate);
     int getRecordingAudioSampleRate() const;
+    void setRecordingAudioEnabled(bool enabled);
+    bool getRecordingAudioEnabled() const;
     
     void setRecordingOutputFormat(const QString& format);
     QString getRecordingOutputFormat() const;
@@ -159,6 +175,9 @@ public:
     bool getVideoTextAntialiasing() const;
     void setVideoSmoothTransform(bool enabled);
     bool getVideoSmoothTransform() const;
+    // Paint FFmpeg frames straight into the viewport instead of via the scene
+    void setVideoDirectRasterRendering(bool enabled);
+    bool getVideoDirectRasterRendering() const;
 
     // Custom key import path persistence
     void setLastCustomKeyImportPath(const QString& path);
@@ -448,6 +448,8 @@ void MainWindowInitializer::connectCameraSignals()
     // Connect fpsChanged signal from CameraManager to StatusBarManager
     connect(m_cameraManager, &CameraManager::fpsChanged,
             m_statusBarManager, &StatusBarManager::setFps);
+    connect(m_cameraManager, &CameraManager::latencyStatsChanged,
+            m_statusBarManager, &StatusBarManager::setLatencyStats);
     
     connect(m_cameraManager, &CameraManager::cameraDeviceSwitching,
             m_videoPane, &VideoPane::onCameraDeviceSwitching);
@@ -86,7 +86,7 @@ void AudioPage::setupUI()
     audioCodecLabel->setStyleSheet(smallLabelFontSize);
     audioCodecBox = new QComboBox();
     audioCodecBox->setObjectName("audioCodecBox");
-    audioCodecBox->addItems({"AAC", "MP3", "PCM", "FLAC"});
+    audioCodecBox->addItems({"AAC", "Opus", "MP3", "PCM", "FLAC"});
     audioCodecBox->setToolTip(tr("Select the audio codec for recording"));
 
     recordingLayout->addWidget(audioCodecLabel, 0, 0);
@@ -153,6 +153,13 @@ void AudioPage::setupUI()
     recordingLayout->addWidget(fileFormatLabel, 4, 0);
     recordingLayout->addWidget(containerFormatBox, 4, 1);
 
+    // Mux HDMI audio into video recordings
+    recordAudioCheckBox = new QCheckBox(tr("Include audio in video recordings"));
+    recordAudioCheckBox->setObjectName("recordAudioCheckBox");
+    recordAudioCheckBox->setToolTip(tr("Encode the captured HDMI audio into the video file (FFmpeg backend)"));
+
+    recordingLayout->addWidget(recordAudioCheckBox, 5, 0, 1, 2);
+
     // Live Audio Settings Group
     QGroupBox *liveGroup = new QGroupBox(tr("Live Audio Settings"));
     liveGroup->setStyleSheet("QGroupBox { font-weight: bold; }");
@@ -211,6 +218,7 @@ void AudioPage::loadSettings()
     audioSampleRateBox->setValue(settings.getRecordingAudioSampleRate());
     audioBitrateBox->setValue(settings.getRecordingAudioBitrate());
     containerFormatBox->setCurrentText(settings.getRecordingOutputFormat());
+    recordAudioCheckBox->setChecked(settings.getRecordingAudioEnabled());
 
     qCDebug(log_ui_audio_page) << "Loaded audio settings from GlobalSetting";
     captureSnapshot();
@@ -226,6 +234,7 @@ void AudioPage::applySettings()
     settings.setRecordingAudioSampleRate(audioSampleRateBox->value());
     settings.setRecordingAudioBitrate(audioBitrateBox->value());
     settings.setRecordingOutputFormat(containerFormatBox->currentText());
+    settings.setRecordingAudioEnabled(recordAudioCheckBox->isChecked());
 
     // Save selected audio device
     if (audioDeviceComboBox->currentIndex() >= 0) {
@@ -257,6 +266,8 @@ void AudioPage::connectSignals()
             this, [this](int){ markDirty(); });
     connect(containerFormatBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, [this](int){ markDirty(); });
+    connect(recordAudioCheckBox, &QCheckBox::toggled,
+            this, [this](bool){ markDirty(); });
 
     // Connect audio device selection
     connect(audioDeviceComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
@@ -372,6 +383,7 @@ void AudioPage::captureSnapshot()
     m_snap_sampleRate = audioSampleRateBox->value();
     m_snap_quality = qualitySlider->value();
     m_snap_containerFormatIndex = containerFormatBox->currentIndex();
+    m_snap_recordAudio = recordAudioCheckBox->isChecked();
     m_snap_audioDeviceIndex = audioDeviceComboBox->currentIndex();
     m_snap_audioBitrate = audioBitrateBox->value();
     m_snap_enableAudio = enableAudioCheckBox->isChecked();
@@ -384,6 +396,7 @@ void AudioPage::revertToSnapshot()
     audioSampleRateBox->setValue(m_snap_sampleRate);
     qualitySlider->setValue(m_snap_quality);
     containerFormatBox->setCurrentIndex(m_snap_containerFormatIndex);
+    recordAudioCheckBox->setChecked(m_snap_recordAudio);
     audioDeviceComboBox->setCurrentIndex(m_snap_audioDeviceIndex);
     audioBitrateBox->setValue(m_snap_audioBitrate);
     enableAudioCheckBox->setChecked(m_snap_enableAudio);
@@ -396,6 +409,7 @@ bool AudioPage::valuesMatchSnapshot() const
         && audioSampleRateBox->value() == m_snap_sampleRate
         && qualitySlider->value() == m_snap_quality
         && containerFormatBox->currentIndex() == m_snap_containerFormatIndex
+        && recordAudioCheckBox->isChecked() == m_snap_recordAudio
         && audioDeviceComboBox->currentIndex() == m_snap_audioDeviceIndex
         && audioBitrateBox->value() == m_snap_audioBitrate
         && enableAudioCheckBox->isChecked() == m_snap_enableAudio
@@ -63,6 +63,7 @@ private:
     QSlider *qualitySlider;
     QLabel *fileFormatLabel;
     QComboBox *containerFormatBox;
+    QCheckBox *recordAudioCheckBox;
 
     // Audio device management widgets
     QComboBox *audioDeviceComboBox;
@@ -78,6 +79,7 @@ private:
     int m_snap_sampleRate;
     int m_snap_quality;
     int m_snap_containerFormatIndex;
+    bool m_snap_recordAudio;
     int m_snap_audioDeviceIndex;
     int m_snap_audioBitrate;
     bool m_snap_enableAudio;
@@ -501,7 +501,7 @@ void RecordingSettingsDialog::loadSettings()
     m_keyframeIntervalSpin->setValue(settings.getRecordingKeyframeInterval());
     
     m_audioCodecCombo->setCurrentText(settings.getRecordingAudioCodec());
-    m_audioBitrateSpin->setValue(settings.getRecordingAudioBitrate() / 1000);
+    m_audioBitrateSpin->setValue(settings.getRecordingAudioBitrate());
     m_sampleRateCombo->setCurrentText(QString::number(settings.getRecordingAudioSampleRate()));
     
     m_formatCombo->setCurrentText(settings.getRecordingOutputFormat());
@@ -523,7 +523,7 @@ void RecordingSettingsDialog::saveSettings()
     settings.setRecordingKeyframeInterval(m_keyframeIntervalSpin->value());
     
     settings.setRecordingAudioCodec(m_audioCodecCombo->currentText());
-    settings.setRecordingAudioBitrate(m_audioBitrateSpin->value() * 1000);
+    settings.setRecordingAudioBitrate(m_audioBitrateSpin->value());
     settings.setRecordingAudioSampleRate(m_sampleRateCombo->currentText().toInt());
     
     settings.setRecordingOutputFormat(m_formatCombo->currentText());
@@ -213,6 +213,11 @@ void StatusBarManager::setFps(double fps)
     m_statusWidget->setFps(fps, backend);
 }
 
+void StatusBarManager::setLatencyStats(const QString& summary)
+{
+    m_statusWidget->setLatencyStats(summary);
+}
+
 QPixmap StatusBarManager::recolorSvg(const QString &svgPath, const QColor &color, const QSize &size)
 {
     QSvgRenderer svgRenderer(svgPath);
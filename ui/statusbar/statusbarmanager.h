@@ -25,6 +25,7 @@ public:
     void setInputResolution(int width, int height, float fps, float pixelClk);
     void setCaptureResolution(int width, int height, int fps);
     void setFps(double fps);
+    void setLatencyStats(const QString& summary);
     void setTargetUsbConnected(bool isConnected);
     void factoryReset(bool isStarted);
     void serialPortReset(bool isStarted);
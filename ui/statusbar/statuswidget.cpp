@@ -455,14 +455,27 @@ void StatusWidget::setFps(const double &fps, const QString &backend) {
         }
         
         fpsLabel->setPixmap(createIconTextLabel("", text, color));
-        fpsLabel->setToolTip(QString("Video FPS (%1): %2").arg(backend).arg(QString::number(fps, 'f', 1)));
+        m_fpsToolTip = QString("Video FPS (%1): %2").arg(backend).arg(QString::number(fps, 'f', 1));
     } else {
         fpsLabel->setPixmap(createIconTextLabel("", QString("%1: N/A").arg(backendPrefix)));
-        fpsLabel->setToolTip(QString("Video FPS (%1) unavailable").arg(backend));
+        m_fpsToolTip = QString("Video FPS (%1) unavailable").arg(backend);
     }
+    updateFpsToolTip();
     update();
 }
 
+void StatusWidget::setLatencyStats(const QString &summary)
+{
+    m_latencySummary = summary;
+    updateFpsToolTip();
+}
+
+void StatusWidget::updateFpsToolTip()
+{
+    fpsLabel->setToolTip(m_latencySummary.isEmpty() ? m_fpsToolTip
+                                                    : m_fpsToolTip + "\n" + m_latencySummary);
+}
+
 QPixmap StatusWidget::createIconTextLabel(const QString &svgPath, const QString &text, const QColor &textColor, const QColor &iconColor)
 {
     // Determine colors to use
@@ -42,6 +42,7 @@ public:
     void setInputResolution(const int &width, const int &height, const float &fps, const float &pixelClk);
     void setCaptureResolution(const int &width, const int &height, const float &fps);
     void setFps(const double &fps, const QString &backend = QString());
+    void setLatencyStats(const QString &summary);  // Shown in the FPS tooltip
     void setKeyboardIndicators(const QString &indicators);
     void setConnectedPort(const QString &port, const int &baudrate);
     void setStatusUpdate(const QString &status);
@@ -95,6 +96,10 @@ private:
     QString m_lastPort;
     int m_lastBaudrate = -1;
 
+    QString m_fpsToolTip;
+    QString m_latencySummary;
+    void updateFpsToolTip();
+
     double getCpuUsage();
     QPixmap createIconTextLabel(const QString &svgPath, const QString &text, const QColor &textColor = QColor(), const QColor &iconColor = QColor());
     QColor getIconColorForCurrentTheme() const;
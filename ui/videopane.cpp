@@ -45,6 +45,45 @@
 #include "log/opflogging.h"
 OPF_LOGGING_CATEGORY(log_ui_video, "opf.ui.video")
 
+VideoFrameItem::VideoFrameItem(const QPixmap& pixmap, QGraphicsItem* parent)
+    : QGraphicsPixmapItem(pixmap, parent)
+{
+}
+
+bool VideoFrameItem::hasPartialFrame() const
+{
+    // Any setPixmap() since, even through a QGraphicsPixmapItem pointer, wins
+    return !m_partialFrame.isNull() && QGraphicsPixmapItem::pixmap().cacheKey() == m_basePixmapKey;
+}
+
+QPixmap VideoFrameItem::pixmap() const
+{
+    return hasPartialFrame() ? m_partialFrame : QGraphicsPixmapItem::pixmap();
+}
+
+void VideoFrameItem::presentPartial(const QPixmap& frame, const QRegion& dirty)
+{
+    m_partialFrame = frame;
+    m_basePixmapKey = QGraphicsPixmapItem::pixmap().cacheKey();
+
+    const qreal dpr = frame.devicePixelRatio() > 0 ? frame.devicePixelRatio() : 1.0;
+    for (const QRect& rect : dirty) {
+        // One logical pixel of margin for the filtering of a scaled item
+        update(QRectF(offset().x() + rect.x() / dpr, offset().y() + rect.y() / dpr,
+                      rect.width() / dpr, rect.height() / dpr).adjusted(-1, -1, 1, 1));
+    }
+}
+
+void VideoFrameItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+    if (!hasPartialFrame()) {
+        QGraphicsPixmapItem::paint(painter, option, widget);
+        return;
+    }
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, transformationMode() == Qt::SmoothTransformation);
+    painter->drawPixmap(offset(), m_partialFrame);
+}
+
 VideoPane::VideoPane(QWidget *parent) : QGraphicsView(parent),
     m_inputHandler(new InputHandler(this, this)),
     escTimer(new QTimer(this)),
@@ -104,6 +143,9 @@ VideoPane::VideoPane(QWidget *parent) : QGraphicsView(parent),
     
     // record default quality state
     m_highQualityRendering = enableAntialiasing && enableTextAntialiasing;
+    
+    m_directRasterRendering = GlobalSetting::instance().getVideoDirectRasterRendering();
+    m_renderClock.start();
 
     // IMPORTANT: Do NOT use DontAdjustForAntialiasing as it degrades quality
     // We keep antialiasing adjustments enabled for better text rendering
@@ -282,7 +324,9 @@ void VideoPane::onCameraDeviceSwitching(const QString& /*fromDevice*/, const QSt
     // qCDebug(log_ui_video) << "VideoPane: Camera switching from" << fromDevice << "to" << toDevice;
     
     // Capture the current frame before switching
+    leaveRasterPath();
     captureCurrentFrame();
+    resetFrameBuffers();
     
     // Set switching mode to display the last frame
     m_isCameraSwitching = true;
@@ -357,11 +401,21 @@ void VideoPane::captureCurrentFrame()
 
 void VideoPane::paintEvent(QPaintEvent *event)
 {
+    const qint64 paintStartNs = m_renderClock.nsecsElapsed();
+    
+    // Raster path: draw the frame ourselves and skip the scene entirely
+    if (useRasterPath() && !m_rasterFrame.isNull()) {
+        paintRasterFrame();
+        recordPaint(paintStartNs);
+        return;
+    }
+    
     // PERFORMANCE: Reduce redundant visibility checks and updates
     if (m_isCameraSwitching && !m_lastFrame.isNull()) {
         // During camera switching, show preserved frame using pixmap item
         if (!m_pixmapItem) {
-            m_pixmapItem = m_scene->addPixmap(m_lastFrame);
+            m_pixmapItem = new VideoFrameItem(m_lastFrame);
+            m_scene->addItem(m_pixmapItem);
             m_pixmapItem->setZValue(1); // Above video item
             m_pixmapItem->setTransformationMode(m_highQualityRendering ? Qt::SmoothTransformation
                                                                          : Qt::FastTransformation);
@@ -402,6 +456,10 @@ void VideoPane::paintEvent(QPaintEvent *event)
     
     // Call the base class paintEvent
     QGraphicsView::paintEvent(event);
+    
+    if (m_directFFmpegMode) {
+        recordPaint(paintStartNs);
+    }
 }
 
 // QVideoWidget compatibility methods
@@ -444,6 +502,7 @@ void VideoPane::resetZoom()
     resetTransform(); // Reset view transform
     updateVideoItemTransform();
     updateScrollBarsAndSceneRect();
+    publishVisibleSourceRect();
     
     // Log zoom reset
     qCDebug(log_ui_video) << "Zoom reset: current zoom=" << m_scaleFactor
@@ -468,6 +527,11 @@ void VideoPane::zoomIn(double factor)
     // Check if this is the first zoom in (transitioning from 1.0 to > 1.0)
     bool wasNotZoomed = (m_scaleFactor <= 1.0);
     
+    // Zooming and scrolling need the scene: hand the current frame back to it
+    if (factor > 1.0) {
+        leaveRasterPath();
+    }
+    
     // Store the center point of the viewport before zooming
     QPointF centerPoint = mapToScene(viewport()->rect().center());
     
@@ -479,6 +543,7 @@ void VideoPane::zoomIn(double factor)
     
     // Center back on the same scene point to maintain focus during zoom
     centerOn(centerPoint);
+    publishVisibleSourceRect();
     
     // Show hint if this is the first zoom in and hint hasn't been shown yet
     if (wasNotZoomed && m_scaleFactor > 1.0 && !m_zoomHintShown) {
@@ -505,6 +570,7 @@ void VideoPane::zoomOut(double factor)
     
     // Center back on the same scene point to maintain focus during zoom
     centerOn(centerPoint);
+    publishVisibleSourceRect();
     
     // Log zoom information
     qCDebug(log_ui_video) << "Zoom out: factor=" << factor << "current zoom=" << m_scaleFactor
@@ -524,6 +590,7 @@ void VideoPane::fitToWindow()
         updateVideoItemTransform();
         updateScrollBarsAndSceneRect();
     }
+    publishVisibleSourceRect();
 }
 
 void VideoPane::actualSize()
@@ -546,7 +613,7 @@ void VideoPane::resizeEvent(QResizeEvent *event)
     }
     
     // If in FFmpeg direct mode and we have a pixmap, re-evaluate frame sizing so we can pre-scale to exact viewport
-    if (m_directFFmpegMode && m_pixmapItem && !m_pixmapItem->pixmap().isNull()) {
+    if (m_directFFmpegMode && !useRasterPath() && m_pixmapItem && !m_pixmapItem->pixmap().isNull()) {
         // Re-run the update path with the currently displayed pixmap to keep 1:1 mapping on resize
         updateVideoFrame(m_pixmapItem->pixmap());
     }
@@ -558,6 +625,7 @@ void VideoPane::resizeEvent(QResizeEvent *event)
 
     // Update scene rect and scroll bars on resize
     updateScrollBarsAndSceneRect();
+    publishVisibleSourceRect();
     
     // Update overlay widget geometry for direct GStreamer mode
     if (m_directGStreamerMode && m_overlayWidget) {
@@ -573,6 +641,37 @@ void VideoPane::resizeEvent(QResizeEvent *event)
     }
 }
 
+void VideoPane::scrollContentsBy(int dx, int dy)
+{
+    QGraphicsView::scrollContentsBy(dx, dy);
+    publishVisibleSourceRect();
+}
+
+// Tell the FFmpeg backend which part of the frame is on screen so it can
+// skip decoding the rest while zoomed in.
+void VideoPane::publishVisibleSourceRect()
+{
+    QRectF normalized;
+    if (m_directFFmpegMode && m_pixmapItem && m_scaleFactor > 1.0) {
+        const QRectF itemRect = m_pixmapItem->boundingRect();
+        if (!itemRect.isEmpty()) {
+            const QRectF visibleScene = mapToScene(viewport()->rect()).boundingRect();
+            const QRectF visibleItem = m_pixmapItem->mapFromScene(visibleScene).boundingRect().intersected(itemRect);
+            if (!visibleItem.isEmpty()) {
+                normalized = QRectF((visibleItem.left() - itemRect.left()) / itemRect.width(),
+                                    (visibleItem.top() - itemRect.top()) / itemRect.height(),
+                                    visibleItem.width() / itemRect.width(),
+                                    visibleItem.height() / itemRect.height());
+            }
+        }
+    }
+
+    if (normalized != m_visibleSourceRect) {
+        m_visibleSourceRect = normalized;
+        emit visibleSourceRectChanged(normalized);
+    }
+}
+
 // Helper methods
 void VideoPane::updateOverlayWidgetGeometry()
 {
@@ -795,7 +894,15 @@ QPointF VideoPane::getTransformedMousePosition(const QPoint& viewportPos)
     QGraphicsItem* targetItem = nullptr;
     QRectF itemRect;
     
-    if (m_directFFmpegMode && m_pixmapItem && m_pixmapItem->isVisible()) {
+    if (useRasterPath() && !m_rasterFrame.isNull()) {
+        // Raster path: the frame is drawn at m_rasterTargetRect, no scene item
+        if (m_rasterTargetRect.isEmpty()) {
+            return QPointF(viewportPos);
+        }
+        double normalizedX = qBound(0.0, (viewportPos.x() - m_rasterTargetRect.left()) / m_rasterTargetRect.width(), 1.0);
+        double normalizedY = qBound(0.0, (viewportPos.y() - m_rasterTargetRect.top()) / m_rasterTargetRect.height(), 1.0);
+        return QPointF(normalizedX * m_originalVideoSize.width(), normalizedY * m_originalVideoSize.height());
+    } else if (m_directFFmpegMode && m_pixmapItem && m_pixmapItem->isVisible()) {
         targetItem = m_pixmapItem;
         itemRect = m_pixmapItem->boundingRect();
         // qCDebug(log_ui_video) << "      [getTransformed] Using FFmpeg pixmap item";
@@ -1286,6 +1393,19 @@ void VideoPane::updateVideoFrameFromImage(const QImage& image)
         return;
     }
 
+    const qint64 startNs = m_renderClock.nsecsElapsed();
+    if (useRasterPath()) {
+        setRasterFrame(image);
+    } else {
+        presentFullFrame(image);
+    }
+    recordFrameArrival(startNs);
+}
+
+void VideoPane::presentFullFrame(const QImage& image)
+{
+    m_rasterFrame = QImage();
+
     // Use window/widget DPR to ensure consistent logical/physical pixel mapping
     qreal widgetDpr = 1.0;
     if (window()) widgetDpr = window()->devicePixelRatioF();
@@ -1301,11 +1421,260 @@ void VideoPane::updateVideoFrameFromImage(const QImage& image)
     //                      << " resulting pixmap.logicalSize=" << QSizeF(frame.width()/widgetDpr, frame.height()/widgetDpr);
 
     updateVideoFrame(frame);
+
+    // Seed the dirty-region buffers when the frame is shown unscaled
+    resetFrameBuffers();
+    if (m_pixmapItem && m_pixmapItem->pixmap().cacheKey() == frame.cacheKey()) {
+        m_frameBuffers[0] = frame;
+        m_displayedFrameKey = frame.cacheKey();
+        m_frameBufferViewport = viewport()->rect().size();
+    }
     
     // CRITICAL FIX: Force immediate viewport update to prevent freezing
     viewport()->update();
 }
 
+void VideoPane::updateVideoFrameFromImage(const QImage& image, const QList<QRect>& dirtyRects)
+{
+    if (image.isNull()) {
+        return;
+    }
+
+    const qint64 startNs = m_renderClock.nsecsElapsed();
+    if (useRasterPath()) {
+        setRasterFrame(image);  // Whole frame is painted anyway; nothing to track
+    } else if (dirtyRects.isEmpty() || !paintDirtyRegions(image, dirtyRects)) {
+        presentFullFrame(image);
+    }
+    recordFrameArrival(startNs);
+}
+
+bool VideoPane::useRasterPath() const
+{
+    return m_directRasterRendering && m_directFFmpegMode && !m_isCameraSwitching && m_scaleFactor <= 1.0;
+}
+
+void VideoPane::setDirectRasterRendering(bool enable)
+{
+    if (m_directRasterRendering == enable) {
+        return;
+    }
+    if (!enable) {
+        leaveRasterPath();
+    }
+    m_directRasterRendering = enable;
+    qCDebug(log_ui_video) << "VideoPane: direct raster rendering" << (enable ? "enabled" : "disabled");
+    viewport()->update();
+}
+
+void VideoPane::setRasterFrame(const QImage& image)
+{
+    // Shallow copy; the pixmap item and dirty-region buffers are bypassed
+    if (m_displayedFrameKey != 0) {
+        resetFrameBuffers();
+    }
+    if (m_pixmapItem && m_pixmapItem->isVisible()) {
+        m_pixmapItem->setVisible(false);
+    }
+    m_rasterFrame = image;
+
+    qreal widgetDpr = 1.0;
+    if (window()) widgetDpr = window()->devicePixelRatioF();
+    else widgetDpr = this->devicePixelRatioF();
+    m_originalVideoSize = QSize(qRound(image.width() / widgetDpr), qRound(image.height() / widgetDpr));
+
+    if (image.size() != m_rasterTargetFrameSize) {
+        updateRasterTargetRect();
+    }
+    viewport()->update();
+}
+
+void VideoPane::updateRasterTargetRect()
+{
+    const QSize viewportSize = viewport()->size();
+    m_rasterTargetFrameSize = m_rasterFrame.size();
+    m_rasterTargetViewportSize = viewportSize;
+
+    if (m_rasterFrame.isNull() || viewportSize.isEmpty()) {
+        m_rasterTargetRect = QRectF();
+        return;
+    }
+
+    QSizeF target = QSizeF(viewportSize);
+    if (m_maintainAspectRatio) {
+        target = QSizeF(m_rasterFrame.size()).scaled(QSizeF(viewportSize), Qt::KeepAspectRatio);
+    }
+    m_rasterTargetRect = QRectF(QPointF((viewportSize.width() - target.width()) / 2.0,
+                                        (viewportSize.height() - target.height()) / 2.0),
+                                target);
+}
+
+void VideoPane::paintRasterFrame()
+{
+    if (viewport()->size() != m_rasterTargetViewportSize) {
+        updateRasterTargetRect();
+    }
+
+    QPainter painter(viewport());
+    // Letterbox bars only; the frame covers the rest
+    const QRegion bars = QRegion(viewport()->rect()).subtracted(QRegion(m_rasterTargetRect.toAlignedRect()));
+    for (const QRect& bar : bars) {
+        painter.fillRect(bar, Qt::black);
+    }
+    const bool scaled = m_rasterTargetRect.size() != QSizeF(m_rasterFrame.size());
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, scaled && m_highQualityRendering);
+    painter.drawImage(m_rasterTargetRect, m_rasterFrame);
+}
+
+// Give the last raster frame to the pixmap item so scene-based features
+// (zoom, scroll, camera-switch preservation) start from what is on screen.
+void VideoPane::leaveRasterPath()
+{
+    if (m_rasterFrame.isNull()) {
+        return;
+    }
+    const QImage frame = m_rasterFrame;
+    presentFullFrame(frame);
+}
+
+void VideoPane::recordFrameArrival(qint64 startNs)
+{
+    const qint64 now = m_renderClock.nsecsElapsed();
+    if (m_unpaintedFrameNs < 0) {
+        m_unpaintedFrameNs = startNs;
+    }
+    m_renderGuiPendingNs += now - startNs;
+    ++m_renderFrames;
+}
+
+void VideoPane::recordPaint(qint64 startNs)
+{
+    if (m_unpaintedFrameNs < 0) {
+        return;  // Repaint without a new frame (expose, overlay, resize)
+    }
+
+    const qint64 now = m_renderClock.nsecsElapsed();
+    const qint64 latencyNs = now - m_unpaintedFrameNs;
+    const qint64 guiNs = m_renderGuiPendingNs + (now - startNs);
+    m_unpaintedFrameNs = -1;
+    m_renderGuiPendingNs = 0;
+    emit framePainted();
+
+    ++m_renderPaints;
+    m_renderLatencyTotalNs += latencyNs;
+    m_renderLatencyMaxNs = qMax(m_renderLatencyMaxNs, latencyNs);
+    m_renderGuiTotalNs += guiNs;
+    m_renderGuiMaxNs = qMax(m_renderGuiMaxNs, guiNs);
+
+    if (now - m_renderWindowStartNs < 5000000000LL) {
+        return;
+    }
+    qCDebug(log_ui_video) << QString("Render path %1 - frames: %2, paints: %3, frame-to-paint avg/max ms: %4/%5, "
+                                     "GUI time per frame avg/max ms: %6/%7")
+        .arg(useRasterPath() ? "raster" : "scene")
+        .arg(m_renderFrames)
+        .arg(m_renderPaints)
+        .arg(m_renderLatencyTotalNs / 1e6 / m_renderPaints, 0, 'f', 2)
+        .arg(m_renderLatencyMaxNs / 1e6, 0, 'f', 2)
+        .arg(m_renderGuiTotalNs / 1e6 / qMax<quint64>(1, m_renderFrames), 0, 'f', 2)
+        .arg(m_renderGuiMaxNs / 1e6, 0, 'f', 2);
+    m_renderWindowStartNs = now;
+    m_renderFrames = 0;
+    m_renderPaints = 0;
+    m_renderLatencyTotalNs = 0;
+    m_renderLatencyMaxNs = 0;
+    m_renderGuiTotalNs = 0;
+    m_renderGuiMaxNs = 0;
+}
+
+// Paint only the changed areas of `image` into the back buffer and flip it
+// onto the pixmap item, avoiding a full QImage->QPixmap conversion for every
+// frame; only the changed areas are repainted on screen.  Returns false when
+// a full update is required instead.
+bool VideoPane::paintDirtyRegions(const QImage& image, const QList<QRect>& dirtyRects)
+{
+    if (!m_directFFmpegMode || !m_pixmapItem || m_displayedFrameKey == 0) {
+        return false;
+    }
+
+    const int front = m_frontBuffer;
+    const int back = 1 - front;
+    const QPixmap& frontPixmap = m_frameBuffers[front];
+
+    // Someone else replaced the item's pixmap (pre-scaling, clear, camera switch)
+    if (frontPixmap.isNull() || m_pixmapItem->pixmap().cacheKey() != m_displayedFrameKey) {
+        return false;
+    }
+    if (frontPixmap.size() != image.size() || viewport()->rect().size() != m_frameBufferViewport) {
+        return false;
+    }
+
+    qreal widgetDpr = 1.0;
+    if (window()) widgetDpr = window()->devicePixelRatioF();
+    else widgetDpr = this->devicePixelRatioF();
+    if (!qFuzzyCompare(frontPixmap.devicePixelRatio(), widgetDpr)) {
+        return false;
+    }
+
+    QRegion damage;
+    for (const QRect& rect : dirtyRects) {
+        damage += rect.intersected(image.rect());
+    }
+    qint64 damagedPixels = 0;
+    for (const QRect& rect : damage) {
+        damagedPixels += static_cast<qint64>(rect.width()) * rect.height();
+    }
+    // Mostly-changed frames are cheaper as a single full conversion
+    if (damagedPixels * 10 > static_cast<qint64>(image.width()) * image.height() * 6) {
+        return false;
+    }
+
+    QPixmap& backPixmap = m_frameBuffers[back];
+    QRegion toPaint = damage;
+    if (backPixmap.size() != frontPixmap.size()) {
+        backPixmap = frontPixmap.copy();
+        backPixmap.setDevicePixelRatio(widgetDpr);
+    } else {
+        toPaint += m_bufferDamage[back];
+    }
+
+    {
+        QPainter painter(&backPixmap);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        for (const QRect& rect : toPaint) {
+            const QRectF target(rect.x() / widgetDpr, rect.y() / widgetDpr,
+                                rect.width() / widgetDpr, rect.height() / widgetDpr);
+            painter.drawImage(target, image, rect);
+        }
+    }
+    m_bufferDamage[back] = QRegion();
+    m_bufferDamage[front] += damage;
+
+    const bool firstPartial = !m_pixmapItem->hasPartialFrame();
+    m_pixmapItem->presentPartial(backPixmap, damage);
+    m_displayedFrameKey = m_pixmapItem->pixmap().cacheKey();
+    m_frontBuffer = back;
+    if (firstPartial) {
+        // The item still holds the full frame it was seeded with as its base
+        // pixmap; painting into that buffer would detach (copy) it every time,
+        // so the next back buffer starts as a fresh copy instead
+        m_frameBuffers[front] = QPixmap();
+        m_bufferDamage[front] = QRegion();
+    }
+    return true;
+}
+
+void VideoPane::resetFrameBuffers()
+{
+    m_frameBuffers[0] = QPixmap();
+    m_frameBuffers[1] = QPixmap();
+    m_bufferDamage[0] = QRegion();
+    m_bufferDamage[1] = QRegion();
+    m_frontBuffer = 0;
+    m_displayedFrameKey = 0;
+    m_frameBufferViewport = QSize();
+}
+
 // Update QGraphicsVideoItem from QImage (GUI thread conversion)
 void VideoPane::updateGraphicsVideoItemFromImage(QGraphicsVideoItem* videoItem, const QImage& image)
 {
@@ -1389,7 +1758,8 @@ void VideoPane::updateVideoFrame(const QPixmap& frame)
         }
 
         if (!m_pixmapItem) {
-            m_pixmapItem = m_scene->addPixmap(local);
+            m_pixmapItem = new VideoFrameItem(local);
+            m_scene->addItem(m_pixmapItem);
             m_pixmapItem->setZValue(2);
             m_pixmapItem->setTransformationMode(m_highQualityRendering ? Qt::SmoothTransformation
                                                                          : Qt::FastTransformation);
@@ -1423,7 +1793,8 @@ void VideoPane::updateVideoFrame(const QPixmap& frame)
     // FALLBACK: Non-viewport-sized frame - let transform pipeline handle it,
     // but keep pixmap DPR consistent and disable item caching to avoid stale scaled cache.
     if (!m_pixmapItem) {
-        m_pixmapItem = m_scene->addPixmap(local);
+        m_pixmapItem = new VideoFrameItem(local);
+        m_scene->addItem(m_pixmapItem);
         m_pixmapItem->setZValue(2);
         m_pixmapItem->setVisible(true);
         m_pixmapItem->setTransformationMode(m_highQualityRendering ? Qt::SmoothTransformation
@@ -1467,7 +1838,8 @@ void VideoPane::enableDirectFFmpegMode(bool enable)
         if (!m_pixmapItem) {
             QPixmap placeholder(640, 480);
             placeholder.fill(Qt::black);
-            m_pixmapItem = m_scene->addPixmap(placeholder);
+            m_pixmapItem = new VideoFrameItem(placeholder);
+            m_scene->addItem(m_pixmapItem);
             m_pixmapItem->setZValue(2); // Above video item
             qCDebug(log_ui_video) << "VideoPane: Created pixmap item for FFmpeg frames";
         }
@@ -1486,6 +1858,8 @@ void VideoPane::enableDirectFFmpegMode(bool enable)
         
     } else {
         qCDebug(log_ui_video) << "VideoPane: Disabling FFmpeg mode";
+        resetFrameBuffers();
+        m_rasterFrame = QImage();
         
         // Restore Qt video item when disabling FFmpeg mode
         if (m_videoItem) {
@@ -1514,6 +1888,8 @@ void VideoPane::enableDirectFFmpegMode(bool enable)
 void VideoPane::clearVideoFrame()
 {
     qWarning() << "VideoPane: Clearing current video frame";
+    resetFrameBuffers();
+    m_rasterFrame = QImage();
     
     if (m_pixmapItem) {
         // Create a black pixmap of the same size as the current one or default size
@@ -33,6 +33,28 @@
 
 Q_DECLARE_LOGGING_CATEGORY(log_ui_video)
 
+// Pixmap item that can swap in a same-sized frame and repaint only the areas
+// that changed; QGraphicsPixmapItem::setPixmap() always repaints the whole item.
+class VideoFrameItem : public QGraphicsPixmapItem
+{
+public:
+    explicit VideoFrameItem(const QPixmap& pixmap, QGraphicsItem* parent = nullptr);
+
+    // The frame on screen: the last partial frame, or the pixmap set last
+    QPixmap pixmap() const;
+
+    // Show `frame` (same size and DPR as the current pixmap), scheduling a repaint
+    // of `dirty` only (device pixels).  A later setPixmap() takes over again.
+    void presentPartial(const QPixmap& frame, const QRegion& dirty);
+    bool hasPartialFrame() const;
+
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+private:
+    QPixmap m_partialFrame;
+    qint64 m_basePixmapKey = 0;     // Base pixmap the partial frame was shown over
+};
+
 class VideoPane : public QGraphicsView
 {
     Q_OBJECT
@@ -77,10 +99,16 @@ public:
     // FFmpeg direct video frame support
     void updateVideoFrame(const QPixmap& frame);
     void updateVideoFrameFromImage(const QImage& image);  // Optimized: receives QImage, converts to QPixmap on GUI thread
+    void updateVideoFrameFromImage(const QImage& image, const QList<QRect>& dirtyRects);  // Repaints only dirtyRects (empty = full frame)
     void updateGraphicsVideoItemFromImage(QGraphicsVideoItem* videoItem, const QImage& image);  // Updates QGraphicsVideoItem from QImage
     void enableDirectFFmpegMode(bool enable = true);
     bool isDirectFFmpegModeEnabled() const { return m_directFFmpegMode; }
     void clearVideoFrame(); // Clear the current video frame display
+    
+    // Lightweight FFmpeg render mode: paintEvent draws the latest frame straight
+    // into the viewport, with no per-frame scene graph work (unzoomed only)
+    void setDirectRasterRendering(bool enable);
+    bool isDirectRasterRenderingEnabled() const { return m_directRasterRendering; }
 
     // Mouse position transformation for InputHandler
     QPointF getTransformedMousePosition(const QPoint& viewportPos);
@@ -105,6 +133,8 @@ signals:
     void mouseMoved(const QPoint& position, const QString& event);
     void videoPaneResized(const QSize& newSize);  // Signal for video pane resize events
     void viewportSizeChanged(const QSize& size);   // Signal for viewport size changes
+    void visibleSourceRectChanged(const QRectF& normalizedRect);  // Visible part of the frame (null = all of it)
+    void framePainted();  // First paint after a new FFmpeg frame arrived
 
 public slots:
     void onCameraDeviceSwitching(const QString& fromDevice, const QString& toDevice);
@@ -120,6 +150,7 @@ protected:
     void resizeEvent(QResizeEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
     void keyReleaseEvent(QKeyEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
 
 private:
     int lastX=0;
@@ -138,7 +169,7 @@ private:
     // Graphics framework components
     QGraphicsScene *m_scene;
     QGraphicsVideoItem *m_videoItem;
-    QGraphicsPixmapItem *m_pixmapItem;  // For displaying static frames
+    VideoFrameItem *m_pixmapItem;       // For displaying static frames
     
     // Aspect ratio and zoom control
     Qt::AspectRatioMode m_aspectRatioMode;
@@ -159,6 +190,37 @@ private:
     bool m_directFFmpegMode;
     QSize m_lastViewportSize;
     bool m_frameIsViewportSized;
+    
+    // Double-buffered frame pixmaps for dirty-region updates.  The pixmap
+    // item shows m_frameBuffers[m_frontBuffer]; changed areas are painted into
+    // the other buffer, which then becomes the front.  m_bufferDamage holds the
+    // areas a buffer is still missing from frames painted into its sibling.
+    QPixmap m_frameBuffers[2];
+    QRegion m_bufferDamage[2];
+    int m_frontBuffer = 0;
+    qint64 m_displayedFrameKey = 0;     // cacheKey() of the pixmap set on m_pixmapItem
+    QSize m_frameBufferViewport;        // Viewport size when the buffers were seeded
+    QRectF m_visibleSourceRect;         // Last value sent with visibleSourceRectChanged
+    
+    // Direct raster render path
+    bool m_directRasterRendering = false;
+    QImage m_rasterFrame;               // Latest frame (shares the decoder's buffer)
+    QRectF m_rasterTargetRect;          // Letterboxed destination in viewport coordinates
+    QSize m_rasterTargetFrameSize;      // Frame and viewport sizes m_rasterTargetRect was computed for
+    QSize m_rasterTargetViewportSize;
+    
+    // Frame-to-paint latency and GUI thread time per frame, for comparing the
+    // scene and raster paths.  Logged every few seconds.
+    QElapsedTimer m_renderClock;
+    qint64 m_unpaintedFrameNs = -1;     // Arrival of the oldest frame not yet painted
+    qint64 m_renderWindowStartNs = 0;
+    quint64 m_renderFrames = 0;
+    quint64 m_renderPaints = 0;
+    qint64 m_renderLatencyTotalNs = 0;
+    qint64 m_renderLatencyMaxNs = 0;
+    qint64 m_renderGuiTotalNs = 0;
+    qint64 m_renderGuiMaxNs = 0;
+    qint64 m_renderGuiPendingNs = 0;    // Frame handling time since the last paint
 
     // rendering quality hint flag (true=antialiasing enabled)
     bool m_highQualityRendering;
@@ -173,6 +235,17 @@ private:
     MouseEventDTO* calculateMouseEventDto(QMouseEvent *event);
     
     void captureCurrentFrame();
+    bool paintDirtyRegions(const QImage& image, const QList<QRect>& dirtyRects);
+    void resetFrameBuffers();
+    void publishVisibleSourceRect();
+    void presentFullFrame(const QImage& image);
+    bool useRasterPath() const;
+    void setRasterFrame(const QImage& image);
+    void updateRasterTargetRect();
+    void leaveRasterPath();
+    void paintRasterFrame();
+    void recordFrameArrival(qint64 startNs);
+    void recordPaint(qint64 startNs);
     void updateVideoItemTransform();
     void updateOverlayWidgetGeometry();
     void centerVideoItem();